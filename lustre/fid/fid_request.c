@@ -52,23 +52,23 @@
 #include <lustre_mdc.h>
 #include "fid_internal.h"
 
-static int seq_client_rpc(struct lu_client_seq *seq,
-                          struct lu_seq_range *output, __u32 opc,
-                          const char *opcname)
+/* Prefetch the next meta-sequence when this many FIDs of the current
+ * sequence are used, see seq_client_prefetch_check(). */
+#define SEQ_PREFETCH_WATERMARK(width)	((width) - ((width) >> 2))
+
+static struct ptlrpc_request *seq_client_req_pack(struct lu_client_seq *seq,
+						  __u32 opc)
 {
 	struct obd_export     *exp = seq->lcs_exp;
 	struct ptlrpc_request *req;
-	struct lu_seq_range   *out, *in;
+	struct lu_seq_range   *in;
 	__u32                 *op;
-	unsigned int           debug_mask;
-	int                    rc;
-	ENTRY;
 
 	LASSERT(exp != NULL && !IS_ERR(exp));
 	req = ptlrpc_request_alloc_pack(class_exp2cliimp(exp), &RQF_SEQ_QUERY,
 					LUSTRE_MDS_VERSION, SEQ_QUERY);
 	if (req == NULL)
-		RETURN(-ENOMEM);
+		return NULL;
 
 	/* Init operation code */
 	op = req_capsule_client_get(&req->rq_pill, &RMF_SEQ_OPC);
@@ -97,7 +97,6 @@ static int seq_client_rpc(struct lu_client_seq *seq,
 		 * it can not release the export of MDT0 */
 		if (seq->lcs_type == LUSTRE_SEQ_DATA)
 			req->rq_no_delay = req->rq_no_resend = 1;
-		debug_mask = D_CONSOLE;
 	} else {
 		if (seq->lcs_type == LUSTRE_SEQ_METADATA) {
 			req->rq_reply_portal = MDC_REPLY_PORTAL;
@@ -106,44 +105,200 @@ static int seq_client_rpc(struct lu_client_seq *seq,
 			req->rq_reply_portal = OSC_REPLY_PORTAL;
 			req->rq_request_portal = SEQ_DATA_PORTAL;
 		}
-
-		debug_mask = D_INFO;
 	}
 
 	ptlrpc_at_set_req_timeout(req);
 
-	if (opc != SEQ_ALLOC_SUPER && seq->lcs_type == LUSTRE_SEQ_METADATA)
-		mdc_get_rpc_lock(exp->exp_obd->u.cli.cl_rpc_lock, NULL);
-
-	rc = ptlrpc_queue_wait(req);
+	return req;
+}
 
-	if (opc != SEQ_ALLOC_SUPER && seq->lcs_type == LUSTRE_SEQ_METADATA)
-		mdc_put_rpc_lock(exp->exp_obd->u.cli.cl_rpc_lock, NULL);
-	if (rc)
-		GOTO(out_req, rc);
+static int seq_client_reply_unpack(struct lu_client_seq *seq,
+				   struct ptlrpc_request *req,
+				   struct lu_seq_range *output,
+				   const char *opcname, unsigned int debug_mask)
+{
+	struct lu_seq_range *out;
 
 	out = req_capsule_server_get(&req->rq_pill, &RMF_SEQ_RANGE);
+	if (out == NULL)
+		return -EPROTO;
+
 	*output = *out;
 
 	if (!range_is_sane(output)) {
 		CERROR("%s: Invalid range received from server: "
 		       DRANGE"\n", seq->lcs_name, PRANGE(output));
-		GOTO(out_req, rc = -EINVAL);
+		return -EINVAL;
 	}
 
 	if (range_is_exhausted(output)) {
 		CERROR("%s: Range received from server is exhausted: "
 		       DRANGE"]\n", seq->lcs_name, PRANGE(output));
-		GOTO(out_req, rc = -EINVAL);
+		return -EINVAL;
 	}
 
 	CDEBUG_LIMIT(debug_mask, "%s: Allocated %s-sequence "DRANGE"]\n",
 		     seq->lcs_name, opcname, PRANGE(output));
 
-	EXIT;
-out_req:
+	return 0;
+}
+
+static int seq_client_rpc(struct lu_client_seq *seq,
+                          struct lu_seq_range *output, __u32 opc,
+                          const char *opcname)
+{
+	struct obd_export     *exp = seq->lcs_exp;
+	struct ptlrpc_request *req;
+	int                    rc;
+	ENTRY;
+
+	req = seq_client_req_pack(seq, opc);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	if (opc != SEQ_ALLOC_SUPER && seq->lcs_type == LUSTRE_SEQ_METADATA)
+		mdc_get_rpc_lock(exp->exp_obd->u.cli.cl_rpc_lock, NULL);
+
+	rc = ptlrpc_queue_wait(req);
+
+	if (opc != SEQ_ALLOC_SUPER && seq->lcs_type == LUSTRE_SEQ_METADATA)
+		mdc_put_rpc_lock(exp->exp_obd->u.cli.cl_rpc_lock, NULL);
+	if (rc == 0)
+		rc = seq_client_reply_unpack(seq, req, output, opcname,
+					     opc == SEQ_ALLOC_SUPER ?
+					     D_CONSOLE : D_INFO);
+
 	ptlrpc_req_finished(req);
-	return rc;
+	RETURN(rc);
+}
+
+struct seq_prefetch_args {
+	struct lu_client_seq	*spa_seq;
+};
+
+static int seq_client_prefetch_interpret(const struct lu_env *env,
+					 struct ptlrpc_request *req,
+					 void *args, int rc)
+{
+	struct seq_prefetch_args *spa = args;
+	struct lu_client_seq	 *seq = spa->spa_seq;
+	struct lu_seq_range	  range;
+
+	if (rc == 0)
+		rc = seq_client_reply_unpack(seq, req, &range, "prefetch meta",
+					     D_INFO);
+	if (rc != 0)
+		/* the sequence will be allocated synchronously instead */
+		CDEBUG(D_INFO, "%s: prefetch meta-sequence failed: rc = %d\n",
+		       seq->lcs_name, rc);
+
+	/* \a seq can be freed once lcs_prefetch is cleared and the lock
+	 * is released, see seq_client_fini() */
+	spin_lock(&seq->lcs_lock);
+	if (rc == 0)
+		seq->lcs_next = range;
+	seq->lcs_prefetch = 0;
+	wake_up_all(&seq->lcs_waitq);
+	spin_unlock(&seq->lcs_lock);
+
+	return 0;
+}
+
+/**
+ * Fetch the next meta-sequence asynchronously.
+ *
+ * The request is not resent nor delayed by recovery, if it fails, the next
+ * sequence is allocated synchronously as before. Unlike the synchronous
+ * allocation, it does not take the MDC RPC lock: the sequence server does
+ * not reconstruct the reply (it uses a local transaction), and holding the
+ * lock over an async request would block the other modifications.
+ */
+static void seq_client_prefetch(struct lu_client_seq *seq)
+{
+	struct ptlrpc_request	 *req;
+	struct seq_prefetch_args *spa;
+
+	req = seq_client_req_pack(seq, SEQ_ALLOC_META);
+	if (req == NULL) {
+		spin_lock(&seq->lcs_lock);
+		seq->lcs_prefetch = 0;
+		wake_up_all(&seq->lcs_waitq);
+		spin_unlock(&seq->lcs_lock);
+		return;
+	}
+
+	req->rq_no_delay = req->rq_no_resend = 1;
+	CLASSERT(sizeof(*spa) <= sizeof(req->rq_async_args));
+	spa = ptlrpc_req_async_args(req);
+	spa->spa_seq = seq;
+	req->rq_interpret_reply = seq_client_prefetch_interpret;
+	ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
+}
+
+/**
+ * Start prefetching the next meta-sequence once most of the current
+ * sequence is used, so that FID allocation does not stall on the sequence
+ * RPC when the current one is exhausted.
+ *
+ * Only the clients which get their sequences from the server via RPC do
+ * this, and only if no sequence is left in the current meta-sequence.
+ */
+static void seq_client_prefetch_check(struct lu_client_seq *seq,
+				      const struct lu_fid *fid)
+{
+	bool prefetch = false;
+
+	if (seq->lcs_srv != NULL || seq->lcs_exp == NULL)
+		return;
+
+	if (fid_oid(fid) < SEQ_PREFETCH_WATERMARK(seq->lcs_width))
+		return;
+
+	/* lcs_space is only changed under lcs_mutex, it is checked without
+	 * the mutex as a hint: the prefetched meta-sequence is kept in
+	 * lcs_next until it is needed anyway. */
+	if (!range_is_exhausted(&seq->lcs_space))
+		return;
+
+	spin_lock(&seq->lcs_lock);
+	if (!seq->lcs_prefetch && range_is_exhausted(&seq->lcs_next) &&
+	    fid_seq(fid) == fid_seq(&seq->lcs_fid)) {
+		seq->lcs_prefetch = 1;
+		prefetch = true;
+	}
+	spin_unlock(&seq->lcs_lock);
+
+	if (prefetch)
+		seq_client_prefetch(seq);
+}
+
+/**
+ * Wait for the meta-sequence prefetch to finish and take its result.
+ *
+ * \retval true	\a space is set to the prefetched meta-sequence
+ * \retval false	nothing was prefetched
+ */
+static bool seq_client_prefetched(struct lu_client_seq *seq,
+				  struct lu_seq_range *space)
+{
+	struct l_wait_info lwi = { 0 };
+	bool		   got = false;
+
+	spin_lock(&seq->lcs_lock);
+	while (seq->lcs_prefetch) {
+		spin_unlock(&seq->lcs_lock);
+		l_wait_event(seq->lcs_waitq, seq->lcs_prefetch == 0, &lwi);
+		spin_lock(&seq->lcs_lock);
+	}
+
+	if (!range_is_exhausted(&seq->lcs_next)) {
+		*space = seq->lcs_next;
+		range_init(&seq->lcs_next);
+		got = true;
+	}
+	spin_unlock(&seq->lcs_lock);
+
+	return got;
 }
 
 /* Request sequence-controller node to allocate new super-sequence. */
@@ -193,6 +348,14 @@ static int seq_client_alloc_meta(const struct lu_env *env,
 		rc = 0;
 #endif
 	} else {
+		/* The meta-sequence was likely fetched in advance. */
+		if (seq_client_prefetched(seq, &seq->lcs_space)) {
+			CDEBUG(D_INFO, "%s: Use prefetched meta-sequence "
+			       DRANGE"\n", seq->lcs_name,
+			       PRANGE(&seq->lcs_space));
+			RETURN(0);
+		}
+
 		do {
 			/* If meta server return -EINPROGRESS or EAGAIN,
 			 * it means meta server might not be ready to
@@ -300,6 +463,7 @@ int seq_client_get_seq(const struct lu_env *env,
 
 	/* Since the caller require the whole seq,
 	 * so marked this seq to be used */
+	spin_lock(&seq->lcs_lock);
 	if (seq->lcs_type == LUSTRE_SEQ_METADATA)
 		seq->lcs_fid.f_oid = LUSTRE_METADATA_SEQ_MAX_WIDTH;
 	else
@@ -307,6 +471,7 @@ int seq_client_get_seq(const struct lu_env *env,
 
 	seq->lcs_fid.f_seq = *seqnr;
 	seq->lcs_fid.f_ver = 0;
+	spin_unlock(&seq->lcs_lock);
         /*
          * Inform caller that sequence switch is performed to allow it
          * to setup FLD for it.
@@ -318,69 +483,99 @@ int seq_client_get_seq(const struct lu_env *env,
 }
 EXPORT_SYMBOL(seq_client_get_seq);
 
+/**
+ * Allocate the next FID from the current sequence, if it is not used up.
+ *
+ * \retval true		\a fid is allocated
+ * \retval false	a new sequence is needed
+ */
+static bool seq_client_fid_next(struct lu_client_seq *seq, struct lu_fid *fid)
+{
+	bool got = false;
+
+	spin_lock(&seq->lcs_lock);
+	if (!fid_is_zero(&seq->lcs_fid) &&
+	    fid_oid(&seq->lcs_fid) < seq->lcs_width) {
+		/* Just bump last allocated fid and return to caller. */
+		seq->lcs_fid.f_oid += 1;
+		*fid = seq->lcs_fid;
+		got = true;
+	}
+	spin_unlock(&seq->lcs_lock);
+
+	return got;
+}
+
 /* Allocate new fid on passed client @seq and save it to @fid. */
 int seq_client_alloc_fid(const struct lu_env *env,
 			 struct lu_client_seq *seq, struct lu_fid *fid)
 {
 	wait_queue_t link;
-	int rc;
+	int rc = 0;
 	ENTRY;
 
 	LASSERT(seq != NULL);
 	LASSERT(fid != NULL);
 
+	if (OBD_FAIL_CHECK(OBD_FAIL_SEQ_EXHAUST)) {
+		spin_lock(&seq->lcs_lock);
+		seq->lcs_fid.f_oid = seq->lcs_width;
+		spin_unlock(&seq->lcs_lock);
+	}
+
+	/* Fast path, lcs_mutex is only needed to switch the sequence. */
+	if (seq_client_fid_next(seq, fid))
+		GOTO(out, rc = 0);
+
 	init_waitqueue_entry_current(&link);
 	mutex_lock(&seq->lcs_mutex);
 
-	if (OBD_FAIL_CHECK(OBD_FAIL_SEQ_EXHAUST))
-		seq->lcs_fid.f_oid = seq->lcs_width;
-
-        while (1) {
+	while (1) {
 		u64 seqnr;
 
-                if (!fid_is_zero(&seq->lcs_fid) &&
-                    fid_oid(&seq->lcs_fid) < seq->lcs_width) {
-                        /* Just bump last allocated fid and return to caller. */
-                        seq->lcs_fid.f_oid += 1;
-                        rc = 0;
-                        break;
-                }
+		if (seq_client_fid_next(seq, fid)) {
+			rc = 0;
+			break;
+		}
 
-                rc = seq_fid_alloc_prep(seq, &link);
-                if (rc)
-                        continue;
+		rc = seq_fid_alloc_prep(seq, &link);
+		if (rc)
+			continue;
 
-                rc = seq_client_alloc_seq(env, seq, &seqnr);
-                if (rc) {
-                        CERROR("%s: Can't allocate new sequence, "
-                               "rc %d\n", seq->lcs_name, rc);
-                        seq_fid_alloc_fini(seq);
+		rc = seq_client_alloc_seq(env, seq, &seqnr);
+		if (rc) {
+			CERROR("%s: Can't allocate new sequence, "
+			       "rc %d\n", seq->lcs_name, rc);
+			seq_fid_alloc_fini(seq);
 			mutex_unlock(&seq->lcs_mutex);
-                        RETURN(rc);
-                }
-
-                CDEBUG(D_INFO, "%s: Switch to sequence "
-                       "[0x%16.16"LPF64"x]\n", seq->lcs_name, seqnr);
+			RETURN(rc);
+		}
 
-                seq->lcs_fid.f_oid = LUSTRE_FID_INIT_OID;
-                seq->lcs_fid.f_seq = seqnr;
-                seq->lcs_fid.f_ver = 0;
+		CDEBUG(D_INFO, "%s: Switch to sequence "
+		       "[0x%16.16"LPF64"x]\n", seq->lcs_name, seqnr);
 
-                /*
-                 * Inform caller that sequence switch is performed to allow it
-                 * to setup FLD for it.
-                 */
-                rc = 1;
+		spin_lock(&seq->lcs_lock);
+		seq->lcs_fid.f_oid = LUSTRE_FID_INIT_OID;
+		seq->lcs_fid.f_seq = seqnr;
+		seq->lcs_fid.f_ver = 0;
+		*fid = seq->lcs_fid;
+		spin_unlock(&seq->lcs_lock);
 
-                seq_fid_alloc_fini(seq);
-                break;
-        }
+		/*
+		 * Inform caller that sequence switch is performed to allow it
+		 * to setup FLD for it.
+		 */
+		rc = 1;
 
-        *fid = seq->lcs_fid;
+		seq_fid_alloc_fini(seq);
+		break;
+	}
 	mutex_unlock(&seq->lcs_mutex);
+out:
+	seq_client_prefetch_check(seq, fid);
 
-        CDEBUG(D_INFO, "%s: Allocated FID "DFID"\n", seq->lcs_name,  PFID(fid));
-        RETURN(rc);
+	CDEBUG(D_INFO, "%s: Allocated FID "DFID"\n", seq->lcs_name,  PFID(fid));
+	RETURN(rc);
 }
 EXPORT_SYMBOL(seq_client_alloc_fid);
 
@@ -390,6 +585,7 @@ EXPORT_SYMBOL(seq_client_alloc_fid);
  */
 void seq_client_flush(struct lu_client_seq *seq)
 {
+	struct lu_seq_range range;
 	wait_queue_t link;
 
 	LASSERT(seq != NULL);
@@ -408,7 +604,13 @@ void seq_client_flush(struct lu_client_seq *seq)
 		set_current_state(TASK_RUNNING);
 	}
 
-        fid_zero(&seq->lcs_fid);
+	/* The prefetched meta-sequence may not be committed on the server,
+	 * drop it as well. */
+	seq_client_prefetched(seq, &range);
+
+	spin_lock(&seq->lcs_lock);
+	fid_zero(&seq->lcs_fid);
+	spin_unlock(&seq->lcs_lock);
         /**
          * this id shld not be used for seq range allocation.
          * set to -1 for dgb check.
@@ -483,6 +685,9 @@ int seq_client_init(struct lu_client_seq *seq,
 	seq->lcs_type = type;
 
 	mutex_init(&seq->lcs_mutex);
+	spin_lock_init(&seq->lcs_lock);
+	range_init(&seq->lcs_next);
+	seq->lcs_prefetch = 0;
 	if (type == LUSTRE_SEQ_METADATA)
 		seq->lcs_width = LUSTRE_METADATA_SEQ_MAX_WIDTH;
 	else
@@ -507,10 +712,14 @@ EXPORT_SYMBOL(seq_client_init);
 
 void seq_client_fini(struct lu_client_seq *seq)
 {
+	struct lu_seq_range range;
         ENTRY;
 
         seq_client_proc_fini(seq);
 
+	/* wait for the prefetch RPC which refers to \a seq */
+	seq_client_prefetched(seq, &range);
+
         if (seq->lcs_exp != NULL) {
                 class_export_put(seq->lcs_exp);
                 seq->lcs_exp = NULL;
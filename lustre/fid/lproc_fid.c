@@ -571,7 +571,9 @@ lprocfs_client_fid_width_seq_write(struct file *file, const char __user *buffer,
 		max = LUSTRE_METADATA_SEQ_MAX_WIDTH;
 
 	if (val <= max && val > 0) {
+		spin_lock(&seq->lcs_lock);
 		seq->lcs_width = val;
+		spin_unlock(&seq->lcs_lock);
 
 		if (rc == 0) {
 			CDEBUG(D_INFO, "%s: Sequence size: "LPU64"\n",
@@ -603,14 +605,16 @@ static int
 lprocfs_client_fid_fid_seq_show(struct seq_file *m, void *unused)
 {
 	struct lu_client_seq *seq = (struct lu_client_seq *)m->private;
+	struct lu_fid fid;
 	int rc;
 	ENTRY;
 
 	LASSERT(seq != NULL);
 
-	mutex_lock(&seq->lcs_mutex);
-	rc = seq_printf(m, DFID"\n", PFID(&seq->lcs_fid));
-	mutex_unlock(&seq->lcs_mutex);
+	spin_lock(&seq->lcs_lock);
+	fid = seq->lcs_fid;
+	spin_unlock(&seq->lcs_lock);
+	rc = seq_printf(m, DFID"\n", PFID(&fid));
 
 	RETURN(rc);
 }
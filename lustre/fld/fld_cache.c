@@ -46,7 +46,9 @@
 #include <libcfs/libcfs.h>
 #include <linux/module.h>
 #include <linux/math64.h>
+#include <linux/rcupdate.h>
 #include <obd_support.h>
+#include <lprocfs_status.h>
 #include <lustre_fld.h>
 #include "fld_internal.h"
 
@@ -68,9 +70,11 @@ struct fld_cache *fld_cache_init(const char *name,
 
 	INIT_LIST_HEAD(&cache->fci_entries_head);
 	INIT_LIST_HEAD(&cache->fci_lru);
+	INIT_LIST_HEAD(&cache->fci_retired);
+	spin_lock_init(&cache->fci_retired_lock);
 
         cache->fci_cache_count = 0;
-	rwlock_init(&cache->fci_lock);
+	mutex_init(&cache->fci_lock);
 
 	strlcpy(cache->fci_name, name,
                 sizeof(cache->fci_name));
@@ -78,8 +82,24 @@ struct fld_cache *fld_cache_init(const char *name,
         cache->fci_cache_size = cache_size;
         cache->fci_threshold = cache_threshold;
 
-        /* Init fld cache info. */
-        memset(&cache->fci_stat, 0, sizeof(cache->fci_stat));
+	/* Init fld cache info. */
+	cache->fci_stats = lprocfs_alloc_stats(FLD_CACHE_STAT_LAST,
+					       LPROCFS_STATS_FLAG_NONE);
+	if (cache->fci_stats == NULL) {
+		OBD_FREE_PTR(cache);
+		RETURN(ERR_PTR(-ENOMEM));
+	}
+	lprocfs_counter_init(cache->fci_stats, FLD_CACHE_STAT_LOOKUP, 0,
+			     "lookup", "reqs");
+	lprocfs_counter_init(cache->fci_stats, FLD_CACHE_STAT_MISS, 0,
+			     "miss", "reqs");
+	lprocfs_counter_init(cache->fci_stats, FLD_CACHE_STAT_RPC, 0,
+			     "rpc", "reqs");
+
+	/* Publish the empty array. */
+	cache->fci_modified = 1;
+	fld_cache_lock(cache);
+	fld_cache_unlock(cache);
 
         CDEBUG(D_INFO, "%s: FLD cache - Size: %d, Threshold: %d\n",
                cache->fci_name, cache_size, cache_threshold);
@@ -87,32 +107,147 @@ struct fld_cache *fld_cache_init(const char *name,
         RETURN(cache);
 }
 
+/**
+ * Free the replaced lookup arrays left by fld_cache_array_free().
+ */
+static void fld_cache_array_reap(struct fld_cache *cache)
+{
+	struct fld_cache_array *array;
+	struct fld_cache_array *tmp;
+	struct list_head	retired;
+
+	INIT_LIST_HEAD(&retired);
+	spin_lock_bh(&cache->fci_retired_lock);
+	list_splice_init(&cache->fci_retired, &retired);
+	spin_unlock_bh(&cache->fci_retired_lock);
+
+	list_for_each_entry_safe(array, tmp, &retired, fca_link) {
+		list_del(&array->fca_link);
+		OBD_FREE_LARGE(array, fld_cache_array_size(array->fca_count));
+	}
+}
+
+/**
+ * RCU callback, frees a lookup array once no reader can see it anymore.
+ *
+ * The large arrays are vmalloc()ed, and vfree() must not be called from
+ * the softirq context, so they are queued on \a fci_retired and freed by
+ * the next fld_cache_array_update() instead.
+ */
+static void fld_cache_array_free(struct rcu_head *head)
+{
+	struct fld_cache_array	*array;
+	struct fld_cache	*cache;
+	size_t			 size;
+
+	array = container_of(head, struct fld_cache_array, fca_rcu);
+	size = fld_cache_array_size(array->fca_count);
+	if (size <= OBD_ALLOC_BIG) {
+		OBD_FREE(array, size);
+		return;
+	}
+
+	cache = array->fca_cache;
+	spin_lock(&cache->fci_retired_lock);
+	list_add_tail(&array->fca_link, &cache->fci_retired);
+	spin_unlock(&cache->fci_retired_lock);
+}
+
 /**
  * destroy fld cache.
  */
 void fld_cache_fini(struct fld_cache *cache)
 {
-        __u64 pct;
-        ENTRY;
+	struct fld_cache_array *array;
+	__u64 count;
+	__u64 miss;
+	__u64 pct;
+	ENTRY;
 
-        LASSERT(cache != NULL);
-        fld_cache_flush(cache);
+	LASSERT(cache != NULL);
+	fld_cache_flush(cache);
+
+	count = lprocfs_stats_collector(cache->fci_stats, FLD_CACHE_STAT_LOOKUP,
+					LPROCFS_FIELDS_FLAGS_COUNT);
+	miss = lprocfs_stats_collector(cache->fci_stats, FLD_CACHE_STAT_MISS,
+				       LPROCFS_FIELDS_FLAGS_COUNT);
+	if (count > 0) {
+		pct = (count - miss) * 100;
+		do_div(pct, count);
+	} else {
+		pct = 0;
+	}
 
-        if (cache->fci_stat.fst_count > 0) {
-                pct = cache->fci_stat.fst_cache * 100;
-                do_div(pct, cache->fci_stat.fst_count);
-        } else {
-                pct = 0;
-        }
+	CDEBUG(D_INFO, "FLD cache statistics (%s):\n", cache->fci_name);
+	CDEBUG(D_INFO, "  Total reqs: "LPU64"\n", count);
+	CDEBUG(D_INFO, "  Cache reqs: "LPU64"\n", count - miss);
+	CDEBUG(D_INFO, "  Cache hits: "LPU64"%%\n", pct);
 
-        CDEBUG(D_INFO, "FLD cache statistics (%s):\n", cache->fci_name);
-        CDEBUG(D_INFO, "  Total reqs: "LPU64"\n", cache->fci_stat.fst_count);
-        CDEBUG(D_INFO, "  Cache reqs: "LPU64"\n", cache->fci_stat.fst_cache);
-        CDEBUG(D_INFO, "  Cache hits: "LPU64"%%\n", pct);
+	/* wait for the arrays replaced by the flush */
+	rcu_barrier();
+	fld_cache_array_reap(cache);
 
-        OBD_FREE_PTR(cache);
+	/* nobody can search the cache anymore */
+	array = cache->fci_array;
+	if (array != NULL)
+		OBD_FREE_LARGE(array, fld_cache_array_size(array->fca_count));
+	lprocfs_free_stats(&cache->fci_stats);
+	OBD_FREE_PTR(cache);
 
-        EXIT;
+	EXIT;
+}
+
+/**
+ * Rebuild the lookup array from the sorted entry list, the old one is
+ * freed by fld_cache_array_free() once no reader can see it anymore.
+ *
+ * Called under \a fci_lock.
+ */
+static void fld_cache_array_update(struct fld_cache *cache)
+{
+	struct fld_cache_array *array;
+	struct fld_cache_array *old;
+	struct fld_cache_entry *flde;
+	int i = 0;
+
+	OBD_ALLOC_LARGE(array, fld_cache_array_size(cache->fci_cache_count));
+	if (array != NULL) {
+		list_for_each_entry(flde, &cache->fci_entries_head, fce_list)
+			array->fca_ranges[i++] = flde->fce_range;
+		LASSERT(i == cache->fci_cache_count);
+		array->fca_cache = cache;
+		array->fca_count = i;
+		cache->fci_modified = 0;
+	} else {
+		/* lookups fall back to the list until the next update */
+		CDEBUG(D_INFO, "%s: cannot allocate lookup array for %d "
+		       "entries\n", cache->fci_name, cache->fci_cache_count);
+	}
+
+	old = cache->fci_array;
+	rcu_assign_pointer(cache->fci_array, array);
+	if (old != NULL)
+		call_rcu(&old->fca_rcu, fld_cache_array_free);
+
+	fld_cache_array_reap(cache);
+}
+
+/**
+ * Lock fld cache for modification.
+ */
+void fld_cache_lock(struct fld_cache *cache)
+{
+	mutex_lock(&cache->fci_lock);
+}
+
+/**
+ * Unlock fld cache, and make the modifications visible to the lookups.
+ */
+void fld_cache_unlock(struct fld_cache *cache)
+{
+	if (cache->fci_modified)
+		fld_cache_array_update(cache);
+	mutex_unlock(&cache->fci_lock);
 }
 
 /**
@@ -124,6 +259,7 @@ void fld_cache_entry_delete(struct fld_cache *cache,
 	list_del(&node->fce_list);
 	list_del(&node->fce_lru);
 	cache->fci_cache_count--;
+	cache->fci_modified = 1;
 	OBD_FREE_PTR(node);
 }
 
@@ -248,10 +384,10 @@ void fld_cache_flush(struct fld_cache *cache)
 {
 	ENTRY;
 
-	write_lock(&cache->fci_lock);
+	fld_cache_lock(cache);
 	cache->fci_cache_size = 0;
 	fld_cache_shrink(cache);
-	write_unlock(&cache->fci_lock);
+	fld_cache_unlock(cache);
 
 	EXIT;
 }
@@ -271,7 +407,7 @@ static void fld_cache_punch_hole(struct fld_cache *cache,
         struct fld_cache_entry *fldt;
 
         ENTRY;
-	OBD_ALLOC_GFP(fldt, sizeof *fldt, GFP_ATOMIC);
+	OBD_ALLOC_PTR(fldt);
         if (!fldt) {
                 OBD_FREE_PTR(f_new);
                 EXIT;
@@ -406,6 +542,7 @@ int fld_cache_insert_nolock(struct fld_cache *cache,
 	if (!cache->fci_no_shrink)
 		fld_cache_shrink(cache);
 
+	cache->fci_modified = 1;
 	head = &cache->fci_entries_head;
 
 	list_for_each_entry_safe(f_curr, n, head, fce_list) {
@@ -444,15 +581,45 @@ int fld_cache_insert(struct fld_cache *cache,
 	if (IS_ERR(flde))
 		RETURN(PTR_ERR(flde));
 
-	write_lock(&cache->fci_lock);
+	fld_cache_lock(cache);
 	rc = fld_cache_insert_nolock(cache, flde);
-	write_unlock(&cache->fci_lock);
+	fld_cache_unlock(cache);
 	if (rc)
 		OBD_FREE_PTR(flde);
 
 	RETURN(rc);
 }
 
+/**
+ * Insert a batch of ranges, e.g. the FLDB records, into fld cache.
+ *
+ * The lookup array is rebuilt only once for the whole batch.
+ */
+int fld_cache_insert_batch(struct fld_cache *cache,
+			   const struct lu_seq_range *ranges, int count)
+{
+	struct fld_cache_entry *flde;
+	int rc = 0;
+	int i;
+
+	fld_cache_lock(cache);
+	for (i = 0; i < count; i++) {
+		flde = fld_cache_entry_create(&ranges[i]);
+		if (IS_ERR(flde))
+			GOTO(out, rc = PTR_ERR(flde));
+
+		rc = fld_cache_insert_nolock(cache, flde);
+		if (rc != 0) {
+			OBD_FREE_PTR(flde);
+			break;
+		}
+	}
+out:
+	fld_cache_unlock(cache);
+
+	RETURN(rc);
+}
+
 void fld_cache_delete_nolock(struct fld_cache *cache,
 		      const struct lu_seq_range *range)
 {
@@ -479,9 +646,9 @@ void fld_cache_delete_nolock(struct fld_cache *cache,
 void fld_cache_delete(struct fld_cache *cache,
 		      const struct lu_seq_range *range)
 {
-	write_lock(&cache->fci_lock);
+	fld_cache_lock(cache);
 	fld_cache_delete_nolock(cache, range);
-	write_unlock(&cache->fci_lock);
+	fld_cache_unlock(cache);
 }
 
 struct fld_cache_entry *
@@ -515,29 +682,25 @@ fld_cache_entry_lookup(struct fld_cache *cache,
 	struct fld_cache_entry *got = NULL;
 	ENTRY;
 
-	read_lock(&cache->fci_lock);
+	fld_cache_lock(cache);
 	got = fld_cache_entry_lookup_nolock(cache, range);
-	read_unlock(&cache->fci_lock);
+	fld_cache_unlock(cache);
 
 	RETURN(got);
 }
 
 /**
- * lookup \a seq sequence for range in fld cache.
+ * lookup \a seq sequence for range in the fld cache entry list.
  */
-int fld_cache_lookup(struct fld_cache *cache,
-		     const u64 seq, struct lu_seq_range *range)
+static int fld_cache_lookup_list(struct fld_cache *cache,
+				 const u64 seq, struct lu_seq_range *range)
 {
 	struct fld_cache_entry *flde;
 	struct fld_cache_entry *prev = NULL;
-	struct list_head *head;
-	ENTRY;
+	int rc = -ENOENT;
 
-	read_lock(&cache->fci_lock);
-	head = &cache->fci_entries_head;
-
-	cache->fci_stat.fst_count++;
-	list_for_each_entry(flde, head, fce_list) {
+	fld_cache_lock(cache);
+	list_for_each_entry(flde, &cache->fci_entries_head, fce_list) {
 		if (flde->fce_range.lsr_start > seq) {
 			if (prev != NULL)
 				*range = prev->fce_range;
@@ -545,14 +708,71 @@ int fld_cache_lookup(struct fld_cache *cache,
 		}
 
 		prev = flde;
-                if (range_within(&flde->fce_range, seq)) {
-                        *range = flde->fce_range;
+		if (range_within(&flde->fce_range, seq)) {
+			*range = flde->fce_range;
+			rc = 0;
+			break;
+		}
+	}
+	fld_cache_unlock(cache);
+
+	return rc;
+}
 
-                        cache->fci_stat.fst_cache++;
-			read_unlock(&cache->fci_lock);
-			RETURN(0);
+/**
+ * lookup \a seq sequence for range in fld cache.
+ *
+ * The ranges in the cache don't overlap and are sorted by lsr_start, so
+ * the range containing \a seq can only be the last one starting at or
+ * before \a seq, it is found by binary search in the RCU protected array
+ * without taking any lock.
+ *
+ * \retval 0		found, \a range is the matched range
+ * \retval -ENOENT	not found, \a range is the left-side range if there
+ *			is any range on the right side of \a seq
+ */
+int fld_cache_lookup(struct fld_cache *cache,
+		     const u64 seq, struct lu_seq_range *range)
+{
+	struct fld_cache_array *array;
+	int start = 0;
+	int end;
+	int mid;
+	int rc = -ENOENT;
+	ENTRY;
+
+	lprocfs_counter_incr(cache->fci_stats, FLD_CACHE_STAT_LOOKUP);
+
+	rcu_read_lock();
+	array = rcu_dereference(cache->fci_array);
+	if (unlikely(array == NULL)) {
+		rcu_read_unlock();
+		rc = fld_cache_lookup_list(cache, seq, range);
+		goto out;
+	}
+
+	/* find the first range starting after seq */
+	end = array->fca_count;
+	while (start < end) {
+		mid = start + (end - start) / 2;
+		if (array->fca_ranges[mid].lsr_start > seq)
+			end = mid;
+		else
+			start = mid + 1;
+	}
+
+	if (start > 0) {
+		if (range_within(&array->fca_ranges[start - 1], seq)) {
+			*range = array->fca_ranges[start - 1];
+			rc = 0;
+		} else if (start < array->fca_count) {
+			*range = array->fca_ranges[start - 1];
 		}
 	}
-	read_unlock(&cache->fci_lock);
-	RETURN(-ENOENT);
+	rcu_read_unlock();
+out:
+	if (rc != 0)
+		lprocfs_counter_incr(cache->fci_stats, FLD_CACHE_STAT_MISS);
+
+	RETURN(rc);
 }
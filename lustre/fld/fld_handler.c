@@ -270,6 +270,8 @@ int fld_server_lookup(const struct lu_env *env, struct lu_server_fld *fld,
 		 * replication on all mdt servers.
 		 */
 		range->lsr_start = seq;
+		lprocfs_counter_incr(fld->lsf_cache->fci_stats,
+				     FLD_CACHE_STAT_RPC);
 		rc = fld_client_rpc(fld->lsf_control_exp,
 				    range, FLD_QUERY, NULL);
 		if (rc == 0)
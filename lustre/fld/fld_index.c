@@ -209,11 +209,11 @@ int fld_index_create(const struct lu_env *env, struct lu_server_fld *fld,
 	if (IS_ERR(flde))
 		GOTO(out, rc = PTR_ERR(flde));
 
-	write_lock(&fld->lsf_cache->fci_lock);
+	fld_cache_lock(fld->lsf_cache);
 	if (deleted)
 		fld_cache_delete_nolock(fld->lsf_cache, new_range);
 	rc = fld_cache_insert_nolock(fld->lsf_cache, flde);
-	write_unlock(&fld->lsf_cache->fci_lock);
+	fld_cache_unlock(fld->lsf_cache);
 	if (rc)
 		OBD_FREE_PTR(flde);
 out:
@@ -330,12 +330,13 @@ int fld_index_init(const struct lu_env *env, struct lu_server_fld *fld,
 	struct dt_object	*dt_obj = NULL;
 	struct lu_fid		fid;
 	struct lu_attr		*attr = NULL;
-	struct lu_seq_range	*range = NULL;
+	struct lu_seq_range	*ranges = NULL;
 	struct fld_thread_info	*info;
 	struct dt_object_format	dof;
 	struct dt_it		*it;
 	const struct dt_it_ops	*iops;
 	int			rc;
+	int			count = 0;
 	__u32			index;
 	ENTRY;
 
@@ -382,7 +383,10 @@ int fld_index_init(const struct lu_env *env, struct lu_server_fld *fld,
 		GOTO(out, rc);
 	}
 
-	range = &info->fti_rec;
+	OBD_ALLOC(ranges, FLD_INDEX_BATCH * sizeof(*ranges));
+	if (ranges == NULL)
+		GOTO(out, rc = -ENOMEM);
+
 	/* Load fld entry to cache */
 	iops = &dt_obj->do_index_ops->dio_it;
 	it = iops->init(env, dt_obj, 0, NULL);
@@ -394,18 +398,30 @@ int fld_index_init(const struct lu_env *env, struct lu_server_fld *fld,
 		GOTO(out_it_fini, rc);
 
 	if (rc > 0) {
-		/* Load FLD entry into server cache */
+		/* Load FLD entries into server cache in batches, so the
+		 * cache lookup array is not rebuilt for every entry */
 		do {
-			rc = iops->rec(env, it, (struct dt_rec *)range, 0);
-			if (rc != 0)
-				GOTO(out_it_put, rc);
-			LASSERT(range != NULL);
-			range_be_to_cpu(range, range);
-			rc = fld_cache_insert(fld->lsf_cache, range);
+			rc = iops->rec(env, it, (struct dt_rec *)&ranges[count],
+				       0);
 			if (rc != 0)
 				GOTO(out_it_put, rc);
+			range_be_to_cpu(&ranges[count], &ranges[count]);
+			if (++count == FLD_INDEX_BATCH) {
+				rc = fld_cache_insert_batch(fld->lsf_cache,
+							    ranges, count);
+				if (rc != 0)
+					GOTO(out_it_put, rc);
+				count = 0;
+			}
 			rc = iops->next(env, it);
 		} while (rc == 0);
+
+		if (count > 0) {
+			rc = fld_cache_insert_batch(fld->lsf_cache, ranges,
+						    count);
+			if (rc != 0)
+				GOTO(out_it_put, rc);
+		}
 	} else {
 		fld->lsf_new = 1;
 	}
@@ -436,6 +452,9 @@ out:
 	if (attr != NULL)
 		OBD_FREE_PTR(attr);
 
+	if (ranges != NULL)
+		OBD_FREE(ranges, FLD_INDEX_BATCH * sizeof(*ranges));
+
 	if (rc < 0) {
 		if (dt_obj != NULL)
 			lu_object_put(env, &dt_obj->do_lu);
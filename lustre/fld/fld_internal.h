@@ -69,9 +69,12 @@ enum {
         LUSTRE_FLD_RUN  = 1 << 1
 };
 
-struct fld_stats {
-        __u64   fst_count;
-        __u64   fst_cache;
+/* fld cache counters, see fld_cache::fci_stats */
+enum {
+	FLD_CACHE_STAT_LOOKUP	= 0,
+	FLD_CACHE_STAT_MISS,
+	FLD_CACHE_STAT_RPC,
+	FLD_CACHE_STAT_LAST
 };
 
 typedef int (*fld_hash_func_t) (struct lu_client_fld *, __u64);
@@ -93,12 +96,47 @@ struct fld_cache_entry {
 	struct lu_seq_range	fce_range;
 };
 
+/**
+ * Snapshot of the sorted fld cache entries, it is replaced as a whole
+ * whenever the cache is changed, so lookups can search it under RCU.
+ */
+struct fld_cache_array {
+	/**
+	 * Frees the array once the readers are done with it, see
+	 * fld_cache_array_free(). */
+	struct rcu_head		fca_rcu;
+	/**
+	 * Link in fld_cache::fci_retired, for the arrays which have to be
+	 * freed from process context. */
+	struct list_head	fca_link;
+	struct fld_cache	*fca_cache;
+	int			fca_count;
+	struct lu_seq_range	fca_ranges[0];
+};
+
+static inline size_t fld_cache_array_size(int count)
+{
+	return sizeof(struct fld_cache_array) +
+	       count * sizeof(struct lu_seq_range);
+}
+
 struct fld_cache {
 	/**
-	 * Cache guard, protects fci_hash mostly because others immutable after
-	 * init is finished.
+	 * Cache guard, serializes the cache modifications. The lookups do
+	 * not take it, they search \a fci_array instead.
 	 */
-	rwlock_t		 fci_lock;
+	struct mutex		 fci_lock;
+
+	/**
+	 * Sorted array of the cached ranges for lockless lookup, NULL if
+	 * it could not be allocated. Updated under \a fci_lock. */
+	struct fld_cache_array	*fci_array;
+
+	/**
+	 * Replaced arrays no reader can see anymore, which are too large to
+	 * be freed from the RCU callback. Protected by \a fci_retired_lock */
+	struct list_head	 fci_retired;
+	spinlock_t		 fci_retired_lock;
 
         /**
          * Cache shrink threshold */
@@ -120,14 +158,17 @@ struct fld_cache {
          * sorted fld entries. */
 	struct list_head	fci_entries_head;
 
-        /**
-         * Cache statistics. */
-        struct fld_stats         fci_stat;
+	/**
+	 * Cache statistics, FLD_CACHE_STAT_*. */
+	struct lprocfs_stats	*fci_stats;
 
         /**
          * Cache name used for debug and messages. */
         char                     fci_name[80];
-	unsigned int		 fci_no_shrink:1;
+	unsigned int		 fci_no_shrink:1,
+	/**
+	 * The entries are changed since \a fci_array was built. */
+				 fci_modified:1;
 };
 
 enum {
@@ -146,6 +187,9 @@ enum {
         FLD_CLIENT_CACHE_THRESHOLD = 10
 };
 
+/* Number of FLDB records loaded into the cache at once on server setup. */
+#define FLD_INDEX_BATCH (PAGE_CACHE_SIZE / sizeof(struct lu_seq_range))
+
 extern struct lu_fld_hash fld_hash[];
 
 
@@ -208,6 +252,13 @@ void fld_cache_flush(struct fld_cache *cache);
 int fld_cache_insert(struct fld_cache *cache,
 		     const struct lu_seq_range *range);
 
+int fld_cache_insert_batch(struct fld_cache *cache,
+			   const struct lu_seq_range *ranges, int count);
+
+void fld_cache_lock(struct fld_cache *cache);
+
+void fld_cache_unlock(struct fld_cache *cache);
+
 struct fld_cache_entry
 *fld_cache_entry_create(const struct lu_seq_range *range);
 
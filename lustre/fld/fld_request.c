@@ -250,6 +250,14 @@ static int fld_client_proc_init(struct lu_client_fld *fld)
 		GOTO(out_cleanup, rc);
 	}
 
+	rc = lprocfs_register_stats(fld->lcf_proc_dir, "cache_stats",
+				    fld->lcf_cache->fci_stats);
+	if (rc) {
+		CERROR("%s: Can't init FLD cache stats, rc %d\n",
+		       fld->lcf_name, rc);
+		GOTO(out_cleanup, rc);
+	}
+
 	RETURN(0);
 
 out_cleanup:
@@ -499,6 +507,8 @@ int fld_client_lookup(struct lu_client_fld *fld, u64 seq, u32 *mds,
 	} else
 #endif /* HAVE_SERVER_SUPPORT */
 	{
+		lprocfs_counter_incr(fld->lcf_cache->fci_stats,
+				     FLD_CACHE_STAT_RPC);
 		rc = fld_client_rpc(target->ft_exp, &res, FLD_QUERY, NULL);
 	}
 
@@ -68,6 +68,7 @@ struct dt_index_features;
 struct niobuf_local;
 struct niobuf_remote;
 struct ldlm_enqueue_info;
+struct ptlrpc_request_set;
 
 typedef enum {
         MNTOPT_USERXATTR        = 0x00000001,
@@ -1844,6 +1845,9 @@ struct thandle_update {
 	/* sent after or before local transaction */
 	unsigned int		tu_sent_after_local_trans:1,
 				tu_only_remote_trans:1;
+
+	/* update RPCs sent in parallel, see out_remote_send() */
+	struct ptlrpc_request_set *tu_rqset;
 };
 
 /**
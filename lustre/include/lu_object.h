@@ -593,6 +593,18 @@ enum {
         LU_SS_LAST_STAT
 };
 
+/**
+ * Buckets of lu_object lookup latency histogram, log2 of microseconds. The
+ * histogram is kept separately for lookups served from the cache (hit) and
+ * lookups which had to allocate the object (miss).
+ */
+enum {
+	LU_LOOKUP_HIST_BUCKETS	= 16,
+	LU_LOOKUP_HIST_HIT	= 0,
+	LU_LOOKUP_HIST_MISS	= LU_LOOKUP_HIST_BUCKETS,
+	LU_LOOKUP_HIST_LAST	= 2 * LU_LOOKUP_HIST_BUCKETS
+};
+
 /**
  * lu_site is a "compartment" within which objects are unique, and LRU
  * discipline is maintained.
@@ -638,6 +650,14 @@ struct lu_site {
 	 * lu_site stats
 	 */
 	struct lprocfs_stats	*ls_stats;
+	/**
+	 * lookup latency histogram, see LU_LOOKUP_HIST_*
+	 */
+	struct lprocfs_stats	*ls_lookup_hist;
+	/**
+	 * whether the lookup latency is accounted in ls_lookup_hist
+	 */
+	bool			 ls_lookup_hist_on;
 	/**
 	 * XXX: a hack! fld has to find md_site via site, remove when possible
 	 */
@@ -1289,6 +1309,9 @@ int  lu_env_refill_by_tags(struct lu_env *env, __u32 ctags, __u32 stags);
  */
 int lu_site_stats_seq_print(const struct lu_site *s, struct seq_file *m);
 int lu_site_stats_print(const struct lu_site *s, char *page, int count);
+int lu_site_lookup_hist_seq_print(const struct lu_site *s,
+				  struct seq_file *m);
+void lu_site_lookup_hist_enable(struct lu_site *s, bool enable);
 
 /**
  * Common name structure to be passed around for various name related methods.
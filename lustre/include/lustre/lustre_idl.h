@@ -2040,6 +2040,7 @@ extern void lustre_swab_quota_body(struct quota_body *b);
 enum {
 	LQUOTA_TYPE_USR	= 0x00, /* maps to USRQUOTA */
 	LQUOTA_TYPE_GRP	= 0x01, /* maps to GRPQUOTA */
+	LQUOTA_TYPE_PRJ	= 0x02, /* maps to PRJQUOTA */
 	LQUOTA_TYPE_MAX
 };
 
@@ -3608,6 +3609,9 @@ enum lfsck_events {
 	LE_SKIP_NLINK		= 14,
 	LE_SET_LMV_MASTER	= 15,
 	LE_SET_LMV_SLAVE	= 16,
+	LE_DIRTY_TRACK_ON	= 17,
+	LE_DIRTY_TRACK_OFF	= 18,
+	LE_DIRTY_MARK		= 19,
 };
 
 enum lfsck_event_flags {
@@ -4068,10 +4072,16 @@ struct object_update {
 struct object_update_request {
 	__u32			ourq_magic;
 	__u16			ourq_count;	/* number of ourq_updates[] */
-	__u16			ourq_padding;
+	__u16			ourq_flags;	/* enum update_request_flag */
 	struct object_update	ourq_updates[0];
 };
 
+enum update_request_flag {
+	/* updates with different batchid belong to independent transactions,
+	 * a failed one does not abort the others */
+	UPDATE_REQ_FL_BATCH	= 0x0001,
+};
+
 void lustre_swab_object_update(struct object_update *ou);
 void lustre_swab_object_update_request(struct object_update_request *our);
 
@@ -58,6 +58,9 @@ enum lfsck_param_flags {
 
 	/* Create MDT-object for dangling name entry. */
 	LPF_CREATE_MDTOBJ	= 0x0080,
+
+	/* Only check the objects modified since the last LFSCK run. */
+	LPF_INCREMENTAL		= 0x0100,
 };
 
 enum lfsck_type {
@@ -90,6 +93,7 @@ enum lfsck_start_valid {
 	LSV_ASYNC_WINDOWS	= 0x00000008,
 	LSV_CREATE_OSTOBJ	= 0x00000010,
 	LSV_CREATE_MDTOBJ	= 0x00000020,
+	LSV_INCREMENTAL		= 0x00000040,
 };
 
 /* Arguments for starting lfsck. */
@@ -113,7 +113,9 @@ struct obd_statfs {
 	__u32           os_fprecreated;	/* objs available now to the caller */
 					/* used in QoS code to find preferred
 					 * OSTs */
-        __u32           os_spare2;
+	__u32		os_io_latency;	/* recent bulk I/O service time in
+					 * usec, used in QoS code to avoid
+					 * the busy OSTs */
         __u32           os_spare3;
         __u32           os_spare4;
         __u32           os_spare5;
@@ -575,7 +577,18 @@ static inline __u64 lustre_stoqb(size_t space)
 #define LUSTRE_Q_INVALIDATE  0x80000b     /* invalidate quota data */
 #define LUSTRE_Q_FINVALIDATE 0x80000c     /* invalidate filter quota data */
 
-#define UGQUOTA 2       /* set both USRQUOTA and GRPQUOTA */
+/* Project quota is not known to older kernels and C libraries, but uses
+ * the same numbering as upstream so that Q_GETQUOTA can be passed through */
+#ifndef PRJQUOTA
+#define PRJQUOTA 2
+#endif
+
+/* number of quota types handled by the quota master and slaves */
+#define LL_MAXQUOTAS 3
+
+#define UGQUOTA 2       /* set both USRQUOTA and GRPQUOTA, deprecated since
+			 * it collides with PRJQUOTA, use ALLQUOTA instead */
+#define ALLQUOTA 255    /* set all quota types */
 
 struct if_quotacheck {
         char                    obd_type[16];
@@ -842,6 +855,13 @@ enum changelog_send_flag {
 	CHANGELOG_FLAG_BLOCK    = 0x02,
 	/* Pack jobid into the changelog records if available. */
 	CHANGELOG_FLAG_JOBID    = 0x04,
+	/* Only send records matching a struct changelog_filter, which then
+	 * follows struct ioc_changelog (see struct ioc_changelog_filter). */
+	CHANGELOG_FLAG_FILTER	= 0x08,
+	/* Drop a CLOSE, TRUNC, SETATTR, XATTR or [MCA]TIME record when a
+	 * later record of the same type for the same file follows closely.
+	 * Clearing up to a delivered record also covers those it replaced. */
+	CHANGELOG_FLAG_COLLAPSE	= 0x10,
 };
 
 #define CR_MAXSIZE cfs_size_round(2 * NAME_MAX + 2 + \
@@ -1011,6 +1031,46 @@ struct ioc_changelog {
         __u32 icc_flags;
 };
 
+/* Changelog record filter, applied by the client before records are queued
+ * to the reader. It does not reduce the llog reads from the MDS, which still
+ * send every record to the client. Fields left zero match every record. */
+struct changelog_filter {
+	__u32		cf_type_mask;	/**< 1 << CL_* of wanted record types */
+	__u32		cf_padding;
+	lustre_fid	cf_pfid;	/**< parent directory of the change */
+	char		cf_jobid[LUSTRE_JOBID_SIZE]; /**< job causing it */
+};
+
+struct ioc_changelog_filter {
+	struct ioc_changelog	icf_changelog;
+	struct changelog_filter	icf_filter;
+};
+
+static inline bool changelog_filter_match(const struct changelog_filter *cf,
+					  struct changelog_rec *rec)
+{
+	if (cf->cf_type_mask != 0 && rec->cr_type < 32 &&
+	    !(cf->cf_type_mask & (1U << rec->cr_type)))
+		return false;
+
+	if (!fid_is_zero(&cf->cf_pfid) &&
+	    memcmp(&cf->cf_pfid, &rec->cr_pfid, sizeof(cf->cf_pfid)) != 0) {
+		/* a rename also concerns its source directory */
+		if (!(rec->cr_flags & CLF_RENAME) ||
+		    memcmp(&cf->cf_pfid, &changelog_rec_rename(rec)->cr_spfid,
+			   sizeof(cf->cf_pfid)) != 0)
+			return false;
+	}
+
+	if (cf->cf_jobid[0] != '\0' &&
+	    (!(rec->cr_flags & CLF_JOBID) ||
+	     strncmp(cf->cf_jobid, changelog_rec_jobid(rec)->cr_jobid,
+		     sizeof(cf->cf_jobid)) != 0))
+		return false;
+
+	return true;
+}
+
 enum changelog_message_type {
         CL_RECORD = 10, /* message is a changelog_rec */
         CL_EOF    = 11, /* at end of current changelog */
@@ -338,6 +338,10 @@ extern int llapi_swap_layouts(const char *path1, const char *path2,
 
 extern int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 				 const char *mdtname, long long startrec);
+extern int llapi_changelog_start_filter(void **priv,
+					enum changelog_send_flag flags,
+					const char *mdtname, long long startrec,
+					const struct changelog_filter *filter);
 extern int llapi_changelog_fini(void **priv);
 extern int llapi_changelog_recv(void *priv, struct changelog_rec **rech);
 extern int llapi_changelog_free(struct changelog_rec **rech);
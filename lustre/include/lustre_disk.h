@@ -72,6 +72,7 @@
 #define LFSCK_BOOKMARK		"lfsck_bookmark"
 #define LFSCK_LAYOUT		"lfsck_layout"
 #define LFSCK_NAMESPACE		"lfsck_namespace"
+#define LFSCK_DIRTY		"lfsck_dirty"
 
 /****************** persistent mount data *********************/
 
@@ -237,6 +237,7 @@ enum local_oid {
 	LFSCK_NAMESPACE_OID     = 4122UL,
 	REMOTE_PARENT_DIR_OID	= 4123UL,
 	SLAVE_LLOG_CATALOGS_OID	= 4124UL,
+	ACCT_PROJECT_OID	= 4125UL,
 };
 
 static inline void lu_local_obj_fid(struct lu_fid *fid, __u32 oid)
@@ -282,9 +283,10 @@ static inline int fid_is_otable_it(const struct lu_fid *fid)
 
 static inline int fid_is_acct(const struct lu_fid *fid)
 {
-        return fid_seq(fid) == FID_SEQ_LOCAL_FILE &&
-               (fid_oid(fid) == ACCT_USER_OID ||
-                fid_oid(fid) == ACCT_GROUP_OID);
+	return fid_seq(fid) == FID_SEQ_LOCAL_FILE &&
+	       (fid_oid(fid) == ACCT_USER_OID ||
+		fid_oid(fid) == ACCT_GROUP_OID ||
+		fid_oid(fid) == ACCT_PROJECT_OID);
 }
 
 static inline int fid_is_quota(const struct lu_fid *fid)
@@ -387,6 +389,18 @@ struct lu_client_seq {
 	/* wait queue for fid allocation and update indicator */
 	wait_queue_head_t       lcs_waitq;
 	int                     lcs_update;
+
+	/*
+	 * Protects lcs_fid, lcs_next and lcs_prefetch, FIDs are allocated
+	 * from the current sequence without taking lcs_mutex.
+	 */
+	spinlock_t		lcs_lock;
+
+	/* Meta-sequence fetched before the current sequence is used up. */
+	struct lu_seq_range	lcs_next;
+
+	/* Prefetch RPC of lcs_next is in flight. */
+	int			lcs_prefetch;
 };
 
 /* server sequence manager interface */
@@ -132,6 +132,8 @@ int lfsck_register(const struct lu_env *env, struct dt_device *key,
 		   struct dt_device *next, struct obd_device *obd,
 		   lfsck_out_notify notify, void *notify_data, bool master);
 void lfsck_degister(const struct lu_env *env, struct dt_device *key);
+void lfsck_mark_dirty(const struct lu_env *env, struct dt_device *key,
+		      const struct lu_fid *fid);
 
 int lfsck_add_target(const struct lu_env *env, struct dt_device *key,
 		     struct dt_device *tgt, struct obd_export *exp,
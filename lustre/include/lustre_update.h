@@ -180,6 +180,13 @@ int out_prep_update_req(const struct lu_env *env, struct obd_import *imp,
 int out_remote_sync(const struct lu_env *env, struct obd_import *imp,
 		    struct dt_update_request *update,
 		    struct ptlrpc_request **reqp);
+int out_remote_send(const struct lu_env *env, struct obd_import *imp,
+		    struct dt_update_request *dt_update,
+		    struct thandle_update *tu);
+int out_remote_wait(const struct lu_env *env, struct thandle_update *tu);
+int update_buffer_resize(struct update_buffer *ubuf, size_t new_size);
+int out_update_merge(struct update_buffer *ubuf,
+		     const struct object_update_request *ureq, __u64 *batchid);
 int out_update_pack(const struct lu_env *env, struct update_buffer *ubuf,
 		    enum update_type op, const struct lu_fid *fid,
 		    int params_count, __u16 *param_sizes, const void **bufs,
@@ -49,6 +49,7 @@ static void lfsck_bookmark_le_to_cpu(struct lfsck_bookmark *des,
 	des->lb_async_windows = le16_to_cpu(src->lb_async_windows);
 	fid_le_to_cpu(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_le_to_cpu(&des->lb_last_fid, &src->lb_last_fid);
+	des->lb_dirty_flags = le32_to_cpu(src->lb_dirty_flags);
 }
 
 void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
@@ -61,6 +62,7 @@ void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
 	des->lb_async_windows = cpu_to_le16(src->lb_async_windows);
 	fid_cpu_to_le(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_cpu_to_le(&des->lb_last_fid, &src->lb_last_fid);
+	des->lb_dirty_flags = cpu_to_le32(src->lb_dirty_flags);
 }
 
 static int lfsck_bookmark_load(const struct lu_env *env,
@@ -228,6 +230,11 @@ int lfsck_set_param(const struct lu_env *env, struct lfsck_instance *lfsck,
 			dirty = true;
 		}
 
+		if (bk->lb_param & LPF_INCREMENTAL) {
+			bk->lb_param &= ~LPF_INCREMENTAL;
+			dirty = true;
+		}
+
 		if (__lfsck_set_speed(lfsck, LFSCK_SPEED_NO_LIMIT))
 			dirty = true;
 
@@ -295,6 +302,18 @@ int lfsck_set_param(const struct lu_env *env, struct lfsck_instance *lfsck,
 			}
 		}
 
+		if ((start->ls_valid & LSV_INCREMENTAL) || reset) {
+			if ((bk->lb_param & LPF_INCREMENTAL) &&
+			    !(start->ls_flags & LPF_INCREMENTAL)) {
+				bk->lb_param &= ~LPF_INCREMENTAL;
+				dirty = true;
+			} else if (!(bk->lb_param & LPF_INCREMENTAL) &&
+				   (start->ls_flags & LPF_INCREMENTAL)) {
+				bk->lb_param |= LPF_INCREMENTAL;
+				dirty = true;
+			}
+		}
+
 		if ((bk->lb_param & LPF_OST_ORPHAN) &&
 		    !(start->ls_flags & LPF_OST_ORPHAN)) {
 			bk->lb_param &= ~LPF_OST_ORPHAN;
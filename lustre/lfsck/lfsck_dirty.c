@@ -0,0 +1,820 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/lfsck/lfsck_dirty.c
+ *
+ * The dirty objects tracking for the incremental LFSCK.
+ *
+ * When the tracking is enabled, the MDD reports the FIDs of the objects
+ * modified by namespace or layout/attribute changes or by migration to the
+ * LFSCK through lfsck_mark_dirty(), and OUT reports the objects modified by
+ * the cross-MDT updates through the LE_DIRTY_MARK event. The FIDs are cached in RAM and flushed in batches
+ * by the "lfsck_dirty" thread into the active one of the two lfsck_dirty
+ * index files, outside of the MDD transactions.
+ *
+ * A full LFSCK run rebuilds the dirty set from scratch. When it completes
+ * the first phase scanning, the dirty set holds all the objects modified
+ * since the scan started, so it is marked as valid. Then the incremental
+ * LFSCK switches the new modifications to the other lfsck_dirty file and
+ * only checks the objects recorded in the former one.
+ *
+ * The RAM cache grows by pages as needed while the flush falls behind.
+ * The FIDs in it will be lost if the server crashes, or if the cache hits
+ * LFSCK_DIRTY_CACHE_MAX. In such case the dirty set is marked as invalid,
+ * and the next incremental LFSCK will fall back to a full scan.
+ *
+ * The MDD is told whether the tracking is enabled via the LE_DIRTY_TRACK_ON
+ * and LE_DIRTY_TRACK_OFF events, so it does not call lfsck_mark_dirty()
+ * for nothing.
+ */
+
+#define DEBUG_SUBSYSTEM S_LFSCK
+
+#include <lu_object.h>
+#include <dt_object.h>
+#include <lustre_fid.h>
+#include <lustre/lustre_user.h>
+
+#include "lfsck_internal.h"
+
+/* The FIDs cached in RAM, lfsck_instance::li_dirty_chunks is the list of
+ * them in the modification order. */
+struct lfsck_dirty_chunk {
+	struct list_head	ldc_link;
+	int			ldc_count;
+	struct lu_fid		ldc_fids[0];
+};
+
+#define LFSCK_DIRTY_CHUNK_SIZE		PAGE_CACHE_SIZE
+#define LFSCK_DIRTY_CHUNK_FIDS						\
+	((LFSCK_DIRTY_CHUNK_SIZE - sizeof(struct lfsck_dirty_chunk)) /	\
+	 sizeof(struct lu_fid))
+
+/* How many FIDs can be cached in RAM before being flushed. */
+#define LFSCK_DIRTY_CACHE_MAX		(1 << 20)
+
+/* Wake up the flush thread when so many FIDs are cached. */
+#define LFSCK_DIRTY_FLUSH_THRESHOLD	1024
+
+/* Flush the cached FIDs at least every so many seconds. */
+#define LFSCK_DIRTY_FLUSH_INTERVAL	5
+
+static inline int lfsck_dirty_active(struct lfsck_bookmark *bk)
+{
+	return bk->lb_dirty_flags & LDF_ACTIVE ? 1 : 0;
+}
+
+static int lfsck_dirty_load_one(const struct lu_env *env,
+				struct lfsck_instance *lfsck, int idx,
+				bool reset)
+{
+	char			*name = lfsck_env_info(env)->lti_key;
+	struct dt_object	*obj;
+	int			 rc;
+
+	snprintf(name, NAME_MAX, "%s_%02d", LFSCK_DIRTY, idx);
+	if (lfsck->li_dirty_objs[idx] != NULL) {
+		if (!reset)
+			return 0;
+
+		lfsck_object_put(env, lfsck->li_dirty_objs[idx]);
+		lfsck->li_dirty_objs[idx] = NULL;
+	}
+
+	if (reset) {
+		rc = local_object_unlink(env, lfsck->li_bottom,
+					 lfsck->li_lfsck_dir, name);
+		if (rc != 0 && rc != -ENOENT)
+			return rc;
+	}
+
+	obj = local_index_find_or_create(env, lfsck->li_los,
+					 lfsck->li_lfsck_dir, name,
+					 S_IFREG | S_IRUGO | S_IWUSR,
+					 &dt_lfsck_features);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+
+	rc = obj->do_ops->do_index_try(env, obj, &dt_lfsck_features);
+	if (rc != 0) {
+		lfsck_object_put(env, obj);
+		return rc;
+	}
+
+	lfsck->li_dirty_objs[idx] = obj;
+
+	return 0;
+}
+
+static int lfsck_dirty_reset(const struct lu_env *env,
+			     struct lfsck_instance *lfsck)
+{
+	int rc = 0;
+	int i;
+
+	for (i = 0; i < LFSCK_DIRTY_FILES && rc == 0; i++)
+		rc = lfsck_dirty_load_one(env, lfsck, i, true);
+
+	return rc;
+}
+
+static int lfsck_dirty_insert(const struct lu_env *env,
+			      struct lfsck_instance *lfsck,
+			      struct dt_object *obj,
+			      const struct lu_fid *fids, int count)
+{
+	struct lu_fid		*key	= &lfsck_env_info(env)->lti_fid3;
+	struct dt_device	*dev	= lfsck_obj2dev(obj);
+	struct thandle		*th;
+	__u8			 rec	= 1;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	th = dt_trans_create(env, dev);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	for (i = 0; i < count; i++) {
+		fid_cpu_to_be(key, &fids[i]);
+		rc = dt_declare_insert(env, obj, (const struct dt_rec *)&rec,
+				       (const struct dt_key *)key, th);
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+
+	rc = dt_trans_start_local(env, dev, th);
+	if (rc != 0)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count; i++) {
+		fid_cpu_to_be(key, &fids[i]);
+		rc = dt_insert(env, obj, (const struct dt_rec *)&rec,
+			       (const struct dt_key *)key, th, BYPASS_CAPA, 1);
+		/* Modified again since recorded. */
+		if (rc == -EEXIST)
+			rc = 0;
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+
+	GOTO(stop, rc);
+
+stop:
+	dt_trans_stop(env, dev, th);
+
+	return rc;
+}
+
+/**
+ * Flush the FIDs cached in RAM into the active lfsck_dirty file.
+ *
+ * If some FIDs cannot be recorded, then the dirty set becomes incomplete,
+ * the next incremental LFSCK has to rebuild it via a full scan.
+ *
+ * The caller should hold lfsck::li_dirty_mutex.
+ */
+static void __lfsck_dirty_flush(const struct lu_env *env,
+				struct lfsck_instance *lfsck)
+{
+	struct lfsck_bookmark		*bk	= &lfsck->li_bookmark_ram;
+	struct lfsck_dirty_chunk	*ldc;
+	struct lfsck_dirty_chunk	*next;
+	struct dt_object		*obj;
+	struct list_head		 head;
+	int				 rc	= 0;
+	int				 i;
+	bool				 overflow;
+
+	INIT_LIST_HEAD(&head);
+	spin_lock(&lfsck->li_dirty_lock);
+	list_splice_init(&lfsck->li_dirty_chunks, &head);
+	overflow = lfsck->li_dirty_overflow;
+	lfsck->li_dirty_count = 0;
+	lfsck->li_dirty_overflow = 0;
+	spin_unlock(&lfsck->li_dirty_lock);
+
+	obj = lfsck->li_dirty_objs[lfsck_dirty_active(bk)];
+	list_for_each_entry_safe(ldc, next, &head, ldc_link) {
+		for (i = 0; i < ldc->ldc_count && rc == 0;
+		     i += LFSCK_DIRTY_BATCH)
+			rc = lfsck_dirty_insert(env, lfsck, obj,
+						ldc->ldc_fids + i,
+						min_t(int, ldc->ldc_count - i,
+						      LFSCK_DIRTY_BATCH));
+
+		list_del(&ldc->ldc_link);
+		OBD_FREE(ldc, LFSCK_DIRTY_CHUNK_SIZE);
+	}
+
+	if ((rc != 0 || overflow) &&
+	    bk->lb_dirty_flags & (LDF_VALID | LDF_FULL_SCAN)) {
+		CDEBUG(D_LFSCK, "%s: fail to record the modified objects, "
+		       "the next incremental LFSCK will scan the whole "
+		       "device: overflow = %d, rc = %d\n",
+		       lfsck_lfsck2name(lfsck), overflow ? 1 : 0, rc);
+
+		bk->lb_dirty_flags &= ~(LDF_VALID | LDF_FULL_SCAN);
+		lfsck_bookmark_store(env, lfsck);
+	}
+}
+
+static void lfsck_dirty_flush(const struct lu_env *env,
+			      struct lfsck_instance *lfsck)
+{
+	mutex_lock(&lfsck->li_dirty_mutex);
+	__lfsck_dirty_flush(env, lfsck);
+	mutex_unlock(&lfsck->li_dirty_mutex);
+}
+
+static int lfsck_dirty_engine(void *args)
+{
+	struct lfsck_thread_args *lta	 = args;
+	struct lu_env		 *env	 = &lta->lta_env;
+	struct lfsck_instance	 *lfsck	 = lta->lta_lfsck;
+	struct ptlrpc_thread	 *thread = &lfsck->li_dirty_thread;
+	struct l_wait_info	  lwi;
+	ENTRY;
+
+	spin_lock(&lfsck->li_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&lfsck->li_lock);
+	wake_up_all(&thread->t_ctl_waitq);
+
+	while (1) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(LFSCK_DIRTY_FLUSH_INTERVAL),
+				  NULL, NULL);
+		l_wait_event(thread->t_ctl_waitq,
+			     lfsck->li_dirty_count >=
+					LFSCK_DIRTY_FLUSH_THRESHOLD ||
+			     lfsck->li_dirty_overflow ||
+			     !thread_is_running(thread),
+			     &lwi);
+
+		/* Flush the left FIDs before exit. */
+		lfsck_dirty_flush(env, lfsck);
+		if (unlikely(!thread_is_running(thread)))
+			break;
+	}
+
+	spin_lock(&lfsck->li_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&lfsck->li_lock);
+	wake_up_all(&thread->t_ctl_waitq);
+	lfsck_thread_args_fini(lta);
+
+	RETURN(0);
+}
+
+static int lfsck_dirty_thread_start(const struct lu_env *env,
+				    struct lfsck_instance *lfsck)
+{
+	struct ptlrpc_thread		*thread = &lfsck->li_dirty_thread;
+	struct lfsck_thread_args	*lta;
+	struct task_struct		*task;
+	struct l_wait_info		 lwi	= { 0 };
+	int				 rc;
+
+	if (thread_is_running(thread))
+		return 0;
+
+	thread_set_flags(thread, 0);
+	lta = lfsck_thread_args_init(lfsck, NULL, NULL);
+	if (IS_ERR(lta))
+		return PTR_ERR(lta);
+
+	task = kthread_run(lfsck_dirty_engine, lta, "lfsck_dirty");
+	if (IS_ERR(task)) {
+		rc = PTR_ERR(task);
+		CERROR("%s: cannot start LFSCK dirty thread: rc = %d\n",
+		       lfsck_lfsck2name(lfsck), rc);
+		lfsck_thread_args_fini(lta);
+
+		return rc;
+	}
+
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_running(thread) ||
+		     thread_is_stopped(thread),
+		     &lwi);
+
+	spin_lock(&lfsck->li_dirty_lock);
+	lfsck->li_dirty_tracking = 1;
+	spin_unlock(&lfsck->li_dirty_lock);
+
+	if (lfsck->li_out_notify != NULL)
+		lfsck->li_out_notify(env, lfsck->li_out_notify_data,
+				     LE_DIRTY_TRACK_ON);
+
+	return 0;
+}
+
+/**
+ * Stop recording the modified objects.
+ *
+ * \retval	true if the tracking was running, then all the cached FIDs
+ *		have been flushed to disk
+ * \retval	false if the tracking was not running
+ */
+static bool lfsck_dirty_thread_stop(const struct lu_env *env,
+				    struct lfsck_instance *lfsck)
+{
+	struct ptlrpc_thread	*thread = &lfsck->li_dirty_thread;
+	struct l_wait_info	 lwi	= { 0 };
+
+	if (lfsck->li_out_notify != NULL)
+		lfsck->li_out_notify(env, lfsck->li_out_notify_data,
+				     LE_DIRTY_TRACK_OFF);
+
+	spin_lock(&lfsck->li_dirty_lock);
+	lfsck->li_dirty_tracking = 0;
+	spin_unlock(&lfsck->li_dirty_lock);
+
+	spin_lock(&lfsck->li_lock);
+	if (thread_is_init(thread) || thread_is_stopped(thread)) {
+		spin_unlock(&lfsck->li_lock);
+
+		return false;
+	}
+
+	thread_set_flags(thread, SVC_STOPPING);
+	spin_unlock(&lfsck->li_lock);
+
+	wake_up_all(&thread->t_ctl_waitq);
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_stopped(thread),
+		     &lwi);
+
+	return true;
+}
+
+/**
+ * Record the FID of the modified object in RAM.
+ *
+ * It is called by the MDD inside the modification transaction, so it only
+ * caches the FID and leaves the flush to the "lfsck_dirty" thread.
+ *
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] fid	the FID of the modified object
+ */
+void lfsck_dirty_add(struct lfsck_instance *lfsck, const struct lu_fid *fid)
+{
+	struct lfsck_dirty_chunk	*ldc;
+	struct lfsck_dirty_chunk	*new	= NULL;
+	bool				 wakeup = false;
+
+	if (!lfsck->li_dirty_tracking)
+		return;
+
+again:
+	spin_lock(&lfsck->li_dirty_lock);
+	if (unlikely(!lfsck->li_dirty_tracking))
+		goto unlock;
+
+	ldc = NULL;
+	if (!list_empty(&lfsck->li_dirty_chunks))
+		ldc = list_entry(lfsck->li_dirty_chunks.prev,
+				 struct lfsck_dirty_chunk, ldc_link);
+
+	/* Consecutive changes to the same object are common. */
+	if (ldc != NULL && ldc->ldc_count > 0 &&
+	    lu_fid_eq(&ldc->ldc_fids[ldc->ldc_count - 1], fid))
+		goto unlock;
+
+	if (ldc == NULL || ldc->ldc_count == LFSCK_DIRTY_CHUNK_FIDS) {
+		if (unlikely(lfsck->li_dirty_count >= LFSCK_DIRTY_CACHE_MAX))
+			goto overflow;
+
+		if (new == NULL) {
+			spin_unlock(&lfsck->li_dirty_lock);
+			OBD_ALLOC(new, LFSCK_DIRTY_CHUNK_SIZE);
+			if (new != NULL)
+				goto again;
+
+			spin_lock(&lfsck->li_dirty_lock);
+			goto overflow;
+		}
+
+		list_add_tail(&new->ldc_link, &lfsck->li_dirty_chunks);
+		ldc = new;
+		new = NULL;
+	}
+
+	ldc->ldc_fids[ldc->ldc_count++] = *fid;
+	if (++lfsck->li_dirty_count == LFSCK_DIRTY_FLUSH_THRESHOLD)
+		wakeup = true;
+	goto unlock;
+
+overflow:
+	if (!lfsck->li_dirty_overflow) {
+		lfsck->li_dirty_overflow = 1;
+		wakeup = true;
+	}
+
+unlock:
+	spin_unlock(&lfsck->li_dirty_lock);
+	if (new != NULL)
+		OBD_FREE(new, LFSCK_DIRTY_CHUNK_SIZE);
+	if (wakeup)
+		wake_up_all(&lfsck->li_dirty_thread.t_ctl_waitq);
+}
+
+/**
+ * Load the lfsck_dirty files and the tracking state when the MDT mounts.
+ *
+ * If the server was not stopped cleanly last time, then the FIDs cached in
+ * RAM were lost, and the dirty set cannot be trusted any longer.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+int lfsck_dirty_setup(const struct lu_env *env, struct lfsck_instance *lfsck)
+{
+	struct lfsck_bookmark	*bk = &lfsck->li_bookmark_ram;
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	for (i = 0; i < LFSCK_DIRTY_FILES; i++) {
+		rc = lfsck_dirty_load_one(env, lfsck, i, false);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
+	if (!(bk->lb_dirty_flags & LDF_TRACKING))
+		RETURN(0);
+
+	if (bk->lb_dirty_flags & LDF_OPEN) {
+		CDEBUG(D_LFSCK, "%s: the modified objects may be lost since "
+		       "last unclean shutdown, the next incremental LFSCK "
+		       "will scan the whole device\n",
+		       lfsck_lfsck2name(lfsck));
+
+		bk->lb_dirty_flags &= ~(LDF_VALID | LDF_FULL_SCAN);
+	}
+
+	bk->lb_dirty_flags |= LDF_OPEN;
+	rc = lfsck_bookmark_store(env, lfsck);
+
+	RETURN(rc);
+}
+
+/**
+ * Start recording the modified objects if the tracking has been enabled.
+ *
+ * It is called after the lfsck instance has been registered. Failing to
+ * start the thread is not fatal: the dirty set still has LDF_OPEN on disk,
+ * so it will be dropped at the next mount.
+ */
+void lfsck_dirty_resume(const struct lu_env *env,
+			struct lfsck_instance *lfsck)
+{
+	if (lfsck->li_master &&
+	    lfsck->li_bookmark_ram.lb_dirty_flags & LDF_TRACKING)
+		lfsck_dirty_thread_start(env, lfsck);
+}
+
+/**
+ * Stop recording the modified objects when the MDT is going to umount.
+ *
+ * All the cached FIDs have been flushed to disk, so clear LDF_OPEN to
+ * keep the dirty set valid for the next mount.
+ */
+void lfsck_dirty_fini(const struct lu_env *env, struct lfsck_instance *lfsck)
+{
+	struct lfsck_bookmark *bk = &lfsck->li_bookmark_ram;
+
+	if (!lfsck->li_master || !lfsck_dirty_thread_stop(env, lfsck))
+		return;
+
+	mutex_lock(&lfsck->li_dirty_mutex);
+	if (bk->lb_dirty_flags & LDF_OPEN) {
+		bk->lb_dirty_flags &= ~LDF_OPEN;
+		lfsck_bookmark_store(env, lfsck);
+	}
+	mutex_unlock(&lfsck->li_dirty_mutex);
+}
+
+void lfsck_dirty_cleanup(const struct lu_env *env,
+			 struct lfsck_instance *lfsck)
+{
+	struct lfsck_dirty_chunk	*ldc;
+	struct lfsck_dirty_chunk	*next;
+	int				 i;
+
+	for (i = 0; i < LFSCK_DIRTY_FILES; i++) {
+		if (lfsck->li_dirty_objs[i] != NULL) {
+			lfsck_object_put(env, lfsck->li_dirty_objs[i]);
+			lfsck->li_dirty_objs[i] = NULL;
+		}
+	}
+
+	list_for_each_entry_safe(ldc, next, &lfsck->li_dirty_chunks,
+				 ldc_link) {
+		list_del(&ldc->ldc_link);
+		OBD_FREE(ldc, LFSCK_DIRTY_CHUNK_SIZE);
+	}
+	lfsck->li_dirty_count = 0;
+}
+
+/**
+ * Decide how the master engine will scan for the new LFSCK run.
+ *
+ * If the incremental LFSCK is required and the dirty set is valid, then
+ * switch the new modifications to the other lfsck_dirty file, the master
+ * engine will only check the objects recorded in the current one. If the
+ * former incremental LFSCK did not finish, then go on with its file.
+ *
+ * Otherwise, the LFSCK will scan the whole device. If the tracking is
+ * enabled, then the dirty set is rebuilt from scratch, and the scan has
+ * to start from the device beginning, unless it resumes a former full
+ * scan for rebuilding the dirty set.
+ *
+ * Specifying "-i off" disables the tracking and drops the dirty set.
+ *
+ * The caller should hold lfsck::li_mutex.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] start	pointer to the start parameters
+ *
+ * \retval		positive number if the LFSCK components need reset
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+int lfsck_dirty_start(const struct lu_env *env, struct lfsck_instance *lfsck,
+		      struct lfsck_start *start)
+{
+	struct lfsck_bookmark	*bk	= &lfsck->li_bookmark_ram;
+	int			 rc	= 0;
+	ENTRY;
+
+	if (!lfsck->li_master)
+		RETURN(0);
+
+	if (start->ls_valid & LSV_INCREMENTAL &&
+	    !(start->ls_flags & LPF_INCREMENTAL)) {
+		if (!(bk->lb_dirty_flags & LDF_TRACKING))
+			RETURN(0);
+
+		lfsck_dirty_thread_stop(env, lfsck);
+		mutex_lock(&lfsck->li_dirty_mutex);
+		bk->lb_dirty_flags = 0;
+		rc = lfsck_dirty_reset(env, lfsck);
+		if (rc == 0)
+			rc = lfsck_bookmark_store(env, lfsck);
+		mutex_unlock(&lfsck->li_dirty_mutex);
+
+		RETURN(rc);
+	}
+
+	if (!(bk->lb_param & LPF_INCREMENTAL) &&
+	    !(bk->lb_dirty_flags & LDF_TRACKING))
+		RETURN(0);
+
+	mutex_lock(&lfsck->li_dirty_mutex);
+	if (!thread_is_running(&lfsck->li_dirty_thread)) {
+		rc = lfsck_dirty_thread_start(env, lfsck);
+		if (rc != 0)
+			GOTO(unlock, rc);
+
+		/* The former modifications have not been recorded. */
+		bk->lb_dirty_flags &= ~(LDF_VALID | LDF_FULL_SCAN);
+		bk->lb_dirty_flags |= LDF_TRACKING | LDF_OPEN;
+	} else {
+		__lfsck_dirty_flush(env, lfsck);
+	}
+
+	if (bk->lb_param & LPF_INCREMENTAL &&
+	    bk->lb_dirty_flags & LDF_VALID) {
+		if (!(bk->lb_dirty_flags & LDF_INCR_SCAN)) {
+			/* The inactive file has been emptied by the former
+			 * incremental LFSCK, make sure of that. */
+			rc = lfsck_dirty_load_one(env, lfsck,
+					!lfsck_dirty_active(bk), true);
+			if (rc != 0)
+				GOTO(unlock, rc);
+
+			bk->lb_dirty_flags ^= LDF_ACTIVE;
+			bk->lb_dirty_flags |= LDF_INCR_SCAN;
+		}
+	} else if (start->ls_flags & LPF_RESET ||
+		   !(bk->lb_dirty_flags & LDF_FULL_SCAN)) {
+		rc = lfsck_dirty_reset(env, lfsck);
+		if (rc != 0)
+			GOTO(unlock, rc);
+
+		bk->lb_dirty_flags &= ~(LDF_VALID | LDF_INCR_SCAN);
+		bk->lb_dirty_flags |= LDF_FULL_SCAN;
+		rc = 1;
+	}
+
+	GOTO(unlock, rc);
+
+unlock:
+	if (rc >= 0) {
+		int rc1 = lfsck_bookmark_store(env, lfsck);
+
+		if (rc1 != 0)
+			rc = rc1;
+	}
+	mutex_unlock(&lfsck->li_dirty_mutex);
+
+	CDEBUG(D_LFSCK, "%s: prepare the %s LFSCK, dirty flags %#x: rc = %d\n",
+	       lfsck_lfsck2name(lfsck),
+	       bk->lb_dirty_flags & LDF_INCR_SCAN ? "incremental" : "full",
+	       bk->lb_dirty_flags, rc);
+
+	return rc;
+}
+
+/**
+ * Update the dirty set when the master engine has finished the first phase
+ * scanning.
+ *
+ * After a full scan, the dirty set holds all the objects modified since
+ * the scan started, so it becomes valid. After an incremental scan, all
+ * the recorded objects have been checked, so its file is emptied.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+int lfsck_dirty_post(const struct lu_env *env, struct lfsck_instance *lfsck)
+{
+	struct lfsck_bookmark	*bk	= &lfsck->li_bookmark_ram;
+	int			 rc	= 0;
+
+	if (!lfsck->li_master)
+		return 0;
+
+	mutex_lock(&lfsck->li_dirty_mutex);
+	if (bk->lb_dirty_flags & LDF_INCR_SCAN) {
+		rc = lfsck_dirty_load_one(env, lfsck,
+					  !lfsck_dirty_active(bk), true);
+		if (rc == 0) {
+			bk->lb_dirty_flags &= ~LDF_INCR_SCAN;
+			rc = lfsck_bookmark_store(env, lfsck);
+		}
+	} else if (bk->lb_dirty_flags & LDF_FULL_SCAN) {
+		bk->lb_dirty_flags &= ~LDF_FULL_SCAN;
+		bk->lb_dirty_flags |= LDF_VALID;
+		rc = lfsck_bookmark_store(env, lfsck);
+	}
+	mutex_unlock(&lfsck->li_dirty_mutex);
+
+	return rc;
+}
+
+/**
+ * Load a batch of FIDs to be checked by the incremental LFSCK.
+ *
+ * The checked FIDs are removed via lfsck_dirty_delete(), so it always
+ * loads from the beginning of the inactive lfsck_dirty file.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[out] fids	the buffer for the loaded FIDs
+ * \param[in] count	how many FIDs can be held in the buffer
+ *
+ * \retval		the count of the loaded FIDs, 0 if all done
+ * \retval		negative error number on failure
+ */
+int lfsck_dirty_load(const struct lu_env *env, struct lfsck_instance *lfsck,
+		     struct lu_fid *fids, int count)
+{
+	struct lfsck_bookmark	*bk	= &lfsck->li_bookmark_ram;
+	struct dt_object	*obj;
+	const struct dt_it_ops	*iops;
+	struct dt_it		*di;
+	struct dt_key		*key;
+	struct lu_fid		 fid;
+	int			 loaded	= 0;
+	int			 rc;
+	ENTRY;
+
+	obj = lfsck->li_dirty_objs[!lfsck_dirty_active(bk)];
+	iops = &obj->do_index_ops->dio_it;
+	di = iops->init(env, obj, 0, BYPASS_CAPA);
+	if (IS_ERR(di))
+		RETURN(PTR_ERR(di));
+
+	fid_zero(&fid);
+	rc = iops->get(env, di, (const struct dt_key *)&fid);
+	if (rc < 0)
+		GOTO(fini, rc);
+
+	do {
+		key = iops->key(env, di);
+		if (IS_ERR(key)) {
+			rc = PTR_ERR(key);
+			if (rc == -ENOENT)
+				rc = 1;
+			break;
+		}
+
+		fid_be_to_cpu(&fids[loaded++], (const struct lu_fid *)key);
+		rc = iops->next(env, di);
+	} while (rc == 0 && loaded < count);
+
+	iops->put(env, di);
+
+	GOTO(fini, rc);
+
+fini:
+	iops->fini(env, di);
+
+	return rc < 0 ? rc : loaded;
+}
+
+/**
+ * Remove the FIDs that have been checked by the incremental LFSCK from the
+ * inactive lfsck_dirty file.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] fids	the FIDs to be removed
+ * \param[in] count	how many FIDs to be removed
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+int lfsck_dirty_delete(const struct lu_env *env, struct lfsck_instance *lfsck,
+		       const struct lu_fid *fids, int count)
+{
+	struct lfsck_bookmark	*bk	= &lfsck->li_bookmark_ram;
+	struct lu_fid		*key	= &lfsck_env_info(env)->lti_fid3;
+	struct dt_object	*obj;
+	struct dt_device	*dev;
+	struct thandle		*th;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	if (count == 0)
+		RETURN(0);
+
+	obj = lfsck->li_dirty_objs[!lfsck_dirty_active(bk)];
+	dev = lfsck_obj2dev(obj);
+	th = dt_trans_create(env, dev);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	for (i = 0; i < count; i++) {
+		fid_cpu_to_be(key, &fids[i]);
+		rc = dt_declare_delete(env, obj, (const struct dt_key *)key,
+				       th);
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+
+	rc = dt_trans_start_local(env, dev, th);
+	if (rc != 0)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count; i++) {
+		fid_cpu_to_be(key, &fids[i]);
+		rc = dt_delete(env, obj, (const struct dt_key *)key, th,
+			       BYPASS_CAPA);
+		if (rc == -ENOENT)
+			rc = 0;
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+
+	GOTO(stop, rc);
+
+stop:
+	dt_trans_stop(env, dev, th);
+
+	if (rc != 0)
+		CDEBUG(D_LFSCK, "%s: fail to remove the checked objects from "
+		       "the lfsck_dirty file: rc = %d\n",
+		       lfsck_lfsck2name(lfsck), rc);
+
+	return rc;
+}
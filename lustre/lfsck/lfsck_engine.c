@@ -39,6 +39,13 @@
 
 #include "lfsck_internal.h"
 
+static int lfsck_oit_workers = 4;
+CFS_MODULE_PARM(lfsck_oit_workers, "i", int, 0644,
+		"number of threads handling the OIT objects, 0 for serial scan");
+
+/* The objects that can be queued for each OIT worker. */
+#define LFSCK_OIT_QUEUE_DEPTH	64
+
 int lfsck_unpack_ent(struct lu_dirent *ent, __u64 *cookie, __u16 *type)
 {
 	struct luda_type	*lt;
@@ -535,6 +542,7 @@ static int lfsck_prep(const struct lu_env *env, struct lfsck_instance *lfsck,
 		if (lfsck->li_lmv != NULL && lfsck->li_lmv->ll_lmv_master)
 			pos->lp_dir_cookie = 0;
 
+		lfsck->li_dir_oit_cookie = pos->lp_oit_cookie;
 		rc = lfsck_open_dir(env, lfsck, pos->lp_dir_cookie);
 		if (rc > 0)
 			/* The end of the directory. */
@@ -572,28 +580,61 @@ out:
 	return rc;
 }
 
-static int lfsck_exec_oit(const struct lu_env *env,
-			  struct lfsck_instance *lfsck, struct dt_object *obj)
+/**
+ * Call all the LFSCK components' exec_oit() for the given object.
+ *
+ * It may be called by the OIT workers concurrently, the components protect
+ * their shared statistics and trace files by themselves.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] obj	pointer to the object found by the OIT scan
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int lfsck_exec_oit_obj(const struct lu_env *env,
+			      struct lfsck_instance *lfsck,
+			      struct dt_object *obj)
 {
 	struct lfsck_component *com;
 	int			rc;
-	ENTRY;
-
-	LASSERT(lfsck->li_obj_dir == NULL);
 
 	list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
 		rc = com->lc_ops->lfsck_exec_oit(env, com, obj);
 		if (rc != 0)
-			RETURN(rc);
+			return rc;
 	}
 
+	return 0;
+}
+
+/**
+ * Start the namespace-based directory traversal for the given object
+ * if needed. It is only called by the master engine.
+ *
+ * \a cookie is the OIT position of the directory, it is remembered as
+ * lfsck_instance::li_dir_oit_cookie for the positions derived from the
+ * directory traversal.
+ */
+static int lfsck_exec_oit_dir(const struct lu_env *env,
+			      struct lfsck_instance *lfsck,
+			      struct dt_object *obj, __u64 cookie)
+{
+	int rc;
+	ENTRY;
+
+	LASSERT(lfsck->li_obj_dir == NULL);
+
 	rc = lfsck_needs_scan_dir(env, lfsck, obj);
 	if (rc <= 0)
 		GOTO(out, rc);
 
 	rc = lfsck_load_stripe_lmv(env, lfsck, obj);
-	if (rc == 0)
+	if (rc == 0) {
+		lfsck->li_dir_oit_cookie = cookie;
 		rc = lfsck_open_dir(env, lfsck, 0);
+	}
 
 	GOTO(out, rc);
 
@@ -607,6 +648,74 @@ out:
 	return rc > 0 ? 0 : rc;
 }
 
+/**
+ * Handle the object found by the OIT scan.
+ *
+ * If \a dir is not NULL, then the caller is an OIT worker: the directory
+ * that may need namespace-based traversal is not handled here, instead,
+ * it is returned via \a dir with the reference held for the master engine.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] fid	the FID of the object
+ * \param[in] cookie	the OIT position of the object
+ * \param[in] update_lma whether the LMA of the object needs to be updated
+ * \param[out] dir	the directory to be handled by the master engine
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int lfsck_exec_oit(const struct lu_env *env,
+			  struct lfsck_instance *lfsck,
+			  const struct lu_fid *fid, __u64 cookie,
+			  bool update_lma, struct dt_object **dir)
+{
+	struct lfsck_thread_info *info	= lfsck_env_info(env);
+	struct dt_object	 *target;
+	int			  rc	= 0;
+
+	/* The failure positions are recorded against the object in hand,
+	 * not against the master's OIT iterator that may be far ahead. */
+	info->lti_oit_cookie = cookie;
+	target = lfsck_object_find_bottom(env, lfsck, fid);
+	if (IS_ERR(target)) {
+		rc = PTR_ERR(target);
+		CDEBUG(D_LFSCK, "%s: OIT scan failed at find target "
+		       DFID", cookie "LPU64": rc = %d\n",
+		       lfsck_lfsck2name(lfsck), PFID(fid), cookie, rc);
+		lfsck_fail(env, lfsck, true);
+		info->lti_oit_cookie = LFSCK_OIT_IDLE;
+
+		return rc;
+	}
+
+	if (dt_object_exists(target)) {
+		if (update_lma) {
+			rc = lfsck_update_lma(env, lfsck, target);
+			if (rc != 0)
+				CDEBUG(D_LFSCK, "%s: fail to update "
+				       "LMA for "DFID": rc = %d\n",
+				       lfsck_lfsck2name(lfsck),
+				       PFID(lfsck_dto2fid(target)), rc);
+		}
+		if (rc == 0)
+			rc = lfsck_exec_oit_obj(env, lfsck, target);
+		info->lti_oit_cookie = LFSCK_OIT_IDLE;
+		if (rc == 0 && dir == NULL) {
+			rc = lfsck_exec_oit_dir(env, lfsck, target, cookie);
+		} else if (rc == 0 && !list_empty(&lfsck->li_list_dir) &&
+			   S_ISDIR(lfsck_object_type(target))) {
+			*dir = target;
+
+			return 0;
+		}
+	}
+	info->lti_oit_cookie = LFSCK_OIT_IDLE;
+	lfsck_object_put(env, target);
+
+	return rc;
+}
+
 static int lfsck_exec_dir(const struct lu_env *env,
 			  struct lfsck_instance *lfsck,
 			  struct lu_dirent *ent, __u16 type)
@@ -821,6 +930,354 @@ checkpoint:
 	RETURN(rc);
 }
 
+/**
+ * OIT worker engine.
+ *
+ * The OIT worker takes the objects queued by the master engine in turn,
+ * and calls the LFSCK components' exec_oit() for them. The directory that
+ * needs namespace-based traversal is given back to the master engine.
+ *
+ * \param[in] args	pointer to the lfsck_thread_args
+ *
+ * \retval		0 always
+ */
+static int lfsck_oit_worker_engine(void *args)
+{
+	struct lfsck_thread_args *lta	  = args;
+	struct lu_env		 *env	  = &lta->lta_env;
+	struct lfsck_instance	 *lfsck	  = lta->lta_lfsck;
+	struct lfsck_oit_worker	 *low	  = lta->lta_oit_worker;
+	struct ptlrpc_thread	 *mthread = &lfsck->li_thread;
+	struct ptlrpc_thread	 *thread  = &low->low_thread;
+	struct l_wait_info	  lwi	  = { 0 };
+	struct lfsck_oit_unit	 *lou;
+	struct dt_object	 *dir;
+	int			  rc;
+	ENTRY;
+
+	lfsck_env_info(env)->lti_oit_cookie = LFSCK_OIT_IDLE;
+	spin_lock(&lfsck->li_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&lfsck->li_lock);
+	wake_up_all(&mthread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(mthread->t_ctl_waitq,
+			     !list_empty(&lfsck->li_list_oit) ||
+			     !thread_is_running(thread),
+			     &lwi);
+
+		spin_lock(&lfsck->li_lock);
+		if (unlikely(!thread_is_running(thread))) {
+			spin_unlock(&lfsck->li_lock);
+			break;
+		}
+
+		if (list_empty(&lfsck->li_list_oit)) {
+			spin_unlock(&lfsck->li_lock);
+			continue;
+		}
+
+		lou = list_entry(lfsck->li_list_oit.next,
+				 struct lfsck_oit_unit, lou_link);
+		list_del_init(&lou->lou_link);
+		low->low_cookie = lou->lou_cookie;
+		spin_unlock(&lfsck->li_lock);
+
+		dir = NULL;
+		rc = lfsck_exec_oit(env, lfsck, &lou->lou_fid, lou->lou_cookie,
+				    lou->lou_update_lma, &dir);
+
+		spin_lock(&lfsck->li_lock);
+		low->low_cookie = LFSCK_OIT_IDLE;
+		if (rc < 0 && lfsck->li_oit_result == 0)
+			lfsck->li_oit_result = rc;
+		if (dir != NULL) {
+			lou->lou_obj = dir;
+			list_add_tail(&lou->lou_link, &lfsck->li_list_oit_dir);
+			lou = NULL;
+		} else {
+			lfsck->li_oit_queued--;
+		}
+		spin_unlock(&lfsck->li_lock);
+
+		if (lou != NULL)
+			OBD_FREE_PTR(lou);
+		wake_up_all(&mthread->t_ctl_waitq);
+	}
+
+	CDEBUG(D_LFSCK, "%s: OIT worker %d exit\n",
+	       lfsck_lfsck2name(lfsck), low->low_index);
+
+	spin_lock(&lfsck->li_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&lfsck->li_lock);
+	wake_up_all(&mthread->t_ctl_waitq);
+	lfsck_thread_args_fini(lta);
+
+	RETURN(0);
+}
+
+/**
+ * Stop the OIT workers. The objects that have not been handled yet are
+ * kept in the queue, so that the checkpoint still covers them.
+ */
+static void lfsck_oit_workers_stop(struct lfsck_instance *lfsck)
+{
+	struct ptlrpc_thread	*mthread = &lfsck->li_thread;
+	struct l_wait_info	 lwi	 = { 0 };
+	int			 i;
+
+	if (lfsck->li_oit_workers == NULL)
+		return;
+
+	spin_lock(&lfsck->li_lock);
+	for (i = 0; i < lfsck->li_oit_workers_count; i++)
+		thread_set_flags(&lfsck->li_oit_workers[i].low_thread,
+				 SVC_STOPPING);
+	spin_unlock(&lfsck->li_lock);
+	wake_up_all(&mthread->t_ctl_waitq);
+
+	for (i = 0; i < lfsck->li_oit_workers_count; i++)
+		l_wait_event(mthread->t_ctl_waitq,
+			     thread_is_stopped(
+				&lfsck->li_oit_workers[i].low_thread),
+			     &lwi);
+}
+
+/**
+ * Start the OIT workers for the master engine.
+ *
+ * The workers are not started if fault injection is enabled, so that the
+ * test cases can control the scanning order. Failing to start the workers
+ * is not fatal, the master engine will handle the objects by itself.
+ */
+static void lfsck_oit_workers_start(struct lfsck_instance *lfsck)
+{
+	struct ptlrpc_thread	*mthread = &lfsck->li_thread;
+	struct lfsck_oit_worker	*workers;
+	struct lfsck_oit_worker	*low;
+	struct lfsck_thread_args *lta;
+	struct task_struct	*task;
+	struct l_wait_info	 lwi	 = { 0 };
+	int			 count	 = lfsck_oit_workers;
+	int			 i;
+	ENTRY;
+
+	if (count > num_online_cpus())
+		count = num_online_cpus();
+
+	if (count <= 0 || cfs_fail_loc != 0)
+		RETURN_EXIT;
+
+	OBD_ALLOC(workers, sizeof(*workers) * count);
+	if (workers == NULL)
+		RETURN_EXIT;
+
+	lfsck->li_oit_queued = 0;
+	lfsck->li_oit_result = 0;
+	lfsck->li_oit_workers = workers;
+	for (i = 0; i < count; i++) {
+		low = &workers[i];
+		low->low_index = i;
+		init_waitqueue_head(&low->low_thread.t_ctl_waitq);
+
+		lta = lfsck_thread_args_init(lfsck, NULL, NULL);
+		if (IS_ERR(lta))
+			break;
+
+		lta->lta_oit_worker = low;
+		task = kthread_run(lfsck_oit_worker_engine, lta,
+				   "lfsck_oit_%02d", i);
+		if (IS_ERR(task)) {
+			CDEBUG(D_LFSCK, "%s: cannot start OIT worker %d: "
+			       "rc = %ld\n", lfsck_lfsck2name(lfsck), i,
+			       PTR_ERR(task));
+			lfsck_thread_args_fini(lta);
+			break;
+		}
+
+		l_wait_event(mthread->t_ctl_waitq,
+			     thread_is_running(&low->low_thread),
+			     &lwi);
+
+		spin_lock(&lfsck->li_lock);
+		lfsck->li_oit_workers_count++;
+		spin_unlock(&lfsck->li_lock);
+	}
+
+	if (i < count) {
+		/* Fall back to handle the objects by the master engine. */
+		lfsck_oit_workers_stop(lfsck);
+		spin_lock(&lfsck->li_lock);
+		lfsck->li_oit_workers = NULL;
+		lfsck->li_oit_workers_count = 0;
+		spin_unlock(&lfsck->li_lock);
+		OBD_FREE(workers, sizeof(*workers) * count);
+		count = 0;
+	}
+
+	CDEBUG(D_LFSCK, "%s: started %d OIT workers\n",
+	       lfsck_lfsck2name(lfsck), count);
+
+	EXIT;
+}
+
+/**
+ * Release the OIT workers and the objects left in their queue.
+ */
+static void lfsck_oit_workers_fini(const struct lu_env *env,
+				   struct lfsck_instance *lfsck)
+{
+	struct lfsck_oit_worker	*workers = lfsck->li_oit_workers;
+	struct lfsck_oit_unit	*lou;
+	struct lfsck_oit_unit	*next;
+	struct list_head	 head;
+	int			 count;
+
+	if (workers == NULL)
+		return;
+
+	INIT_LIST_HEAD(&head);
+	spin_lock(&lfsck->li_lock);
+	list_splice_init(&lfsck->li_list_oit, &head);
+	list_splice_init(&lfsck->li_list_oit_dir, &head);
+	count = lfsck->li_oit_workers_count;
+	lfsck->li_oit_workers = NULL;
+	lfsck->li_oit_workers_count = 0;
+	lfsck->li_oit_queued = 0;
+	spin_unlock(&lfsck->li_lock);
+
+	list_for_each_entry_safe(lou, next, &head, lou_link) {
+		list_del(&lou->lou_link);
+		if (lou->lou_obj != NULL)
+			lfsck_object_put(env, lou->lou_obj);
+		OBD_FREE_PTR(lou);
+	}
+
+	OBD_FREE(workers, sizeof(*workers) * count);
+}
+
+/**
+ * Queue the object found by the OIT scan for the OIT workers, or handle
+ * it directly if there is no OIT worker.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ * \param[in] fid	the FID of the object
+ * \param[in] update_lma whether the LMA of the object needs to be updated
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int lfsck_oit_dispatch(const struct lu_env *env,
+			      struct lfsck_instance *lfsck,
+			      const struct lu_fid *fid, bool update_lma)
+{
+	struct ptlrpc_thread	*thread = &lfsck->li_thread;
+	struct lfsck_oit_unit	*lou;
+	struct l_wait_info	 lwi	= { 0 };
+	__u64			 cookie = lfsck->li_pos_current.lp_oit_cookie;
+	bool			 wakeup;
+
+	if (lfsck->li_oit_workers == NULL)
+		return lfsck_exec_oit(env, lfsck, fid, cookie, update_lma,
+				      NULL);
+
+	OBD_ALLOC_PTR(lou);
+	if (unlikely(lou == NULL))
+		return -ENOMEM;
+
+	INIT_LIST_HEAD(&lou->lou_link);
+	lou->lou_fid = *fid;
+	lou->lou_cookie = cookie;
+	lou->lou_update_lma = update_lma;
+
+	/* Do not wait for the queue space if some directory has been given
+	 * back, otherwise the master engine may wait for itself. */
+	l_wait_event(thread->t_ctl_waitq,
+		     lfsck->li_oit_queued < lfsck->li_oit_workers_count *
+					    LFSCK_OIT_QUEUE_DEPTH ||
+		     !list_empty(&lfsck->li_list_oit_dir) ||
+		     !thread_is_running(thread),
+		     &lwi);
+
+	spin_lock(&lfsck->li_lock);
+	if (unlikely(!thread_is_running(thread))) {
+		spin_unlock(&lfsck->li_lock);
+		OBD_FREE_PTR(lou);
+
+		return 0;
+	}
+
+	wakeup = list_empty(&lfsck->li_list_oit);
+	list_add_tail(&lou->lou_link, &lfsck->li_list_oit);
+	lfsck->li_oit_queued++;
+	spin_unlock(&lfsck->li_lock);
+
+	if (wakeup)
+		wake_up_all(&thread->t_ctl_waitq);
+
+	return 0;
+}
+
+/**
+ * Start the namespace-based traversal for the directory that has been
+ * given back by the OIT worker.
+ */
+static int lfsck_master_oit_dir(const struct lu_env *env,
+				struct lfsck_instance *lfsck)
+{
+	struct lfsck_oit_unit	*lou;
+	int			 rc;
+
+	spin_lock(&lfsck->li_lock);
+	lou = list_entry(lfsck->li_list_oit_dir.next,
+			 struct lfsck_oit_unit, lou_link);
+	list_del_init(&lou->lou_link);
+	spin_unlock(&lfsck->li_lock);
+
+	/* After the OIT scan has finished, the last traversed directory
+	 * is kept open by lfsck_master_dir_engine(). */
+	if (lfsck->li_obj_dir != NULL)
+		lfsck_close_dir(env, lfsck, 1);
+
+	rc = lfsck_exec_oit_dir(env, lfsck, lou->lou_obj, lou->lou_cookie);
+	lfsck_object_put(env, lou->lou_obj);
+
+	spin_lock(&lfsck->li_lock);
+	lfsck->li_oit_queued--;
+	spin_unlock(&lfsck->li_lock);
+	OBD_FREE_PTR(lou);
+
+	return rc;
+}
+
+/**
+ * Start the namespace-based traversal for the next shard of the striped
+ * directory queued on the lfsck::li_list_lmv.
+ */
+static int lfsck_master_lmv_dir(const struct lu_env *env,
+				struct lfsck_instance *lfsck)
+{
+	struct lfsck_lmv_unit	*llu;
+	int			 rc;
+
+	spin_lock(&lfsck->li_lock);
+	llu = list_entry(lfsck->li_list_lmv.next,
+			 struct lfsck_lmv_unit, llu_link);
+	list_del_init(&llu->llu_link);
+	spin_unlock(&lfsck->li_lock);
+
+	lfsck->li_lmv = &llu->llu_lmv;
+	lfsck->li_obj_dir = lfsck_object_get(llu->llu_obj);
+	rc = lfsck_open_dir(env, lfsck, 0);
+	if (rc == 0)
+		rc = lfsck_master_dir_engine(env, lfsck);
+
+	return rc;
+}
+
 /**
  * Object-table based iteration engine.
  *
@@ -854,6 +1311,7 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 	struct lfsck_bookmark	 *bk	= &lfsck->li_bookmark_ram;
 	struct ptlrpc_thread	 *thread = &lfsck->li_thread;
 	struct seq_server_site	 *ss	= lfsck_dev_site(lfsck);
+	struct l_wait_info	 lwi	= { 0 };
 	__u32			 idx	= lfsck_dev_idx(lfsck);
 	int			 rc;
 	ENTRY;
@@ -862,8 +1320,7 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 		RETURN(-EIO);
 
 	do {
-		struct dt_object *target;
-		bool		  update_lma = false;
+		bool update_lma = false;
 
 		if (lfsck->li_di_dir != NULL) {
 			rc = lfsck_master_dir_engine(env, lfsck);
@@ -871,8 +1328,34 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 				RETURN(rc);
 		}
 
-		if (unlikely(lfsck->li_oit_over))
-			RETURN(1);
+		if (unlikely(lfsck->li_oit_over)) {
+			/* Wait for the OIT workers to handle the queued
+			 * objects, the directories they give back will be
+			 * traversed by the master engine. */
+			l_wait_event(thread->t_ctl_waitq,
+				     lfsck->li_oit_queued == 0 ||
+				     !list_empty(&lfsck->li_list_oit_dir) ||
+				     !thread_is_running(thread),
+				     &lwi);
+			if (unlikely(!thread_is_running(thread)))
+				RETURN(0);
+
+			if (lfsck->li_oit_result != 0 &&
+			    bk->lb_param & LPF_FAILOUT)
+				RETURN(lfsck->li_oit_result);
+
+			if (list_empty(&lfsck->li_list_oit_dir))
+				RETURN(1);
+		}
+
+		if (!list_empty(&lfsck->li_list_oit_dir)) {
+			rc = lfsck_master_oit_dir(env, lfsck);
+			if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+				RETURN(rc);
+
+			rc = 0;
+			continue;
+		}
 
 		if (CFS_FAIL_TIMEOUT(OBD_FAIL_LFSCK_DELAY1, cfs_fail_val) &&
 		    unlikely(!thread_is_running(thread))) {
@@ -889,20 +1372,7 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 		lfsck->li_current_oit_processed = 1;
 
 		if (!list_empty(&lfsck->li_list_lmv)) {
-			struct lfsck_lmv_unit *llu;
-
-			spin_lock(&lfsck->li_lock);
-			llu = list_entry(lfsck->li_list_lmv.next,
-					 struct lfsck_lmv_unit, llu_link);
-			list_del_init(&llu->llu_link);
-			spin_unlock(&lfsck->li_lock);
-
-			lfsck->li_lmv = &llu->llu_lmv;
-			lfsck->li_obj_dir = lfsck_object_get(llu->llu_obj);
-			rc = lfsck_open_dir(env, lfsck, 0);
-			if (rc == 0)
-				rc = lfsck_master_dir_engine(env, lfsck);
-
+			rc = lfsck_master_lmv_dir(env, lfsck);
 			if (rc <= 0)
 				RETURN(rc);
 		}
@@ -967,32 +1437,9 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 			}
 		}
 
-		target = lfsck_object_find_bottom(env, lfsck, fid);
-		if (IS_ERR(target)) {
-			CDEBUG(D_LFSCK, "%s: OIT scan failed at find target "
-			       DFID", cookie "LPU64": rc = %d\n",
-			       lfsck_lfsck2name(lfsck), PFID(fid),
-			       iops->store(env, di), rc);
-			lfsck_fail(env, lfsck, true);
-			if (bk->lb_param & LPF_FAILOUT)
-				RETURN(PTR_ERR(target));
-			else
-				goto checkpoint;
-		}
-
-		if (dt_object_exists(target)) {
-			if (update_lma) {
-				rc = lfsck_update_lma(env, lfsck, target);
-				if (rc != 0)
-					CDEBUG(D_LFSCK, "%s: fail to update "
-					       "LMA for "DFID": rc = %d\n",
-					       lfsck_lfsck2name(lfsck),
-					       PFID(lfsck_dto2fid(target)), rc);
-			}
-			if (rc == 0)
-				rc = lfsck_exec_oit(env, lfsck, target);
-		}
-		lfsck_object_put(env, target);
+		rc = lfsck_oit_dispatch(env, lfsck, fid, update_lma);
+		if (rc == 0)
+			rc = lfsck->li_oit_result;
 		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
 			RETURN(rc);
 
@@ -1023,24 +1470,185 @@ checkpoint:
 			       iops->store(env, di));
 			RETURN(0);
 		}
-	} while (rc == 0 || lfsck->li_di_dir != NULL);
+	} while (rc == 0 || lfsck->li_di_dir != NULL || lfsck->li_oit_over);
 
 	RETURN(rc);
 }
 
+/**
+ * Dirty objects based iteration engine.
+ *
+ * It is used by the incremental LFSCK on the MDT instead of the OIT scan.
+ * Only the objects recorded in the inactive lfsck_dirty file, that is the
+ * objects modified since the former LFSCK run, are checked. If one of them
+ * is a directory, it is traversed via the namespace-based iteration as the
+ * OIT engine does, then the linkEA of its children will be verified too.
+ *
+ * The checked FIDs are removed from the lfsck_dirty file batch by batch,
+ * then the paused incremental LFSCK can resume from where it stopped.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] lfsck	pointer to the lfsck instance
+ *
+ * \retval		positive number if all dirty objects have been checked
+ * \retval		0 if the iteration is stopped or paused
+ * \retval		negative error number on failure
+ */
+static int lfsck_master_dirty_engine(const struct lu_env *env,
+				     struct lfsck_instance *lfsck)
+{
+	struct lfsck_thread_info *info	 = lfsck_env_info(env);
+	struct lu_seq_range	 *range	 = &info->lti_range;
+	struct lfsck_bookmark	 *bk	 = &lfsck->li_bookmark_ram;
+	struct ptlrpc_thread	 *thread = &lfsck->li_thread;
+	struct seq_server_site	 *ss	 = lfsck_dev_site(lfsck);
+	struct lu_fid		 *fids;
+	struct lu_fid		 *fid;
+	__u32			  idx	 = lfsck_dev_idx(lfsck);
+	int			  count	 = 0;
+	int			  done	 = 0;
+	int			  rc;
+	ENTRY;
+
+	if (unlikely(ss == NULL))
+		RETURN(-EIO);
+
+	OBD_ALLOC(fids, sizeof(*fids) * LFSCK_DIRTY_BATCH);
+	if (fids == NULL)
+		RETURN(-ENOMEM);
+
+	/* The directory traversal interrupted by the former pause will be
+	 * restarted when its FID, that is still in the lfsck_dirty file,
+	 * is checked again. */
+	if (lfsck->li_obj_dir != NULL)
+		lfsck_close_dir(env, lfsck, 1);
+
+	while (1) {
+		if (done == count) {
+			rc = lfsck_dirty_delete(env, lfsck, fids, done);
+			if (rc != 0)
+				GOTO(out, rc);
+
+			done = 0;
+			count = lfsck_dirty_load(env, lfsck, fids,
+						 LFSCK_DIRTY_BATCH);
+			if (count <= 0)
+				GOTO(out, rc = (count < 0 ? count : 1));
+		}
+
+		if (CFS_FAIL_TIMEOUT(OBD_FAIL_LFSCK_DELAY1, cfs_fail_val) &&
+		    unlikely(!thread_is_running(thread))) {
+			CDEBUG(D_LFSCK, "%s: dirty scan exit for engine stop, "
+			       "next "DFID"\n", lfsck_lfsck2name(lfsck),
+			       PFID(&fids[done]));
+
+			GOTO(out, rc = 0);
+		}
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_LFSCK_CRASH))
+			GOTO(out, rc = 0);
+
+		if (!list_empty(&lfsck->li_list_lmv)) {
+			rc = lfsck_master_lmv_dir(env, lfsck);
+			if (rc <= 0)
+				GOTO(out, rc);
+
+			if (lfsck->li_obj_dir != NULL)
+				lfsck_close_dir(env, lfsck, rc);
+		}
+
+		fid = &fids[done];
+		lfsck->li_new_scanned++;
+		rc = 0;
+		/* The object only used locally will not be handled, just as
+		 * the OIT engine does. */
+		if (!fid_is_norm(fid) && !fid_is_igif(fid) &&
+		    !lu_fid_eq(fid, &lfsck->li_global_root_fid))
+			goto checkpoint;
+
+		fld_range_set_mdt(range);
+		rc = fld_local_lookup(env, ss->ss_server_fld, fid_seq(fid),
+				      range);
+		if (rc != 0 || range->lsr_index != idx) {
+			rc = 0;
+			goto checkpoint;
+		}
+
+		rc = lfsck_exec_oit(env, lfsck, fid, 0, false, NULL);
+		if (rc == 0 && lfsck->li_di_dir != NULL) {
+			rc = lfsck_master_dir_engine(env, lfsck);
+			if (rc <= 0)
+				GOTO(out, rc);
+
+			rc = 0;
+		}
+
+		if (lfsck->li_obj_dir != NULL)
+			lfsck_close_dir(env, lfsck, 1);
+
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+			GOTO(out, rc);
+
+checkpoint:
+		done++;
+		rc = lfsck_checkpoint(env, lfsck);
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+			GOTO(out, rc);
+
+		/* Rate control. */
+		lfsck_control_speed(lfsck);
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_LFSCK_FATAL1)) {
+			spin_lock(&lfsck->li_lock);
+			thread_set_flags(thread, SVC_STOPPING);
+			spin_unlock(&lfsck->li_lock);
+			GOTO(out, rc = -EINVAL);
+		}
+
+		if (unlikely(!thread_is_running(thread))) {
+			CDEBUG(D_LFSCK, "%s: dirty scan exit for engine stop, "
+			       "last "DFID"\n", lfsck_lfsck2name(lfsck),
+			       PFID(fid));
+			GOTO(out, rc = 0);
+		}
+	}
+
+out:
+	/* Forget the checked FIDs, the others will be checked when the
+	 * incremental LFSCK is resumed. */
+	if (done > 0 && !OBD_FAIL_CHECK(OBD_FAIL_LFSCK_CRASH)) {
+		int rc1 = lfsck_dirty_delete(env, lfsck, fids, done);
+
+		if (rc1 != 0)
+			CDEBUG(D_LFSCK, "%s: fail to remove the checked FIDs "
+			       "from the dirty set: rc = %d\n",
+			       lfsck_lfsck2name(lfsck), rc1);
+	}
+
+	OBD_FREE(fids, sizeof(*fids) * LFSCK_DIRTY_BATCH);
+
+	return rc;
+}
+
 int lfsck_master_engine(void *args)
 {
 	struct lfsck_thread_args *lta      = args;
 	struct lu_env		 *env	   = &lta->lta_env;
 	struct lfsck_instance	 *lfsck    = lta->lta_lfsck;
+	struct lfsck_bookmark	 *bk	   = &lfsck->li_bookmark_ram;
 	struct ptlrpc_thread	 *thread   = &lfsck->li_thread;
 	struct dt_object	 *oit_obj  = lfsck->li_obj_oit;
 	const struct dt_it_ops	 *oit_iops = &oit_obj->do_index_ops->dio_it;
 	struct dt_it		 *oit_di;
 	struct l_wait_info	  lwi	   = { 0 };
+	bool			  scanned  = false;
 	int			  rc;
 	ENTRY;
 
+	/* No object is in hand yet, lfsck_pos_fill() must not see a stale
+	 * OIT position left by a former run. */
+	lfsck_env_info(env)->lti_oit_cookie = LFSCK_OIT_IDLE;
+
 	if (lfsck->li_master &&
 	    (!list_empty(&lfsck->li_list_scan) ||
 	     !list_empty(&lfsck->li_list_double_scan))) {
@@ -1092,11 +1700,18 @@ int lfsck_master_engine(void *args)
 	if (!thread_is_running(thread))
 		GOTO(fini_oit, rc = 0);
 
-	if (!list_empty(&lfsck->li_list_scan) ||
-	    list_empty(&lfsck->li_list_double_scan))
+	scanned = !list_empty(&lfsck->li_list_scan);
+	if (scanned && lfsck->li_master &&
+	    bk->lb_dirty_flags & LDF_INCR_SCAN) {
+		/* The OIT is only used for the position and statistics. */
+		rc = lfsck_master_dirty_engine(env, lfsck);
+	} else if (scanned || list_empty(&lfsck->li_list_double_scan)) {
+		lfsck_oit_workers_start(lfsck);
 		rc = lfsck_master_oit_engine(env, lfsck);
-	else
+		lfsck_oit_workers_stop(lfsck);
+	} else {
 		rc = 1;
+	}
 
 	lfsck_pos_fill(env, lfsck, &lfsck->li_pos_checkpoint, false);
 	CDEBUG(D_LFSCK, "LFSCK exit: oit_flags = %#x, dir_flags = %#x, "
@@ -1111,6 +1726,16 @@ int lfsck_master_engine(void *args)
 		rc = lfsck_post(env, lfsck, rc);
 	else
 		lfsck_close_dir(env, lfsck, rc);
+	lfsck_oit_workers_fini(env, lfsck);
+
+	if (rc == 1 && scanned) {
+		int rc1 = lfsck_dirty_post(env, lfsck);
+
+		if (rc1 != 0)
+			CDEBUG(D_LFSCK, "%s: fail to update the dirty set "
+			       "after the first-stage scanning: rc = %d\n",
+			       lfsck_lfsck2name(lfsck), rc1);
+	}
 
 fini_oit:
 	lfsck_di_oit_put(env, lfsck);
@@ -104,10 +104,47 @@ struct lfsck_bookmark {
 	/* The FID for the last MDT-object created by the LFSCK repairing. */
 	struct lu_fid	lb_last_fid;
 
+	/* See 'enum lfsck_dirty_flags'. */
+	__u32	lb_dirty_flags;
+
+	/* For 64-bits aligned. */
+	__u32	lb_padding2;
+
 	/* For future using. */
-	__u64	lb_reserved[2];
+	__u64	lb_reserved[1];
 };
 
+/* The state of the dirty objects tracking for the incremental LFSCK,
+ * see lfsck_dirty.c. */
+enum lfsck_dirty_flags {
+	/* Record the FIDs of the modified objects in the lfsck_dirty files. */
+	LDF_TRACKING		= 0x0001,
+
+	/* The lfsck_dirty files contain all the objects modified since the
+	 * last full scan, so the incremental LFSCK is allowed. */
+	LDF_VALID		= 0x0002,
+
+	/* The device is in use, the FIDs cached in RAM will be lost if the
+	 * server crashes. Found at mount time means unclean shutdown. */
+	LDF_OPEN		= 0x0004,
+
+	/* The new modifications are recorded in the lfsck_dirty_01,
+	 * otherwise in the lfsck_dirty_00. */
+	LDF_ACTIVE		= 0x0008,
+
+	/* A full scan for (re)building the dirty set is in processing. */
+	LDF_FULL_SCAN		= 0x0010,
+
+	/* An incremental scan of the inactive lfsck_dirty file is in
+	 * processing. */
+	LDF_INCR_SCAN		= 0x0020,
+};
+
+#define LFSCK_DIRTY_FILES	2
+
+/* How many FIDs are handled in one lfsck_dirty file transaction. */
+#define LFSCK_DIRTY_BATCH	64
+
 enum lfsck_namespace_trace_flags {
 	LNTF_CHECK_LINKEA	= 0x01,
 	LNTF_CHECK_PARENT	= 0x02,
@@ -619,6 +656,37 @@ struct lfsck_instance {
 	/* For the lfsck_lmv_unit to be handled. */
 	struct list_head	  li_list_lmv;
 
+	/* For the lfsck_oit_unit to be handled by the OIT workers, in OIT
+	 * order, and for the directories they give back to the master
+	 * engine. Both are protected by li_lock. */
+	struct list_head	  li_list_oit;
+	struct list_head	  li_list_oit_dir;
+
+	/* The OIT workers, see lfsck_oit_workers_start(). */
+	struct lfsck_oit_worker	 *li_oit_workers;
+	int			  li_oit_workers_count;
+
+	/* Units queued to or held by the OIT workers, under li_lock. */
+	int			  li_oit_queued;
+
+	/* The first failure reported by the OIT workers. */
+	int			  li_oit_result;
+
+	/* The FIDs of the objects modified since the last LFSCK run, they
+	 * are cached in RAM and flushed to the active lfsck_dirty file by
+	 * the li_dirty_thread. The cache is protected by li_dirty_lock. */
+	spinlock_t		  li_dirty_lock;
+	struct list_head	  li_dirty_chunks;
+	int			  li_dirty_count;
+	unsigned int		  li_dirty_tracking:1,
+				  li_dirty_overflow:1;
+
+	/* Serialize the flush and the switch of the lfsck_dirty files,
+	 * and protect lfsck_bookmark::lb_dirty_flags. */
+	struct mutex		  li_dirty_mutex;
+	struct dt_object	 *li_dirty_objs[LFSCK_DIRTY_FILES];
+	struct ptlrpc_thread	  li_dirty_thread;
+
 	atomic_t		  li_ref;
 	atomic_t		  li_double_scan_count;
 	struct ptlrpc_thread	  li_thread;
@@ -648,6 +716,11 @@ struct lfsck_instance {
 	struct lfsck_position	  li_pos_current;
 	struct lfsck_position	  li_pos_checkpoint;
 
+	/* The OIT position of the directory under namespace-based traversal,
+	 * it may be behind li_pos_current if the directory has been given
+	 * back by some OIT worker. */
+	__u64			  li_dir_oit_cookie;
+
 	struct lfsck_lmv	 *li_lmv;
 
 	/* Obj for otable-based iteration */
@@ -715,6 +788,30 @@ struct lfsck_thread_args {
 	struct lfsck_instance		*lta_lfsck;
 	struct lfsck_component		*lta_com;
 	struct lfsck_start_param	*lta_lsp;
+	struct lfsck_oit_worker		*lta_oit_worker;
+};
+
+/* The object found by the OIT scan and handled by some OIT worker. */
+struct lfsck_oit_unit {
+	struct list_head	 lou_link;
+	struct lu_fid		 lou_fid;
+
+	/* The OIT position of the object. */
+	__u64			 lou_cookie;
+
+	/* The directory given back to the master engine. */
+	struct dt_object	*lou_obj;
+	bool			 lou_update_lma;
+};
+
+#define LFSCK_OIT_IDLE		0
+
+struct lfsck_oit_worker {
+	struct ptlrpc_thread	 low_thread;
+
+	/* The OIT position of the object in hand, or LFSCK_OIT_IDLE. */
+	__u64			 low_cookie;
+	int			 low_index;
 };
 
 struct lfsck_assistant_req {
@@ -848,6 +945,10 @@ struct lfsck_thread_info {
 	struct lmv_mds_md_v1	lti_lmv2;
 	struct lmv_mds_md_v1	lti_lmv3;
 	struct lmv_mds_md_v1	lti_lmv4;
+
+	/* The OIT position of the object being handled by exec_oit, or
+	 * LFSCK_OIT_IDLE out of lfsck_exec_oit(). */
+	__u64			lti_oit_cookie;
 };
 
 /* lfsck_lib.c */
@@ -880,6 +981,10 @@ void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
 bool __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit);
 void lfsck_control_speed(struct lfsck_instance *lfsck);
 void lfsck_control_speed_by_self(struct lfsck_component *com);
+struct lfsck_thread_args *
+lfsck_thread_args_init(struct lfsck_instance *lfsck,
+		       struct lfsck_component *com,
+		       struct lfsck_start_param *lsp);
 void lfsck_thread_args_fini(struct lfsck_thread_args *lta);
 struct lfsck_assistant_data *
 lfsck_assistant_data_init(struct lfsck_assistant_operations *lao,
@@ -922,6 +1027,22 @@ int lfsck_bookmark_setup(const struct lu_env *env,
 int lfsck_set_param(const struct lu_env *env, struct lfsck_instance *lfsck,
 		    struct lfsck_start *start, bool reset);
 
+/* lfsck_dirty.c */
+void lfsck_dirty_add(struct lfsck_instance *lfsck, const struct lu_fid *fid);
+int lfsck_dirty_setup(const struct lu_env *env, struct lfsck_instance *lfsck);
+void lfsck_dirty_resume(const struct lu_env *env,
+			struct lfsck_instance *lfsck);
+void lfsck_dirty_fini(const struct lu_env *env, struct lfsck_instance *lfsck);
+void lfsck_dirty_cleanup(const struct lu_env *env,
+			 struct lfsck_instance *lfsck);
+int lfsck_dirty_start(const struct lu_env *env, struct lfsck_instance *lfsck,
+		      struct lfsck_start *start);
+int lfsck_dirty_post(const struct lu_env *env, struct lfsck_instance *lfsck);
+int lfsck_dirty_load(const struct lu_env *env, struct lfsck_instance *lfsck,
+		     struct lu_fid *fids, int count);
+int lfsck_dirty_delete(const struct lu_env *env, struct lfsck_instance *lfsck,
+		       const struct lu_fid *fids, int count);
+
 /* lfsck_namespace.c */
 int lfsck_namespace_trace_update(const struct lu_env *env,
 				 struct lfsck_component *com,
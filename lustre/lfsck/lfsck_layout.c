@@ -1361,10 +1361,13 @@ static void lfsck_layout_record_failure(const struct lu_env *env,
 					struct lfsck_instance *lfsck,
 					struct lfsck_layout *lo)
 {
-	__u64 cookie;
+	__u64 cookie = lfsck_env_info(env)->lti_oit_cookie;
 
 	lo->ll_objs_failed_phase1++;
-	cookie = lfsck->li_obj_oit->do_index_ops->dio_it.store(env,
+	/* The OIT workers record the object in hand, not the shared
+	 * OIT iterator. */
+	if (cookie == LFSCK_OIT_IDLE)
+		cookie = lfsck->li_obj_oit->do_index_ops->dio_it.store(env,
 							lfsck->li_di_oit);
 	if (lo->ll_pos_first_inconsistent == 0 ||
 	    lo->ll_pos_first_inconsistent < cookie) {
@@ -4303,7 +4306,7 @@ static int lfsck_layout_scan_stripes(const struct lu_env *env,
 
 		if (llo == NULL) {
 			llo = lfsck_layout_object_init(env, parent,
-				lfsck->li_pos_current.lp_oit_cookie);
+						       info->lti_oit_cookie);
 			if (IS_ERR(llo)) {
 				rc = PTR_ERR(llo);
 				goto next;
@@ -4429,7 +4432,9 @@ again:
 	lmm->lmm_oi = *oi;
 
 	if (bk->lb_param & LPF_DRYRUN) {
+		down_write(&com->lc_sem);
 		lo->ll_objs_repaired[LLIT_OTHERS - 1]++;
+		up_write(&com->lc_sem);
 
 		GOTO(out, stripe = true);
 	}
@@ -4468,7 +4473,9 @@ again:
 	if (rc != 0)
 		GOTO(out, rc);
 
+	down_write(&com->lc_sem);
 	lo->ll_objs_repaired[LLIT_OTHERS - 1]++;
+	up_write(&com->lc_sem);
 
 	GOTO(out, stripe = true);
 
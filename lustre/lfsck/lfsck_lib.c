@@ -99,6 +99,7 @@ const char *lfsck_param_names[] = {
 	"orphan",
 	"create_ostobj",
 	"create_mdtobj",
+	"incremental",
 	NULL
 };
 
@@ -1541,6 +1542,7 @@ void lfsck_instance_cleanup(const struct lu_env *env,
 
 	lfsck_tgt_descs_fini(&lfsck->li_ost_descs);
 	lfsck_tgt_descs_fini(&lfsck->li_mdt_descs);
+	lfsck_dirty_cleanup(env, lfsck);
 
 	if (lfsck->li_lfsck_dir != NULL) {
 		lfsck_object_put(env, lfsck->li_lfsck_dir);
@@ -1675,22 +1677,80 @@ int lfsck_pos_dump(struct seq_file *m, struct lfsck_position *pos,
 	return 0;
 }
 
+/**
+ * Find the lowest OIT position that is still queued to or being handled
+ * by the OIT workers. The caller should hold lfsck::li_lock.
+ *
+ * \retval	the lowest in-flight OIT position, or LFSCK_OIT_IDLE if none
+ */
+static __u64 lfsck_oit_cookie_inflight(struct lfsck_instance *lfsck)
+{
+	struct lfsck_oit_unit	*lou;
+	__u64			 cookie = LFSCK_OIT_IDLE;
+	int			 i;
+
+	if (lfsck->li_oit_queued == 0)
+		return LFSCK_OIT_IDLE;
+
+	/* The queue is in OIT order, only the first one matters. */
+	if (!list_empty(&lfsck->li_list_oit)) {
+		lou = list_entry(lfsck->li_list_oit.next,
+				 struct lfsck_oit_unit, lou_link);
+		cookie = lou->lou_cookie;
+	}
+
+	list_for_each_entry(lou, &lfsck->li_list_oit_dir, lou_link) {
+		if (cookie == LFSCK_OIT_IDLE || lou->lou_cookie < cookie)
+			cookie = lou->lou_cookie;
+	}
+
+	for (i = 0; i < lfsck->li_oit_workers_count; i++) {
+		__u64 cur = lfsck->li_oit_workers[i].low_cookie;
+
+		if (cur != LFSCK_OIT_IDLE &&
+		    (cookie == LFSCK_OIT_IDLE || cur < cookie))
+			cookie = cur;
+	}
+
+	return cookie;
+}
+
 void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
 		    struct lfsck_position *pos, bool init)
 {
-	const struct dt_it_ops *iops = &lfsck->li_obj_oit->do_index_ops->dio_it;
+	const struct dt_it_ops	 *iops = &lfsck->li_obj_oit->do_index_ops->dio_it;
+	struct lfsck_thread_info *info = lfsck_env_info(env);
+	__u64			  inflight;
 
 	if (unlikely(lfsck->li_di_oit == NULL)) {
 		memset(pos, 0, sizeof(*pos));
 		return;
 	}
 
+	/* Called during exec_oit, maybe by some OIT worker: the position is
+	 * the object in hand, the shared OIT iterator may be far ahead. */
+	if (info->lti_oit_cookie != LFSCK_OIT_IDLE) {
+		pos->lp_oit_cookie = info->lti_oit_cookie;
+		fid_zero(&pos->lp_dir_parent);
+		pos->lp_dir_cookie = 0;
+		return;
+	}
+
 	pos->lp_oit_cookie = iops->store(env, lfsck->li_di_oit);
 	if (!lfsck->li_current_oit_processed && !init)
 		pos->lp_oit_cookie--;
 
 	LASSERT(pos->lp_oit_cookie > 0);
 
+	spin_lock(&lfsck->li_lock);
+	/* Some objects before the OIT iterator may be still in the OIT
+	 * workers' hands, resume from the first of them. The directory
+	 * position is kept: the directory is either before them, or it
+	 * will be given back again when the OIT scan reaches it. */
+	inflight = lfsck_oit_cookie_inflight(lfsck);
+	if (inflight > 1 && inflight <= pos->lp_oit_cookie)
+		pos->lp_oit_cookie = inflight - 1;
+
 	if (lfsck->li_di_dir != NULL) {
 		struct dt_object *dto = lfsck->li_obj_dir;
 
@@ -1707,6 +1767,7 @@ void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
 		fid_zero(&pos->lp_dir_parent);
 		pos->lp_dir_cookie = 0;
 	}
+	spin_unlock(&lfsck->li_lock);
 }
 
 bool __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit)
@@ -1771,7 +1832,7 @@ void lfsck_control_speed_by_self(struct lfsck_component *com)
 	}
 }
 
-static struct lfsck_thread_args *
+struct lfsck_thread_args *
 lfsck_thread_args_init(struct lfsck_instance *lfsck,
 		       struct lfsck_component *com,
 		       struct lfsck_start_param *lsp)
@@ -2611,7 +2672,7 @@ static int lfsck_start_all(const struct lu_env *env,
 	lr->lr_async_windows = bk->lb_async_windows;
 	lr->lr_valid = LSV_SPEED_LIMIT | LSV_ERROR_HANDLE | LSV_DRYRUN |
 		       LSV_ASYNC_WINDOWS | LSV_CREATE_OSTOBJ |
-		       LSV_CREATE_MDTOBJ;
+		       LSV_CREATE_MDTOBJ | LSV_INCREMENTAL;
 
 	laia->laia_com = NULL;
 	laia->laia_ltds = ltds;
@@ -2818,6 +2879,15 @@ int lfsck_start(const struct lu_env *env, struct dt_device *key,
 	if (rc != 0)
 		GOTO(out, rc);
 
+	/* Rebuilding the dirty set for the incremental LFSCK needs to scan
+	 * from the device beginning. */
+	rc = lfsck_dirty_start(env, lfsck, start);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	if (rc > 0)
+		flags |= DOIF_RESET;
+
 	list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
 		start->ls_active |= com->lc_type;
 		if (flags & DOIF_RESET) {
@@ -3006,6 +3076,11 @@ int lfsck_in_notify(const struct lu_env *env, struct dt_device *key,
 		rc = lfsck_stop(env, key, stop);
 		break;
 	}
+	case LE_DIRTY_MARK:
+		/* The object is modified by OUT on behalf of another MDT. */
+		lfsck_mark_dirty(env, key, &lr->lr_fid);
+		rc = 0;
+		break;
 	case LE_PHASE1_DONE:
 	case LE_PHASE2_DONE:
 	case LE_FID_ACCESSED:
@@ -3109,6 +3184,12 @@ int lfsck_register(const struct lu_env *env, struct dt_device *key,
 	INIT_LIST_HEAD(&lfsck->li_list_double_scan);
 	INIT_LIST_HEAD(&lfsck->li_list_idle);
 	INIT_LIST_HEAD(&lfsck->li_list_lmv);
+	INIT_LIST_HEAD(&lfsck->li_list_oit);
+	INIT_LIST_HEAD(&lfsck->li_list_oit_dir);
+	spin_lock_init(&lfsck->li_dirty_lock);
+	INIT_LIST_HEAD(&lfsck->li_dirty_chunks);
+	mutex_init(&lfsck->li_dirty_mutex);
+	init_waitqueue_head(&lfsck->li_dirty_thread.t_ctl_waitq);
 	atomic_set(&lfsck->li_ref, 1);
 	atomic_set(&lfsck->li_double_scan_count, 0);
 	init_waitqueue_head(&lfsck->li_thread.t_ctl_waitq);
@@ -3238,6 +3319,10 @@ int lfsck_register(const struct lu_env *env, struct dt_device *key,
 		rc = lfsck_namespace_setup(env, lfsck);
 		if (rc < 0)
 			GOTO(out, rc);
+
+		rc = lfsck_dirty_setup(env, lfsck);
+		if (rc < 0)
+			GOTO(out, rc);
 	}
 
 	rc = lfsck_layout_setup(env, lfsck);
@@ -3249,6 +3334,8 @@ int lfsck_register(const struct lu_env *env, struct dt_device *key,
 	rc = lfsck_instance_add(lfsck);
 	if (rc == 0)
 		rc = lfsck_add_target_from_orphan(env, lfsck);
+	if (rc == 0)
+		lfsck_dirty_resume(env, lfsck);
 out:
 	if (obj != NULL && !IS_ERR(obj))
 		lfsck_object_put(env, obj);
@@ -3265,11 +3352,38 @@ void lfsck_degister(const struct lu_env *env, struct dt_device *key)
 	struct lfsck_instance *lfsck;
 
 	lfsck = lfsck_instance_find(key, false, true);
-	if (lfsck != NULL)
+	if (lfsck != NULL) {
+		lfsck_dirty_fini(env, lfsck);
 		lfsck_instance_put(env, lfsck);
+	}
 }
 EXPORT_SYMBOL(lfsck_degister);
 
+/**
+ * Record the object modified by the MDD for the incremental LFSCK.
+ *
+ * It is called inside the modification transaction, and does nothing
+ * unless the dirty objects tracking has been enabled by "lfsck_start -i".
+ * The MDD only calls it between the LE_DIRTY_TRACK_ON and LE_DIRTY_TRACK_OFF
+ * events, to skip the lfsck instance lookup when the tracking is off.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] key	the bottom device of the MDT
+ * \param[in] fid	the FID of the modified object
+ */
+void lfsck_mark_dirty(const struct lu_env *env, struct dt_device *key,
+		      const struct lu_fid *fid)
+{
+	struct lfsck_instance *lfsck;
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		lfsck_dirty_add(lfsck, fid);
+		lfsck_instance_put(env, lfsck);
+	}
+}
+EXPORT_SYMBOL(lfsck_mark_dirty);
+
 int lfsck_add_target(const struct lu_env *env, struct dt_device *key,
 		     struct dt_device *tgt, struct obd_export *exp,
 		     __u32 index, bool for_ost)
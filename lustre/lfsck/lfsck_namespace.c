@@ -73,7 +73,7 @@ lfsck_namespace_assistant_req_init(struct lfsck_instance *lfsck,
 	lnr->lnr_lar.lar_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
 	lnr->lnr_lmv = lfsck_lmv_get(lfsck->li_lmv);
 	lnr->lnr_fid = ent->lde_fid;
-	lnr->lnr_oit_cookie = lfsck->li_pos_current.lp_oit_cookie;
+	lnr->lnr_oit_cookie = lfsck->li_dir_oit_cookie;
 	lnr->lnr_dir_cookie = ent->lde_hash;
 	lnr->lnr_attr = ent->lde_attrs;
 	lnr->lnr_size = size;
@@ -3821,7 +3821,7 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 	lnr->lnr_lar.lar_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
 	lnr->lnr_lmv = lfsck_lmv_get(llmv);
 	lnr->lnr_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
-	lnr->lnr_oit_cookie = lfsck->li_pos_current.lp_oit_cookie;
+	lnr->lnr_oit_cookie = lfsck->li_dir_oit_cookie;
 	lnr->lnr_dir_cookie = MDS_DIR_END_OFF;
 	lnr->lnr_size = size;
 
@@ -898,10 +898,13 @@ static int quotactl_ioctl(struct ll_sb_info *sbi, struct if_quotactl *qctl)
                         RETURN(-EPERM);
                 break;
 	case Q_GETQUOTA:
+		/* a project ID is not tied to the caller's credentials,
+		 * only the administrator may query the project quota */
 		if (((type == USRQUOTA &&
 		      !uid_eq(current_euid(), make_kuid(&init_user_ns, id))) ||
 		     (type == GRPQUOTA &&
-		      !in_egroup_p(make_kgid(&init_user_ns, id)))) &&
+		      !in_egroup_p(make_kgid(&init_user_ns, id))) ||
+		     type == PRJQUOTA) &&
 		    (!cfs_capable(CFS_CAP_SYS_ADMIN) ||
 		     sbi->ll_flags & LL_SBI_RMT_CLIENT))
 			RETURN(-EPERM);
@@ -1647,7 +1650,21 @@ out_rmdir:
 		RETURN(obd_iocontrol(cmd, sbi->ll_md_exp, 0, NULL,
 				     (void __user *)arg));
         }
-        case OBD_IOC_CHANGELOG_SEND:
+	case OBD_IOC_CHANGELOG_SEND: {
+		struct ioc_changelog	icc;
+		size_t			size = sizeof(icc);
+
+		if (copy_from_user(&icc, (void __user *)arg, sizeof(icc)))
+			RETURN(-EFAULT);
+
+		/* a record filter follows the request */
+		if (icc.icc_flags & CHANGELOG_FLAG_FILTER)
+			size = sizeof(struct ioc_changelog_filter);
+
+		rc = copy_and_ioctl(cmd, sbi->ll_md_exp, (void __user *)arg,
+				    size);
+		RETURN(rc);
+	}
         case OBD_IOC_CHANGELOG_CLEAR:
 		rc = copy_and_ioctl(cmd, sbi->ll_md_exp, (void __user *)arg,
                                     sizeof(struct ioc_changelog));
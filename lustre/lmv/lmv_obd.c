@@ -2229,77 +2229,65 @@ static int lmv_fsync(struct obd_export *exp, const struct lu_fid *fid,
 }
 
 /**
- * Get current minimum entry from striped directory
+ * Read position in one stripe of a striped directory, see
+ * lmv_read_striped_page().
+ */
+struct lmv_stripe_dirent {
+	/* the stripe page holding lsd_ent, kmapped */
+	struct page		*lsd_page;
+	/* current entry, NULL if the end of the stripe is reached */
+	struct lu_dirent	*lsd_ent;
+	/* stripe index */
+	int			 lsd_idx;
+};
+
+static inline __u64 lmv_stripe_dirent_hash(const struct lmv_stripe_dirent *sd)
+{
+	return le64_to_cpu(sd->lsd_ent->lde_hash);
+}
+
+/**
+ * Move to the next entry of the stripe.
  *
- * This function will search the dir entry, whose hash value is the
- * closest(>=) to @hash_offset, from all of sub-stripes, and it is
- * only being called for striped directory.
+ * Starts from the entry closest(>=) to \a hash_offset if no entry is read
+ * from this stripe yet, reads the next stripe page when the current one is
+ * finished, and skips the dummy entries as well as . and .. of the non-zero
+ * stripes, because there can only be one . and .. in a directory.
  *
  * \param[in] exp		export of LMV
- * \param[in] op_data		parameters transferred beween client MD stack
- *                              stripe_information will be included in this
- *                              parameter
+ * \param[in] op_data		parameters transferred beween client MD stack,
+ *				stripe information is included
  * \param[in] cb_op		ldlm callback being used in enqueue in
- *                              mdc_read_page
- * \param[in] hash_offset	the hash value, which is used to locate
- *                              minum(closet) dir entry
- * \param[in|out] stripe_offset the caller use this to indicate the stripe
- *                              index of last entry, so to avoid hash conflict
- *                              between stripes. It will also be used to
- *                              return the stripe index of current dir entry.
- * \param[in|out] entp		the minum entry and it also is being used
- *                              to input the last dir entry to resolve the
- *                              hash conflict
- *
- * \param[out] ppage		the page which holds the minum entry
+ *				mdc_read_page
+ * \param[in] hash_offset	the hash of the first entry to return
+ * \param[in,out] sd		the stripe read position
  *
- * \retval                      = 0 get the entry successfully
- *                              negative errno (< 0) does not get the entry
+ * \retval 0			success, sd->lsd_ent is NULL at stripe end
+ * \retval negative		error code if failed
  */
-static int lmv_get_min_striped_entry(struct obd_export *exp,
-				     struct md_op_data *op_data,
-				     struct md_callback *cb_op,
-				     __u64 hash_offset, int *stripe_offset,
-				     struct lu_dirent **entp,
-				     struct page **ppage)
+static int lmv_stripe_dirent_next(struct obd_export *exp,
+				  struct md_op_data *op_data,
+				  struct md_callback *cb_op,
+				  __u64 hash_offset,
+				  struct lmv_stripe_dirent *sd)
 {
-	struct obd_device	*obd = exp->exp_obd;
-	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_obd		*lmv = &exp->exp_obd->u.lmv;
 	struct lmv_stripe_md	*lsm = op_data->op_mea1;
+	struct lmv_oinfo	*oinfo = &lsm->lsm_md_oinfo[sd->lsd_idx];
 	struct lmv_tgt_desc	*tgt;
-	int			stripe_count;
-	struct lu_dirent	*min_ent = NULL;
-	struct page		*min_page = NULL;
-	int			min_idx = 0;
-	int			i;
-	int			rc = 0;
+	struct lu_dirpage	*dp;
+	struct lu_dirent	*ent;
+	__u64			 stripe_hash = hash_offset;
+	int			 rc;
 	ENTRY;
 
-	stripe_count = lsm->lsm_md_stripe_count;
-	for (i = 0; i < stripe_count; i++) {
-		struct lu_dirent	*ent = NULL;
-		struct page		*page = NULL;
-		struct lu_dirpage	*dp;
-		__u64			stripe_hash = hash_offset;
-
-		tgt = lmv_get_target(lmv, lsm->lsm_md_oinfo[i].lmo_mds, NULL);
-		if (IS_ERR(tgt))
-			GOTO(out, rc = PTR_ERR(tgt));
-
-		/* op_data will be shared by each stripe, so we need
-		 * reset these value for each stripe */
-		op_data->op_fid1 = lsm->lsm_md_oinfo[i].lmo_fid;
-		op_data->op_fid2 = lsm->lsm_md_oinfo[i].lmo_fid;
-		op_data->op_data = lsm->lsm_md_oinfo[i].lmo_root;
-next:
-		rc = md_read_page(tgt->ltd_exp, op_data, cb_op, stripe_hash,
-				  &page);
-		if (rc != 0)
-			GOTO(out, rc);
+	if (sd->lsd_page != NULL)
+		ent = lu_dirent_next(sd->lsd_ent);
+	else
+		ent = NULL;
 
-		dp = page_address(page);
-		for (ent = lu_dirent_start(dp); ent != NULL;
-		     ent = lu_dirent_next(ent)) {
+	while (1) {
+		for (; ent != NULL; ent = lu_dirent_next(ent)) {
 			/* Skip dummy entry */
 			if (le16_to_cpu(ent->lde_namelen) == 0)
 				continue;
@@ -2307,76 +2295,103 @@ next:
 			if (le64_to_cpu(ent->lde_hash) < hash_offset)
 				continue;
 
-			if (le64_to_cpu(ent->lde_hash) == hash_offset &&
-			    (*entp == ent || i < *stripe_offset))
-				continue;
-
 			/* skip . and .. for other stripes */
-			if (i != 0 &&
+			if (sd->lsd_idx != 0 &&
 			    (strncmp(ent->lde_name, ".",
 				     le16_to_cpu(ent->lde_namelen)) == 0 ||
 			     strncmp(ent->lde_name, "..",
 				     le16_to_cpu(ent->lde_namelen)) == 0))
 				continue;
-			break;
+
+			sd->lsd_ent = ent;
+			RETURN(0);
 		}
 
-		if (ent == NULL) {
+		if (sd->lsd_page != NULL) {
+			dp = page_address(sd->lsd_page);
 			stripe_hash = le64_to_cpu(dp->ldp_hash_end);
 
-			kunmap(page);
-			page_cache_release(page);
-			page = NULL;
+			kunmap(sd->lsd_page);
+			page_cache_release(sd->lsd_page);
+			sd->lsd_page = NULL;
+			sd->lsd_ent = NULL;
 
-			/* reach the end of current stripe, go to next stripe */
+			/* reach the end of current stripe */
 			if (stripe_hash == MDS_DIR_END_OFF)
-				continue;
-			else
-				goto next;
+				RETURN(0);
 		}
 
-		if (min_ent != NULL) {
-			if (le64_to_cpu(min_ent->lde_hash) >
-			    le64_to_cpu(ent->lde_hash)) {
-				min_ent = ent;
-				kunmap(min_page);
-				page_cache_release(min_page);
-				min_idx = i;
-				min_page = page;
-			} else {
-				kunmap(page);
-				page_cache_release(page);
-				page = NULL;
-			}
-		} else {
-			min_ent = ent;
-			min_page = page;
-			min_idx = i;
+		tgt = lmv_get_target(lmv, oinfo->lmo_mds, NULL);
+		if (IS_ERR(tgt))
+			RETURN(PTR_ERR(tgt));
+
+		/* op_data will be shared by each stripe, so we need
+		 * reset these value for each stripe */
+		op_data->op_fid1 = oinfo->lmo_fid;
+		op_data->op_fid2 = oinfo->lmo_fid;
+		op_data->op_data = oinfo->lmo_root;
+
+		rc = md_read_page(tgt->ltd_exp, op_data, cb_op, stripe_hash,
+				  &sd->lsd_page);
+		if (rc != 0) {
+			sd->lsd_page = NULL;
+			RETURN(rc);
 		}
+
+		dp = page_address(sd->lsd_page);
+		ent = lu_dirent_start(dp);
 	}
+}
 
-out:
-	if (*ppage != NULL) {
-		kunmap(*ppage);
-		page_cache_release(*ppage);
+/* Order of the stripe read positions in the merge heap: by the hash of the
+ * current entry, and by stripe index for the entries with the same hash. */
+static inline bool lmv_stripe_dirent_less(const struct lmv_stripe_dirent *a,
+					  const struct lmv_stripe_dirent *b)
+{
+	__u64 hash_a = lmv_stripe_dirent_hash(a);
+	__u64 hash_b = lmv_stripe_dirent_hash(b);
+
+	return hash_a < hash_b || (hash_a == hash_b && a->lsd_idx < b->lsd_idx);
+}
+
+/* Restore the min-heap order from \a i downwards. */
+static void lmv_stripe_heap_down(struct lmv_stripe_dirent **heap, int count,
+				 int i)
+{
+	struct lmv_stripe_dirent *tmp;
+	int min;
+
+	while (1) {
+		min = i;
+		if (2 * i + 1 < count &&
+		    lmv_stripe_dirent_less(heap[2 * i + 1], heap[min]))
+			min = 2 * i + 1;
+		if (2 * i + 2 < count &&
+		    lmv_stripe_dirent_less(heap[2 * i + 2], heap[min]))
+			min = 2 * i + 2;
+		if (min == i)
+			break;
+
+		tmp = heap[i];
+		heap[i] = heap[min];
+		heap[min] = tmp;
+		i = min;
 	}
-	*stripe_offset = min_idx;
-	*entp = min_ent;
-	*ppage = min_page;
-	RETURN(rc);
 }
 
 /**
  * Build dir entry page from a striped directory
  *
- * This function gets one entry by @offset from a striped directory. It will
- * read entries from all of stripes, and choose one closest to the required
- * offset(&offset). A few notes
+ * This function fills one page with the entries from @offset of a striped
+ * directory. Each stripe is read in hash order from its own position, and
+ * the stripe positions are kept in a min-heap by the hash of their current
+ * entry, so the entries are merged in hash order with O(log(stripe_count))
+ * per entry, and every stripe page is only read once for the whole page.
+ * A few notes
  * 1. skip . and .. for non-zero stripes, because there can only have one .
  * and .. in a directory.
  * 2. op_data will be shared by all of stripes, instead of allocating new
  * one, so need to restore before reusing.
- * 3. release the entry page if that is not being chosen.
  *
  * \param[in] exp	obd export refer to LMV
  * \param[in] op_data	hold those MD parameters of read_entry
@@ -2396,18 +2411,23 @@ static int lmv_read_striped_page(struct obd_export *exp,
 				 __u64 offset, struct page **ppage)
 {
 	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_stripe_md	*lsm = op_data->op_mea1;
 	struct lu_fid		master_fid = op_data->op_fid1;
 	struct inode		*master_inode = op_data->op_data;
 	__u64			hash_offset = offset;
-	struct lu_dirpage	*dp;
-	struct page		*min_ent_page = NULL;
+	struct lu_dirpage	*dp = NULL;
 	struct page		*ent_page = NULL;
-	struct lu_dirent	*ent;
-	void			*area;
-	int			ent_idx = 0;
-	struct lu_dirent	*min_ent = NULL;
+	struct lu_dirent	*ent = NULL;
+	void			*area = NULL;
+	struct lmv_stripe_dirent *stripes = NULL;
+	struct lmv_stripe_dirent **heap = NULL;
+	struct lmv_stripe_dirent *sd;
+	struct lu_dirent	*min_ent;
 	struct lu_dirent	*last_ent;
 	size_t			left_bytes;
+	int			stripe_count = lsm->lsm_md_stripe_count;
+	int			heap_count = 0;
+	int			i;
 	int			rc;
 	ENTRY;
 
@@ -2415,11 +2435,19 @@ static int lmv_read_striped_page(struct obd_export *exp,
 	if (rc)
 		RETURN(rc);
 
+	OBD_ALLOC_LARGE(stripes, stripe_count * sizeof(*stripes));
+	if (stripes == NULL)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC_LARGE(heap, stripe_count * sizeof(*heap));
+	if (heap == NULL)
+		GOTO(out, rc = -ENOMEM);
+
 	/* Allocate a page and read entries from all of stripes and fill
 	 * the page by hash order */
 	ent_page = alloc_page(GFP_KERNEL);
 	if (ent_page == NULL)
-		RETURN(-ENOMEM);
+		GOTO(out, rc = -ENOMEM);
 
 	/* Initialize the entry page */
 	dp = kmap(ent_page);
@@ -2431,24 +2459,37 @@ static int lmv_read_striped_page(struct obd_export *exp,
 	left_bytes = PAGE_CACHE_SIZE - sizeof(*dp);
 	ent = area;
 	last_ent = ent;
-	do {
-		__u16	ent_size;
 
-		/* Find the minum entry from all sub-stripes */
-		rc = lmv_get_min_striped_entry(exp, op_data, cb_op, hash_offset,
-					       &ent_idx, &min_ent,
-					       &min_ent_page);
+	/* Find the entry closest to the offset in each stripe */
+	for (i = 0; i < stripe_count; i++) {
+		sd = &stripes[i];
+		sd->lsd_idx = i;
+		rc = lmv_stripe_dirent_next(exp, op_data, cb_op, hash_offset,
+					    sd);
 		if (rc != 0)
 			GOTO(out, rc);
 
+		if (sd->lsd_ent != NULL)
+			heap[heap_count++] = sd;
+	}
+
+	for (i = heap_count / 2 - 1; i >= 0; i--)
+		lmv_stripe_heap_down(heap, heap_count, i);
+
+	do {
+		__u16	ent_size;
+
 		/* If it can not get minum entry, it means it already reaches
 		 * the end of this directory */
-		if (min_ent == NULL) {
+		if (heap_count == 0) {
 			last_ent->lde_reclen = 0;
 			hash_offset = MDS_DIR_END_OFF;
 			GOTO(out, rc);
 		}
 
+		/* The minimum entry of all sub-stripes */
+		sd = heap[0];
+		min_ent = sd->lsd_ent;
 		ent_size = le16_to_cpu(min_ent->lde_reclen);
 
 		/* the last entry lde_reclen is 0, but it might not
@@ -2485,15 +2526,35 @@ static int lmv_read_striped_page(struct obd_export *exp,
 			last_ent->lde_reclen = 0;
 			break;
 		}
+
+		/* Advance the stripe and put it back into the heap */
+		rc = lmv_stripe_dirent_next(exp, op_data, cb_op, hash_offset,
+					    sd);
+		if (rc != 0)
+			GOTO(out, rc);
+
+		if (sd->lsd_ent == NULL)
+			heap[0] = heap[--heap_count];
+		lmv_stripe_heap_down(heap, heap_count, 0);
 	} while (1);
 out:
-	if (min_ent_page != NULL) {
-		kunmap(min_ent_page);
-		page_cache_release(min_ent_page);
+	for (i = 0; i < stripe_count; i++) {
+		sd = &stripes[i];
+		if (sd->lsd_page != NULL) {
+			kunmap(sd->lsd_page);
+			page_cache_release(sd->lsd_page);
+		}
 	}
 
+	if (heap != NULL)
+		OBD_FREE_LARGE(heap, stripe_count * sizeof(*heap));
+	OBD_FREE_LARGE(stripes, stripe_count * sizeof(*stripes));
+
 	if (unlikely(rc != 0)) {
-		__free_page(ent_page);
+		if (ent_page != NULL) {
+			kunmap(ent_page);
+			__free_page(ent_page);
+		}
 		ent_page = NULL;
 	} else {
 		if (ent == area)
@@ -561,14 +561,22 @@ static int lod_trans_start(const struct lu_env *env, struct dt_device *dev,
 	if (unlikely(th->th_update != NULL)) {
 		struct thandle_update *tu = th->th_update;
 		struct dt_update_request *update;
+		int rc2;
 
 		list_for_each_entry(update, &tu->tu_remote_update_list,
 				    dur_list) {
 			LASSERT(update->dur_dt != NULL);
 			rc = dt_trans_start(env, update->dur_dt, th);
 			if (rc != 0)
-				return rc;
+				break;
 		}
+
+		/* the remote updates are sent in parallel */
+		rc2 = out_remote_wait(env, tu);
+		if (rc == 0)
+			rc = rc2;
+		if (rc != 0)
+			return rc;
 	}
 	return dt_trans_start(env, lod->lod_child, th);
 }
@@ -606,6 +614,11 @@ static int lod_trans_stop(const struct lu_env *env, struct dt_device *dt,
 		if (unlikely(rc2 != 0 && rc == 0))
 			rc = rc2;
 	}
+
+	/* the remote updates are sent in parallel */
+	rc2 = out_remote_wait(env, tu);
+	if (unlikely(rc2 != 0 && rc == 0))
+		rc = rc2;
 	thandle_put(th);
 
 	RETURN(rc);
@@ -1083,6 +1096,11 @@ static void lod_key_fini(const struct lu_context *ctx,
 		info->lti_ea_store = NULL;
 		info->lti_ea_store_size = 0;
 	}
+	if (info->lti_qos_buf) {
+		OBD_FREE_LARGE(info->lti_qos_buf, info->lti_qos_buf_size);
+		info->lti_qos_buf = NULL;
+		info->lti_qos_buf_size = 0;
+	}
 	lu_buf_free(&info->lti_linkea_buf);
 	OBD_FREE_PTR(info);
 }
@@ -84,8 +84,16 @@ struct lod_qos {
 	struct rw_semaphore	 lq_rw_sem;
 	__u32			 lq_active_oss_count;
 	unsigned int		 lq_prio_free;   /* priority for free space */
+	unsigned int		 lq_prio_perf;   /* priority for I/O latency */
 	unsigned int		 lq_threshold_rr;/* priority for rr */
 	struct lod_qos_rr	 lq_rr;          /* round robin qos data */
+	__u64			 lq_used_epoch;  /* objects allocated by qos, the
+						  * OSS penalties are decreased
+						  * lazily by it */
+	__u64			 lq_ost_epoch;   /* objects allocated by qos
+						  * without a pool, the OST
+						  * penalties are decreased
+						  * lazily by it */
 	bool			 lq_dirty:1,     /* recalc qos data */
 				 lq_same_space:1,/* the ost's all have approx.
 						    the same space avail */
@@ -99,8 +107,12 @@ struct lod_qos_oss {
 	__u64			 lqo_penalty;	/* current penalty */
 	__u64			 lqo_penalty_per_obj; /* penalty decrease
 							 every obj*/
+	__u64			 lqo_epoch;	/* lq_used_epoch at the last
+						 * penalty update */
 	time_t			 lqo_used;	/* last used time, seconds */
 	__u32			 lqo_ost_count;	/* number of osts on this oss */
+	__u32			 lqo_cand;	/* the last candidate on this
+						 * oss in lod_alloc_qos() */
 };
 
 struct ltd_qos {
@@ -109,6 +121,10 @@ struct ltd_qos {
 	__u64			 ltq_penalty_per_obj; /* penalty decrease
 							 every obj*/
 	__u64			 ltq_weight;	/* net weighting */
+	__u32			 ltq_perf;	/* performance headroom compared
+						 * with the fastest OST, 0-256 */
+	__u64			 ltq_epoch;	/* lq_ost_epoch at the last
+						 * penalty update */
 	time_t			 ltq_used;	/* last used time, seconds */
 	bool			 ltq_usable:1;	/* usable for striping */
 };
@@ -282,6 +298,9 @@ struct lod_thread_info {
 	/* per-thread buffer for LOV EA */
 	void             *lti_ea_store;
 	__u32             lti_ea_store_size;
+	/* per-thread buffer for the QoS allocation candidates */
+	void             *lti_qos_buf;
+	__u32             lti_qos_buf_size;
 	/* per-thread buffer for LMV EA */
 	struct lu_buf     lti_buf;
 	struct ost_id     lti_ostid;
@@ -1278,6 +1278,8 @@ int lod_pools_init(struct lod_device *lod, struct lustre_cfg *lcfg)
 	lod->lod_qos.lq_prio_free = 232;
 	/* Default threshold for rr (roughly 17%) */
 	lod->lod_qos.lq_threshold_rr = 43;
+	/* I/O latency is not considered by default */
+	lod->lod_qos.lq_prio_perf = 0;
 
 	/* Set up OST pool environment */
 	lod->lod_pools_hash_body = cfs_hash_create("POOLS", HASH_POOLS_CUR_BITS,
@@ -56,6 +56,12 @@
 #define TGT_BAVAIL(i) (OST_TGT(lod,i)->ltd_statfs.os_bavail * \
 		       OST_TGT(lod,i)->ltd_statfs.os_bsize)
 
+/* The I/O latency (usec) below which the OSTs are regarded as equally fast,
+ * the small differences of idle OSTs should not affect the allocation. */
+#define LOD_QOS_LATENCY_MIN	10000
+#define TGT_LATENCY(i) (min_t(__u32, OST_TGT(lod,i)->ltd_statfs.os_io_latency, \
+			      INT_MAX) + LOD_QOS_LATENCY_MIN)
+
 /**
  * Add a new target to Quality of Service (QoS) target table.
  *
@@ -256,6 +262,7 @@ static void lod_qos_statfs_update(const struct lu_env *env,
 	unsigned int	   i;
 	int		   idx;
 	__u64		   max_age, avail;
+	__u32		   latency;
 	ENTRY;
 
 	max_age = cfs_time_shift_64(-2 * lod->lod_desc.ld_qos_maxage);
@@ -271,10 +278,13 @@ static void lod_qos_statfs_update(const struct lu_env *env,
 	for (i = 0; i < osts->op_count; i++) {
 		idx = osts->op_array[i];
 		avail = OST_TGT(lod,idx)->ltd_statfs.os_bavail;
+		latency = OST_TGT(lod,idx)->ltd_statfs.os_io_latency;
 		if (lod_statfs_and_check(env, lod, idx,
 					 &OST_TGT(lod, idx)->ltd_statfs))
 			continue;
-		if (OST_TGT(lod,idx)->ltd_statfs.os_bavail != avail)
+		if (OST_TGT(lod,idx)->ltd_statfs.os_bavail != avail ||
+		    (lod->lod_qos.lq_prio_perf != 0 &&
+		     OST_TGT(lod,idx)->ltd_statfs.os_io_latency != latency))
 			/* recalculate weigths */
 			lod->lod_qos.lq_dirty = 1;
 	}
@@ -285,6 +295,56 @@ out:
 	EXIT;
 }
 
+/**
+ * Apply the penalty decrease for the objects allocated since the last update.
+ *
+ * Every object allocated by QoS decreases the penalties of all the OSSs and
+ * of the OSTs in the pool it was allocated from by their penalty_per_obj.
+ * Instead of walking all of them for each object, the count of allocated
+ * objects is kept in lq_used_epoch, and in lq_ost_epoch for the objects
+ * allocated without a pool, and the decrease is applied when the penalty
+ * is really used.
+ *
+ * \param[in] penalty	the penalty at the last update
+ * \param[in] per_obj	the penalty decrease for each object
+ * \param[in] objs	the number of objects allocated since then
+ *
+ * \retval		the current penalty
+ */
+static inline __u64 lod_qos_penalty_decay(__u64 penalty, __u64 per_obj,
+					  __u64 objs)
+{
+	if (objs == 0 || per_obj == 0)
+		return penalty;
+
+	if (div64_u64(penalty, per_obj) < objs)
+		return 0;
+
+	return penalty - per_obj * objs;
+}
+
+static void lod_qos_ost_penalty_sync(struct lod_device *lod,
+				     struct ltd_qos *ltq)
+{
+	__u64 epoch = lod->lod_qos.lq_ost_epoch;
+
+	ltq->ltq_penalty = lod_qos_penalty_decay(ltq->ltq_penalty,
+						 ltq->ltq_penalty_per_obj,
+						 epoch - ltq->ltq_epoch);
+	ltq->ltq_epoch = epoch;
+}
+
+static void lod_qos_oss_penalty_sync(struct lod_device *lod,
+				     struct lod_qos_oss *oss)
+{
+	__u64 epoch = lod->lod_qos.lq_used_epoch;
+
+	oss->lqo_penalty = lod_qos_penalty_decay(oss->lqo_penalty,
+						 oss->lqo_penalty_per_obj,
+						 epoch - oss->lqo_epoch);
+	oss->lqo_epoch = epoch;
+}
+
 /**
  * Calculate per-OST and per-OSS penalties
  *
@@ -305,6 +365,7 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 {
 	struct lod_qos_oss *oss;
 	__u64		    ba_max, ba_min, temp;
+	__u32		    lat_min, perf_min;
 	__u32		    num_active;
 	unsigned int	    i;
 	int		    rc, prio_wide;
@@ -332,16 +393,20 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 
 	ba_min = (__u64)(-1);
 	ba_max = 0;
+	lat_min = (__u32)(-1);
 	now = cfs_time_current_sec();
 	/* Calculate OST penalty per object
 	 * (lod ref taken in lod_qos_prep_create()) */
 	cfs_foreach_bit(lod->lod_ost_bitmap, i) {
 		LASSERT(OST_TGT(lod,i));
+		/* Apply the pending decrease before penalty_per_obj changes. */
+		lod_qos_ost_penalty_sync(lod, &OST_TGT(lod,i)->ltd_qos);
 		temp = TGT_BAVAIL(i);
 		if (!temp)
 			continue;
 		ba_min = min(temp, ba_min);
 		ba_max = max(temp, ba_max);
+		lat_min = min_t(__u32, TGT_LATENCY(i), lat_min);
 
 		/* Count the number of usable OSS's */
 		if (OST_TGT(lod,i)->ltd_qos.ltq_oss->lqo_bavail == 0)
@@ -375,6 +440,7 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 
 	/* Per-OSS penalty is prio * oss_avail / oss_osts / (num_oss - 1) / 2 */
 	list_for_each_entry(oss, &lod->lod_qos.lq_oss_list, lqo_oss_list) {
+		lod_qos_oss_penalty_sync(lod, oss);
 		temp = oss->lqo_bavail >> 1;
 		do_div(temp, oss->lqo_ost_count * num_active);
 		oss->lqo_penalty_per_obj = (temp * prio_wide) >> 8;
@@ -388,13 +454,31 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 			oss->lqo_penalty >>= age / lod->lod_desc.ld_qos_maxage;
 	}
 
+	/* Performance headroom is the I/O latency of the fastest OST
+	 * relative to the OST's own, see lod_qos_calc_weight(). */
+	perf_min = 256;
+	cfs_foreach_bit(lod->lod_ost_bitmap, i) {
+		if (lat_min == (__u32)(-1) || TGT_BAVAIL(i) == 0) {
+			OST_TGT(lod,i)->ltd_qos.ltq_perf = 256;
+			continue;
+		}
+
+		temp = (__u64)lat_min << 8;
+		do_div(temp, TGT_LATENCY(i));
+		OST_TGT(lod,i)->ltd_qos.ltq_perf = temp;
+		perf_min = min_t(__u32, temp, perf_min);
+	}
+
 	lod->lod_qos.lq_dirty = 0;
 	lod->lod_qos.lq_reset = 0;
 
 	/* If each ost has almost same free space,
 	 * do rr allocation for better creation performance */
 	lod->lod_qos.lq_same_space = 0;
-	if ((ba_max * (256 - lod->lod_qos.lq_threshold_rr)) >> 8 < ba_min) {
+	if ((ba_max * (256 - lod->lod_qos.lq_threshold_rr)) >> 8 < ba_min &&
+	    /* Some OST is much slower than the others, avoid it. */
+	    (lod->lod_qos.lq_prio_perf == 0 ||
+	     256 - lod->lod_qos.lq_threshold_rr <= perf_min)) {
 		lod->lod_qos.lq_same_space = 1;
 		/* Reset weights for the next time we enter qos mode */
 		lod->lod_qos.lq_reset = 1;
@@ -414,6 +498,9 @@ out:
  *
  * The final OST weight is the number of bytes available minus the OST and
  * OSS penalties.  See lod_qos_calc_ppo() for how penalties are calculated.
+ * If qos_prio_perf is set, the weight is then scaled down by the OST's
+ * performance headroom, so the OSTs with high I/O latency are less likely
+ * to be selected.
  *
  * \param[in] lod	LOD device, where OST targets are listed
  * \param[in] i		OST target index
@@ -423,37 +510,50 @@ out:
 static int lod_qos_calc_weight(struct lod_device *lod, int i)
 {
 	__u64 temp, temp2;
+	__u32 prio;
 
+	lod_qos_ost_penalty_sync(lod, &OST_TGT(lod,i)->ltd_qos);
+	lod_qos_oss_penalty_sync(lod, OST_TGT(lod,i)->ltd_qos.ltq_oss);
 	temp = TGT_BAVAIL(i);
 	temp2 = OST_TGT(lod,i)->ltd_qos.ltq_penalty +
 		OST_TGT(lod,i)->ltd_qos.ltq_oss->lqo_penalty;
 	if (temp < temp2)
-		OST_TGT(lod,i)->ltd_qos.ltq_weight = 0;
+		temp = 0;
 	else
-		OST_TGT(lod,i)->ltd_qos.ltq_weight = temp - temp2;
+		temp -= temp2;
+
+	prio = lod->lod_qos.lq_prio_perf;
+	if (prio != 0)
+		temp = (temp >> 8) * ((256 - prio) +
+			((prio * OST_TGT(lod,i)->ltd_qos.ltq_perf) >> 8));
+
+	OST_TGT(lod,i)->ltd_qos.ltq_weight = temp;
 	return 0;
 }
 
 /**
- * Re-calculate weights.
+ * Update the penalties after an OST target was used for a new object.
  *
- * The function is called when some OST target was used for a new object. In
- * this case we should re-calculate all the weights to keep new allocations
- * balanced well.
+ * The used OST and its OSS get the maximum penalties, then the penalties of
+ * all the OSSs and of the OSTs in \a osts are decreased by their
+ * penalty_per_obj. The latter is done lazily via lod_qos::lq_used_epoch and
+ * lod_qos::lq_ost_epoch, see lod_qos_penalty_decay(), so the cost does not
+ * depend on the number of OSTs. Only the OSTs of a named pool are walked,
+ * as the other OSTs must keep their penalties.
  *
  * \param[in] lod	LOD device
- * \param[in] osts	OST pool where a new object was placed
+ * \param[in] osts	pool the object was allocated from
  * \param[in] index	OST target where a new object was placed
- * \param[out] total_wt	new total weight for the pool
  *
  * \retval		0
  */
 static int lod_qos_used(struct lod_device *lod, struct ost_pool *osts,
-			__u32 index, __u64 *total_wt)
+			__u32 index)
 {
 	struct lod_tgt_desc *ost;
 	struct lod_qos_oss  *oss;
-	unsigned int j;
+	struct ltd_qos	    *ltq;
+	unsigned int	     j;
 	ENTRY;
 
 	ost = OST_TGT(lod,index);
@@ -463,6 +563,8 @@ static int lod_qos_used(struct lod_device *lod, struct ost_pool *osts,
 	ost->ltd_qos.ltq_usable = 0;
 
 	oss = ost->ltd_qos.ltq_oss;
+	lod_qos_ost_penalty_sync(lod, &ost->ltd_qos);
+	lod_qos_oss_penalty_sync(lod, oss);
 
 	/* Decay old penalty by half (we're adding max penalty, and don't
 	   want it to run away.) */
@@ -478,50 +580,30 @@ static int lod_qos_used(struct lod_device *lod, struct ost_pool *osts,
 	oss->lqo_penalty += oss->lqo_penalty_per_obj *
 		lod->lod_qos.lq_active_oss_count;
 
-	/* Decrease all OSS penalties */
-	list_for_each_entry(oss, &lod->lod_qos.lq_oss_list, lqo_oss_list) {
-		if (oss->lqo_penalty < oss->lqo_penalty_per_obj)
-			oss->lqo_penalty = 0;
-		else
-			oss->lqo_penalty -= oss->lqo_penalty_per_obj;
-	}
-
-	*total_wt = 0;
-	/* Decrease all OST penalties */
-	for (j = 0; j < osts->op_count; j++) {
-		int i;
-
-		i = osts->op_array[j];
-		if (!cfs_bitmap_check(lod->lod_ost_bitmap, i))
-			continue;
+	/* Decrease all OSS and the pool's OST penalties */
+	lod->lod_qos.lq_used_epoch++;
+	if (osts == &lod->lod_pool_info) {
+		lod->lod_qos.lq_ost_epoch++;
+	} else {
+		for (j = 0; j < osts->op_count; j++) {
+			if (!cfs_bitmap_check(lod->lod_ost_bitmap,
+					      osts->op_array[j]))
+				continue;
 
-		ost = OST_TGT(lod,i);
-		LASSERT(ost);
-
-		if (ost->ltd_qos.ltq_penalty <
-				ost->ltd_qos.ltq_penalty_per_obj)
-			ost->ltd_qos.ltq_penalty = 0;
-		else
-			ost->ltd_qos.ltq_penalty -=
-				ost->ltd_qos.ltq_penalty_per_obj;
-
-		lod_qos_calc_weight(lod, i);
-
-		/* Recalc the total weight of usable osts */
-		if (ost->ltd_qos.ltq_usable)
-			*total_wt += ost->ltd_qos.ltq_weight;
-
-		QOS_DEBUG("recalc tgt %d usable=%d avail="LPU64
-			  " ostppo="LPU64" ostp="LPU64" ossppo="LPU64
-			  " ossp="LPU64" wt="LPU64"\n",
-			  i, ost->ltd_qos.ltq_usable, TGT_BAVAIL(i) >> 10,
-			  ost->ltd_qos.ltq_penalty_per_obj >> 10,
-			  ost->ltd_qos.ltq_penalty >> 10,
-			  ost->ltd_qos.ltq_oss->lqo_penalty_per_obj >> 10,
-			  ost->ltd_qos.ltq_oss->lqo_penalty >> 10,
-			  ost->ltd_qos.ltq_weight >> 10);
+			ltq = &OST_TGT(lod, osts->op_array[j])->ltd_qos;
+			lod_qos_ost_penalty_sync(lod, ltq);
+			ltq->ltq_penalty = lod_qos_penalty_decay(
+				ltq->ltq_penalty, ltq->ltq_penalty_per_obj, 1);
+		}
 	}
 
+	QOS_DEBUG("used tgt %d avail="LPU64" ostppo="LPU64" ostp="LPU64
+		  " ossppo="LPU64" ossp="LPU64"\n",
+		  index, TGT_BAVAIL(index) >> 10,
+		  ost->ltd_qos.ltq_penalty_per_obj >> 10,
+		  ost->ltd_qos.ltq_penalty >> 10,
+		  oss->lqo_penalty_per_obj >> 10, oss->lqo_penalty >> 10);
+
 	RETURN(0);
 }
 
@@ -1269,6 +1351,172 @@ out:
 	RETURN(rc);
 }
 
+/*
+ * The candidate OSTs for the weighted allocation.
+ *
+ * The weights of the candidates are kept in a Fenwick (binary indexed) tree,
+ * so both selecting the candidate by a random weight and updating the weight
+ * of some candidate are O(log n) instead of walking all the candidates.
+ */
+struct lod_qos_cand {
+	__u32	lqc_idx;	/* OST index */
+	__u32	lqc_next;	/* the former candidate on the same OSS */
+	__u64	lqc_weight;	/* the weight in the tree, 0 if not usable */
+};
+
+/**
+ * Prepare the per-thread buffer for the candidates and their tree.
+ *
+ * \param[in] env	execution environment for this thread
+ * \param[in] count	the maximum number of the candidates
+ * \param[out] tree	the Fenwick tree, with \a count + 1 slots
+ *
+ * \retval		the candidates array
+ * \retval		NULL if fails to allocate the buffer
+ */
+static struct lod_qos_cand *lod_qos_cands_get(const struct lu_env *env,
+					      __u32 count, __u64 **tree)
+{
+	struct lod_thread_info	*info = lod_env_info(env);
+	__u32			 size;
+
+	size = count * sizeof(struct lod_qos_cand) +
+	       (count + 1) * sizeof(__u64);
+	if (info->lti_qos_buf_size < size) {
+		if (info->lti_qos_buf != NULL)
+			OBD_FREE_LARGE(info->lti_qos_buf,
+				       info->lti_qos_buf_size);
+
+		/* Round up to avoid resizing for each new OST. */
+		size = roundup_pow_of_two(size);
+		OBD_ALLOC_LARGE(info->lti_qos_buf, size);
+		if (info->lti_qos_buf == NULL) {
+			info->lti_qos_buf_size = 0;
+			return NULL;
+		}
+
+		info->lti_qos_buf_size = size;
+	}
+
+	*tree = (__u64 *)((char *)info->lti_qos_buf +
+			  count * sizeof(struct lod_qos_cand));
+
+	return info->lti_qos_buf;
+}
+
+static __u64 lod_qos_tree_sum(__u64 *tree, __u32 count)
+{
+	__u64 sum = 0;
+	__u32 i;
+
+	for (i = count; i > 0; i -= i & -i)
+		sum += tree[i];
+
+	return sum;
+}
+
+/**
+ * Build the Fenwick tree for the candidates in O(n).
+ *
+ * \retval		the total weight of the candidates
+ */
+static __u64 lod_qos_tree_build(struct lod_qos_cand *cands, __u64 *tree,
+				__u32 count)
+{
+	__u32 i;
+	__u32 j;
+
+	tree[0] = 0;
+	for (i = 1; i <= count; i++)
+		tree[i] = cands[i - 1].lqc_weight;
+
+	for (i = 1; i <= count; i++) {
+		j = i + (i & -i);
+		if (j <= count)
+			tree[j] += tree[i];
+	}
+
+	return lod_qos_tree_sum(tree, count);
+}
+
+/**
+ * Change the weight of the candidate \a pos.
+ *
+ * \param[in,out] total	the total weight of the candidates
+ */
+static void lod_qos_tree_update(struct lod_qos_cand *cands, __u64 *tree,
+				__u32 count, __u32 pos, __u64 weight,
+				__u64 *total)
+{
+	/* The unsigned arithmetic works for the decrease too. */
+	__u64 delta = weight - cands[pos].lqc_weight;
+	__u32 i;
+
+	cands[pos].lqc_weight = weight;
+	*total += delta;
+	for (i = pos + 1; i <= count; i += i & -i)
+		tree[i] += delta;
+}
+
+/**
+ * Find the candidate hit by the random weight \a rand.
+ *
+ * It is the first candidate whose accumulated weight is greater than
+ * \a rand, so the candidate with a higher weight is proportionately
+ * more likely to be selected.
+ *
+ * \param[in] rand	the random weight, less than the total weight
+ *
+ * \retval		the position of the candidate
+ */
+static __u32 lod_qos_tree_find(__u64 *tree, __u32 count, __u64 rand)
+{
+	__u32 pos = 0;
+	__u32 step;
+
+	for (step = 1 << (fls(count) - 1); step > 0; step >>= 1) {
+		if (pos + step <= count && tree[pos + step] <= rand) {
+			pos += step;
+			rand -= tree[pos];
+		}
+	}
+
+	return pos;
+}
+
+/**
+ * Generate a random weight in [0, \a total_weight).
+ */
+static __u64 lod_qos_random(__u64 total_weight)
+{
+	__u64 rand;
+
+	if (total_weight == 0)
+		return 0;
+
+#if BITS_PER_LONG == 32
+	rand = cfs_rand() % (unsigned)total_weight;
+	/* If total_weight > 32-bit, first generate the high
+	 * 32 bits of the random number, then add in the low
+	 * 32 bits (truncated to the upper limit, if needed) */
+	if (total_weight > 0xffffffffULL)
+		rand = (__u64)(cfs_rand() %
+			(unsigned)(total_weight >> 32)) << 32;
+	else
+		rand = 0;
+
+	if (rand == (total_weight & 0xffffffff00000000ULL))
+		rand |= cfs_rand() % (unsigned)total_weight;
+	else
+		rand |= cfs_rand();
+
+#else
+	rand = ((__u64)cfs_rand() << 32 | cfs_rand()) % total_weight;
+#endif
+
+	return rand;
+}
+
 /**
  * Check whether QoS allocation should be used.
  *
@@ -1317,7 +1565,8 @@ static inline int lod_qos_is_usable(struct lod_device *lod)
  * The algorithm has two steps: find available OSTs and calucate their weights,
  * then select the OSTs the weights used as the probability. An OST with a
  * higher weight is proportionately more likely to be selected than one with
- * a lower weight.
+ * a lower weight. The weights are kept in a Fenwick tree, so each stripe is
+ * selected in O(log n) rather than by walking all the OSTs.
  *
  * \param[in] env	execution environment for this thread
  * \param[in] lo	LOD object
@@ -1337,7 +1586,10 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	struct lod_device   *m = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
 	struct obd_statfs   *sfs = &lod_env_info(env)->lti_osfs;
 	struct lod_tgt_desc *ost;
+	struct lod_qos_oss  *oss;
+	struct lod_qos_cand *cands;
 	struct dt_object    *o;
+	__u64		    *tree;
 	__u64		     total_weight = 0;
 	unsigned int	     i;
 	int		     rc = 0;
@@ -1380,17 +1632,22 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	if (rc)
 		GOTO(out, rc);
 
-	rc = lod_qos_ost_in_use_clear(env, lo->ldo_stripenr);
-	if (rc)
-		GOTO(out, rc);
+	cands = lod_qos_cands_get(env, osts->op_count, &tree);
+	if (cands == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	list_for_each_entry(oss, &m->lod_qos.lq_oss_list, lqo_oss_list)
+		oss->lqo_cand = LOV_QOS_EMPTY;
 
 	good_osts = 0;
 	/* Find all the OSTs that are valid stripe candidates */
 	for (i = 0; i < osts->op_count; i++) {
-		if (!cfs_bitmap_check(m->lod_ost_bitmap, osts->op_array[i]))
+		__u32 idx = osts->op_array[i];
+
+		if (!cfs_bitmap_check(m->lod_ost_bitmap, idx))
 			continue;
 
-		rc = lod_statfs_and_check(env, m, osts->op_array[i], sfs);
+		rc = lod_statfs_and_check(env, m, idx, sfs);
 		if (rc) {
 			/* this OSP doesn't feel well */
 			continue;
@@ -1404,15 +1661,18 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 
 		/* Fail Check before osc_precreate() is called
 		   so we can only 'fail' single OSC. */
-		if (OBD_FAIL_CHECK(OBD_FAIL_MDS_OSC_PRECREATE) &&
-				   osts->op_array[i] == 0)
+		if (OBD_FAIL_CHECK(OBD_FAIL_MDS_OSC_PRECREATE) && idx == 0)
 			continue;
 
-		ost = OST_TGT(m,osts->op_array[i]);
+		ost = OST_TGT(m, idx);
 		ost->ltd_qos.ltq_usable = 1;
-		lod_qos_calc_weight(m, osts->op_array[i]);
-		total_weight += ost->ltd_qos.ltq_weight;
+		lod_qos_calc_weight(m, idx);
 
+		/* 0-weight osts will only be used when nothing else left. */
+		cands[good_osts].lqc_idx = idx;
+		cands[good_osts].lqc_weight = ost->ltd_qos.ltq_weight + 1;
+		cands[good_osts].lqc_next = ost->ltd_qos.ltq_oss->lqo_cand;
+		ost->ltd_qos.ltq_oss->lqo_cand = good_osts;
 		good_osts++;
 	}
 
@@ -1426,87 +1686,53 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 		stripe_cnt = good_osts;
 
 	/* Find enough OSTs with weighted random allocation. */
+	total_weight = lod_qos_tree_build(cands, tree, good_osts);
 	nfound = 0;
-	while (nfound < stripe_cnt) {
-		__u64 rand, cur_weight;
-
-		cur_weight = 0;
-		rc = -ENOSPC;
+	while (nfound < stripe_cnt && total_weight > 0) {
+		__u32 pos;
+		__u32 idx;
 
-		if (total_weight) {
-#if BITS_PER_LONG == 32
-			rand = cfs_rand() % (unsigned)total_weight;
-			/* If total_weight > 32-bit, first generate the high
-			 * 32 bits of the random number, then add in the low
-			 * 32 bits (truncated to the upper limit, if needed) */
-			if (total_weight > 0xffffffffULL)
-				rand = (__u64)(cfs_rand() %
-					(unsigned)(total_weight >> 32)) << 32;
-			else
-				rand = 0;
-
-			if (rand == (total_weight & 0xffffffff00000000ULL))
-				rand |= cfs_rand() % (unsigned)total_weight;
-			else
-				rand |= cfs_rand();
+		pos = lod_qos_tree_find(tree, good_osts,
+					lod_qos_random(total_weight));
+		idx = cands[pos].lqc_idx;
+		QOS_DEBUG("stripe_cnt=%d nfound=%d weight="LPU64
+			  " total_weight="LPU64"\n", stripe_cnt, nfound,
+			  cands[pos].lqc_weight, total_weight);
 
-#else
-			rand = ((__u64)cfs_rand() << 32 | cfs_rand()) %
-				total_weight;
-#endif
-		} else {
-			rand = 0;
-		}
+		/* do not put >1 objects on a single OST */
+		lod_qos_tree_update(cands, tree, good_osts, pos, 0,
+				    &total_weight);
 
-		/* On average, this will hit larger-weighted osts more often.
-		   0-weight osts will always get used last (only when rand=0) */
-		for (i = 0; i < osts->op_count; i++) {
-			__u32 idx = osts->op_array[i];
+		QOS_DEBUG("stripe=%d to idx=%d\n", nfound, idx);
 
-			if (!cfs_bitmap_check(m->lod_ost_bitmap, idx))
-				continue;
-
-			ost = OST_TGT(m,idx);
-
-			if (!ost->ltd_qos.ltq_usable)
-				continue;
-
-			cur_weight += ost->ltd_qos.ltq_weight;
-			QOS_DEBUG("stripe_cnt=%d nfound=%d cur_weight="LPU64
-				  " rand="LPU64" total_weight="LPU64"\n",
-				  stripe_cnt, nfound, cur_weight, rand,
-				  total_weight);
-
-			if (cur_weight < rand)
-				continue;
-
-			QOS_DEBUG("stripe=%d to idx=%d\n", nfound, idx);
-
-			/*
-			 * do not put >1 objects on a single OST
-			 */
-			if (lod_qos_is_ost_used(env, idx, nfound))
-				continue;
-			lod_qos_ost_in_use(env, nfound, idx);
-
-			o = lod_qos_declare_object_on(env, m, idx, th);
-			if (IS_ERR(o)) {
-				QOS_DEBUG("can't declare object on #%u: %d\n",
-					  idx, (int) PTR_ERR(o));
-				continue;
-			}
-			stripe[nfound++] = o;
-			lod_qos_used(m, osts, idx, &total_weight);
-			rc = 0;
-			break;
+		o = lod_qos_declare_object_on(env, m, idx, th);
+		if (IS_ERR(o)) {
+			QOS_DEBUG("can't declare object on #%u: %d\n",
+				  idx, (int) PTR_ERR(o));
+			continue;
 		}
+		stripe[nfound++] = o;
+		lod_qos_used(m, osts, idx);
+
+		/* The OSS penalty has been raised, re-weight the other
+		 * candidates on the same OSS. The penalties decrease of
+		 * the other OSSs and OSTs will be seen next time. */
+		oss = OST_TGT(m, idx)->ltd_qos.ltq_oss;
+		for (pos = oss->lqo_cand; pos != LOV_QOS_EMPTY;
+		     pos = cands[pos].lqc_next) {
+			if (cands[pos].lqc_weight == 0)
+				continue;
 
-		if (rc) {
-			/* no OST found on this iteration, give up */
-			break;
+			ost = OST_TGT(m, cands[pos].lqc_idx);
+			lod_qos_calc_weight(m, cands[pos].lqc_idx);
+			lod_qos_tree_update(cands, tree, good_osts, pos,
+					    ost->ltd_qos.ltq_weight + 1,
+					    &total_weight);
 		}
 	}
 
+	rc = 0;
+
 	if (unlikely(nfound != stripe_cnt)) {
 		/*
 		 * when the decision to use weighted algorithm was made
@@ -389,6 +389,68 @@ lod_qos_priofree_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(lod_qos_priofree);
 
+/**
+ * Show QoS performance priority parameter.
+ *
+ * The printed value is a percentage value (0-100%) indicating how much the
+ * OST weight is reduced by its recent I/O latency compared with the fastest
+ * OST. 0% means the I/O latency is ignored, 100% means the weight is scaled
+ * down proportionally to the latency, so busy or degraded OSTs get fewer new
+ * objects. The latency is reported by each OST via statfs.
+ *
+ * \param[in] m		seq file
+ * \param[in] v		unused for single entry
+ *
+ * \retval 0		on success
+ * \retval negative	error code if failed
+ */
+static int lod_qos_prioperf_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+	struct lod_device *lod = lu2lod_dev(dev->obd_lu_dev);
+
+	LASSERT(lod != NULL);
+	return seq_printf(m, "%d%%\n",
+			(lod->lod_qos.lq_prio_perf * 100 + 255) >> 8);
+}
+
+/**
+ * Set QoS performance priority parameter.
+ *
+ * See lod_qos_prioperf_seq_show() for description of this parameter.
+ *
+ * \param[in] file	proc file
+ * \param[in] buffer	string which contains the performance priority (0-100)
+ * \param[in] count	@buffer length
+ * \param[in] off	unused for single entry
+ *
+ * \retval @count	on success
+ * \retval negative	error code if failed
+ */
+static ssize_t
+lod_qos_prioperf_seq_write(struct file *file, const char __user *buffer,
+			   size_t count, loff_t *off)
+{
+	struct seq_file   *m = file->private_data;
+	struct obd_device *dev = m->private;
+	struct lod_device *lod;
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	lod = lu2lod_dev(dev->obd_lu_dev);
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > 100)
+		return -EINVAL;
+	lod->lod_qos.lq_prio_perf = (val << 8) / 100;
+	lod->lod_qos.lq_dirty = 1;
+	return count;
+}
+LPROC_SEQ_FOPS(lod_qos_prioperf);
+
 /**
  * Show threshold for "same space on all OSTs" rule.
  *
@@ -727,6 +789,8 @@ static struct lprocfs_vars lprocfs_lod_obd_vars[] = {
 	  .fops	=	&lod_desc_uuid_fops	},
 	{ .name	=	"qos_prio_free",
 	  .fops	=	&lod_qos_priofree_fops	},
+	{ .name	=	"qos_prio_perf",
+	  .fops	=	&lod_qos_prioperf_fops	},
 	{ .name	=	"qos_threshold_rr",
 	  .fops	=	&lod_qos_thresholdrr_fops },
 	{ .name	=	"qos_maxage",
@@ -1962,12 +1962,29 @@ static struct kuc_hdr *changelog_kuc_hdr(char *buf, size_t len, __u32 flags)
 	return lh;
 }
 
+/* With CHANGELOG_FLAG_COLLAPSE, up to this many records are held back so
+ * that a later record of the same type for the same file can replace them */
+#define CHANGELOG_COLLAPSE_WINDOW	1024
+#define CHANGELOG_COLLAPSE_HASH_BITS	8
+
+/* a record held back in the collapse window */
+struct changelog_pending {
+	struct list_head	cp_list;	/* cs_pending, in index order */
+	struct hlist_node	cp_hash;	/* cs_pending_hash */
+	struct kuc_hdr		cp_msg;		/* followed by the record */
+};
+
 struct changelog_show {
 	__u64				 cs_startrec;
 	enum changelog_send_flag	 cs_flags;
 	struct file			*cs_fp;
 	char				*cs_buf;
 	struct obd_device		*cs_obd;
+	struct changelog_filter		 cs_filter;
+	struct list_head		 cs_pending;
+	struct hlist_head		*cs_pending_hash;
+	int				 cs_pending_count;
+	__u64				 cs_collapsed;
 };
 
 static inline char *cs_obd_name(struct changelog_show *cs)
@@ -1975,6 +1992,106 @@ static inline char *cs_obd_name(struct changelog_show *cs)
 	return cs->cs_obd->obd_name;
 }
 
+/* Records describing the latest state of a file rather than an event in
+ * the namespace, so only the last one of a kind matters to a consumer. */
+static bool changelog_rec_collapsible(const struct changelog_rec *rec)
+{
+	switch (rec->cr_type) {
+	case CL_CLOSE:
+	case CL_TRUNC:
+	case CL_SETATTR:
+	case CL_XATTR:
+	case CL_MTIME:
+	case CL_CTIME:
+	case CL_ATIME:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline struct changelog_rec *
+changelog_pending_rec(struct changelog_pending *cp)
+{
+	return (struct changelog_rec *)(&cp->cp_msg + 1);
+}
+
+static void changelog_pending_free(struct changelog_show *cs,
+				   struct changelog_pending *cp)
+{
+	list_del(&cp->cp_list);
+	if (!hlist_unhashed(&cp->cp_hash))
+		hlist_del(&cp->cp_hash);
+	cs->cs_pending_count--;
+	OBD_FREE(cp, offsetof(struct changelog_pending, cp_msg) +
+		 cp->cp_msg.kuc_msglen);
+}
+
+/* Send the oldest held back record to the reader */
+static int changelog_pending_send(struct changelog_show *cs)
+{
+	struct changelog_pending	*cp;
+	int				 rc;
+
+	LASSERT(!list_empty(&cs->cs_pending));
+	cp = list_entry(cs->cs_pending.next, struct changelog_pending,
+			cp_list);
+	rc = libcfs_kkuc_msg_put(cs->cs_fp, &cp->cp_msg);
+	changelog_pending_free(cs, cp);
+
+	return rc;
+}
+
+/*
+ * Queue record \a rec in the collapse window, dropping an older record of
+ * the same type for the same file which it supersedes. The record flags of
+ * the dropped one are merged in, so e.g. SETATTR still reports all changed
+ * attributes. Records go out in index order, so once a consumer has
+ * cleared up to a record, every record it has replaced is covered too.
+ */
+static int changelog_collapse_queue(struct changelog_show *cs,
+				    struct changelog_rec *rec, size_t len)
+{
+	struct changelog_pending	*cp;
+	struct changelog_pending	*old;
+	struct changelog_rec		*new;
+	struct hlist_node		*pos;
+	struct hlist_head		*head;
+
+	OBD_ALLOC(cp, offsetof(struct changelog_pending, cp_msg) + len);
+	if (cp == NULL)
+		return -ENOMEM;
+
+	INIT_HLIST_NODE(&cp->cp_hash);
+	changelog_kuc_hdr((char *)&cp->cp_msg, len, cs->cs_flags);
+	new = changelog_pending_rec(cp);
+	memcpy(new, rec, len - sizeof(cp->cp_msg));
+
+	if (changelog_rec_collapsible(new)) {
+		head = &cs->cs_pending_hash[fid_hash(&new->cr_tfid,
+					     CHANGELOG_COLLAPSE_HASH_BITS)];
+		cfs_hlist_for_each_entry(old, pos, head, cp_hash) {
+			struct changelog_rec *orec = changelog_pending_rec(old);
+
+			if (orec->cr_type != new->cr_type ||
+			    !lu_fid_eq(&orec->cr_tfid, &new->cr_tfid))
+				continue;
+
+			new->cr_flags |= orec->cr_flags & CLF_FLAGMASK;
+			changelog_pending_free(cs, old);
+			cs->cs_collapsed++;
+			break;
+		}
+		hlist_add_head(&cp->cp_hash, head);
+	}
+	list_add_tail(&cp->cp_list, &cs->cs_pending);
+
+	if (++cs->cs_pending_count > CHANGELOG_COLLAPSE_WINDOW)
+		return changelog_pending_send(cs);
+
+	return 0;
+}
+
 static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 			     struct llog_rec_hdr *hdr, void *data)
 {
@@ -2000,6 +2117,13 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 		RETURN(0);
 	}
 
+	/* Drop unwanted records before they are queued to the reader. The
+	 * whole llog chunks are still read from the MDS, so this only saves
+	 * the copies through the kuc pipe and the parsing in user space. */
+	if ((cs->cs_flags & CHANGELOG_FLAG_FILTER) &&
+	    !changelog_filter_match(&cs->cs_filter, &rec->cr))
+		RETURN(0);
+
 	CDEBUG(D_HSM, LPU64" %02d%-5s "LPU64" 0x%x t="DFID" p="DFID" %.*s\n",
 	       rec->cr.cr_index, rec->cr.cr_type,
 	       changelog_type2str(rec->cr.cr_type), rec->cr.cr_time,
@@ -2009,6 +2133,9 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 
 	len = sizeof(*lh) + changelog_rec_size(&rec->cr) + rec->cr.cr_namelen;
 
+	if (cs->cs_flags & CHANGELOG_FLAG_COLLAPSE)
+		RETURN(changelog_collapse_queue(cs, &rec->cr, len));
+
         /* Set up the message */
         lh = changelog_kuc_hdr(cs->cs_buf, len, cs->cs_flags);
         memcpy(lh + 1, &rec->cr, len - sizeof(*lh));
@@ -2035,6 +2162,15 @@ static int mdc_changelog_send_thread(void *csdata)
 	if (cs->cs_buf == NULL)
 		GOTO(out, rc = -ENOMEM);
 
+	INIT_LIST_HEAD(&cs->cs_pending);
+	if (cs->cs_flags & CHANGELOG_FLAG_COLLAPSE) {
+		OBD_ALLOC(cs->cs_pending_hash,
+			  sizeof(struct hlist_head) <<
+			  CHANGELOG_COLLAPSE_HASH_BITS);
+		if (cs->cs_pending_hash == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+
         /* Set up the remote catalog handle */
         ctxt = llog_get_context(cs->cs_obd, LLOG_CHANGELOG_REPL_CTXT);
         if (ctxt == NULL)
@@ -2058,6 +2194,13 @@ static int mdc_changelog_send_thread(void *csdata)
 
 	rc = llog_cat_process(NULL, llh, changelog_kkuc_cb, cs, 0, 0);
 
+	/* Send what is left in the collapse window */
+	while (rc == 0 && !list_empty(&cs->cs_pending))
+		rc = changelog_pending_send(cs);
+	if (cs->cs_collapsed > 0)
+		CDEBUG(D_HSM, "%s: "LPU64" superseded records collapsed\n",
+		       cs_obd_name(cs), cs->cs_collapsed);
+
         /* Send EOF no matter what our result */
         if ((kuch = changelog_kuc_hdr(cs->cs_buf, sizeof(*kuch),
                                       cs->cs_flags))) {
@@ -2073,6 +2216,14 @@ out:
                 llog_ctxt_put(ctxt);
 	if (cs->cs_buf)
 		OBD_FREE(cs->cs_buf, KUC_CHANGELOG_MSG_MAXSIZE);
+	if (cs->cs_pending_hash != NULL) {
+		while (!list_empty(&cs->cs_pending))
+			changelog_pending_free(cs,
+				list_entry(cs->cs_pending.next,
+					   struct changelog_pending, cp_list));
+		OBD_FREE(cs->cs_pending_hash, sizeof(struct hlist_head) <<
+			 CHANGELOG_COLLAPSE_HASH_BITS);
+	}
 	OBD_FREE_PTR(cs);
 	return rc;
 }
@@ -2094,6 +2245,8 @@ static int mdc_ioc_changelog_send(struct obd_device *obd,
 	/* matching fput in mdc_changelog_send_thread */
 	cs->cs_fp = fget(icc->icc_id);
 	cs->cs_flags = icc->icc_flags;
+	if (cs->cs_flags & CHANGELOG_FLAG_FILTER)
+		cs->cs_filter = ((struct ioc_changelog_filter *)icc)->icf_filter;
 
 	/*
 	 * New thread because we should return to user app before
@@ -140,6 +140,9 @@ static int mdd_init0(const struct lu_env *env, struct mdd_device *mdd,
 	mdd->mdd_atime_diff = MAX_ATIME_DIFF;
         /* sync permission changes */
         mdd->mdd_sync_permission = 1;
+	spin_lock_init(&mdd->mdd_split_lock);
+	INIT_LIST_HEAD(&mdd->mdd_split_list);
+	mdd->mdd_split_size = MDD_SPLIT_SIZE_DEF;
 
 	dt_conf_get(env, mdd->mdd_child, &mdd->mdd_dt_conf);
 
@@ -162,6 +165,7 @@ static struct lu_device *mdd_device_fini(const struct lu_env *env,
 		lu_dev_del_linkage(d->ld_site, d);
 
 	mdd_procfs_fini(mdd);
+	mdd_dir_split_fini(mdd);
 	return NULL;
 }
 
@@ -208,57 +212,103 @@ static int changelog_user_init_cb(const struct lu_env *env,
 	return LLOG_PROC_BREAK;
 }
 
+/* changelog records cancelled with one llog header update */
+#define CHANGELOG_CANCEL_BATCH	32
+
+struct changelog_cancel_data {
+	long long		 ccd_endrec;
+	struct llog_handle	*ccd_cathandle;
+	int			 ccd_count;
+	struct llog_cookie	 ccd_cookies[CHANGELOG_CANCEL_BATCH];
+};
+
+static int changelog_cancel_flush(const struct lu_env *env,
+				  struct changelog_cancel_data *ccd)
+{
+	int rc;
+
+	if (ccd->ccd_count == 0)
+		return 0;
+
+	rc = llog_cat_cancel_records(env, ccd->ccd_cathandle, ccd->ccd_count,
+				     ccd->ccd_cookies);
+	ccd->ccd_count = 0;
+
+	return rc < 0 ? rc : 0;
+}
+
 static int llog_changelog_cancel_cb(const struct lu_env *env,
 				    struct llog_handle *llh,
 				    struct llog_rec_hdr *hdr, void *data)
 {
-	struct llog_changelog_rec *rec = (struct llog_changelog_rec *)hdr;
-	struct llog_cookie	 cookie;
-	long long		 endrec = *(long long *)data;
-	int			 rc;
+	struct llog_changelog_rec	*rec = (struct llog_changelog_rec *)hdr;
+	struct changelog_cancel_data	*ccd = data;
+	struct llog_cookie		*cookie;
+	int				 rc;
 
 	ENTRY;
 
 	/* This is always a (sub)log, not the catalog */
 	LASSERT(llh->lgh_hdr->llh_flags & LLOG_F_IS_PLAIN);
 
-	if (rec->cr.cr_index > endrec)
+	if (rec->cr.cr_index > ccd->ccd_endrec) {
 		/* records are in order, so we're done */
-		RETURN(LLOG_PROC_BREAK);
+		rc = changelog_cancel_flush(env, ccd);
+		RETURN(rc < 0 ? rc : LLOG_PROC_BREAK);
+	}
+
+	/* cancel the records of a plain llog in batches, each costs a single
+	 * llog header update */
+	if (ccd->ccd_count > 0 &&
+	    memcmp(&ccd->ccd_cookies[0].lgc_lgl, &llh->lgh_id,
+		   sizeof(llh->lgh_id)) != 0) {
+		rc = changelog_cancel_flush(env, ccd);
+		if (rc < 0)
+			RETURN(rc);
+	}
+
+	cookie = &ccd->ccd_cookies[ccd->ccd_count++];
+	cookie->lgc_lgl = llh->lgh_id;
+	cookie->lgc_index = hdr->lrh_index;
 
-	cookie.lgc_lgl = llh->lgh_id;
-	cookie.lgc_index = hdr->lrh_index;
+	if (ccd->ccd_count < CHANGELOG_CANCEL_BATCH)
+		RETURN(0);
 
-	/* cancel them one at a time.  I suppose we could store up the cookies
-	 * and cancel them all at once; probably more efficient, but this is
-	 * done as a user call, so who cares... */
-	rc = llog_cat_cancel_records(env, llh->u.phd.phd_cat_handle, 1,
-				     &cookie);
-	RETURN(rc < 0 ? rc : 0);
+	RETURN(changelog_cancel_flush(env, ccd));
 }
 
 static int llog_changelog_cancel(const struct lu_env *env,
 				 struct llog_ctxt *ctxt,
 				 struct llog_cookie *cookies, int flags)
 {
-	struct llog_handle	*cathandle = ctxt->loc_handle;
-	int			 rc;
+	struct llog_handle		*cathandle = ctxt->loc_handle;
+	struct changelog_cancel_data	*ccd;
+	int				 rc, rc2;
 
 	ENTRY;
 
 	/* This should only be called with the catalog handle */
 	LASSERT(cathandle->lgh_hdr->llh_flags & LLOG_F_IS_CAT);
 
+	OBD_ALLOC_PTR(ccd);
+	if (ccd == NULL)
+		RETURN(-ENOMEM);
+
+	ccd->ccd_endrec = *(long long *)cookies;
+	ccd->ccd_cathandle = cathandle;
+
 	rc = llog_cat_process(env, cathandle, llog_changelog_cancel_cb,
-			      (void *)cookies, 0, 0);
+			      ccd, 0, 0);
+	rc2 = changelog_cancel_flush(env, ccd);
 	if (rc >= 0)
 		/* 0 or 1 means we're done */
-		rc = 0;
-	else
+		rc = rc2;
+	if (rc < 0)
 		CERROR("%s: cancel idx %u of catalog "DOSTID" rc=%d\n",
 		       ctxt->loc_obd->obd_name, cathandle->lgh_last_idx,
 		       POSTID(&cathandle->lgh_id.lgl_oi), rc);
 
+	OBD_FREE_PTR(ccd);
 	RETURN(rc);
 }
 
@@ -373,6 +423,7 @@ static int mdd_changelog_init(const struct lu_env *env, struct mdd_device *mdd)
 
 	mdd->mdd_cl.mc_index = 0;
 	spin_lock_init(&mdd->mdd_cl.mc_lock);
+	mutex_init(&mdd->mdd_cl.mc_append);
 	mdd->mdd_cl.mc_starttime = cfs_time_current_64();
 	mdd->mdd_cl.mc_flags = 0; /* off by default */
 	mdd->mdd_cl.mc_mask = CHANGELOG_DEFMASK;
@@ -505,6 +556,8 @@ int mdd_changelog_write_header(const struct lu_env *env,
 	struct llog_changelog_rec	*rec;
 	struct lu_buf			*buf;
 	struct llog_ctxt		*ctxt;
+	struct dt_device		*dt;
+	struct thandle			*th;
 	int				 reclen;
 	int				 len = strlen(obd->obd_name);
 	int				 rc;
@@ -532,16 +585,41 @@ int mdd_changelog_write_header(const struct lu_env *env,
 					    rec->cr.cr_namelen);
 	rec->cr_hdr.lrh_type = CHANGELOG_REC;
 	rec->cr.cr_time = cl_time();
-	spin_lock(&mdd->mdd_cl.mc_lock);
-	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
-	spin_unlock(&mdd->mdd_cl.mc_lock);
 
 	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
 	LASSERT(ctxt);
 
-	rc = llog_cat_add(env, ctxt->loc_handle, &rec->cr_hdr, NULL);
+	/* The transaction is started before taking mc_append, which is
+	 * held by mdd_changelog_store() inside the transactions. */
+	dt = lu2dt_dev(ctxt->loc_handle->lgh_obj->do_lu.lo_dev);
+	th = dt_trans_create(env, dt);
+	if (IS_ERR(th))
+		GOTO(out_put, rc = PTR_ERR(th));
+
+	rc = llog_declare_add(env, ctxt->loc_handle, &rec->cr_hdr, th);
+	if (rc != 0)
+		GOTO(out_stop, rc);
+
+	rc = dt_trans_start_local(env, dt, th);
+	if (rc != 0)
+		GOTO(out_stop, rc);
+
+	/* Assign the index and append in order, see mdd_changelog_store(). */
+	mutex_lock(&mdd->mdd_cl.mc_append);
+	spin_lock(&mdd->mdd_cl.mc_lock);
+	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
+	spin_unlock(&mdd->mdd_cl.mc_lock);
+
+	rc = llog_add(env, ctxt->loc_handle, &rec->cr_hdr, NULL, th);
+	mutex_unlock(&mdd->mdd_cl.mc_append);
 	if (rc > 0)
 		rc = 0;
+
+	GOTO(out_stop, rc);
+
+out_stop:
+	dt_trans_stop(env, dt, th);
+out_put:
 	llog_ctxt_put(ctxt);
 
 	/* assume on or off event; reset repeat-access time */
@@ -975,6 +1053,19 @@ out_put:
 static int mdd_lfsck_out_notify(const struct lu_env *env, void *data,
 				enum lfsck_events event)
 {
+	struct mdd_device *mdd = data;
+
+	switch (event) {
+	case LE_DIRTY_TRACK_ON:
+		mdd->mdd_lfsck_tracking = 1;
+		break;
+	case LE_DIRTY_TRACK_OFF:
+		mdd->mdd_lfsck_tracking = 0;
+		break;
+	default:
+		break;
+	}
+
 	return 0;
 }
 
@@ -716,19 +716,23 @@ int mdd_changelog_store(const struct lu_env *env, struct mdd_device *mdd,
 	rec->cr_hdr.lrh_type = CHANGELOG_REC;
 	rec->cr.cr_time = cl_time();
 
-	spin_lock(&mdd->mdd_cl.mc_lock);
-	/* NB: I suppose it's possible llog_add adds out of order wrt cr_index,
-	 * but as long as the MDD transactions are ordered correctly for e.g.
-	 * rename conflicts, I don't think this should matter. */
-	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
-	spin_unlock(&mdd->mdd_cl.mc_lock);
-
 	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
 	if (ctxt == NULL)
 		return -ENXIO;
 
+	/* Assign the index and append under mc_append so that records land
+	 * in the llog in cr_index order: the last record is used to restore
+	 * mc_index at mount, and readers expect increasing indices. The
+	 * append is exclusive on the llog handle anyway, so this does not
+	 * reduce concurrency. No transaction may be started under it. */
+	mutex_lock(&mdd->mdd_cl.mc_append);
+	spin_lock(&mdd->mdd_cl.mc_lock);
+	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
+	spin_unlock(&mdd->mdd_cl.mc_lock);
+
 	/* nested journal transaction */
 	rc = llog_add(env, ctxt->loc_handle, &rec->cr_hdr, NULL, th);
+	mutex_unlock(&mdd->mdd_cl.mc_append);
 	llog_ctxt_put(ctxt);
 	if (rc > 0)
 		rc = 0;
@@ -796,6 +800,12 @@ int mdd_changelog_ns_store(const struct lu_env *env,
 	int				 rc;
 	ENTRY;
 
+	if (target != NULL)
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(target));
+	mdd_lfsck_mark_dirty(env, mdd, tpfid);
+	mdd_lfsck_mark_dirty(env, mdd, sfid);
+	mdd_lfsck_mark_dirty(env, mdd, spfid);
+
 	/* Not recording */
 	if (!(mdd->mdd_cl.mc_flags & CLM_ON))
 		RETURN(0);
@@ -2250,6 +2260,126 @@ unlock:
 	RETURN(rc);
 }
 
+/**
+ * Record \a pobj as a candidate for restriping.
+ *
+ * An already listed directory is refreshed and moved to the head, otherwise
+ * it is added there and the oldest candidate is dropped if the list is full.
+ */
+static void mdd_dir_split_add(struct mdd_device *mdd, struct mdd_object *pobj,
+			      __u32 rate, __u64 size)
+{
+	struct mdd_dir_split	*split;
+	struct mdd_dir_split	*new = NULL;
+	bool			 found = false;
+
+	OBD_ALLOC_PTR(new);
+
+	spin_lock(&mdd->mdd_split_lock);
+	list_for_each_entry(split, &mdd->mdd_split_list, mds_list) {
+		if (lu_fid_eq(&split->mds_fid, mdo2fid(pobj))) {
+			found = true;
+			break;
+		}
+	}
+
+	if (!found) {
+		if (new == NULL) {
+			spin_unlock(&mdd->mdd_split_lock);
+			return;
+		}
+
+		split = new;
+		new = NULL;
+		split->mds_fid = *mdo2fid(pobj);
+		mdd->mdd_split_count++;
+		if (mdd->mdd_split_count > MDD_SPLIT_MAX) {
+			struct mdd_dir_split *old;
+
+			old = list_entry(mdd->mdd_split_list.prev,
+					 struct mdd_dir_split, mds_list);
+			list_del(&old->mds_list);
+			mdd->mdd_split_count--;
+			new = old;
+		}
+	} else {
+		list_del(&split->mds_list);
+	}
+
+	split->mds_rate = rate;
+	split->mds_size = size;
+	split->mds_time = cfs_time_current_sec();
+	list_add(&split->mds_list, &mdd->mdd_split_list);
+	spin_unlock(&mdd->mdd_split_lock);
+
+	if (new != NULL)
+		OBD_FREE_PTR(new);
+
+	if (!found)
+		CWARN("%s: directory "DFID" gets %u creates/s with size "LPU64
+		      ", consider striping it over more MDTs\n",
+		      mdd2obd_dev(mdd)->obd_name, PFID(mdo2fid(pobj)),
+		      rate, size);
+}
+
+void mdd_dir_split_fini(struct mdd_device *mdd)
+{
+	struct mdd_dir_split *split;
+	struct mdd_dir_split *next;
+
+	spin_lock(&mdd->mdd_split_lock);
+	list_for_each_entry_safe(split, next, &mdd->mdd_split_list, mds_list) {
+		list_del(&split->mds_list);
+		OBD_FREE_PTR(split);
+	}
+	mdd->mdd_split_count = 0;
+	spin_unlock(&mdd->mdd_split_lock);
+}
+
+/**
+ * Account a create in directory \a pobj.
+ *
+ * The creates are counted per directory and averaged over windows of at
+ * least MDD_SPLIT_WINDOW seconds. A directory larger than mdd_split_size
+ * that is created into faster than mdd_split_rate is the bottleneck of
+ * this MDT and is reported for restriping, see mdd_dir_split_add(). The
+ * accounting is lockless, concurrent creates may close the same window
+ * only once so that the rate is merely approximate.
+ *
+ * \param[in] mdd	MDD device
+ * \param[in] pobj	parent directory of the new object
+ * \param[in] pattr	attributes of \a pobj
+ */
+static void mdd_dir_split_check(struct mdd_device *mdd,
+				struct mdd_object *pobj,
+				const struct lu_attr *pattr)
+{
+	unsigned long	now;
+	unsigned long	start;
+	__u32		rate;
+	int		count;
+
+	if (mdd->mdd_split_rate == 0)
+		return;
+
+	count = atomic_inc_return(&pobj->mod_create_count);
+	now = cfs_time_current_sec();
+	start = pobj->mod_create_time;
+	if (start != 0 && now < start + MDD_SPLIT_WINDOW)
+		return;
+
+	if (cmpxchg(&pobj->mod_create_time, start, now) != start)
+		return;
+
+	atomic_sub(count, &pobj->mod_create_count);
+	if (start == 0)
+		return;
+
+	rate = count / (now - start);
+	if (rate >= mdd->mdd_split_rate && pattr->la_size >= mdd->mdd_split_size)
+		mdd_dir_split_add(mdd, pobj, rate, pattr->la_size);
+}
+
 /*
  * Create object and insert it into namespace.
  */
@@ -2440,6 +2570,8 @@ out_stop:
 	rc2 = mdd_trans_stop(env, mdd, rc, handle);
 	if (rc == 0)
 		rc = rc2;
+	if (rc == 0 && likely((spec->sp_cr_flags & MDS_OPEN_VOLATILE) == 0))
+		mdd_dir_split_check(mdd, mdd_pobj, pattr);
 out_free:
 	if (ldata->ld_buf && ldata->ld_buf->lb_len > OBD_ALLOC_BIG)
 		/* if we vmalloced a large buffer drop it */
@@ -3656,6 +3788,13 @@ static int mdd_migrate_entries(const struct lu_env *env,
 
 		rc = mdd_linkea_update_child(env, mdd_tobj, child, name,
 					     strlen(name), handle);
+		if (rc != 0)
+			GOTO(out_put, rc);
+
+		/* The migration does not go through the changelog. */
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(child));
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_sobj));
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_tobj));
 
 out_put:
 		mdd_object_put(env, child);
@@ -3892,6 +4031,11 @@ static int mdd_migrate_update_name(const struct lu_env *env,
 	if (rc != 0)
 		GOTO(out_unlock, rc);
 
+	/* The migration does not go through the changelog. */
+	mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_pobj));
+	mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_sobj));
+	mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_tobj));
+
 out_unlock:
 	mdd_write_unlock(env, mdd_sobj);
 
@@ -67,6 +67,7 @@
 
 struct mdd_changelog {
 	spinlock_t		mc_lock;	/* for index */
+	struct mutex		mc_append;	/* keeps llog in index order */
 	int			mc_flags;
 	int			mc_mask;
 	__u64			mc_index;
@@ -111,11 +112,36 @@ struct mdd_device {
         struct mdd_object               *mdd_dot_lustre;
         struct mdd_dot_lustre_objs       mdd_dot_lustre_objs;
 	unsigned int			 mdd_sync_permission;
+	/* set by the LFSCK when it records the modified objects */
+	unsigned int			 mdd_lfsck_tracking;
 	int				 mdd_connects;
 	struct local_oid_storage	*mdd_los;
 	struct mdd_generic_thread	 mdd_orph_cleanup_thread;
+	/* directories whose create rate crossed the split thresholds */
+	spinlock_t			 mdd_split_lock;
+	struct list_head		 mdd_split_list;
+	int				 mdd_split_count;
+	/* creates per second and directory size (bytes) thresholds,
+	 * zero mdd_split_rate disables the tracking */
+	__u32				 mdd_split_rate;
+	__u64				 mdd_split_size;
 };
 
+/* A directory reported as a candidate for restriping. */
+struct mdd_dir_split {
+	struct list_head	mds_list;
+	struct lu_fid		mds_fid;
+	__u64			mds_size;
+	__u32			mds_rate;
+	time_t			mds_time;
+};
+
+/* creates are averaged over at least this many seconds */
+#define MDD_SPLIT_WINDOW	5
+/* at most this many candidates are kept, the oldest one is dropped */
+#define MDD_SPLIT_MAX		64
+#define MDD_SPLIT_SIZE_DEF	(1ULL << 20)
+
 enum mod_flags {
 	/* The dir object has been unlinked */
 	DEAD_OBJ   = 1 << 0,
@@ -129,6 +155,9 @@ struct mdd_object {
         __u32             mod_valid;
         __u64             mod_cltime;
         unsigned long     mod_flags;
+	/* creates in this directory since mod_create_time */
+	atomic_t	  mod_create_count;
+	unsigned long	  mod_create_time;
 };
 
 struct mdd_thread_info {
@@ -218,6 +247,8 @@ int mdd_finish_unlink(const struct lu_env *env, struct mdd_object *obj,
 		      struct md_attr *ma, const struct mdd_object *pobj,
 		      const struct lu_name *lname, struct thandle *th);
 
+void mdd_dir_split_fini(struct mdd_device *mdd);
+
 int mdd_is_root(struct mdd_device *mdd, const struct lu_fid *fid);
 int mdd_lookup(const struct lu_env *env,
                struct md_object *pobj, const struct lu_name *lname,
@@ -414,6 +445,16 @@ static inline struct dt_object* mdd_object_child(struct mdd_object *o)
                              struct dt_object, do_lu);
 }
 
+/* Record the modified object for the incremental LFSCK, it is done
+ * whether the changelog is on or not. */
+static inline void mdd_lfsck_mark_dirty(const struct lu_env *env,
+					struct mdd_device *mdd,
+					const struct lu_fid *fid)
+{
+	if (fid != NULL && mdd->mdd_lfsck_tracking)
+		lfsck_mark_dirty(env, mdd->mdd_bottom, fid);
+}
+
 static inline struct obd_device *mdd2obd_dev(struct mdd_device *mdd)
 {
 	return (mdd->mdd_md_dev.md_lu_dev.ld_obd);
@@ -203,6 +203,93 @@ mdd_sync_perm_seq_write(struct file *file, const char *buffer,
 }
 LPROC_SEQ_FOPS(mdd_sync_perm);
 
+static int mdd_dir_split_rate_seq_show(struct seq_file *m, void *data)
+{
+	struct mdd_device *mdd = m->private;
+
+	LASSERT(mdd != NULL);
+	return seq_printf(m, "%u\n", mdd->mdd_split_rate);
+}
+
+static ssize_t
+mdd_dir_split_rate_seq_write(struct file *file, const char *buffer,
+			     size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct mdd_device	*mdd = m->private;
+	int			 val;
+	int			 rc;
+
+	LASSERT(mdd != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	mdd->mdd_split_rate = val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdd_dir_split_rate);
+
+static int mdd_dir_split_size_seq_show(struct seq_file *m, void *data)
+{
+	struct mdd_device *mdd = m->private;
+
+	LASSERT(mdd != NULL);
+	return seq_printf(m, LPU64"\n", mdd->mdd_split_size);
+}
+
+static ssize_t
+mdd_dir_split_size_seq_write(struct file *file, const char *buffer,
+			     size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct mdd_device	*mdd = m->private;
+	__u64			 val;
+	int			 rc;
+
+	LASSERT(mdd != NULL);
+	rc = lprocfs_write_u64_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	mdd->mdd_split_size = val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdd_dir_split_size);
+
+static int mdd_dir_split_candidates_seq_show(struct seq_file *m, void *data)
+{
+	struct mdd_device	*mdd = m->private;
+	struct mdd_dir_split	*split;
+
+	LASSERT(mdd != NULL);
+	spin_lock(&mdd->mdd_split_lock);
+	list_for_each_entry(split, &mdd->mdd_split_list, mds_list)
+		seq_printf(m, DFID" rate=%u size="LPU64" time=%lu\n",
+			   PFID(&split->mds_fid), split->mds_rate,
+			   split->mds_size, (unsigned long)split->mds_time);
+	spin_unlock(&mdd->mdd_split_lock);
+
+	return 0;
+}
+
+/* Any write forgets the reported directories. */
+static ssize_t
+mdd_dir_split_candidates_seq_write(struct file *file, const char *buffer,
+				   size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct mdd_device	*mdd = m->private;
+
+	LASSERT(mdd != NULL);
+	mdd_dir_split_fini(mdd);
+	return count;
+}
+LPROC_SEQ_FOPS(mdd_dir_split_candidates);
+
 static int mdd_lfsck_speed_limit_seq_show(struct seq_file *m, void *data)
 {
 	struct mdd_device *mdd = m->private;
@@ -285,6 +372,12 @@ static struct lprocfs_vars lprocfs_mdd_obd_vars[] = {
 	  .fops =	&mdd_changelog_users_fops	},
 	{ .name =	"sync_permission",
 	  .fops =	&mdd_sync_perm_fops		},
+	{ .name =	"dir_split_rate",
+	  .fops =	&mdd_dir_split_rate_fops	},
+	{ .name =	"dir_split_size",
+	  .fops =	&mdd_dir_split_size_fops	},
+	{ .name =	"dir_split_candidates",
+	  .fops =	&mdd_dir_split_candidates_fops	},
 	{ .name =	"lfsck_speed_limit",
 	  .fops =	&mdd_lfsck_speed_limit_fops	},
 	{ .name =	"lfsck_async_windows",
@@ -137,6 +137,8 @@ static int mdd_object_init(const struct lu_env *env, struct lu_object *o,
         ENTRY;
 
         mdd_obj->mod_cltime = 0;
+	atomic_set(&mdd_obj->mod_create_count, 0);
+	mdd_obj->mod_create_time = 0;
         under = &d->mdd_child->dd_lu_dev;
         below = under->ld_ops->ldo_object_alloc(env, o->lo_header, under);
 	if (IS_ERR(below))
@@ -657,6 +659,11 @@ int mdd_changelog_data_store(const struct lu_env *env, struct mdd_device *mdd,
 	int				 reclen;
 	int				 rc;
 
+	/* The time and open/close changes do not matter for the LFSCK. */
+	if ((type < CL_MTIME || type > CL_ATIME) &&
+	    type != CL_OPEN && type != CL_CLOSE)
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(mdd_obj));
+
         /* Not recording */
         if (!(mdd->mdd_cl.mc_flags & CLM_ON))
                 RETURN(0);
@@ -748,6 +755,10 @@ static int mdd_attr_set_changelog(const struct lu_env *env,
         struct mdd_device *mdd = mdo2mdd(obj);
         int bits, type = 0;
 
+	/* The changelog mask below does not matter for the LFSCK. */
+	if (valid & ~(LA_CTIME | LA_MTIME | LA_ATIME))
+		mdd_lfsck_mark_dirty(env, mdd, mdo2fid(md2mdd_obj(obj)));
+
 	bits =  (valid & LA_SIZE)  ? 1 << CL_TRUNC : 0;
 	bits |= (valid & ~(LA_CTIME|LA_MTIME|LA_ATIME)) ? 1 << CL_SETATTR : 0;
         bits |= (valid & LA_MTIME) ? 1 << CL_MTIME : 0;
@@ -147,34 +147,30 @@ struct hsm_scan_data {
 };
 
 /**
- *  llog_cat_process() callback, used to:
+ *  cdt_actions_process() callback, used to:
  *  - find waiting request and start action
- *  - purge canceled and done requests
+ *  - cancel timeouted running requests
  * \param env [IN] environment
- * \param llh [IN] llog handle
- * \param hdr [IN] llog record
+ * \param mdt [IN] MDT device
+ * \param larr [IN] action record
  * \param data [IN/OUT] cb data = struct hsm_scan_data
  * \retval 0 success
  * \retval -ve failure
  */
 static int mdt_coordinator_cb(const struct lu_env *env,
-			      struct llog_handle *llh,
-			      struct llog_rec_hdr *hdr,
+			      struct mdt_device *mdt,
+			      struct llog_agent_req_rec *larr,
 			      void *data)
 {
-	const struct llog_agent_req_rec	*larr;
 	struct hsm_scan_data		*hsd;
 	struct hsm_action_item		*hai;
-	struct mdt_device		*mdt;
 	struct coordinator		*cdt;
 	int				 rc;
 	ENTRY;
 
 	hsd = data;
-	mdt = hsd->mti->mti_mdt;
 	cdt = &mdt->mdt_coordinator;
 
-	larr = (struct llog_agent_req_rec *)hdr;
 	dump_llog_agent_req_rec("mdt_coordinator_cb(): ", larr);
 	switch (larr->arr_status) {
 	case ARS_WAITING: {
@@ -377,12 +373,7 @@ static int mdt_coordinator_cb(const struct lu_env *env,
 		}
 		break;
 	}
-	case ARS_FAILED:
-	case ARS_CANCELED:
-	case ARS_SUCCEED:
-		if ((larr->arr_req_change + cdt->cdt_grace_delay) <
-		    cfs_time_current_sec())
-			RETURN(LLOG_DEL_RECORD);
+	default:
 		break;
 	}
 	RETURN(0);
@@ -535,11 +526,22 @@ static int mdt_coordinator(void *data)
 		}
 		hsd.request_cnt = 0;
 
-		rc = cdt_llog_process(mti->mti_env, mdt,
-				      mdt_coordinator_cb, &hsd);
+		/* restores and cancels are queued first, so they get the
+		 * free request slots before archives and removes */
+		rc = cdt_actions_process(mti->mti_env, mdt,
+					 (1 << CDT_AQ_URGENT) |
+					 (1 << CDT_AQ_WAITING) |
+					 (1 << CDT_AQ_STARTED),
+					 mdt_coordinator_cb, &hsd);
 		if (rc < 0)
 			goto clean_cb_alloc;
 
+		/* purge canceled and done requests */
+		rc = cdt_actions_purge(mti->mti_env, mdt);
+		if (rc < 0)
+			CERROR("%s: cannot purge old HSM actions, rc = %d\n",
+			       mdt_obd_name(mdt), rc);
+
 		CDEBUG(D_HSM, "Found %d requests to send and %d"
 			      " requests to cancel\n",
 		       hsd.request_cnt, hsd.cookie_cnt);
@@ -978,6 +980,14 @@ int mdt_hsm_cdt_start(struct mdt_device *mdt)
 
 	/* set up list of started restore requests */
 	cdt_mti = lu_context_key_get(&cdt->cdt_env.le_ctx, &mdt_thread_key);
+
+	/* keep the actions in memory, without them the coordinator still
+	 * works by scanning the llog */
+	rc = cdt_actions_load(cdt_mti->mti_env, mdt);
+	if (rc)
+		CWARN("%s: HSM actions will be read from the llog: rc = %d\n",
+		      mdt_obd_name(mdt), rc);
+
 	rc = mdt_hsm_pending_restore(cdt_mti);
 	if (rc)
 		CERROR("%s: cannot take the layout locks needed"
@@ -987,6 +997,7 @@ int mdt_hsm_cdt_start(struct mdt_device *mdt)
 	task = kthread_run(mdt_coordinator, cdt_mti, "hsm_cdtr");
 	if (IS_ERR(task)) {
 		rc = PTR_ERR(task);
+		cdt_actions_fini(mdt);
 		cdt->cdt_state = CDT_STOPPED;
 		CERROR("%s: error starting coordinator thread: %d\n",
 		       mdt_obd_name(mdt), rc);
@@ -1065,6 +1076,8 @@ int mdt_hsm_cdt_stop(struct mdt_device *mdt)
 	}
 	mutex_unlock(&cdt->cdt_restore_lock);
 
+	cdt_actions_fini(mdt);
+
 	mdt->mdt_opts.mo_coordinator = 0;
 
 	RETURN(0);
@@ -1699,10 +1712,12 @@ static int hsm_cancel_all_actions(struct mdt_device *mdt)
 		OBD_FREE(hal, hal_sz);
 
 	/* cancel all on-disk records */
-	hcad.mdt = mdt;
-
-	rc = cdt_llog_process(mti->mti_env, mti->mti_mdt,
-			      mdt_cancel_all_cb, &hcad);
+	rc = cdt_actions_cancel_all(mti->mti_env, mdt);
+	if (rc == -ENOENT) {
+		hcad.mdt = mdt;
+		rc = cdt_llog_process(mti->mti_env, mti->mti_mdt,
+				      mdt_cancel_all_cb, &hcad);
+	}
 out:
 	/* enable coordinator */
 	cdt->cdt_state = save_state;
@@ -2204,6 +2219,49 @@ mdt_hsm_other_request_mask_seq_write(struct file *file, const char __user *buf,
 					   &cdt->cdt_other_request_mask);
 }
 
+static int mdt_hsm_action_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct mdt_device	*mdt = m->private;
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	int			 i;
+	ENTRY;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cdt->cdt_actions_loaded) {
+		mutex_unlock(&cdt->cdt_llog_lock);
+		seq_printf(m, "actions: not loaded\n");
+		RETURN(0);
+	}
+
+	seq_printf(m, "waiting_urgent: %d\nwaiting: %d\nstarted: %d\n"
+		   "done: %d\n", cdt->cdt_actions_count[CDT_AQ_URGENT],
+		   cdt->cdt_actions_count[CDT_AQ_WAITING],
+		   cdt->cdt_actions_count[CDT_AQ_STARTED],
+		   cdt->cdt_actions_count[CDT_AQ_DONE]);
+
+	for (i = 0; i < CDT_ACTION_STATS_NR; i++) {
+		struct cdt_action_stats	*cas = &cdt->cdt_action_stats[i];
+		__u64			 wait_avg = cas->cas_wait_sum;
+		__u64			 run_avg = cas->cas_run_sum;
+
+		if (cas->cas_dispatched != 0)
+			do_div(wait_avg, cas->cas_dispatched);
+		if (cas->cas_completed != 0)
+			do_div(run_avg, cas->cas_completed);
+
+		seq_printf(m, "%s: dispatched="LPU64" wait_avg="LPU64
+			   " wait_max="LPU64" completed="LPU64" run_avg="
+			   LPU64" run_max="LPU64"\n",
+			   hsm_copytool_action2name(i + HSMA_ARCHIVE),
+			   cas->cas_dispatched, wait_avg, cas->cas_wait_max,
+			   cas->cas_completed, run_avg, cas->cas_run_max);
+	}
+	mutex_unlock(&cdt->cdt_llog_lock);
+
+	RETURN(0);
+}
+LPROC_SEQ_FOPS_RO(mdt_hsm_action_stats);
+
 LPROC_SEQ_FOPS(mdt_hsm_cdt_loop_period);
 LPROC_SEQ_FOPS(mdt_hsm_cdt_grace_delay);
 LPROC_SEQ_FOPS(mdt_hsm_cdt_active_req_timeout);
@@ -2219,6 +2277,9 @@ static struct lprocfs_vars lprocfs_mdt_hsm_vars[] = {
 	{ .name	=	"actions",
 	  .fops	=	&mdt_hsm_actions_fops,
 	  .proc_mode =	0444					},
+	{ .name	=	"action_stats",
+	  .fops	=	&mdt_hsm_action_stats_fops,
+	  .proc_mode =	0444					},
 	{ .name	=	"default_archive_id",
 	  .fops	=	&mdt_hsm_cdt_default_archive_id_fops	},
 	{ .name	=	"grace_delay",
@@ -111,6 +111,419 @@ int cdt_llog_process(const struct lu_env *env, struct mdt_device *mdt,
 	RETURN(rc);
 }
 
+/*
+ * In-memory action store
+ *
+ * While the coordinator runs, every record of the hsm_actions llog has a
+ * copy in a struct cdt_action, queued by state and hashed by cookie and by
+ * FID. The llog is then only written: records are appended, rewritten when
+ * their status changes and cancelled through their saved location, so the
+ * coordinator loop and the status updates never have to scan it again.
+ * The store is protected by cdt_llog_lock. When it is not loaded (the
+ * coordinator is stopped or the load failed) the llog is scanned as before.
+ *
+ * A status change appends the new record before the old one is cancelled,
+ * and the old records of a batch are only cancelled together at the end of
+ * it. A crash in between leaves two records of the same request, the old
+ * status and the new one. The new record is always later in the llog, so
+ * cdt_actions_load() keeps it and cancels the older ones.
+ */
+#define CDT_ACTION_HASH_BITS	12
+#define CDT_ACTION_HASH_SIZE	(1 << CDT_ACTION_HASH_BITS)
+
+static inline struct list_head *
+cdt_action_cookie_head(struct coordinator *cdt, __u64 cookie)
+{
+	return &cdt->cdt_action_cookie_hash[hash_long((unsigned long)cookie,
+						      CDT_ACTION_HASH_BITS)];
+}
+
+static inline struct list_head *
+cdt_action_fid_head(struct coordinator *cdt, const struct lu_fid *fid)
+{
+	return &cdt->cdt_action_fid_hash[fid_hash(fid, CDT_ACTION_HASH_BITS)];
+}
+
+/**
+ * queue of a record, restores and cancels are served before other
+ * waiting requests because an application is blocked on them
+ */
+static enum cdt_action_queue
+cdt_action_queue(const struct llog_agent_req_rec *larr)
+{
+	if (agent_req_in_final_state(larr->arr_status))
+		return CDT_AQ_DONE;
+	if (larr->arr_status == ARS_STARTED)
+		return CDT_AQ_STARTED;
+	if (larr->arr_hai.hai_action == HSMA_RESTORE ||
+	    larr->arr_hai.hai_action == HSMA_CANCEL)
+		return CDT_AQ_URGENT;
+	return CDT_AQ_WAITING;
+}
+
+static struct cdt_action_stats *
+cdt_action_stats(struct coordinator *cdt,
+		 const struct llog_agent_req_rec *larr)
+{
+	__u32	action = larr->arr_hai.hai_action;
+
+	if (action < HSMA_ARCHIVE || action > HSMA_CANCEL)
+		return NULL;
+	return &cdt->cdt_action_stats[action - HSMA_ARCHIVE];
+}
+
+/**
+ * add a copy of a record to the store
+ *  cdt_llog_lock must be hold
+ * \param cdt [IN] coordinator
+ * \param larr [IN] record
+ * \param lcookie [IN] record location in the llog
+ * \retval 0 success
+ * \retval -ve failure
+ */
+static int cdt_action_insert(struct coordinator *cdt,
+			     const struct llog_agent_req_rec *larr,
+			     const struct llog_cookie *lcookie)
+{
+	struct cdt_action	*ca;
+
+	OBD_ALLOC_PTR(ca);
+	if (ca == NULL)
+		return -ENOMEM;
+
+	OBD_ALLOC(ca->ca_larr, larr->arr_hdr.lrh_len);
+	if (ca->ca_larr == NULL) {
+		OBD_FREE_PTR(ca);
+		return -ENOMEM;
+	}
+	memcpy(ca->ca_larr, larr, larr->arr_hdr.lrh_len);
+	ca->ca_larr->arr_hdr.lrh_index = lcookie->lgc_index;
+	ca->ca_lcookie = *lcookie;
+
+	/* chains are kept in llog order, so the last record of a cookie
+	 * or of a FID is also the last one on its chain */
+	ca->ca_queue = cdt_action_queue(larr);
+	list_add_tail(&ca->ca_list, &cdt->cdt_actions[ca->ca_queue]);
+	cdt->cdt_actions_count[ca->ca_queue]++;
+	list_add_tail(&ca->ca_cookie_hash,
+		      cdt_action_cookie_head(cdt, larr->arr_hai.hai_cookie));
+	list_add_tail(&ca->ca_fid_hash,
+		      cdt_action_fid_head(cdt, &larr->arr_hai.hai_fid));
+	return 0;
+}
+
+static void cdt_action_unlink(struct coordinator *cdt, struct cdt_action *ca)
+{
+	cdt->cdt_actions_count[ca->ca_queue]--;
+	list_del(&ca->ca_list);
+	list_del(&ca->ca_cookie_hash);
+	list_del(&ca->ca_fid_hash);
+}
+
+static void __cdt_action_free(struct cdt_action *ca)
+{
+	OBD_FREE(ca->ca_larr, ca->ca_larr->arr_hdr.lrh_len);
+	OBD_FREE_PTR(ca);
+}
+
+static void cdt_action_free(struct coordinator *cdt, struct cdt_action *ca)
+{
+	cdt_action_unlink(cdt, ca);
+	__cdt_action_free(ca);
+}
+
+/* cdt_llog_lock must be hold */
+static void cdt_actions_free_all(struct coordinator *cdt)
+{
+	struct cdt_action	*ca, *tmp;
+	int			 i;
+
+	cdt->cdt_actions_loaded = false;
+	if (cdt->cdt_action_cookie_hash != NULL) {
+		for (i = 0; i < CDT_AQ_NR; i++)
+			list_for_each_entry_safe(ca, tmp, &cdt->cdt_actions[i],
+						 ca_list)
+				cdt_action_free(cdt, ca);
+		OBD_FREE_LARGE(cdt->cdt_action_cookie_hash,
+			       CDT_ACTION_HASH_SIZE * sizeof(struct list_head));
+		cdt->cdt_action_cookie_hash = NULL;
+	}
+	if (cdt->cdt_action_fid_hash != NULL) {
+		OBD_FREE_LARGE(cdt->cdt_action_fid_hash,
+			       CDT_ACTION_HASH_SIZE * sizeof(struct list_head));
+		cdt->cdt_action_fid_hash = NULL;
+	}
+}
+
+struct cdt_actions_load_data {
+	struct coordinator	*cald_cdt;
+	/* older records of a request, left by a crash during a batch */
+	struct list_head	 cald_stale;
+	int			 cald_stale_count;
+};
+
+/**
+ *  llog_cat_process() callback, used to load a record in the store
+ */
+static int cdt_actions_load_cb(const struct lu_env *env,
+			       struct llog_handle *llh,
+			       struct llog_rec_hdr *hdr, void *data)
+{
+	struct cdt_actions_load_data	*cald = data;
+	struct coordinator		*cdt = cald->cald_cdt;
+	struct llog_agent_req_rec	*larr = (struct llog_agent_req_rec *)hdr;
+	struct cdt_action		*ca;
+	struct llog_cookie		 lcookie;
+
+	/* a cancel request has the cookie of the request it cancels, so
+	 * only a record of the same action is a former copy of this one */
+	list_for_each_entry(ca, cdt_action_cookie_head(cdt,
+						larr->arr_hai.hai_cookie),
+			    ca_cookie_hash) {
+		if (ca->ca_larr->arr_hai.hai_cookie ==
+		    larr->arr_hai.hai_cookie &&
+		    ca->ca_larr->arr_hai.hai_action ==
+		    larr->arr_hai.hai_action) {
+			cdt_action_unlink(cdt, ca);
+			list_add_tail(&ca->ca_list, &cald->cald_stale);
+			cald->cald_stale_count++;
+			break;
+		}
+	}
+
+	memset(&lcookie, 0, sizeof(lcookie));
+	lcookie.lgc_lgl = llh->lgh_id;
+	lcookie.lgc_index = hdr->lrh_index;
+	return cdt_action_insert(cdt, larr, &lcookie);
+}
+
+/**
+ * cancel the stale records found by cdt_actions_load_cb(), after the llog
+ * has been processed
+ */
+static void cdt_actions_load_stale(const struct lu_env *env,
+				   struct mdt_device *mdt,
+				   struct llog_handle *cathandle,
+				   struct cdt_actions_load_data *cald)
+{
+	struct cdt_action	*ca, *tmp;
+	int			 rc;
+
+	if (cald->cald_stale_count > 0)
+		CDEBUG(D_HSM, "%s: cancel %d records superseded before a "
+		       "crash\n", mdt_obd_name(mdt), cald->cald_stale_count);
+
+	list_for_each_entry_safe(ca, tmp, &cald->cald_stale, ca_list) {
+		rc = llog_cat_cancel_records(env, cathandle, 1,
+					     &ca->ca_lcookie);
+		if (rc < 0 && rc != -ENOENT)
+			CERROR("%s: cannot cancel stale record of cookie "
+			       LPX64", rc = %d\n", mdt_obd_name(mdt),
+			       ca->ca_larr->arr_hai.hai_cookie, rc);
+		list_del(&ca->ca_list);
+		__cdt_action_free(ca);
+	}
+	cald->cald_stale_count = 0;
+}
+
+/**
+ * load the actions llog in the store, done once at coordinator start
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -ve failure, the llog is then scanned as before
+ */
+int cdt_actions_load(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device		*obd = mdt2obd_dev(mdt);
+	struct coordinator		*cdt = &mdt->mdt_coordinator;
+	struct cdt_actions_load_data	 cald;
+	struct llog_ctxt		*lctxt;
+	int				 i, rc;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		RETURN(-ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	cald.cald_cdt = cdt;
+	INIT_LIST_HEAD(&cald.cald_stale);
+	cald.cald_stale_count = 0;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	cdt_actions_free_all(cdt);
+
+	for (i = 0; i < CDT_AQ_NR; i++) {
+		INIT_LIST_HEAD(&cdt->cdt_actions[i]);
+		cdt->cdt_actions_count[i] = 0;
+	}
+	memset(cdt->cdt_action_stats, 0, sizeof(cdt->cdt_action_stats));
+
+	OBD_ALLOC_LARGE(cdt->cdt_action_cookie_hash,
+			CDT_ACTION_HASH_SIZE * sizeof(struct list_head));
+	OBD_ALLOC_LARGE(cdt->cdt_action_fid_hash,
+			CDT_ACTION_HASH_SIZE * sizeof(struct list_head));
+	if (cdt->cdt_action_cookie_hash == NULL ||
+	    cdt->cdt_action_fid_hash == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < CDT_ACTION_HASH_SIZE; i++) {
+		INIT_LIST_HEAD(&cdt->cdt_action_cookie_hash[i]);
+		INIT_LIST_HEAD(&cdt->cdt_action_fid_hash[i]);
+	}
+
+	rc = llog_cat_process(env, lctxt->loc_handle, cdt_actions_load_cb,
+			      &cald, 0, 0);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	cdt_actions_load_stale(env, mdt, lctxt->loc_handle, &cald);
+
+	cdt->cdt_actions_loaded = true;
+	CDEBUG(D_HSM, "%s: %d waiting, %d started and %d done requests "
+	       "loaded\n", mdt_obd_name(mdt),
+	       cdt->cdt_actions_count[CDT_AQ_URGENT] +
+	       cdt->cdt_actions_count[CDT_AQ_WAITING],
+	       cdt->cdt_actions_count[CDT_AQ_STARTED],
+	       cdt->cdt_actions_count[CDT_AQ_DONE]);
+	rc = 0;
+out:
+	if (rc < 0) {
+		struct cdt_action *ca, *tmp;
+
+		CERROR("%s: cannot load HSM_ACTIONS llog in memory, rc = %d\n",
+		       mdt_obd_name(mdt), rc);
+		/* the stale records are left in the llog, the next load will
+		 * find them again */
+		list_for_each_entry_safe(ca, tmp, &cald.cald_stale, ca_list) {
+			list_del(&ca->ca_list);
+			__cdt_action_free(ca);
+		}
+		cdt_actions_free_all(cdt);
+	}
+	mutex_unlock(&cdt->cdt_llog_lock);
+out_ctxt:
+	llog_ctxt_put(lctxt);
+	RETURN(rc);
+}
+
+/**
+ * free the store, done at coordinator stop
+ * \param mdt [IN] MDT device
+ */
+void cdt_actions_fini(struct mdt_device *mdt)
+{
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	cdt_actions_free_all(cdt);
+	mutex_unlock(&cdt->cdt_llog_lock);
+}
+
+/**
+ * find the record to update for a cookie, with the same rules as
+ * mdt_agent_record_update_cb()
+ *  cdt_llog_lock must be hold
+ */
+static struct cdt_action *cdt_action_find(struct coordinator *cdt,
+					  __u64 cookie,
+					  enum agent_req_status status)
+{
+	struct cdt_action		*ca;
+	struct llog_agent_req_rec	*larr;
+
+	list_for_each_entry(ca, cdt_action_cookie_head(cdt, cookie),
+			    ca_cookie_hash) {
+		larr = ca->ca_larr;
+		if (larr->arr_hai.hai_cookie != cookie)
+			continue;
+		if (agent_req_in_final_state(larr->arr_status) ||
+		    (larr->arr_hai.hai_action == HSMA_CANCEL &&
+		     status == ARS_CANCELED))
+			continue;
+		return ca;
+	}
+	return NULL;
+}
+
+/**
+ * change the status of an action, the record is written again at the end
+ * of the llog and the location of the old one is returned to be cancelled
+ *  cdt_llog_lock must be hold
+ * \param env [IN] environment
+ * \param cdt [IN] coordinator
+ * \param cathandle [IN] actions llog catalog
+ * \param ca [IN] action
+ * \param status [IN] new status
+ * \param change [IN] change time
+ * \param old [OUT] location of the old record
+ * \retval 0 success
+ * \retval -ve failure, the action is unchanged
+ */
+static int cdt_action_set_status(const struct lu_env *env,
+				 struct coordinator *cdt,
+				 struct llog_handle *cathandle,
+				 struct cdt_action *ca,
+				 enum agent_req_status status,
+				 cfs_time_t change, struct llog_cookie *old)
+{
+	struct llog_agent_req_rec	*larr = ca->ca_larr;
+	struct llog_rec_hdr		 saved_hdr = larr->arr_hdr;
+	enum agent_req_status		 old_status = larr->arr_status;
+	cfs_time_t			 old_change = larr->arr_req_change;
+	struct cdt_action_stats		*cas;
+	struct llog_cookie		 lcookie;
+	enum cdt_action_queue		 queue;
+	int				 rc;
+
+	larr->arr_status = status;
+	larr->arr_req_change = change;
+	larr->arr_hdr.lrh_id = 0;
+	larr->arr_hdr.lrh_index = 0;
+	rc = llog_cat_add(env, cathandle, &larr->arr_hdr, &lcookie);
+	larr->arr_hdr = saved_hdr;
+	if (rc < 0) {
+		larr->arr_status = old_status;
+		larr->arr_req_change = old_change;
+		return rc;
+	}
+	*old = ca->ca_lcookie;
+	ca->ca_lcookie = lcookie;
+	larr->arr_hdr.lrh_index = lcookie.lgc_index;
+
+	cas = cdt_action_stats(cdt, larr);
+	if (cas != NULL && old_status == ARS_WAITING &&
+	    status == ARS_STARTED) {
+		__u64 wait = change - larr->arr_req_create;
+
+		cas->cas_dispatched++;
+		cas->cas_wait_sum += wait;
+		if (wait > cas->cas_wait_max)
+			cas->cas_wait_max = wait;
+	} else if (cas != NULL && old_status == ARS_STARTED &&
+		   agent_req_in_final_state(status)) {
+		__u64 run = change - old_change;
+
+		cas->cas_completed++;
+		cas->cas_run_sum += run;
+		if (run > cas->cas_run_max)
+			cas->cas_run_max = run;
+	}
+
+	queue = cdt_action_queue(larr);
+	cdt->cdt_actions_count[ca->ca_queue]--;
+	cdt->cdt_actions_count[queue]++;
+	ca->ca_queue = queue;
+	list_move_tail(&ca->ca_list, &cdt->cdt_actions[queue]);
+	list_move_tail(&ca->ca_cookie_hash,
+		       cdt_action_cookie_head(cdt, larr->arr_hai.hai_cookie));
+	list_move_tail(&ca->ca_fid_hash,
+		       cdt_action_fid_head(cdt, &larr->arr_hai.hai_fid));
+	return 0;
+}
+
 /**
  * add an entry in agent llog
  * \param env [IN] environment
@@ -130,6 +543,7 @@ int mdt_agent_record_add(const struct lu_env *env,
 	struct coordinator		*cdt = &mdt->mdt_coordinator;
 	struct llog_ctxt		*lctxt = NULL;
 	struct llog_agent_req_rec	*larr;
+	struct llog_cookie		 lcookie;
 	int				 rc;
 	int				 sz;
 	ENTRY;
@@ -162,10 +576,19 @@ int mdt_agent_record_add(const struct lu_env *env,
 		hai->hai_cookie = cdt->cdt_last_cookie;
 	}
 	larr->arr_hai.hai_cookie = hai->hai_cookie;
-	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, NULL);
+	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, &lcookie);
 	if (rc > 0)
 		rc = 0;
 
+	if (rc == 0 && cdt->cdt_actions_loaded &&
+	    cdt_action_insert(cdt, larr, &lcookie) != 0) {
+		/* the record is safe in the llog, go back to scanning it */
+		CERROR("%s: cannot add cookie "LPX64" to the in-memory "
+		       "actions, use the llog\n", mdt_obd_name(mdt),
+		       hai->hai_cookie);
+		cdt_actions_free_all(cdt);
+	}
+
 	mutex_unlock(&cdt->cdt_llog_lock);
 	llog_ctxt_put(lctxt);
 
@@ -255,6 +678,89 @@ static int mdt_agent_record_update_cb(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * update entries of the in-memory store and journal them in agent llog
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param cookies [IN] entries to update
+ * \param cookies_count [IN] number of cookies
+ * \param status [IN] new status of the request
+ * \retval 0 success
+ * \retval -ENOENT store not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+static int cdt_actions_update(const struct lu_env *env, struct mdt_device *mdt,
+			      __u64 *cookies, int cookies_count,
+			      enum agent_req_status status)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
+	struct llog_cookie	*old;
+	cfs_time_t		 change = cfs_time_current_sec();
+	int			 i, rc = 0, rc2, done = 0;
+	ENTRY;
+
+	if (!cdt->cdt_actions_loaded)
+		RETURN(-ENOENT);
+	if (cookies_count == 0)
+		RETURN(0);
+
+	OBD_ALLOC_LARGE(old, cookies_count * sizeof(*old));
+	if (old == NULL)
+		RETURN(-ENOMEM);
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		GOTO(out_free, rc = -ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cdt->cdt_actions_loaded)
+		GOTO(out_unlock, rc = -ENOENT);
+
+	for (i = 0; i < cookies_count; i++) {
+		struct cdt_action *ca;
+
+		ca = cdt_action_find(cdt, cookies[i], status);
+		if (ca == NULL) {
+			CDEBUG(D_HSM, "%s: no record to set to %s for cookie "
+			       LPX64"\n", mdt_obd_name(mdt),
+			       agent_req_status2name(status), cookies[i]);
+			continue;
+		}
+
+		rc2 = cdt_action_set_status(env, cdt, lctxt->loc_handle, ca,
+					    status, change, &old[done]);
+		if (rc2 < 0) {
+			CERROR("%s: cannot set cookie "LPX64" to %s, rc = %d\n",
+			       mdt_obd_name(mdt), cookies[i],
+			       agent_req_status2name(status), rc2);
+			rc = rc2;
+			continue;
+		}
+		done++;
+	}
+
+	/* the old records are dropped with one header write per llog */
+	if (done > 0) {
+		rc2 = llog_cat_cancel_records(env, lctxt->loc_handle, done,
+					      old);
+		if (rc2 < 0 && rc2 != -ENOENT && rc == 0)
+			rc = rc2;
+	}
+
+	EXIT;
+out_unlock:
+	mutex_unlock(&cdt->cdt_llog_lock);
+out_ctxt:
+	llog_ctxt_put(lctxt);
+out_free:
+	OBD_FREE_LARGE(old, cookies_count * sizeof(*old));
+	return rc;
+}
+
 /**
  * update an entry in agent llog
  * \param env [IN] environment
@@ -273,6 +779,10 @@ int mdt_agent_record_update(const struct lu_env *env, struct mdt_device *mdt,
 	int			 rc;
 	ENTRY;
 
+	rc = cdt_actions_update(env, mdt, cookies, cookies_count, status);
+	if (rc != -ENOENT)
+		RETURN(rc);
+
 	ducb.mdt = mdt;
 	ducb.cookies = cookies;
 	ducb.cookies_count = cookies_count;
@@ -319,6 +829,348 @@ int mdt_agent_llog_update_rec(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * apply the return code of a cdt_action_cb_t on an action
+ *  cdt_llog_lock must be hold
+ */
+static int cdt_action_cb_done(const struct lu_env *env,
+			      struct coordinator *cdt,
+			      struct llog_handle *cathandle,
+			      struct cdt_action *ca, int rc)
+{
+	if (rc != LLOG_DEL_RECORD)
+		return rc;
+
+	rc = llog_cat_cancel_records(env, cathandle, 1, &ca->ca_lcookie);
+	if (rc < 0 && rc != -ENOENT)
+		CERROR("%s: cannot cancel record of cookie "LPX64", rc = %d\n",
+		       cathandle->lgh_ctxt->loc_obd->obd_name,
+		       ca->ca_larr->arr_hai.hai_cookie, rc);
+	cdt_action_free(cdt, ca);
+	return 0;
+}
+
+/**
+ * data passed to llog_cat_process() callback
+ * to walk the llog when the store is not loaded
+ */
+struct cdt_actions_llog_data {
+	struct mdt_device	*cald_mdt;
+	unsigned int		 cald_queues;
+	cdt_action_cb_t		 cald_cb;
+	void			*cald_data;
+};
+
+static int cdt_actions_llog_cb(const struct lu_env *env,
+			       struct llog_handle *llh,
+			       struct llog_rec_hdr *hdr, void *data)
+{
+	struct cdt_actions_llog_data	*cald = data;
+	struct llog_agent_req_rec	*larr;
+
+	larr = (struct llog_agent_req_rec *)hdr;
+	if (!(cald->cald_queues & (1 << cdt_action_queue(larr))))
+		return 0;
+	return cald->cald_cb(env, cald->cald_mdt, larr, cald->cald_data);
+}
+
+/**
+ * walk the actions of some queues, urgent ones first
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param queues [IN] mask of (1 << CDT_AQ_XXX) to walk
+ * \param cb [IN] callback
+ * \param data [IN] callback data
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_actions_process(const struct lu_env *env, struct mdt_device *mdt,
+			unsigned int queues, cdt_action_cb_t cb, void *data)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
+	struct cdt_action	*ca, *tmp;
+	int			 i, rc = 0;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		RETURN(-ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+
+	if (!cdt->cdt_actions_loaded) {
+		struct cdt_actions_llog_data cald = {
+			.cald_mdt	= mdt,
+			.cald_queues	= queues,
+			.cald_cb	= cb,
+			.cald_data	= data,
+		};
+
+		rc = llog_cat_process(env, lctxt->loc_handle,
+				      cdt_actions_llog_cb, &cald, 0, 0);
+	} else {
+		for (i = 0; i < CDT_AQ_NR && rc == 0; i++) {
+			if (!(queues & (1 << i)))
+				continue;
+
+			list_for_each_entry_safe(ca, tmp, &cdt->cdt_actions[i],
+						 ca_list) {
+				rc = cb(env, mdt, ca->ca_larr, data);
+				rc = cdt_action_cb_done(env, cdt,
+							lctxt->loc_handle,
+							ca, rc);
+				if (rc != 0)
+					break;
+			}
+		}
+	}
+
+	if (rc < 0)
+		CERROR("%s: failed to process HSM actions (rc=%d)\n",
+		       mdt_obd_name(mdt), rc);
+	else
+		rc = 0;
+
+	mutex_unlock(&cdt->cdt_llog_lock);
+	EXIT;
+out_ctxt:
+	llog_ctxt_put(lctxt);
+	return rc;
+}
+
+/**
+ * walk the actions on a FID, in llog order
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param fid [IN] FID
+ * \param cb [IN] callback
+ * \param data [IN] callback data
+ * \retval 0 success
+ * \retval -ENOENT store not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+int cdt_actions_fid_process(const struct lu_env *env, struct mdt_device *mdt,
+			    const struct lu_fid *fid, cdt_action_cb_t cb,
+			    void *data)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
+	struct cdt_action	*ca, *tmp;
+	int			 rc = 0;
+	ENTRY;
+
+	if (!cdt->cdt_actions_loaded)
+		RETURN(-ENOENT);
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		RETURN(-ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cdt->cdt_actions_loaded)
+		GOTO(out_unlock, rc = -ENOENT);
+
+	list_for_each_entry_safe(ca, tmp, cdt_action_fid_head(cdt, fid),
+				 ca_fid_hash) {
+		if (!lu_fid_eq(&ca->ca_larr->arr_hai.hai_fid, fid))
+			continue;
+
+		rc = cb(env, mdt, ca->ca_larr, data);
+		rc = cdt_action_cb_done(env, cdt, lctxt->loc_handle, ca, rc);
+		if (rc != 0)
+			break;
+	}
+	if (rc > 0)
+		rc = 0;
+
+	EXIT;
+out_unlock:
+	mutex_unlock(&cdt->cdt_llog_lock);
+out_ctxt:
+	llog_ctxt_put(lctxt);
+	return rc;
+}
+
+/**
+ *  llog_cat_process() callback, used to remove old records in final state
+ *  when the store is not loaded
+ */
+static int cdt_actions_purge_cb(const struct lu_env *env,
+				struct llog_handle *llh,
+				struct llog_rec_hdr *hdr, void *data)
+{
+	struct llog_agent_req_rec	*larr;
+	struct coordinator		*cdt = data;
+
+	larr = (struct llog_agent_req_rec *)hdr;
+	if (agent_req_in_final_state(larr->arr_status) &&
+	    (larr->arr_req_change + cdt->cdt_grace_delay) <
+	    cfs_time_current_sec())
+		return LLOG_DEL_RECORD;
+	return 0;
+}
+
+/* records cancelled with one llog_cat_cancel_records() call by purges */
+#define CDT_ACTIONS_CANCEL_BATCH	64
+
+/**
+ * remove records in final state for more than cdt_grace_delay
+ * the done queue is in change time order, so only expired entries are
+ * walked
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_actions_purge(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
+	struct llog_cookie	*cookies = NULL;
+	struct cdt_action	*ca, *tmp;
+	cfs_time_t		 now = cfs_time_current_sec();
+	int			 rc = 0, rc2, n = 0;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		RETURN(-ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+
+	if (!cdt->cdt_actions_loaded) {
+		rc = llog_cat_process(env, lctxt->loc_handle,
+				      cdt_actions_purge_cb, cdt, 0, 0);
+		if (rc > 0)
+			rc = 0;
+		GOTO(out_unlock, rc);
+	}
+
+	list_for_each_entry_safe(ca, tmp, &cdt->cdt_actions[CDT_AQ_DONE],
+				 ca_list) {
+		if ((ca->ca_larr->arr_req_change + cdt->cdt_grace_delay) >=
+		    now)
+			break;
+
+		if (cookies == NULL) {
+			OBD_ALLOC(cookies, CDT_ACTIONS_CANCEL_BATCH *
+					   sizeof(*cookies));
+			if (cookies == NULL)
+				GOTO(out_unlock, rc = -ENOMEM);
+		}
+
+		cookies[n++] = ca->ca_lcookie;
+		cdt_action_free(cdt, ca);
+		if (n == CDT_ACTIONS_CANCEL_BATCH) {
+			rc2 = llog_cat_cancel_records(env, lctxt->loc_handle,
+						      n, cookies);
+			if (rc2 < 0 && rc2 != -ENOENT && rc == 0)
+				rc = rc2;
+			n = 0;
+		}
+	}
+	if (n > 0) {
+		rc2 = llog_cat_cancel_records(env, lctxt->loc_handle, n,
+					      cookies);
+		if (rc2 < 0 && rc2 != -ENOENT && rc == 0)
+			rc = rc2;
+	}
+
+	EXIT;
+out_unlock:
+	mutex_unlock(&cdt->cdt_llog_lock);
+	if (cookies != NULL)
+		OBD_FREE(cookies, CDT_ACTIONS_CANCEL_BATCH * sizeof(*cookies));
+out_ctxt:
+	llog_ctxt_put(lctxt);
+	return rc;
+}
+
+/**
+ * set all waiting and started actions to canceled
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -ENOENT store not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+int cdt_actions_cancel_all(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
+	struct llog_cookie	*cookies;
+	struct cdt_action	*ca, *tmp;
+	cfs_time_t		 now = cfs_time_current_sec();
+	int			 i, rc = 0, rc2, n = 0;
+	ENTRY;
+
+	if (!cdt->cdt_actions_loaded)
+		RETURN(-ENOENT);
+
+	OBD_ALLOC(cookies, CDT_ACTIONS_CANCEL_BATCH * sizeof(*cookies));
+	if (cookies == NULL)
+		RETURN(-ENOMEM);
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL)
+		GOTO(out_free, rc = -ENOENT);
+	if (lctxt->loc_handle == NULL)
+		GOTO(out_ctxt, rc = -ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cdt->cdt_actions_loaded)
+		GOTO(out_unlock, rc = -ENOENT);
+
+	for (i = CDT_AQ_URGENT; i <= CDT_AQ_STARTED; i++) {
+		list_for_each_entry_safe(ca, tmp, &cdt->cdt_actions[i],
+					 ca_list) {
+			rc2 = cdt_action_set_status(env, cdt,
+						    lctxt->loc_handle, ca,
+						    ARS_CANCELED, now,
+						    &cookies[n]);
+			if (rc2 < 0) {
+				if (rc == 0)
+					rc = rc2;
+				continue;
+			}
+			if (++n < CDT_ACTIONS_CANCEL_BATCH)
+				continue;
+
+			rc2 = llog_cat_cancel_records(env, lctxt->loc_handle,
+						      n, cookies);
+			if (rc2 < 0 && rc2 != -ENOENT && rc == 0)
+				rc = rc2;
+			n = 0;
+		}
+	}
+	if (n > 0) {
+		rc2 = llog_cat_cancel_records(env, lctxt->loc_handle, n,
+					      cookies);
+		if (rc2 < 0 && rc2 != -ENOENT && rc == 0)
+			rc = rc2;
+	}
+
+	EXIT;
+out_unlock:
+	mutex_unlock(&cdt->cdt_llog_lock);
+out_ctxt:
+	llog_ctxt_put(lctxt);
+out_free:
+	OBD_FREE(cookies, CDT_ACTIONS_CANCEL_BATCH * sizeof(*cookies));
+	return rc;
+}
+
 /*
  * Agent actions /proc seq_file methods
  * As llog processing uses a callback for each entry, we cannot do a sequential
@@ -54,26 +54,24 @@ struct hsm_compat_data_cb {
 };
 
 /**
- * llog_cat_process() callback, used to find record
+ * cdt_actions_fid_process() callback, used to find record
  * compatibles with a new hsm_action_list
  * \param env [IN] environment
- * \param llh [IN] llog handle
- * \param hdr [IN] llog record
+ * \param mdt [IN] MDT device
+ * \param larr [IN] action record
  * \param data [IN] cb data = hsm_compat_data_cb
  * \retval 0 success
  * \retval -ve failure
  */
-static int hsm_find_compatible_cb(const struct lu_env *env,
-				  struct llog_handle *llh,
-				  struct llog_rec_hdr *hdr, void *data)
+static int hsm_find_compatible_rec(const struct lu_env *env,
+				   struct mdt_device *mdt,
+				   struct llog_agent_req_rec *larr, void *data)
 {
-	struct llog_agent_req_rec	*larr;
 	struct hsm_compat_data_cb	*hcdcb;
 	struct hsm_action_item		*hai;
 	int				 i;
 	ENTRY;
 
-	larr = (struct llog_agent_req_rec *)hdr;
 	hcdcb = data;
 	/* a compatible request must be WAITING or STARTED
 	 * and not a cancel */
@@ -117,6 +115,19 @@ static int hsm_find_compatible_cb(const struct lu_env *env,
 	RETURN(0);
 }
 
+/**
+ * llog_cat_process() callback, used to find record
+ * compatibles with a new hsm_action_list when the coordinator
+ * actions are not in memory
+ */
+static int hsm_find_compatible_cb(const struct lu_env *env,
+				  struct llog_handle *llh,
+				  struct llog_rec_hdr *hdr, void *data)
+{
+	return hsm_find_compatible_rec(env, NULL,
+				       (struct llog_agent_req_rec *)hdr, data);
+}
+
 /**
  * find compatible requests already recorded
  * \param env [IN] environment
@@ -155,7 +166,18 @@ static int hsm_find_compatible(const struct lu_env *env, struct mdt_device *mdt,
 	hcdcb.cdt = &mdt->mdt_coordinator;
 	hcdcb.hal = hal;
 
-	rc = cdt_llog_process(env, mdt, hsm_find_compatible_cb, &hcdcb);
+	/* only the records on the FIDs of the request are looked at */
+	rc = 0;
+	hai = hai_first(hal);
+	for (i = 0; i < hal->hal_count && rc == 0; i++, hai = hai_next(hai)) {
+		if (hai->hai_action == HSMA_CANCEL && hai->hai_cookie != 0)
+			continue;
+		rc = cdt_actions_fid_process(env, mdt, &hai->hai_fid,
+					     hsm_find_compatible_rec, &hcdcb);
+	}
+	if (rc == -ENOENT)
+		rc = cdt_llog_process(env, mdt, hsm_find_compatible_cb,
+				      &hcdcb);
 
 	RETURN(rc);
 }
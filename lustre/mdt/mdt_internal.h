@@ -109,6 +109,28 @@ enum cdt_states { CDT_STOPPED = 0,
 		  CDT_DISABLE,
 		  CDT_STOPPING };
 
+/* queues of the in-memory action store, see mdt_hsm_cdt_actions.c */
+enum cdt_action_queue {
+	CDT_AQ_URGENT = 0,	/**< waiting restores and cancels */
+	CDT_AQ_WAITING,		/**< other waiting requests */
+	CDT_AQ_STARTED,		/**< requests sent to an agent */
+	CDT_AQ_DONE,		/**< requests in a final state */
+	CDT_AQ_NR
+};
+
+/* latency of the requests of one action type */
+struct cdt_action_stats {
+	__u64	cas_dispatched;	/**< requests sent to an agent */
+	__u64	cas_wait_sum;	/**< seconds waited before being sent */
+	__u64	cas_wait_max;
+	__u64	cas_completed;	/**< requests which reached a final state */
+	__u64	cas_run_sum;	/**< seconds between sent and final state */
+	__u64	cas_run_max;
+};
+
+/* per-action statistics, indexed by hsm_copytool_action - HSMA_ARCHIVE */
+#define CDT_ACTION_STATS_NR	(HSMA_CANCEL - HSMA_ARCHIVE + 1)
+
 /* when multiple lock are needed, the lock order is
  * cdt_llog_lock
  * cdt_agent_lock
@@ -152,6 +174,15 @@ struct coordinator {
 						       * agents */
 	struct list_head	 cdt_restore_hdl;     /**< list of restore lock
 						       * handles */
+	/* in-memory copy of the hsm_actions llog, protected by
+	 * cdt_llog_lock and only valid while cdt_actions_loaded is set */
+	bool			 cdt_actions_loaded;
+	struct list_head	 cdt_actions[CDT_AQ_NR]; /**< actions by
+							 * state */
+	int			 cdt_actions_count[CDT_AQ_NR];
+	struct list_head	*cdt_action_cookie_hash; /**< by cookie */
+	struct list_head	*cdt_action_fid_hash;	 /**< by FID */
+	struct cdt_action_stats	 cdt_action_stats[CDT_ACTION_STATS_NR];
 	/* Bitmasks indexed by the HSMA_XXX constants. */
 	__u64			 cdt_user_request_mask;
 	__u64			 cdt_group_request_mask;
@@ -528,6 +559,22 @@ struct cdt_restore_handle {
 };
 extern struct kmem_cache *mdt_hsm_cdt_kmem;	/** restore handle slab cache */
 
+/* in-memory copy of one hsm_actions llog record */
+struct cdt_action {
+	struct list_head		 ca_list;	/**< state queue */
+	struct list_head		 ca_cookie_hash; /**< cookie hash chain */
+	struct list_head		 ca_fid_hash;	/**< FID hash chain */
+	struct llog_cookie		 ca_lcookie;	/**< record location */
+	enum cdt_action_queue		 ca_queue;	/**< queue holding it */
+	struct llog_agent_req_rec	*ca_larr;	/**< record copy */
+};
+
+/* callback used to walk the action store, can return LLOG_DEL_RECORD
+ * to drop the action or LLOG_PROC_BREAK to stop the walk */
+typedef int (*cdt_action_cb_t)(const struct lu_env *env,
+			       struct mdt_device *mdt,
+			       struct llog_agent_req_rec *larr, void *data);
+
 static inline const struct md_device_operations *
 mdt_child_ops(struct mdt_device * m)
 {
@@ -863,6 +910,15 @@ int mdt_agent_record_update(const struct lu_env *env,
 int mdt_agent_llog_update_rec(const struct lu_env *env, struct mdt_device *mdt,
 			      struct llog_handle *llh,
 			      struct llog_agent_req_rec *larr);
+int cdt_actions_load(const struct lu_env *env, struct mdt_device *mdt);
+void cdt_actions_fini(struct mdt_device *mdt);
+int cdt_actions_process(const struct lu_env *env, struct mdt_device *mdt,
+			unsigned int queues, cdt_action_cb_t cb, void *data);
+int cdt_actions_fid_process(const struct lu_env *env, struct mdt_device *mdt,
+			    const struct lu_fid *fid, cdt_action_cb_t cb,
+			    void *data);
+int cdt_actions_purge(const struct lu_env *env, struct mdt_device *mdt);
+int cdt_actions_cancel_all(const struct lu_env *env, struct mdt_device *mdt);
 
 /* mdt/mdt_hsm_cdt_agent.c */
 extern const struct file_operations mdt_hsm_agent_fops;
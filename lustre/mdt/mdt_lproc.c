@@ -480,6 +480,33 @@ static int mdt_site_stats_seq_show(struct seq_file *m, void *data)
 }
 LPROC_SEQ_FOPS_RO(mdt_site_stats);
 
+static int mdt_site_lookup_hist_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return lu_site_lookup_hist_seq_print(mdt_lu_site(mdt), m);
+}
+
+static ssize_t
+mdt_site_lookup_hist_seq_write(struct file *file, const char __user *buffer,
+			       size_t count, loff_t *off)
+{
+	struct seq_file   *m = file->private_data;
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	int		   val;
+	int		   rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	lu_site_lookup_hist_enable(mdt_lu_site(mdt), val != 0);
+	return count;
+}
+LPROC_SEQ_FOPS(mdt_site_lookup_hist);
+
 static int mdt_capa_timeout_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
@@ -852,6 +879,8 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 	  .fops =	&mdt_capa_count_fops			},
 	{ .name =	"site_stats",
 	  .fops =	&mdt_site_stats_fops			},
+	{ .name =	"site_lookup_hist",
+	  .fops =	&mdt_site_lookup_hist_fops		},
 	{ .name =	"evict_client",
 	  .fops =	&mdt_mds_evict_client_fops		},
 	{ .name =	"hash_stats",
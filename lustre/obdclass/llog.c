@@ -105,31 +105,60 @@ void llog_handle_put(struct llog_handle *loghandle)
 		llog_free_handle(loghandle);
 }
 
-/* returns negative on error; 0 if success; 1 if success & log destroyed */
-int llog_cancel_rec(const struct lu_env *env, struct llog_handle *loghandle,
-		    int index)
+/**
+ * Cancel several records of one llog at once.
+ *
+ * All bits are cleared in memory first, then the llog header is written a
+ * single time, so cancelling a batch of records costs one header update
+ * instead of one per record.
+ *
+ * \param[in] env	execution environment
+ * \param[in] loghandle	llog handle
+ * \param[in] num	number of records to cancel
+ * \param[in,out] index	indices of the records; those already cancelled
+ *			are reset to 0
+ *
+ * \retval LLOG_DEL_PLAIN	if the llog became empty and was destroyed
+ * \retval 0		on success
+ * \retval -ENOENT	if none of the records was set
+ * \retval negative	on error, no record is cancelled then
+ */
+int llog_cancel_arr_rec(const struct lu_env *env,
+			struct llog_handle *loghandle, int num, int *index)
 {
-        struct llog_log_hdr *llh = loghandle->lgh_hdr;
-        int rc = 0;
-        ENTRY;
+	struct llog_log_hdr	*llh = loghandle->lgh_hdr;
+	int			 cleared = 0;
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
 
-        CDEBUG(D_RPCTRACE, "Canceling %d in log "DOSTID"\n",
-               index, POSTID(&loghandle->lgh_id.lgl_oi));
+	for (i = 0; i < num; i++) {
+		if (index[i] == 0) {
+			CERROR("Can't cancel index 0 which is header\n");
+			RETURN(-EINVAL);
+		}
+	}
 
-        if (index == 0) {
-                CERROR("Can't cancel index 0 which is header\n");
-                RETURN(-EINVAL);
-        }
+	CDEBUG(D_RPCTRACE, "Canceling %d records from %d in log "DOSTID"\n",
+	       num, index[0], POSTID(&loghandle->lgh_id.lgl_oi));
 
 	spin_lock(&loghandle->lgh_hdr_lock);
-	if (!ext2_clear_bit(index, llh->llh_bitmap)) {
+	for (i = 0; i < num; i++) {
+		if (!ext2_clear_bit(index[i], llh->llh_bitmap)) {
+			CDEBUG(D_RPCTRACE, "Catalog index %u already clear?\n",
+			       index[i]);
+			index[i] = 0;
+			continue;
+		}
+		llh->llh_count--;
+		cleared++;
+	}
+
+	if (cleared == 0) {
 		spin_unlock(&loghandle->lgh_hdr_lock);
-		CDEBUG(D_RPCTRACE, "Catalog index %u already clear?\n", index);
 		RETURN(-ENOENT);
 	}
 
-	llh->llh_count--;
-
 	if ((llh->llh_flags & LLOG_F_ZAP_WHEN_EMPTY) &&
 	    (llh->llh_count == 1) &&
 	    (loghandle->lgh_last_idx == (LLOG_BITMAP_BYTES * 8) - 1)) {
@@ -159,12 +188,23 @@ int llog_cancel_rec(const struct lu_env *env, struct llog_handle *loghandle,
 	RETURN(0);
 out_err:
 	spin_lock(&loghandle->lgh_hdr_lock);
-	ext2_set_bit(index, llh->llh_bitmap);
-	llh->llh_count++;
+	for (i = 0; i < num; i++) {
+		if (index[i] == 0)
+			continue;
+		ext2_set_bit(index[i], llh->llh_bitmap);
+		llh->llh_count++;
+	}
 	spin_unlock(&loghandle->lgh_hdr_lock);
 	return rc;
 }
 
+/* returns negative on error; 0 if success; 1 if success & log destroyed */
+int llog_cancel_rec(const struct lu_env *env, struct llog_handle *loghandle,
+		    int index)
+{
+	return llog_cancel_arr_rec(env, loghandle, 1, &index);
+}
+
 static int llog_read_header(const struct lu_env *env,
 			    struct llog_handle *handle,
 			    struct obd_uuid *uuid)
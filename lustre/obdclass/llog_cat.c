@@ -457,12 +457,24 @@ out_trans:
 }
 EXPORT_SYMBOL(llog_cat_add);
 
+/* Most cookies passed together belong to the same plain llog: up to this
+ * many consecutive ones are cancelled with a single llog header update */
+#define LLOG_CAT_CANCEL_BATCH	32
+
+static inline bool llog_cat_same_log(const struct llog_logid *a,
+				     const struct llog_logid *b)
+{
+	return ostid_id(&a->lgl_oi) == ostid_id(&b->lgl_oi) &&
+	       ostid_seq(&a->lgl_oi) == ostid_seq(&b->lgl_oi) &&
+	       a->lgl_ogen == b->lgl_ogen;
+}
+
 /* For each cookie in the cookie array, we clear the log in-use bit and either:
  * - the log is empty, so mark it free in the catalog header and delete it
  * - the log is not empty, just write out the log header
  *
  * The cookies may be in different log files, so we need to get new logs
- * each time.
+ * each time. Runs of cookies for the same log are cancelled together.
  *
  * Assumes caller has already pushed us into the kernel context.
  */
@@ -470,25 +482,31 @@ int llog_cat_cancel_records(const struct lu_env *env,
 			    struct llog_handle *cathandle, int count,
 			    struct llog_cookie *cookies)
 {
-	int i, index, rc = 0, failed = 0;
+	int	idx[LLOG_CAT_CANCEL_BATCH];
+	int	i, n, index, rc = 0, failed = 0;
 
 	ENTRY;
 
-	for (i = 0; i < count; i++, cookies++) {
+	for (i = 0; i < count; i += n) {
 		struct llog_handle	*loghandle;
-		struct llog_logid	*lgl = &cookies->lgc_lgl;
+		struct llog_logid	*lgl = &cookies[i].lgc_lgl;
 		int			 lrc;
 
+		for (n = 0; n < LLOG_CAT_CANCEL_BATCH && i + n < count &&
+			    llog_cat_same_log(&cookies[i + n].lgc_lgl, lgl);
+		     n++)
+			idx[n] = cookies[i + n].lgc_index;
+
 		rc = llog_cat_id2handle(env, cathandle, &loghandle, lgl);
 		if (rc) {
 			CERROR("%s: cannot find handle for llog "DOSTID": %d\n",
 			       cathandle->lgh_ctxt->loc_obd->obd_name,
 			       POSTID(&lgl->lgl_oi), rc);
-			failed++;
+			failed += n;
 			continue;
 		}
 
-		lrc = llog_cancel_rec(env, loghandle, cookies->lgc_index);
+		lrc = llog_cancel_arr_rec(env, loghandle, n, idx);
 		if (lrc == LLOG_DEL_PLAIN) { /* log has been destroyed */
 			index = loghandle->u.phd.phd_cookie.lgc_index;
 			rc = llog_cat_cleanup(env, cathandle, loghandle,
@@ -497,7 +515,7 @@ int llog_cat_cancel_records(const struct lu_env *env,
 			if (rc == 0) /* ENOENT shouldn't rewrite any error */
 				rc = lrc;
 		} else if (lrc < 0) {
-			failed++;
+			failed += n;
 			rc = lrc;
 		}
 		llog_handle_put(loghandle);
@@ -311,6 +311,50 @@ static int llog_osd_declare_write_rec(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Write the parts of the llog header changed by adding or removing record
+ * \a index: the fixed header fields (llh_count), the bitmap word holding
+ * bit \a index and the header tail. This avoids rewriting the whole
+ * LLOG_CHUNK_SIZE header for every appended record.
+ *
+ * \param[in] env	execution environment
+ * \param[in] o	llog object
+ * \param[in] llh	in-memory llog header
+ * \param[in] index	index of the record whose bit has changed
+ * \param[in] th	current transaction handle
+ *
+ * \retval		0 on successful write
+ * \retval		negative error if write failed
+ */
+static int llog_osd_write_hdr_bits(const struct lu_env *env,
+				   struct dt_object *o,
+				   struct llog_log_hdr *llh, int index,
+				   struct thandle *th)
+{
+	struct llog_thread_info	*lgi = llog_info(env);
+	__u32			*word = &llh->llh_bitmap[index / 32];
+	int			 rc;
+
+	lgi->lgi_off = 0;
+	lgi->lgi_buf.lb_len = offsetof(struct llog_log_hdr, llh_bitmap);
+	lgi->lgi_buf.lb_buf = &llh->llh_hdr;
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		return rc;
+
+	lgi->lgi_off = (char *)word - (char *)llh;
+	lgi->lgi_buf.lb_len = sizeof(*word);
+	lgi->lgi_buf.lb_buf = word;
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		return rc;
+
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_tail);
+	lgi->lgi_buf.lb_len = sizeof(llh->llh_tail);
+	lgi->lgi_buf.lb_buf = &llh->llh_tail;
+	return dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+}
+
 /**
  * Implementation of the llog_operations::lop_write
  *
@@ -347,6 +391,7 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	struct llog_rec_tail	*lrt;
 	struct dt_object	*o;
 	size_t			 left;
+	loff_t			 rec_off;
 	bool			 header_is_updated = false;
 
 	ENTRY;
@@ -518,20 +563,23 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	llh->llh_count++;
 	spin_unlock(&loghandle->lgh_hdr_lock);
 
-	lgi->lgi_off = 0;
-	lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
-	lgi->lgi_buf.lb_buf = &llh->llh_hdr;
-	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	/* the record goes right after the padding, if any; the header of an
+	 * empty llog is written in full and the record follows it */
+	rec_off = lgi->lgi_off;
+	if (rec_off == 0) {
+		lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
+		lgi->lgi_buf.lb_buf = &llh->llh_hdr;
+		rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off,
+				     th);
+		rec_off = lgi->lgi_off;
+	} else {
+		rc = llog_osd_write_hdr_bits(env, o, llh, index, th);
+	}
 	if (rc)
 		GOTO(out, rc);
 
 	header_is_updated = true;
-	rc = dt_attr_get(env, o, &lgi->lgi_attr, NULL);
-	if (rc)
-		GOTO(out, rc);
-
-	LASSERT(lgi->lgi_attr.la_valid & LA_SIZE);
-	lgi->lgi_off = lgi->lgi_attr.la_size;
+	lgi->lgi_off = rec_off;
 	lgi->lgi_buf.lb_len = reclen;
 	lgi->lgi_buf.lb_buf = rec;
 	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
@@ -565,12 +613,8 @@ out:
 	llh->llh_tail.lrt_index = loghandle->lgh_last_idx;
 
 	/* restore the header on disk if it was written */
-	if (header_is_updated) {
-		lgi->lgi_off = 0;
-		lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
-		lgi->lgi_buf.lb_buf = &llh->llh_hdr;
-		dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
-	}
+	if (header_is_updated)
+		llog_osd_write_hdr_bits(env, o, llh, index, th);
 
 	RETURN(rc);
 }
@@ -1074,6 +1074,121 @@ out_put:
 	RETURN(rc);
 }
 
+/* count the records of a catalog after re-opening it from disk */
+static int llog_test_9_count(const struct lu_env *env, struct llog_ctxt *ctxt,
+			     struct llog_logid *logid)
+{
+	struct llog_handle	*cath;
+	int			 rc, rc2;
+
+	rc = llog_open(env, ctxt, &cath, logid, NULL, LLOG_OPEN_EXISTS);
+	if (rc) {
+		CERROR("9: can't re-open catalog: %d\n", rc);
+		return rc;
+	}
+
+	rc = llog_init_handle(env, cath, LLOG_F_IS_CAT, &uuid);
+	if (rc == 0) {
+		plain_counter = 0;
+		rc = llog_cat_process(env, cath, test_8_cb, "foobar", 0, 0);
+	}
+
+	rc2 = llog_cat_close(env, cath);
+	if (rc == 0)
+		rc = rc2;
+
+	return rc < 0 ? rc : plain_counter;
+}
+
+/* Test appends and cancel of several records with one header update */
+static int llog_test_9(const struct lu_env *env, struct obd_device *obd)
+{
+	struct llog_handle	*cath;
+	struct llog_cookie	*cookies;
+	struct llog_mini_rec	 lmr;
+	struct llog_ctxt	*ctxt;
+	struct llog_logid	 logid;
+	char			 name[10];
+	int			 num = 10;
+	int			 rc, rc2, i;
+
+	ENTRY;
+
+	ctxt = llog_get_context(obd, LLOG_TEST_ORIG_CTXT);
+	LASSERT(ctxt);
+
+	OBD_ALLOC(cookies, num * sizeof(*cookies));
+	if (cookies == NULL)
+		GOTO(out_put, rc = -ENOMEM);
+
+	lmr.lmr_hdr.lrh_len = lmr.lmr_tail.lrt_len = LLOG_MIN_REC_SIZE;
+	lmr.lmr_hdr.lrh_type = 0xf00f00;
+
+	sprintf(name, "%x", llog_test_rand + 3);
+	CWARN("9a: add %d records to a new catalog %s\n", num, name);
+	rc = llog_open_create(env, ctxt, &cath, NULL, name);
+	if (rc) {
+		CERROR("9a: llog_create with name %s failed: %d\n", name, rc);
+		GOTO(out_free, rc);
+	}
+	rc = llog_init_handle(env, cath, LLOG_F_IS_CAT, &uuid);
+	if (rc) {
+		CERROR("9a: can't init llog handle: %d\n", rc);
+		GOTO(out_close, rc);
+	}
+	logid = cath->lgh_id;
+
+	for (i = 0; i < num; i++) {
+		rc = llog_cat_add(env, cath, &lmr.lmr_hdr, &cookies[i]);
+		if (rc != 1) {
+			CERROR("9a: add record %d failed: %d\n", i, rc);
+			GOTO(out_close, rc = rc < 0 ? rc : -EINVAL);
+		}
+	}
+	rc = verify_handle("9a", cath->u.chd.chd_current_log, num + 1);
+	if (rc)
+		GOTO(out_close, rc);
+
+	rc = llog_cat_close(env, cath);
+	if (rc)
+		GOTO(out_free, rc);
+
+	CWARN("9b: check records from disk\n");
+	rc = llog_test_9_count(env, ctxt, &logid);
+	if (rc != num) {
+		CERROR("9b: found %d records, expected %d\n", rc, num);
+		GOTO(out_free, rc = rc < 0 ? rc : -EIO);
+	}
+
+	CWARN("9c: cancel %d records at once\n", num);
+	rc = llog_open(env, ctxt, &cath, &logid, NULL, LLOG_OPEN_EXISTS);
+	if (rc)
+		GOTO(out_free, rc);
+	rc = llog_init_handle(env, cath, LLOG_F_IS_CAT, &uuid);
+	if (rc == 0)
+		rc = llog_cat_cancel_records(env, cath, num, cookies);
+	if (rc)
+		CERROR("9c: cancel %d records failed: %d\n", num, rc);
+out_close:
+	rc2 = llog_cat_close(env, cath);
+	if (rc == 0)
+		rc = rc2;
+	if (rc)
+		GOTO(out_free, rc);
+
+	CWARN("9d: check no record is left\n");
+	rc = llog_test_9_count(env, ctxt, &logid);
+	if (rc != 0) {
+		CERROR("9d: found %d records, expected 0\n", rc);
+		rc = rc < 0 ? rc : -EIO;
+	}
+out_free:
+	OBD_FREE(cookies, num * sizeof(*cookies));
+out_put:
+	llog_ctxt_put(ctxt);
+	RETURN(rc);
+}
+
 /* -------------------------------------------------------------------------
  * Tests above, boring obd functions below
  * ------------------------------------------------------------------------- */
@@ -1122,6 +1237,10 @@ static int llog_run_tests(const struct lu_env *env, struct obd_device *obd)
 	if (rc)
 		GOTO(cleanup, rc);
 
+	rc = llog_test_9(env, obd);
+	if (rc)
+		GOTO(cleanup, rc);
+
 cleanup:
 	err = llog_destroy(env, llh);
 	if (err)
@@ -66,6 +66,11 @@ enum {
 #define	LU_CACHE_NR_LDISKFS_LIMIT	LU_CACHE_NR_UNLIMITED
 /** This is set to roughly (20 * OSS_NTHRS_MAX) to prevent thrashing */
 #define	LU_CACHE_NR_ZFS_LIMIT		10240
+/**
+ * Memory taken by a cached object together with its inode, as assumed by
+ * lu_htable_order(), to turn the memory target of the cache into objects.
+ */
+#define	LU_OBJECT_FOOTPRINT_SHIFT	10
 
 #define LU_SITE_BITS_MIN    12
 #define LU_SITE_BITS_MAX    24
@@ -85,8 +90,68 @@ static long lu_cache_nr = LU_CACHE_NR_DEFAULT;
 CFS_MODULE_PARM(lu_cache_nr, "l", long, 0644,
 		"Maximum number of objects in lu_object cache");
 
+static unsigned int lu_cache_mb;
+CFS_MODULE_PARM(lu_cache_mb, "i", uint, 0644,
+		"Memory target of lu_object cache in MB, "
+		"0 for lu_cache_percent of the memory");
+
 static void lu_object_free(const struct lu_env *env, struct lu_object *o);
 
+/**
+ * Maximum number of objects cached by a site: the memory target of the
+ * cache, lu_cache_mb or else lu_cache_percent of the memory, divided by the
+ * object footprint, and no more than lu_cache_nr if that is set.
+ */
+static __u64 lu_cache_limit(void)
+{
+	__u64 mem;
+	__u64 nr;
+
+	if (lu_cache_mb != 0)
+		mem = (__u64)lu_cache_mb << 20;
+	else
+		mem = ((__u64)totalram_pages * lu_cache_percent / 100) <<
+		      PAGE_CACHE_SHIFT;
+
+	nr = mem >> LU_OBJECT_FOOTPRINT_SHIFT;
+	if (lu_cache_nr != LU_CACHE_NR_UNLIMITED)
+		nr = min_t(__u64, nr, lu_cache_nr);
+
+	return nr;
+}
+
+#ifdef __KERNEL__
+/**
+ * Background purge of sites exceeding lu_cache_limit(), so that lookups
+ * don't have to purge the cache inline while allocating new objects.
+ */
+static unsigned long		lu_purge_flags;
+static wait_queue_head_t	lu_purge_waitq;
+static struct completion	lu_purge_start;
+static struct completion	lu_purge_stop;
+/**
+ * Site being purged by the thread without lu_sites_guard held, protected by
+ * lu_sites_guard. lu_site_fini() waits on lu_purge_done until it is done.
+ */
+static struct lu_site		*lu_purge_site;
+static wait_queue_head_t	lu_purge_done;
+
+enum {
+	LU_PURGE_RUNNING	= 0,
+	LU_PURGE_WAKEUP		= 1,
+	LU_PURGE_STOP		= 2,
+};
+
+/**
+ * Excess over the limit left to the purge thread, if the cache grows past
+ * it, lookups purge inline again to throttle themselves.
+ */
+static inline __u64 lu_cache_nr_slack(__u64 nr)
+{
+	return max_t(__u64, nr >> 3, LU_CACHE_NR_MAX_ADJUST);
+}
+#endif
+
 /**
  * Decrease reference counter on object. If last reference is freed, return
  * object to the cache, unless lu_object_is_dying(o) holds. In the latter
@@ -375,9 +440,13 @@ int lu_site_purge(const struct lu_env *env, struct lu_site *s, int nr)
         cfs_hash_for_each_bucket(s->ls_obj_hash, &bd, i) {
                 if (i < start)
                         continue;
+                bkt = cfs_hash_bd_extra_get(s->ls_obj_hash, &bd);
+		/* racy check, don't take the lock of buckets with empty LRU */
+		if (bkt->lsb_lru_len == 0)
+			continue;
+
                 count = bnr;
                 cfs_hash_bd_lock(s->ls_obj_hash, &bd, 1);
-                bkt = cfs_hash_bd_extra_get(s->ls_obj_hash, &bd);
 
 		list_for_each_entry_safe(h, temp, &bkt->lsb_lru, loh_lru) {
 			LASSERT(atomic_read(&h->loh_ref) == 0);
@@ -638,7 +707,7 @@ struct lu_object *lu_object_find(const struct lu_env *env,
 EXPORT_SYMBOL(lu_object_find);
 
 /*
- * Limit the lu_object cache to a maximum of lu_cache_nr objects.  Because
+ * Limit the lu_object cache to a maximum of lu_cache_limit() objects.  Because
  * the calculation for the number of objects to reclaim is not covered by
  * a lock the maximum number of objects is capped by LU_CACHE_MAX_ADJUST.
  * This ensures that many concurrent threads will not accidentally purge
@@ -649,16 +718,57 @@ static void lu_object_limit(const struct lu_env *env,
 {
 	__u64 size, nr;
 
-	if (lu_cache_nr == LU_CACHE_NR_UNLIMITED)
+	size = cfs_hash_size_get(dev->ld_site->ls_obj_hash);
+	nr = lu_cache_limit();
+	if (size <= nr)
 		return;
 
-	size = cfs_hash_size_get(dev->ld_site->ls_obj_hash);
-	nr = (__u64)lu_cache_nr;
-	if (size > nr)
-		lu_site_purge(env, dev->ld_site,
-			      MIN(size - nr, LU_CACHE_NR_MAX_ADJUST));
+#ifdef __KERNEL__
+	if (test_bit(LU_PURGE_RUNNING, &lu_purge_flags) &&
+	    size - nr < lu_cache_nr_slack(nr)) {
+		if (!test_and_set_bit(LU_PURGE_WAKEUP, &lu_purge_flags))
+			wake_up(&lu_purge_waitq);
+		return;
+	}
+#endif
+
+	lu_site_purge(env, dev->ld_site,
+		      MIN(size - nr, LU_CACHE_NR_MAX_ADJUST));
+}
+
+/**
+ * Start timing the lookup, only if the lookup latency histogram is enabled,
+ * see lu_site_lookup_hist_enable().
+ */
+static inline void lu_object_lookup_start(struct lu_site *s,
+					  struct timeval *start)
+{
+	if (s->ls_lookup_hist_on)
+		do_gettimeofday(start);
+	else
+		start->tv_sec = 0;
+}
+
+/**
+ * Account lookup which started at \a start in the lookup latency histogram.
+ */
+static void lu_object_lookup_tally(struct lu_site *s, int hit,
+				   struct timeval *start)
+{
+	struct timeval	now;
+	long		usec;
+	int		bucket = 0;
+
+	if (start->tv_sec == 0 || s->ls_lookup_hist == NULL)
+		return;
 
-	return;
+	do_gettimeofday(&now);
+	usec = cfs_timeval_sub(&now, start, NULL);
+	if (usec > 0)
+		bucket = min(fls(usec), LU_LOOKUP_HIST_BUCKETS - 1);
+	lprocfs_counter_incr(s->ls_lookup_hist,
+			     (hit ? LU_LOOKUP_HIST_HIT : LU_LOOKUP_HIST_MISS) +
+			     bucket);
 }
 
 static struct lu_object *lu_object_new(const struct lu_env *env,
@@ -669,7 +779,9 @@ static struct lu_object *lu_object_new(const struct lu_env *env,
         struct lu_object        *o;
         cfs_hash_t              *hs;
         cfs_hash_bd_t            bd;
+	struct timeval		 start;
 
+	lu_object_lookup_start(dev->ld_site, &start);
         o = lu_object_alloc(env, dev, f, conf);
         if (unlikely(IS_ERR(o)))
                 return o;
@@ -680,6 +792,7 @@ static struct lu_object *lu_object_new(const struct lu_env *env,
         cfs_hash_bd_unlock(hs, &bd, 1);
 
 	lu_object_limit(env, dev);
+	lu_object_lookup_tally(dev->ld_site, 0, &start);
 
         return o;
 }
@@ -699,6 +812,7 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
 	cfs_hash_t            *hs;
 	cfs_hash_bd_t          bd;
 	__u64                  version = 0;
+	struct timeval         start;
 
         /*
          * This uses standard index maintenance protocol:
@@ -725,10 +839,15 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
 
         s  = dev->ld_site;
         hs = s->ls_obj_hash;
+	lu_object_lookup_start(s, &start);
         cfs_hash_bd_get_and_lock(hs, (void *)f, &bd, 1);
         o = htable_lookup(s, &bd, f, waiter, &version);
         cfs_hash_bd_unlock(hs, &bd, 1);
-	if (!IS_ERR(o) || PTR_ERR(o) != -ENOENT)
+	if (!IS_ERR(o)) {
+		lu_object_lookup_tally(s, 1, &start);
+		return o;
+	}
+	if (PTR_ERR(o) != -ENOENT)
                 return o;
 
         /*
@@ -749,6 +868,7 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
                 cfs_hash_bd_unlock(hs, &bd, 1);
 
 		lu_object_limit(env, dev);
+		lu_object_lookup_tally(s, 0, &start);
 
                 return o;
         }
@@ -1099,6 +1219,17 @@ int lu_site_init(struct lu_site *s, struct lu_device *top)
         lprocfs_counter_init(s->ls_stats, LU_SS_LRU_PURGED,
                              0, "lru_purged", "lru_purged");
 
+	/* Not fatal, the lookup latency is not accounted without it. It is
+	 * only accounted once enabled via lu_site_lookup_hist_enable(). */
+	s->ls_lookup_hist = lprocfs_alloc_stats(LU_LOOKUP_HIST_LAST, 0);
+	if (s->ls_lookup_hist != NULL) {
+		for (i = 0; i < LU_LOOKUP_HIST_LAST; i++)
+			lprocfs_counter_init(s->ls_lookup_hist, i, 0,
+					     i < LU_LOOKUP_HIST_MISS ?
+					     "lookup_hit" : "lookup_miss",
+					     "usec");
+	}
+
 	INIT_LIST_HEAD(&s->ls_linkage);
         s->ls_top_dev = top;
         top->ld_site = s;
@@ -1123,6 +1254,11 @@ void lu_site_fini(struct lu_site *s)
 	list_del_init(&s->ls_linkage);
 	mutex_unlock(&lu_sites_guard);
 
+#ifdef __KERNEL__
+	/* the purge thread may still be purging it without the mutex */
+	wait_event(lu_purge_done, ACCESS_ONCE(lu_purge_site) != s);
+#endif
+
         if (s->ls_obj_hash != NULL) {
                 cfs_hash_putref(s->ls_obj_hash);
                 s->ls_obj_hash = NULL;
@@ -1137,6 +1273,9 @@ void lu_site_fini(struct lu_site *s)
 
         if (s->ls_stats != NULL)
                 lprocfs_free_stats(&s->ls_stats);
+
+	if (s->ls_lookup_hist != NULL)
+		lprocfs_free_stats(&s->ls_lookup_hist);
 }
 EXPORT_SYMBOL(lu_site_fini);
 
@@ -1994,6 +2133,131 @@ static int lu_cache_shrink(SHRINKER_ARGS(sc, nr_to_scan, gfp_mask))
 #endif /* HAVE_SHRINKER_COUNT */
 
 
+#ifdef __KERNEL__
+/**
+ * Trim sites exceeding lu_cache_limit() down to 15/16 of it, so that the
+ * thread is not woken up again by every next object allocation.
+ *
+ * lu_sites_guard is only held to pick the sites, the objects are freed
+ * without it, so that the shrinker and the site setup are not blocked by
+ * the purge, nor can an allocation made while freeing objects deadlock
+ * against the shrinker. lu_site_fini() waits for the site being purged.
+ */
+static void lu_site_purge_excess(struct lu_env *env)
+{
+	struct lu_site	*s;
+	__u64		 size;
+	__u64		 target;
+	int		 nr = 0;
+
+	target = lu_cache_limit();
+	target -= target >> 4;
+
+	mutex_lock(&lu_sites_guard);
+	list_for_each_entry(s, &lu_sites, ls_linkage)
+		nr++;
+
+	/* Visit each site once, rotating the list like the shrinker. */
+	while (nr-- > 0 && !list_empty(&lu_sites)) {
+		s = list_entry(lu_sites.next, struct lu_site, ls_linkage);
+		list_move_tail(&s->ls_linkage, &lu_sites);
+
+		size = cfs_hash_size_get(s->ls_obj_hash);
+		if (size <= target)
+			continue;
+
+		/* for the keys registered since the last purge */
+		if (lu_env_refill(env) != 0)
+			break;
+
+		lu_purge_site = s;
+		mutex_unlock(&lu_sites_guard);
+
+		lu_site_purge(env, s, size - target);
+
+		mutex_lock(&lu_sites_guard);
+		lu_purge_site = NULL;
+		wake_up_all(&lu_purge_done);
+	}
+	mutex_unlock(&lu_sites_guard);
+}
+
+static int lu_site_purge_thread(void *unused)
+{
+	struct lu_env	env;
+	int		rc;
+
+	unshare_fs_struct();
+	rc = lu_env_init(&env, LCT_SHRINKER);
+	if (rc != 0) {
+		CERROR("cannot init lu_cache_purge env: rc = %d\n", rc);
+		complete(&lu_purge_start);
+		return rc;
+	}
+
+	set_bit(LU_PURGE_RUNNING, &lu_purge_flags);
+	complete(&lu_purge_start);
+
+	while (!test_bit(LU_PURGE_STOP, &lu_purge_flags)) {
+		struct l_wait_info lwi = { 0 };
+
+		l_wait_event(lu_purge_waitq,
+			     test_bit(LU_PURGE_WAKEUP, &lu_purge_flags) ||
+			     test_bit(LU_PURGE_STOP, &lu_purge_flags), &lwi);
+		if (!test_and_clear_bit(LU_PURGE_WAKEUP, &lu_purge_flags))
+			continue;
+
+		lu_site_purge_excess(&env);
+	}
+
+	lu_env_fini(&env);
+	clear_bit(LU_PURGE_RUNNING, &lu_purge_flags);
+	complete(&lu_purge_stop);
+	return 0;
+}
+
+static int lu_site_purge_thread_start(void)
+{
+	struct task_struct *task;
+
+	lu_purge_flags = 0;
+	lu_purge_site = NULL;
+	init_waitqueue_head(&lu_purge_waitq);
+	init_waitqueue_head(&lu_purge_done);
+	init_completion(&lu_purge_start);
+	init_completion(&lu_purge_stop);
+
+	task = kthread_run(lu_site_purge_thread, NULL, "lu_cache_purge");
+	if (IS_ERR(task))
+		return PTR_ERR(task);
+
+	wait_for_completion(&lu_purge_start);
+	if (!test_bit(LU_PURGE_RUNNING, &lu_purge_flags))
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void lu_site_purge_thread_stop(void)
+{
+	if (!test_bit(LU_PURGE_RUNNING, &lu_purge_flags))
+		return;
+
+	set_bit(LU_PURGE_STOP, &lu_purge_flags);
+	wake_up(&lu_purge_waitq);
+	wait_for_completion(&lu_purge_stop);
+}
+#else /* !__KERNEL__ */
+static inline int lu_site_purge_thread_start(void)
+{
+	return 0;
+}
+
+static inline void lu_site_purge_thread_stop(void)
+{
+}
+#endif /* __KERNEL__ */
+
 /*
  * Debugging stuff.
  */
@@ -2086,7 +2350,12 @@ int lu_global_init(void)
         if (lu_site_shrinker == NULL)
                 return -ENOMEM;
 
-        return result;
+	/* Not fatal, the shrinker still purges the caches without it. */
+	result = lu_site_purge_thread_start();
+	if (result != 0)
+		CWARN("cannot start lu_cache_purge thread: rc = %d\n", result);
+
+	return 0;
 }
 
 /**
@@ -2094,6 +2363,8 @@ int lu_global_init(void)
  */
 void lu_global_fini(void)
 {
+	lu_site_purge_thread_stop();
+
         if (lu_site_shrinker != NULL) {
 		remove_shrinker(lu_site_shrinker);
                 lu_site_shrinker = NULL;
@@ -2171,6 +2442,79 @@ int lu_site_stats_print(const struct lu_site *s, char *page, int count)
                         ls_stats_read(s->ls_stats, LU_SS_LRU_PURGED));
 }
 
+/**
+ * Output lookup latency histogram of the site, for lookups served from the
+ * cache and for lookups allocating new objects, the ratio of totals being
+ * the cache hit rate.
+ */
+int lu_site_lookup_hist_seq_print(const struct lu_site *s, struct seq_file *m)
+{
+	struct lprocfs_stats	*hist = s->ls_lookup_hist;
+	__u64			 hit[LU_LOOKUP_HIST_BUCKETS];
+	__u64			 miss[LU_LOOKUP_HIST_BUCKETS];
+	__u64			 hit_tot = 0;
+	__u64			 miss_tot = 0;
+	__u64			 hit_cum = 0;
+	__u64			 miss_cum = 0;
+	struct timeval		 now;
+	int			 i;
+
+	if (hist == NULL)
+		return 0;
+
+	if (!s->ls_lookup_hist_on)
+		return seq_printf(m, "disabled, write 1 to enable\n");
+
+	for (i = 0; i < LU_LOOKUP_HIST_BUCKETS; i++) {
+		hit[i] = lprocfs_stats_collector(hist, LU_LOOKUP_HIST_HIT + i,
+						 LPROCFS_FIELDS_FLAGS_COUNT);
+		miss[i] = lprocfs_stats_collector(hist,
+						  LU_LOOKUP_HIST_MISS + i,
+						  LPROCFS_FIELDS_FLAGS_COUNT);
+		hit_tot += hit[i];
+		miss_tot += miss[i];
+	}
+
+	do_gettimeofday(&now);
+	seq_printf(m, "snapshot_time:         %lu.%lu (secs.usecs)\n",
+		   now.tv_sec, now.tv_usec);
+	seq_printf(m, "hit_rate:              "LPU64"%%\n",
+		   hit_tot + miss_tot == 0 ? 0 :
+		   hit_tot * 100 / (hit_tot + miss_tot));
+	seq_printf(m, "\n%26s hit       |     miss\n", " ");
+	seq_printf(m, "%-22s %-5s %% cum %% |  %-11s %% cum %%\n",
+		   "lookup time", "usec", "usec");
+	for (i = 0; i < LU_LOOKUP_HIST_BUCKETS; i++) {
+		hit_cum += hit[i];
+		miss_cum += miss[i];
+		if (hit_cum == 0 && miss_cum == 0)
+			continue;
+
+		seq_printf(m, "%u:\t\t%10llu %3llu %3llu   | %4llu %3llu %3llu\n",
+			   i == 0 ? 0 : 1 << (i - 1),
+			   hit[i], hit_tot == 0 ? 0 : hit[i] * 100 / hit_tot,
+			   hit_tot == 0 ? 0 : hit_cum * 100 / hit_tot,
+			   miss[i], miss_tot == 0 ? 0 : miss[i] * 100 / miss_tot,
+			   miss_tot == 0 ? 0 : miss_cum * 100 / miss_tot);
+		if (hit_cum == hit_tot && miss_cum == miss_tot)
+			break;
+	}
+	return 0;
+}
+EXPORT_SYMBOL(lu_site_lookup_hist_seq_print);
+
+/**
+ * Clear the lookup latency histogram, and enable or disable the accounting,
+ * which costs two clock reads per lookup.
+ */
+void lu_site_lookup_hist_enable(struct lu_site *s, bool enable)
+{
+	s->ls_lookup_hist_on = enable;
+	if (s->ls_lookup_hist != NULL)
+		lprocfs_clear_stats(s->ls_lookup_hist);
+}
+EXPORT_SYMBOL(lu_site_lookup_hist_enable);
+
 /**
  * Helper function to initialize a number of kmem slab caches at once.
  */
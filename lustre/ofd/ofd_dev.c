@@ -1914,6 +1914,8 @@ static int ofd_statfs_hdl(struct tgt_session_info *tsi)
 	if (rc != 0)
 		CERROR("%s: statfs failed: rc = %d\n",
 		       tgt_name(tsi->tsi_tgt), rc);
+	else
+		osfs->os_io_latency = ofd_io_latency(ofd_exp(tsi->tsi_exp));
 
 	if (OBD_FAIL_CHECK(OBD_FAIL_OST_STATFS_EINPROGRESS))
 		rc = -EINPROGRESS;
@@ -152,6 +152,12 @@ struct ofd_device {
 	 * tracking is only effective when ofd_statfs_inflight > 1 */
 	u64			 ofd_osfs_inflight;
 
+	/* moving average of the bulk I/O service time in usec, it is
+	 * reported to the MDTs via statfs for QoS allocation */
+	__u32			 ofd_io_latency;
+	/* when the last bulk I/O completed, seconds */
+	time_t			 ofd_io_latency_time;
+
 	/* grants: all values in bytes */
 	/* grant lock to protect all grant counters */
 	spinlock_t		 ofd_grant_lock;
@@ -389,6 +395,7 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		 struct niobuf_remote *rnb, int npages,
 		 struct niobuf_local *lnb, struct obd_trans_info *oti,
 		 int old_rc);
+__u32 ofd_io_latency(struct ofd_device *ofd);
 
 /* ofd_trans.c */
 struct thandle *ofd_trans_create(const struct lu_env *env,
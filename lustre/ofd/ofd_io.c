@@ -1145,6 +1145,46 @@ out:
 	RETURN(rc);
 }
 
+/* The reported I/O latency is halved for every so many idle seconds. */
+#define OFD_IO_LATENCY_DECAY	10
+
+/**
+ * Account the service time of the bulk I/O request being handled.
+ *
+ * The time is counted from the request arrival, so it includes the wait
+ * for the OST I/O threads, and reflects the OST load as well as the disk
+ * latency. A moving average is kept without locking: racing updates may
+ * lose a sample, which is harmless.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ */
+static void ofd_io_latency_add(const struct lu_env *env,
+			       struct ofd_device *ofd)
+{
+	struct ptlrpc_request	*req;
+	struct timeval		 now;
+	long			 usec;
+
+	if (env->le_ses == NULL)
+		return;
+
+	req = tgt_ses_req(tgt_ses_info(env));
+	if (req == NULL)
+		return;
+
+	do_gettimeofday(&now);
+	usec = cfs_timeval_sub(&now, &req->rq_arrival_time, NULL);
+	if (usec < 0)
+		return;
+
+	usec = min_t(long, usec, INT_MAX);
+	/* avg = 7/8 * avg + 1/8 * sample */
+	ofd->ofd_io_latency = ofd->ofd_io_latency -
+			      (ofd->ofd_io_latency >> 3) + (usec >> 3);
+	ofd->ofd_io_latency_time = cfs_time_current_sec();
+}
+
 /**
  * Commit bulk IO to the storage.
  *
@@ -1260,7 +1300,31 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		rc = -EPROTO;
 	}
 
+	ofd_io_latency_add(env, ofd);
+
 	if (oti != NULL)
 		ofd_info2oti(info, oti);
 	RETURN(rc);
 }
+
+/**
+ * Get the recent bulk I/O service time of the OFD.
+ *
+ * It is reported to the MDTs via statfs. If the OFD has been idle for a
+ * while, the value is decayed, otherwise an OST that was once busy would
+ * never get new objects again to refresh it.
+ *
+ * \param[in] ofd	OFD device
+ *
+ * \retval		the I/O latency in usec
+ */
+__u32 ofd_io_latency(struct ofd_device *ofd)
+{
+	__u32	latency = ofd->ofd_io_latency;
+	time_t	idle = cfs_time_current_sec() - ofd->ofd_io_latency_time;
+
+	if (idle >= OFD_IO_LATENCY_DECAY)
+		latency >>= min_t(time_t, idle / OFD_IO_LATENCY_DECAY, 31);
+
+	return latency;
+}
@@ -361,7 +361,8 @@ check_oi:
 
 		LASSERTF(rc == -ESTALE || rc == -ENOENT, "rc = %d\n", rc);
 
-		rc = osd_oi_lookup(info, dev, fid, id, OI_CHECK_FLD);
+		rc = osd_oi_lookup(info, dev, fid, id,
+				   OI_CHECK_FLD | OI_SKIP_CACHE);
 		/* XXX: There are some possible cases:
 		 *	1. rc = 0.
 		 *	   Backup/restore caused the OI invalid.
@@ -1227,6 +1228,8 @@ static void osd_object_delete(const struct lu_env *env, struct lu_object *l)
 		qid_t			 uid = i_uid_read(inode);
 		qid_t			 gid = i_gid_read(inode);
 
+		osd_frag_stats_update(env, obj);
+
                 iput(inode);
                 obj->oo_inode = NULL;
 
@@ -2036,6 +2039,7 @@ static int osd_attr_set(const struct lu_env *env,
 		rc = iam_update(oh->ot_handle, bag, (const struct iam_key *)fid1,
 				(const struct iam_rec *)id, ipd);
 		osd_ipd_put(env, bag, ipd);
+		osd_oi_cache_delete(osd_dev(dt->do_lu.lo_dev), fid0);
 		return(rc > 0 ? 0 : rc);
 	}
 
@@ -2100,6 +2104,10 @@ static int osd_mkfile(struct osd_thread_info *info, struct osd_object *obj,
 		ldiskfs_set_inode_state(inode, LDISKFS_STATE_LUSTRE_NOSCRUB);
 
                 obj->oo_inode = inode;
+		/* may be a re-create of a destroyed object */
+		spin_lock(&obj->oo_guard);
+		obj->oo_xattr_loaded = 0;
+		spin_unlock(&obj->oo_guard);
                 result = 0;
         } else {
                 if (obj->oo_hl_head != NULL) {
@@ -2980,6 +2988,134 @@ static int osd_object_version_get(const struct lu_env *env,
         return 0;
 }
 
+/*
+ * xattrs the MDT probes on nearly every getattr/open, most of which are
+ * absent on a typical file. Their presence is learned from one listxattr
+ * call (one pass over the inode body and the EA block) so that lookups of
+ * missing ones can be answered without searching the EA storage each time.
+ * LMA and FID are not listed: they are also written through raw inode
+ * methods that bypass osd_xattr_set(). Nor are the ACLs: without the "acl"
+ * mount option, getting them must fail with -EOPNOTSUPP, not -ENODATA.
+ */
+static const char *osd_xattr_cached[] = {
+	XATTR_NAME_LOV,
+	XATTR_NAME_LMV,
+	XATTR_NAME_DEFAULT_LMV,
+	XATTR_NAME_LINK,
+	XATTR_NAME_HSM,
+	XATTR_NAME_SOM,
+};
+
+static int osd_xattr_cached_idx(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(osd_xattr_cached); i++)
+		if (strcmp(name, osd_xattr_cached[i]) == 0)
+			return i;
+
+	return -1;
+}
+
+/*
+ * Forget what is known about xattrs of @obj. Called both before and after
+ * a change, so oo_xattr_gen is odd while the change is in progress.
+ */
+static void osd_xattr_cache_inval(struct osd_object *obj)
+{
+	spin_lock(&obj->oo_guard);
+	obj->oo_xattr_gen++;
+	obj->oo_xattr_loaded = 0;
+	spin_unlock(&obj->oo_guard);
+}
+
+/*
+ * Fill obj->oo_xattr_absent from a single listxattr call. Nothing is
+ * published if an xattr set/del ran (or is running) meanwhile.
+ */
+static int osd_xattr_cache_load(struct osd_thread_info *info,
+				struct osd_object *obj)
+{
+	struct inode	*inode	= obj->oo_inode;
+	struct dentry	*dentry	= &info->oti_obj_dentry;
+	struct lu_buf	*buf	= &info->oti_big_buf;
+	__u32		 absent	= (1 << ARRAY_SIZE(osd_xattr_cached)) - 1;
+	__u32		 gen;
+	char		*name;
+	int		 idx;
+	int		 rc;
+
+	spin_lock(&obj->oo_guard);
+	gen = obj->oo_xattr_gen;
+	spin_unlock(&obj->oo_guard);
+	if (gen & 1)
+		return -EAGAIN;
+
+	dentry->d_inode = inode;
+	dentry->d_sb = inode->i_sb;
+again:
+	rc = inode->i_op->listxattr(dentry, buf->lb_buf, buf->lb_len);
+	if (rc == -ERANGE || (rc > 0 && buf->lb_buf == NULL)) {
+		rc = inode->i_op->listxattr(dentry, NULL, 0);
+		if (rc > 0) {
+			lu_buf_realloc(buf, rc);
+			if (buf->lb_buf == NULL)
+				return -ENOMEM;
+
+			goto again;
+		}
+	}
+	if (rc < 0)
+		return rc;
+
+	for (name = buf->lb_buf; name < (char *)buf->lb_buf + rc;
+	     name += strlen(name) + 1) {
+		idx = osd_xattr_cached_idx(name);
+		if (idx >= 0)
+			absent &= ~(1 << idx);
+	}
+
+	lprocfs_counter_incr(osd_obj2dev(obj)->od_stats,
+			     LPROC_OSD_XATTR_LIST_LOAD);
+
+	spin_lock(&obj->oo_guard);
+	if (obj->oo_xattr_gen == gen) {
+		obj->oo_xattr_absent = absent;
+		obj->oo_xattr_loaded = 1;
+	}
+	spin_unlock(&obj->oo_guard);
+
+	return 0;
+}
+
+/*
+ * Check whether xattr @name is known to be missing on @obj, loading the
+ * xattr name list on the first probe of a cached name.
+ */
+static bool osd_xattr_absent(struct osd_thread_info *info,
+			     struct osd_object *obj, const char *name)
+{
+	int	idx = osd_xattr_cached_idx(name);
+	bool	absent = false;
+
+	if (idx < 0)
+		return false;
+
+	if (!obj->oo_xattr_loaded && osd_xattr_cache_load(info, obj) != 0)
+		return false;
+
+	spin_lock(&obj->oo_guard);
+	if (obj->oo_xattr_loaded)
+		absent = !!(obj->oo_xattr_absent & (1 << idx));
+	spin_unlock(&obj->oo_guard);
+
+	if (absent)
+		lprocfs_counter_incr(osd_obj2dev(obj)->od_stats,
+				     LPROC_OSD_XATTR_ABSENT_HIT);
+
+	return absent;
+}
+
 /*
  * Concurrency: @dt is read locked.
  */
@@ -3017,6 +3153,9 @@ static int osd_xattr_get(const struct lu_env *env, struct dt_object *dt,
 	if (osd_object_auth(env, dt, capa, CAPA_OPC_META_READ))
 		return -EACCES;
 
+	if (osd_xattr_absent(info, obj, name))
+		return -ENODATA;
+
 	return __osd_xattr_get(inode, dentry, name, buf->lb_buf, buf->lb_len);
 }
 
@@ -3090,6 +3229,7 @@ static int osd_xattr_set(const struct lu_env *env, struct dt_object *dt,
 	struct inode	       *inode    = obj->oo_inode;
 	struct osd_thread_info *info     = osd_oti_get(env);
 	int			fs_flags = 0;
+	int			rc;
 	ENTRY;
 
         LASSERT(handle != NULL);
@@ -3118,7 +3258,6 @@ static int osd_xattr_set(const struct lu_env *env, struct dt_object *dt,
 
 	if (strcmp(name, XATTR_NAME_LMV) == 0) {
 		struct lustre_mdt_attrs *lma = &info->oti_mdt_attrs;
-		int			 rc;
 
 		rc = osd_get_lma(info, inode, &info->oti_obj_dentry, lma);
 		if (rc != 0)
@@ -3136,8 +3275,12 @@ static int osd_xattr_set(const struct lu_env *env, struct dt_object *dt,
 	    strcmp(name, XATTR_NAME_LINK) == 0)
 		return -ENOSPC;
 
-	return __osd_xattr_set(info, inode, name, buf->lb_buf, buf->lb_len,
-			       fs_flags);
+	osd_xattr_cache_inval(obj);
+	rc = __osd_xattr_set(info, inode, name, buf->lb_buf, buf->lb_len,
+			     fs_flags);
+	osd_xattr_cache_inval(obj);
+
+	RETURN(rc);
 }
 
 /*
@@ -3219,7 +3362,9 @@ static int osd_xattr_del(const struct lu_env *env, struct dt_object *dt,
 	ll_vfs_dq_init(inode);
 	dentry->d_inode = inode;
 	dentry->d_sb = inode->i_sb;
+	osd_xattr_cache_inval(obj);
 	rc = inode->i_op->removexattr(dentry, name);
+	osd_xattr_cache_inval(obj);
 	return rc;
 }
 
@@ -4207,7 +4352,7 @@ osd_consistency_check(struct osd_thread_info *oti, struct osd_device *dev,
 		RETURN_EXIT;
 
 again:
-	rc = osd_oi_lookup(oti, dev, fid, id, OI_CHECK_FLD);
+	rc = osd_oi_lookup(oti, dev, fid, id, OI_CHECK_FLD | OI_SKIP_CACHE);
 	if (rc != 0 && rc != -ENOENT)
 		RETURN_EXIT;
 
@@ -6140,6 +6285,7 @@ static int osd_device_init0(const struct lu_env *env,
 
 	o->od_full_scrub_ratio = OFSR_DEFAULT;
 	o->od_full_scrub_threshold_rate = FULL_SCRUB_THRESHOLD_RATE_DEFAULT;
+	o->od_scrub_ra_groups = OSD_SCRUB_RA_GROUPS_DEFAULT;
 	rc = osd_mount(env, o, cfg);
 	if (rc != 0)
 		GOTO(out_capa, rc);
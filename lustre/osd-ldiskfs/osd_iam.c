@@ -1469,6 +1469,58 @@ int iam_index_next(struct iam_container *c, struct iam_path *path)
         return result;
 }
 
+/*
+ * Number of leaf nodes to read ahead when iteration crosses into a new window
+ * of leaves referenced by the same index node.
+ */
+enum {
+	IAM_LEAF_READAHEAD = 16
+};
+
+/*
+ * Start asynchronous reads of the leaves following the current one in the
+ * index node immediately above leaf level. Sequential scans of a large
+ * container (OI scrub, index iteration) otherwise issue one synchronous read
+ * per leaf, because leaves are not allocated in key order. Readahead is
+ * issued once per IAM_LEAF_READAHEAD leaves, blocks already in cache are
+ * skipped by sb_breadahead().
+ */
+static void iam_leaf_readahead(struct iam_path *path)
+{
+	struct iam_frame *frame = path->ip_frame;
+	struct inode	 *obj   = iam_path_obj(path);
+	sector_t (*fs_bmap)(struct address_space *, sector_t);
+	iam_ptr_t	  blocks[IAM_LEAF_READAHEAD];
+	struct iam_entry *at;
+	struct iam_entry *end;
+	int		  nr = 0;
+	int		  i;
+
+	fs_bmap = obj->i_mapping->a_ops->bmap;
+	if (unlikely(fs_bmap == NULL))
+		return;
+
+	iam_lock_bh(frame->bh);
+	if ((iam_entry_diff(path, frame->at, frame->entries) - 1) %
+	    IAM_LEAF_READAHEAD == 0) {
+		end = iam_entry_shift(path, frame->entries,
+				      dx_get_count(frame->entries));
+		for (at = iam_entry_shift(path, frame->at, +1);
+		     at < end && nr < IAM_LEAF_READAHEAD;
+		     at = iam_entry_shift(path, at, +1))
+			blocks[nr++] = dx_get_block(path, at);
+	}
+	iam_unlock_bh(frame->bh);
+
+	for (i = 0; i < nr; i++) {
+		sector_t pblk;
+
+		pblk = fs_bmap(obj->i_mapping, blocks[i]);
+		if (pblk != 0)
+			sb_breadahead(obj->i_sb, pblk);
+	}
+}
+
 /*
  * Move iterator one record right.
  *
@@ -1517,6 +1569,8 @@ int iam_it_next(struct iam_iterator *it)
                         assert_corr(iam_leaf_is_locked(leaf));
                         if (result == 1) {
 				struct dynlock_handle *lh;
+
+				iam_leaf_readahead(path);
 				lh = iam_lock_htree(iam_it_container(it),
 						    path->ip_frame->leaf,
 						    DLT_WRITE);
@@ -2611,6 +2665,106 @@ int iam_insert(handle_t *h, struct iam_container *c, const struct iam_key *k,
         return result;
 }
 
+/*
+ * Check whether record with key @k belongs to the leaf @path is positioned at,
+ * so that it can be added there without repeating top-to-bottom lookup. Only
+ * the upper bound is checked: caller guarantees that @k is larger than a key
+ * already in this leaf.
+ *
+ * Valid only for formats using keys as index keys (id_key_size ==
+ * id_ikey_size).
+ */
+static int iam_leaf_covers(struct iam_path *path, const struct iam_key *k)
+{
+	struct iam_frame *frame = path->ip_frame;
+	struct iam_entry *last;
+	struct iam_entry *next;
+	int		  covers = 0;
+
+	iam_lock_bh(frame->bh);
+	last = iam_entry_shift(path, frame->entries,
+			       dx_get_count(frame->entries) - 1);
+	/* the leaf was split, or the index node was, since we looked up */
+	if (frame->at <= last &&
+	    dx_get_block(path, frame->at) == frame->leaf) {
+		next = iam_entry_shift(path, frame->at, +1);
+		covers = next <= last &&
+			 iam_ikeycmp(path->ip_container, iam_ikey_at(path, next),
+				     (const struct iam_ikey *)k) > 0;
+	}
+	iam_unlock_bh(frame->bh);
+	return covers;
+}
+
+/*
+ * Insert @nr records, sorted by key in ascending order, into container @c
+ * (within context of transaction @h). Consecutive records falling into the
+ * same leaf are added while the leaf is kept locked, without repeating
+ * top-to-bottom lookup, so a sorted batch costs about one lookup per touched
+ * leaf instead of one per record. This is used to rebuild OI files in bulk.
+ *
+ * Result for each record is stored into ->ibr_rc: 0 on success, -EEXIST
+ * when record with given key is already present. Records following the first
+ * other error are not touched.
+ *
+ * Return values: 0: all records processed, -ve: error.
+ */
+int iam_insert_sorted(handle_t *h, struct iam_container *c,
+		      struct iam_batch_rec *recs, int nr,
+		      struct iam_path_descr *pd)
+{
+	struct iam_descr    *descr = iam_container_descr(c);
+	struct iam_iterator  it;
+	struct iam_path	    *path  = &it.ii_path;
+	struct iam_leaf	    *leaf  = &path->ip_leaf;
+	int		     result = 0;
+	int		     i;
+
+	iam_it_init(&it, c, IAM_IT_WRITE, pd);
+	for (i = 0; i < nr; i++) {
+		const struct iam_key *k = recs[i].ibr_key;
+
+		if (it_state(&it) != IAM_IT_DETACHED &&
+		    descr->id_key_size == descr->id_ikey_size &&
+		    iam_leaf_covers(path, k)) {
+			path->ip_key_target  = k;
+			path->ip_ikey_target = (const struct iam_ikey *)k;
+			switch (iam_leaf_ops(leaf)->lookup(leaf, k) &
+				~IAM_LOOKUP_LAST) {
+			case IAM_LOOKUP_EXACT:
+				it.ii_state = IAM_IT_ATTACHED;
+				result = 0;
+				break;
+			case IAM_LOOKUP_OK:
+				it.ii_state = IAM_IT_ATTACHED;
+				result = -ENOENT;
+				break;
+			default:
+				it.ii_state = IAM_IT_SKEWED;
+				result = -ENOENT;
+				break;
+			}
+		} else {
+			iam_it_put(&it);
+			iam_it_fini(&it);
+			result = iam_it_get_exact(&it, k);
+		}
+
+		if (result == -ENOENT)
+			result = iam_it_rec_insert(h, &it, k, recs[i].ibr_rec);
+		else if (result == 0)
+			result = -EEXIST;
+		if (result != 0 && result != -EEXIST)
+			break;
+
+		recs[i].ibr_rc = result;
+		result = 0;
+	}
+	iam_it_put(&it);
+	iam_it_fini(&it);
+	return result;
+}
+
 /*
  * Update record with the key @k in container @c (within context of
  * transaction @h), new record is given by @r.
@@ -682,6 +682,20 @@ int iam_update(handle_t *h, struct iam_container *c, const struct iam_key *k,
 int iam_insert(handle_t *handle, struct iam_container *c,
                const struct iam_key *k,
                const struct iam_rec *r, struct iam_path_descr *pd);
+
+/*
+ * One record of a sorted batch, see iam_insert_sorted().
+ */
+struct iam_batch_rec {
+	const struct iam_key	*ibr_key;
+	const struct iam_rec	*ibr_rec;
+	/* per-record result: 0 or -EEXIST */
+	int			 ibr_rc;
+};
+
+int iam_insert_sorted(handle_t *h, struct iam_container *c,
+		      struct iam_batch_rec *recs, int nr,
+		      struct iam_path_descr *pd);
 /*
  * Initialize container @c.
  */
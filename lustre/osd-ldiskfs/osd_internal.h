@@ -135,6 +135,19 @@ struct osd_object {
         int                     oo_compat_dotdot_created;
 
         const struct lu_env    *oo_owner;
+
+	/* Protected by oo_guard. */
+	unsigned int		oo_written:1,	/* blocks allocated in cache */
+				oo_xattr_loaded:1; /* oo_xattr_absent valid */
+	/**
+	 * Which of the frequently probed xattrs (see osd_xattr_cached[]) are
+	 * known to be absent from the inode, filled from a single listxattr
+	 * call. oo_xattr_gen is odd while a set/del is in progress and bumped
+	 * on every change, so that a racing load does not publish a stale
+	 * result. Protected by oo_guard.
+	 */
+	__u32			oo_xattr_absent;
+	__u32			oo_xattr_gen;
 #ifdef CONFIG_LOCKDEP
         struct lockdep_map      oo_dep_map;
 #endif
@@ -198,6 +211,9 @@ struct osd_otable_cache {
 
 	/* Position for up layer LFSCK iteration pre-loading. */
 	__u32		       ooc_pos_preload;
+
+	/* The next block group to be read ahead for pre-loading. */
+	__u32		       ooc_ra_next;
 };
 
 struct osd_otable_it {
@@ -216,6 +232,16 @@ struct osd_otable_it {
 				 ooi_waiting:1; /* it::next is waiting. */
 };
 
+enum osd_frag_hist {
+	OSD_FRAG_EXTENTS	= 0,
+	OSD_FRAG_SIZE		= 1,
+	OSD_FRAG_LAST,
+};
+
+/* one in this many written objects leaving the cache is sampled in the
+ * fragmentation histograms, see osd_frag_stats_update() */
+#define OSD_FRAG_SAMPLE_RATE		16
+
 /*
  * osd device.
  */
@@ -228,6 +254,8 @@ struct osd_device {
         struct osd_oi           **od_oi_table;
         /* total number of OI containers */
         int                       od_oi_count;
+	/* FID -> ino/gen cache in front of the OI containers */
+	struct osd_oi_cache	 *od_oi_cache;
         /*
          * Fid Capability
          */
@@ -261,6 +289,10 @@ struct osd_device {
 	int			od_writethrough_cache;
 
 	struct brw_stats	od_brw_stats;
+	/* extents per object and object size, sampled via fiemap when
+	 * written objects leave the cache, see osd_frag_stats_update() */
+	struct obd_histogram	od_frag_hist[OSD_FRAG_LAST];
+	atomic_t		od_frag_sample;
 	atomic_t		od_r_in_flight;
 	atomic_t		od_w_in_flight;
 
@@ -287,6 +319,9 @@ struct osd_device {
 	 * exceeds the osd_device::od_full_scrub_threshold_rate,
 	 * then trigger OI scrub to scan the whole device. */
 	__u64			 od_full_scrub_threshold_rate;
+	/* How many block groups' inode bitmaps and inode tables are read
+	 * ahead of the OI scrub and the otable-based iteration. */
+	__u32			 od_scrub_ra_groups;
 };
 
 enum osd_full_scrub_ratio {
@@ -303,6 +338,9 @@ enum osd_full_scrub_ratio {
 
 #define FULL_SCRUB_THRESHOLD_RATE_DEFAULT	60
 
+#define OSD_SCRUB_RA_GROUPS_DEFAULT	8
+#define OSD_SCRUB_RA_GROUPS_MAX		256
+
 /* There are at most 10 uid/gids are affected in a transaction, and
  * that's rename case:
  * - 2 for source parent uid & gid;
@@ -384,6 +422,11 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+	LPROC_OSD_OI_CACHE_HIT	= 7,
+	LPROC_OSD_OI_CACHE_MISS	= 8,
+	LPROC_OSD_OI_CACHE_INVALIDATE = 9,
+	LPROC_OSD_XATTR_ABSENT_HIT = 10,
+	LPROC_OSD_XATTR_LIST_LOAD = 11,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
@@ -921,6 +964,7 @@ static inline void osd_ipd_put(const struct lu_env *env,
 int osd_ldiskfs_read(struct inode *inode, void *buf, int size, loff_t *offs);
 int osd_ldiskfs_write_record(struct inode *inode, void *buf, int bufsize,
 			     int write_NUL, loff_t *offs, handle_t *handle);
+void osd_frag_stats_update(const struct lu_env *env, struct osd_object *obj);
 
 static inline
 struct dentry *osd_child_dentry_by_inode(const struct lu_env *env,
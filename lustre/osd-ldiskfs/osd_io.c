@@ -1188,8 +1188,9 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 {
         struct osd_thread_info *oti = osd_oti_get(env);
         struct osd_iobuf *iobuf = &oti->oti_iobuf;
-        struct inode *inode = osd_dt_obj(dt)->oo_inode;
-        struct osd_device  *osd = osd_obj2dev(osd_dt_obj(dt));
+        struct osd_object *obj = osd_dt_obj(dt);
+        struct inode *inode = obj->oo_inode;
+        struct osd_device  *osd = osd_obj2dev(obj);
         loff_t isize;
         int rc = 0, i;
 
@@ -1243,6 +1244,12 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 		rc = osd_ldiskfs_map_inode_pages(inode, iobuf->dr_pages,
 						 iobuf->dr_npages,
 						 iobuf->dr_blocks, 1);
+		/* see osd_frag_stats_update() */
+		if (osd->od_is_ost && !obj->oo_written) {
+			spin_lock(&obj->oo_guard);
+			obj->oo_written = 1;
+			spin_unlock(&obj->oo_guard);
+		}
         } else {
                 /* no pages to write, no transno is needed */
                 thandle->th_local = 1;
@@ -1854,6 +1861,46 @@ static int osd_fiemap_get(const struct lu_env *env, struct dt_object *dt,
         return rc;
 }
 
+/**
+ * Account the on-disk layout of an OST object written while it was cached
+ * in the per-OST fragmentation histograms (see "extent_stats" in lprocfs).
+ *
+ * Mapping the extents may need to read the extent tree from disk, so only
+ * one in OSD_FRAG_SAMPLE_RATE of the written objects leaving the cache is
+ * sampled, which is enough for the distribution shown in the histograms.
+ *
+ * \param env	execution environment
+ * \param obj	object leaving the cache
+ */
+void osd_frag_stats_update(const struct lu_env *env, struct osd_object *obj)
+{
+	struct osd_device	*osd = osd_obj2dev(obj);
+	struct inode		*inode = obj->oo_inode;
+	struct ll_user_fiemap	 fm = { 0 };
+	int			 rc;
+
+	if (inode == NULL || !obj->oo_written || inode->i_nlink == 0)
+		return;
+
+	if (atomic_inc_return(&osd->od_frag_sample) % OSD_FRAG_SAMPLE_RATE)
+		return;
+
+	/* with fm_extent_count == 0 only the extent count is returned */
+	fm.fm_length = FIEMAP_MAX_OFFSET;
+	rc = osd_fiemap_get(env, &obj->oo_dt, &fm);
+	if (rc != 0) {
+		CDEBUG(D_INODE, "%s: cannot map "DFID": rc = %d\n",
+		       osd_name(osd), PFID(lu_object_fid(&obj->oo_dt.do_lu)),
+		       rc);
+		return;
+	}
+
+	lprocfs_oh_tally_log2(&osd->od_frag_hist[OSD_FRAG_EXTENTS],
+			      fm.fm_mapped_extents);
+	lprocfs_oh_tally_log2(&osd->od_frag_hist[OSD_FRAG_SIZE],
+			      i_size_read(inode) >> 10);
+}
+
 /*
  * in some cases we may need declare methods for objects being created
  * e.g., when we create symlink
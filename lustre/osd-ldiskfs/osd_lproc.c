@@ -188,6 +188,69 @@ static ssize_t osd_brw_stats_seq_write(struct file *file, const char *buf,
 
 LPROC_SEQ_FOPS(osd_brw_stats);
 
+static void display_frag_hist(struct seq_file *seq, char *name, char *units,
+			      struct obd_histogram *hist)
+{
+	unsigned long tot, cum = 0, n;
+	int i;
+
+	seq_printf(seq, "\n%-22s %-5s %% cum %%\n", name, units);
+
+	tot = lprocfs_oh_sum(hist);
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		n = hist->oh_buckets[i];
+		cum += n;
+		if (cum == 0)
+			continue;
+
+		if (i < 10)
+			seq_printf(seq, "%u", 1 << i);
+		else if (i < 20)
+			seq_printf(seq, "%uK", 1 << (i - 10));
+		else
+			seq_printf(seq, "%uM", 1 << (i - 20));
+
+		seq_printf(seq, ":\t\t%10lu %3lu %3lu\n",
+			   n, tot ? n * 100 / tot : 0, tot ? cum * 100 / tot : 0);
+
+		if (cum == tot)
+			break;
+	}
+}
+
+static int osd_extent_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct osd_device *osd = seq->private;
+	struct timeval now;
+
+	/* this sampling races with updates */
+	do_gettimeofday(&now);
+	seq_printf(seq, "snapshot_time:         %lu.%lu (secs.usecs)\n",
+		   now.tv_sec, now.tv_usec);
+
+	display_frag_hist(seq, "extents per object", "objs",
+			  &osd->od_frag_hist[OSD_FRAG_EXTENTS]);
+	display_frag_hist(seq, "object size (KB)", "objs",
+			  &osd->od_frag_hist[OSD_FRAG_SIZE]);
+
+	return 0;
+}
+
+static ssize_t osd_extent_stats_seq_write(struct file *file, const char *buf,
+					  size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct osd_device *osd = seq->private;
+	int i;
+
+	for (i = 0; i < OSD_FRAG_LAST; i++)
+		lprocfs_oh_clear(&osd->od_frag_hist[i]);
+
+	return len;
+}
+
+LPROC_SEQ_FOPS(osd_extent_stats);
+
 static int osd_stats_init(struct osd_device *osd)
 {
         int i, result;
@@ -195,6 +258,8 @@ static int osd_stats_init(struct osd_device *osd)
 
         for (i = 0; i < BRW_LAST; i++)
 		spin_lock_init(&osd->od_brw_stats.hist[i].oh_lock);
+	for (i = 0; i < OSD_FRAG_LAST; i++)
+		spin_lock_init(&osd->od_frag_hist[i].oh_lock);
 
         osd->od_stats = lprocfs_alloc_stats(LPROC_OSD_LAST, 0);
         if (osd->od_stats != NULL) {
@@ -218,6 +283,22 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_OI_CACHE_HIT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "oi_cache_hit", "reqs");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_OI_CACHE_MISS,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "oi_cache_miss", "reqs");
+		lprocfs_counter_init(osd->od_stats,
+				     LPROC_OSD_OI_CACHE_INVALIDATE,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "oi_cache_invalidate", "reqs");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_XATTR_ABSENT_HIT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "xattr_absent_hit", "reqs");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_XATTR_LIST_LOAD,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "xattr_list_load", "reqs");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
@@ -231,6 +312,10 @@ static int osd_stats_init(struct osd_device *osd)
 #endif
 		result = lprocfs_seq_create(osd->od_proc_entry, "brw_stats",
 					    0644, &osd_brw_stats_fops, osd);
+		if (result == 0 && osd->od_is_ost)
+			result = lprocfs_seq_create(osd->od_proc_entry,
+						    "extent_stats", 0644,
+						    &osd_extent_stats_fops, osd);
         } else
                 result = -ENOMEM;
 
@@ -478,6 +563,42 @@ ldiskfs_osd_full_scrub_threshold_rate_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ldiskfs_osd_full_scrub_threshold_rate);
 
+static int ldiskfs_osd_scrub_ra_groups_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *dev = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	return seq_printf(m, "%u\n", dev->od_scrub_ra_groups);
+}
+
+static ssize_t
+ldiskfs_osd_scrub_ra_groups_seq_write(struct file *file, const char *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file	  *m = file->private_data;
+	struct dt_device  *dt = m->private;
+	struct osd_device *dev = osd_dt_dev(dt);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 0 || val > OSD_SCRUB_RA_GROUPS_MAX)
+		return -EINVAL;
+
+	dev->od_scrub_ra_groups = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_scrub_ra_groups);
+
 static int
 ldiskfs_osd_track_declares_assert_seq_show(struct seq_file *m, void *data)
 {
@@ -514,6 +635,18 @@ static int ldiskfs_osd_oi_scrub_seq_show(struct seq_file *m, void *data)
 }
 LPROC_SEQ_FOPS_RO(ldiskfs_osd_oi_scrub);
 
+static int ldiskfs_osd_oi_cache_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *dev = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	return osd_oi_cache_dump(m, dev);
+}
+LPROC_SEQ_FOPS_RO(ldiskfs_osd_oi_cache);
+
 static int ldiskfs_osd_readcache_seq_show(struct seq_file *m, void *data)
 {
 	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
@@ -660,8 +793,12 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	  .fops	=	&ldiskfs_osd_full_scrub_ratio_fops	},
 	{ .name	=	"full_scrub_threshold_rate",
 	  .fops	=	&ldiskfs_osd_full_scrub_threshold_rate_fops	},
+	{ .name	=	"scrub_readahead_groups",
+	  .fops	=	&ldiskfs_osd_scrub_ra_groups_fops	},
 	{ .name	=	"oi_scrub",
 	  .fops	=	&ldiskfs_osd_oi_scrub_fops	},
+	{ .name	=	"oi_cache",
+	  .fops	=	&ldiskfs_osd_oi_cache_fops	},
 	{ .name	=	"read_cache_enable",
 	  .fops	=	&ldiskfs_osd_cache_fops		},
 	{ .name	=	"writethrough_cache_enable",
@@ -67,6 +67,11 @@ CFS_MODULE_PARM(osd_oi_count, "i", int, 0444,
                 "Number of Object Index containers to be created, "
                 "it's only valid for new filesystem.");
 
+static unsigned int osd_oi_cache_size = 1 << 18;
+CFS_MODULE_PARM(osd_oi_cache_size, "i", uint, 0444,
+		"Number of FID to inode mappings cached in front of the "
+		"Object Index containers, 0 to disable the cache.");
+
 /** to serialize concurrent OI index initialization */
 static struct mutex oi_init_lock;
 
@@ -101,6 +106,274 @@ static void osd_oi_table_put(struct osd_thread_info *info,
 	}
 }
 
+static int osd_oi_cache_init(struct osd_device *osd)
+{
+	struct osd_oi_cache	*ooc;
+	unsigned int		 nr;
+	int			 rc;
+	int			 i;
+
+	if (osd_oi_cache_size < OSD_OIC_WAYS)
+		return 0;
+
+	OBD_ALLOC_PTR(ooc);
+	if (ooc == NULL)
+		return -ENOMEM;
+
+	nr = size_roundup_power2(osd_oi_cache_size / OSD_OIC_WAYS);
+	ooc->ooc_bits = ilog2(nr);
+	OBD_ALLOC_LARGE(ooc->ooc_sets, nr * sizeof(*ooc->ooc_sets));
+	if (ooc->ooc_sets == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	OBD_ALLOC_LARGE(ooc->ooc_pcpu,
+			nr_cpu_ids * sizeof(*ooc->ooc_pcpu));
+	if (ooc->ooc_pcpu == NULL) {
+		OBD_FREE_LARGE(ooc->ooc_sets, nr * sizeof(*ooc->ooc_sets));
+		GOTO(out, rc = -ENOMEM);
+	}
+
+	for (i = 0; i < nr; i++) {
+		seqcount_init(&ooc->ooc_sets[i].ocs_seq);
+		spin_lock_init(&ooc->ooc_sets[i].ocs_lock);
+	}
+
+	osd->od_oi_cache = ooc;
+	return 0;
+
+out:
+	OBD_FREE_PTR(ooc);
+	return rc;
+}
+
+static void osd_oi_cache_fini(struct osd_device *osd)
+{
+	struct osd_oi_cache *ooc = osd->od_oi_cache;
+
+	if (ooc == NULL)
+		return;
+
+	osd->od_oi_cache = NULL;
+	OBD_FREE_LARGE(ooc->ooc_pcpu,
+		       nr_cpu_ids * sizeof(*ooc->ooc_pcpu));
+	OBD_FREE_LARGE(ooc->ooc_sets,
+		       (1 << ooc->ooc_bits) * sizeof(*ooc->ooc_sets));
+	OBD_FREE_PTR(ooc);
+}
+
+/**
+ * Look \a fid up in the OI cache, the per-CPU front-end first.
+ *
+ * \retval 0		found, \a id is filled
+ * \retval -ENOENT	not cached
+ */
+static int osd_oi_cache_lookup(struct osd_device *osd,
+			       const struct lu_fid *fid,
+			       struct osd_inode_id *id)
+{
+	struct osd_oi_cache		*ooc = osd->od_oi_cache;
+	struct osd_oic_set		*set;
+	struct osd_oic_pcpu_entry	*pe;
+	struct osd_oic_entry		 found;
+	unsigned int			 hash;
+	unsigned int			 seq;
+	int				 i;
+	int				 rc;
+
+	if (ooc == NULL)
+		return -ENOENT;
+
+	hash = fid_hash(fid, ooc->ooc_bits);
+	set = &ooc->ooc_sets[hash];
+	pe = &ooc->ooc_pcpu[get_cpu()].opc_entries[hash &
+						   (OSD_OIC_PCPU_SIZE - 1)];
+	if (lu_fid_eq(&pe->ope_entry.oce_fid, fid) &&
+	    pe->ope_seq == read_seqcount_begin(&set->ocs_seq)) {
+		*id = pe->ope_entry.oce_id;
+		put_cpu();
+		lprocfs_counter_incr(osd->od_stats, LPROC_OSD_OI_CACHE_HIT);
+		return 0;
+	}
+
+	do {
+		rc = -ENOENT;
+		seq = read_seqcount_begin(&set->ocs_seq);
+		for (i = 0; i < OSD_OIC_WAYS; i++) {
+			if (lu_fid_eq(&set->ocs_entries[i].oce_fid, fid)) {
+				found = set->ocs_entries[i];
+				rc = 0;
+				break;
+			}
+		}
+	} while (read_seqcount_retry(&set->ocs_seq, seq));
+
+	if (rc == 0) {
+		/* fid_zero() never matches a sane FID, so a stale copy of
+		 * an invalidated entry can not be returned here */
+		pe->ope_entry = found;
+		pe->ope_seq = seq;
+		*id = found.oce_id;
+	}
+	put_cpu();
+
+	lprocfs_counter_incr(osd->od_stats, rc == 0 ? LPROC_OSD_OI_CACHE_HIT :
+						      LPROC_OSD_OI_CACHE_MISS);
+	return rc;
+}
+
+/**
+ * Sample the generation of the set \a fid belongs to, before looking
+ * \a fid up in the OI file, see osd_oi_cache_fill().
+ */
+static unsigned int osd_oi_cache_gen(struct osd_device *osd,
+				     const struct lu_fid *fid)
+{
+	struct osd_oi_cache	*ooc = osd->od_oi_cache;
+	unsigned int		 gen;
+
+	if (ooc == NULL)
+		return 0;
+
+	gen = ACCESS_ONCE(ooc->ooc_sets[fid_hash(fid, ooc->ooc_bits)].ocs_gen);
+	smp_rmb();
+
+	return gen;
+}
+
+/* Set the mapping \a fid -> \a id in \a set, with ocs_lock held. */
+static void osd_oi_cache_set(struct osd_oic_set *set, const struct lu_fid *fid,
+			     const struct osd_inode_id *id)
+{
+	struct osd_oic_entry	*entry = NULL;
+	int			 i;
+
+	for (i = 0; i < OSD_OIC_WAYS; i++) {
+		if (lu_fid_eq(&set->ocs_entries[i].oce_fid, fid)) {
+			entry = &set->ocs_entries[i];
+			break;
+		}
+
+		if (entry == NULL && fid_is_zero(&set->ocs_entries[i].oce_fid))
+			entry = &set->ocs_entries[i];
+	}
+
+	if (entry == NULL)
+		entry = &set->ocs_entries[set->ocs_victim++ % OSD_OIC_WAYS];
+
+	write_seqcount_begin(&set->ocs_seq);
+	entry->oce_fid = *fid;
+	entry->oce_id = *id;
+	write_seqcount_end(&set->ocs_seq);
+}
+
+/**
+ * Cache the mapping \a fid -> \a id just read from the OI file, unless
+ * the set has been changed since \a gen was sampled by osd_oi_cache_gen(),
+ * in which case the mapping may be stale already.
+ */
+static void osd_oi_cache_fill(struct osd_device *osd, const struct lu_fid *fid,
+			      const struct osd_inode_id *id, unsigned int gen)
+{
+	struct osd_oi_cache	*ooc = osd->od_oi_cache;
+	struct osd_oic_set	*set;
+
+	if (ooc == NULL)
+		return;
+
+	set = &ooc->ooc_sets[fid_hash(fid, ooc->ooc_bits)];
+	spin_lock(&set->ocs_lock);
+	if (set->ocs_gen == gen)
+		osd_oi_cache_set(set, fid, id);
+	spin_unlock(&set->ocs_lock);
+}
+
+/**
+ * Add or refresh the cached mapping \a fid -> \a id, after the OI file
+ * has been changed.
+ */
+void osd_oi_cache_insert(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id)
+{
+	struct osd_oi_cache	*ooc = osd->od_oi_cache;
+	struct osd_oic_set	*set;
+
+	if (ooc == NULL)
+		return;
+
+	set = &ooc->ooc_sets[fid_hash(fid, ooc->ooc_bits)];
+	spin_lock(&set->ocs_lock);
+	set->ocs_gen++;
+	osd_oi_cache_set(set, fid, id);
+	spin_unlock(&set->ocs_lock);
+}
+
+/**
+ * Drop the cached mapping for \a fid, if any, after the OI file has been
+ * changed.
+ *
+ * Bumping the set sequence also invalidates all the per-CPU copies, and
+ * bumping the set generation prevents the lookups started before from
+ * caching what they have read.
+ */
+void osd_oi_cache_delete(struct osd_device *osd, const struct lu_fid *fid)
+{
+	struct osd_oi_cache	*ooc = osd->od_oi_cache;
+	struct osd_oic_set	*set;
+	int			 i;
+
+	if (ooc == NULL)
+		return;
+
+	set = &ooc->ooc_sets[fid_hash(fid, ooc->ooc_bits)];
+	spin_lock(&set->ocs_lock);
+	set->ocs_gen++;
+	for (i = 0; i < OSD_OIC_WAYS; i++) {
+		if (lu_fid_eq(&set->ocs_entries[i].oce_fid, fid)) {
+			write_seqcount_begin(&set->ocs_seq);
+			fid_zero(&set->ocs_entries[i].oce_fid);
+			write_seqcount_end(&set->ocs_seq);
+			lprocfs_counter_incr(osd->od_stats,
+					     LPROC_OSD_OI_CACHE_INVALIDATE);
+			break;
+		}
+	}
+	spin_unlock(&set->ocs_lock);
+}
+
+int osd_oi_cache_dump(struct seq_file *m, struct osd_device *osd)
+{
+	struct osd_oi_cache	*ooc = osd->od_oi_cache;
+	__u64			 hit = 0;
+	__u64			 miss = 0;
+	__u64			 inval = 0;
+
+	if (ooc == NULL)
+		return seq_printf(m, "status: disabled\n");
+
+	if (osd->od_stats != NULL) {
+		hit = lprocfs_stats_collector(osd->od_stats,
+					      LPROC_OSD_OI_CACHE_HIT,
+					      LPROCFS_FIELDS_FLAGS_COUNT);
+		miss = lprocfs_stats_collector(osd->od_stats,
+					       LPROC_OSD_OI_CACHE_MISS,
+					       LPROCFS_FIELDS_FLAGS_COUNT);
+		inval = lprocfs_stats_collector(osd->od_stats,
+					LPROC_OSD_OI_CACHE_INVALIDATE,
+					LPROCFS_FIELDS_FLAGS_COUNT);
+	}
+
+	return seq_printf(m, "status: enabled\n"
+			  "entries: %u\n"
+			  "ways: %u\n"
+			  "hits: "LPU64"\n"
+			  "misses: "LPU64"\n"
+			  "invalidations: "LPU64"\n"
+			  "hit_rate: "LPU64"%%\n",
+			  (1 << ooc->ooc_bits) * OSD_OIC_WAYS, OSD_OIC_WAYS,
+			  hit, miss, inval,
+			  hit + miss != 0 ? hit * 100 / (hit + miss) : 0);
+}
+
 static int osd_oi_index_create_one(struct osd_thread_info *info,
 				   struct osd_device *osd, const char *name,
 				   struct dt_index_features *feat)
@@ -437,12 +710,23 @@ out:
 		}
 	}
 
+	if (rc == 0) {
+		rc = osd_oi_cache_init(osd);
+		if (rc < 0) {
+			osd_oi_table_put(info, oi, osd->od_oi_count);
+			OBD_FREE(oi, sizeof(*oi) * OSD_OI_FID_NR_MAX);
+			osd->od_oi_table = NULL;
+		}
+	}
+
 	mutex_unlock(&oi_init_lock);
 	return rc;
 }
 
 void osd_oi_fini(struct osd_thread_info *info, struct osd_device *osd)
 {
+	osd_oi_cache_fini(osd);
+
 	if (unlikely(osd->od_oi_table == NULL))
 		return;
 
@@ -529,18 +813,27 @@ int fid_is_on_ost(struct osd_thread_info *info, struct osd_device *osd,
 }
 
 static int __osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
-			   const struct lu_fid *fid, struct osd_inode_id *id)
+			   const struct lu_fid *fid, struct osd_inode_id *id,
+			   enum oi_check_flags flags)
 {
 	struct lu_fid *oi_fid = &info->oti_fid2;
+	unsigned int   gen;
 	int	       rc;
 
+	if (!(flags & OI_SKIP_CACHE) &&
+	    osd_oi_cache_lookup(osd, fid, id) == 0)
+		return 0;
+
+	gen = osd_oi_cache_gen(osd, fid);
 	fid_cpu_to_be(oi_fid, fid);
 	rc = osd_oi_iam_lookup(info, osd_fid2oi(osd, fid), (struct dt_rec *)id,
 			       (const struct dt_key *)oi_fid);
 	if (rc > 0) {
 		osd_id_unpack(id, id);
+		osd_oi_cache_fill(osd, fid, id, gen);
 		rc = 0;
 	} else if (rc == 0) {
+		osd_oi_cache_delete(osd, fid);
 		rc = -ENOENT;
 	}
 	return rc;
@@ -568,7 +861,7 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 			return osd_acct_obj_lookup(info, osd, fid, id);
 
 		/* For other special FIDs, try OI first, then do spec lookup */
-		rc = __osd_oi_lookup(info, osd, fid, id);
+		rc = __osd_oi_lookup(info, osd, fid, id, flags);
 		if (rc == -ENOENT)
 			return osd_obj_spec_lookup(info, osd, fid, id);
 		return rc;
@@ -579,7 +872,7 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		return 0;
 	}
 
-	return __osd_oi_lookup(info, osd, fid, id);
+	return __osd_oi_lookup(info, osd, fid, id, flags);
 }
 
 static int osd_oi_iam_refresh(struct osd_thread_info *oti, struct osd_oi *oi,
@@ -639,7 +932,7 @@ int osd_oi_insert(struct osd_thread_info *info, struct osd_device *osd,
 		if (rc != -EEXIST)
 			return rc;
 
-		rc = osd_oi_lookup(info, osd, fid, oi_id, 0);
+		rc = osd_oi_lookup(info, osd, fid, oi_id, OI_SKIP_CACHE);
 		if (rc != 0)
 			return rc;
 
@@ -678,15 +971,66 @@ update:
 		rc = osd_oi_iam_refresh(info, osd_fid2oi(osd, fid),
 					(const struct dt_rec *)oi_id,
 					(const struct dt_key *)oi_fid, th, false);
-		if (rc != 0)
+		if (rc != 0) {
+			osd_oi_cache_delete(osd, fid);
 			return rc;
+		}
 	}
 
+	osd_oi_cache_insert(osd, fid, id);
 	if (unlikely(fid_seq(fid) == FID_SEQ_LOCAL_FILE))
 		rc = osd_obj_spec_insert(info, osd, fid, id, th);
 	return rc;
 }
 
+/**
+ * Insert a batch of OI mappings into the OI container \a idx within the
+ * transaction \a th. Keys (big-endian FIDs) must be sorted in ascending order
+ * and belong to normal FIDs mapped by that container; records are packed
+ * inode ids. The per-record result is returned in ibr_rc, and a record that
+ * failed with -EEXIST is expected to be retried through osd_oi_insert(), which
+ * knows how to resolve conflicting mappings.
+ *
+ * \retval   0, all the records were processed
+ * \retval -ve, on error, the remaining records were not processed
+ */
+int osd_oi_insert_batch(struct osd_thread_info *info, struct osd_device *osd,
+			int idx, struct iam_batch_rec *recs, int nr,
+			handle_t *th)
+{
+	struct osd_oi		*oi	= osd->od_oi_table[idx];
+	struct lu_fid		*fid	= &info->oti_fid2;
+	struct osd_inode_id	*id	= &info->oti_id2;
+	struct iam_container	*bag;
+	struct iam_path_descr	*ipd;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	LASSERT(oi != NULL);
+	LASSERT(oi->oi_inode != NULL);
+	LASSERT(th != NULL);
+	ll_vfs_dq_init(oi->oi_inode);
+
+	bag = &oi->oi_dir.od_container;
+	ipd = osd_idx_ipd_get(info->oti_env, bag);
+	if (unlikely(ipd == NULL))
+		RETURN(-ENOMEM);
+
+	rc = iam_insert_sorted(th, bag, recs, nr, ipd);
+	osd_ipd_put(info->oti_env, bag, ipd);
+
+	for (i = 0; i < nr; i++) {
+		if (recs[i].ibr_rc != 0)
+			continue;
+
+		fid_be_to_cpu(fid, (const struct lu_fid *)recs[i].ibr_key);
+		osd_id_unpack(id, (const struct osd_inode_id *)recs[i].ibr_rec);
+		osd_oi_cache_insert(osd, fid, id);
+	}
+	RETURN(rc);
+}
+
 static int osd_oi_iam_delete(struct osd_thread_info *oti, struct osd_oi *oi,
 			     const struct dt_key *key, handle_t *th)
 {
@@ -718,6 +1062,7 @@ int osd_oi_delete(struct osd_thread_info *info,
 		  handle_t *th, enum oi_check_flags flags)
 {
 	struct lu_fid *oi_fid = &info->oti_fid2;
+	int	       rc;
 
 	/* clear idmap cache */
 	if (lu_fid_eq(fid, &info->oti_cache.oic_fid))
@@ -730,8 +1075,11 @@ int osd_oi_delete(struct osd_thread_info *info,
 		return osd_obj_map_delete(info, osd, fid, th);
 
 	fid_cpu_to_be(oi_fid, fid);
-	return osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
-				 (const struct dt_key *)oi_fid, th);
+	rc = osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
+			       (const struct dt_key *)oi_fid, th);
+	osd_oi_cache_delete(osd, fid);
+
+	return rc;
 }
 
 int osd_oi_update(struct osd_thread_info *info, struct osd_device *osd,
@@ -753,9 +1101,12 @@ int osd_oi_update(struct osd_thread_info *info, struct osd_device *osd,
 	rc = osd_oi_iam_refresh(info, osd_fid2oi(osd, fid),
 			       (const struct dt_rec *)oi_id,
 			       (const struct dt_key *)oi_fid, th, false);
-	if (rc != 0)
+	if (rc != 0) {
+		osd_oi_cache_delete(osd, fid);
 		return rc;
+	}
 
+	osd_oi_cache_insert(osd, fid, id);
 	if (unlikely(fid_seq(fid) == FID_SEQ_LOCAL_FILE))
 		rc = osd_obj_spec_update(info, osd, fid, id, th);
 	return rc;
@@ -52,6 +52,7 @@
 
 /* struct rw_semaphore */
 #include <linux/rwsem.h>
+#include <linux/seqlock.h>
 #include <linux/jbd2.h>
 #include <lustre_fid.h>
 #include <lu_object.h>
@@ -65,10 +66,12 @@
 struct lu_fid;
 struct osd_thread_info;
 struct lu_site;
+struct seq_file;
 
 struct dt_device;
 struct osd_device;
 struct osd_oi;
+struct iam_batch_rec;
 
 /*
  * Storage cookie. Datum uniquely identifying inode on the underlying file
@@ -134,6 +137,56 @@ static inline int osd_id_eq_strict(const struct osd_inode_id *id0,
 enum oi_check_flags {
 	OI_CHECK_FLD	= 0x00000001,
 	OI_KNOWN_ON_OST	= 0x00000002,
+	/* bypass the OI lookup cache, verify against the OI files */
+	OI_SKIP_CACHE	= 0x00000004,
+};
+
+/*
+ * OI lookup cache.
+ *
+ * Memory-bounded FID -> ino/gen cache in front of the IAM based OI files,
+ * it shadows the OI mappings inserted, updated and looked up through the
+ * osd_oi_*() interfaces. The cache is OSD_OIC_WAYS-way set associative:
+ * readers walk a set locklessly under its seqcount, writers serialize on
+ * the set spinlock. A small per-CPU direct mapped front-end remembers the
+ * most recent hits; its entries are tagged with the sequence of the set
+ * they were copied from and are only valid while that set is unchanged.
+ *
+ * The OI modifications invalidate the cache after the OI file has been
+ * changed, and bump the set generation; a mapping read from the OI file
+ * is only cached if the generation is the same as before the OI lookup,
+ * so a racing lookup can not cache the stale mapping.
+ */
+#define OSD_OIC_WAYS		4
+#define OSD_OIC_PCPU_BITS	6
+#define OSD_OIC_PCPU_SIZE	(1 << OSD_OIC_PCPU_BITS)
+
+struct osd_oic_entry {
+	struct lu_fid		oce_fid;
+	struct osd_inode_id	oce_id;
+};
+
+struct osd_oic_set {
+	seqcount_t		ocs_seq;
+	spinlock_t		ocs_lock;
+	unsigned int		ocs_victim;
+	unsigned int		ocs_gen;
+	struct osd_oic_entry	ocs_entries[OSD_OIC_WAYS];
+};
+
+struct osd_oic_pcpu_entry {
+	struct osd_oic_entry	ope_entry;
+	unsigned int		ope_seq;
+};
+
+struct osd_oic_pcpu {
+	struct osd_oic_pcpu_entry opc_entries[OSD_OIC_PCPU_SIZE];
+};
+
+struct osd_oi_cache {
+	struct osd_oic_set	*ooc_sets;
+	struct osd_oic_pcpu	*ooc_pcpu;
+	unsigned int		 ooc_bits;
 };
 
 int osd_oi_mod_init(void);
@@ -145,6 +198,9 @@ int  osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 int  osd_oi_insert(struct osd_thread_info *info, struct osd_device *osd,
 		   const struct lu_fid *fid, const struct osd_inode_id *id,
 		   handle_t *th, enum oi_check_flags flags);
+int  osd_oi_insert_batch(struct osd_thread_info *info, struct osd_device *osd,
+			 int idx, struct iam_batch_rec *recs, int nr,
+			 handle_t *th);
 int  osd_oi_delete(struct osd_thread_info *info,
 		   struct osd_device *osd, const struct lu_fid *fid,
 		   handle_t *th, enum oi_check_flags flags);
@@ -154,4 +210,9 @@ int  osd_oi_update(struct osd_thread_info *info, struct osd_device *osd,
 
 int fid_is_on_ost(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid, enum oi_check_flags flags);
+
+void osd_oi_cache_insert(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id);
+void osd_oi_cache_delete(struct osd_device *osd, const struct lu_fid *fid);
+int osd_oi_cache_dump(struct seq_file *m, struct osd_device *osd);
 #endif /* _OSD_OI_H */
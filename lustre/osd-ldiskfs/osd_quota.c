@@ -77,6 +77,11 @@ int osd_acct_obj_lookup(struct osd_thread_info *info, struct osd_device *osd,
 					   LDISKFS_FEATURE_RO_COMPAT_QUOTA))
 		RETURN(-ENOENT);
 
+	/* ldiskfs has no project quota inode, project usage can't be
+	 * tracked until the inode project ID is supported */
+	if (fid_oid(fid) == ACCT_PROJECT_OID)
+		RETURN(-ENOENT);
+
 	id->oii_gen = OSD_OII_NOGEN;
 	id->oii_ino = qf_inums[fid2type(fid)];
 	if (!ldiskfs_valid_inum(sb, id->oii_ino))
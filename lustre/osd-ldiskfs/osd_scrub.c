@@ -41,6 +41,7 @@
 #include <lustre_disk.h>
 #include <dt_object.h>
 #include <linux/xattr.h>
+#include <linux/sort.h>
 
 #include "osd_internal.h"
 #include "osd_oi.h"
@@ -185,6 +186,154 @@ static int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 	RETURN(rc);
 }
 
+/* Batched rebuild of OI files */
+
+#define OSD_SCRUB_OI_BATCH	32
+
+struct osd_scrub_oi_item {
+	struct lu_fid		 osi_key;	/* big-endian, the OI key */
+	struct osd_inode_id	 osi_rec;	/* packed, the OI record */
+	struct lu_fid		 osi_fid;
+	struct osd_inode_id	 osi_id;
+	struct inode		*osi_inode;
+};
+
+struct osd_scrub_oi_batch {
+	int			 osb_count;
+	/* OI container all the items in the batch are mapped by */
+	int			 osb_idx;
+	struct osd_scrub_oi_item osb_items[OSD_SCRUB_OI_BATCH];
+	struct iam_batch_rec	 osb_recs[OSD_SCRUB_OI_BATCH];
+};
+
+static int osd_scrub_oi_item_cmp(const void *a, const void *b)
+{
+	const struct osd_scrub_oi_item *i1 = a;
+	const struct osd_scrub_oi_item *i2 = b;
+
+	/* the same order as IAM lfix keys in OI files */
+	return memcmp(&i1->osi_key, &i2->osi_key, sizeof(i1->osi_key));
+}
+
+/**
+ * Insert the pending OI mappings into the OI file in FID order within one
+ * transaction, so that each touched OI leaf is looked up and journalled once
+ * per batch instead of once per mapping. Mappings which cannot be inserted in
+ * batch (conflicting with some existing mapping, or because of failure) are
+ * handled one by one via the osd_scrub_refresh_mapping().
+ *
+ * Called with os_rwsem held for write.
+ */
+static int osd_scrub_oi_batch_flush(struct osd_thread_info *info,
+				    struct osd_device *dev)
+{
+	struct osd_scrub	  *scrub = &dev->od_scrub;
+	struct scrub_file	  *sf	 = &scrub->os_file;
+	struct osd_scrub_oi_batch *osb	 = scrub->os_oi_batch;
+	handle_t		  *th;
+	int			   result = 0;
+	int			   rc;
+	int			   i;
+	ENTRY;
+
+	if (osb == NULL || osb->osb_count == 0)
+		RETURN(0);
+
+	sort(osb->osb_items, osb->osb_count, sizeof(osb->osb_items[0]),
+	     osd_scrub_oi_item_cmp, NULL);
+	for (i = 0; i < osb->osb_count; i++) {
+		osb->osb_recs[i].ibr_key =
+			(const struct iam_key *)&osb->osb_items[i].osi_key;
+		osb->osb_recs[i].ibr_rec =
+			(const struct iam_rec *)&osb->osb_items[i].osi_rec;
+		osb->osb_recs[i].ibr_rc = -EAGAIN;
+	}
+
+	th = osd_journal_start_sb(osd_sb(dev), LDISKFS_HT_MISC,
+			osd_dto_credits_noquota[DTO_INDEX_INSERT] *
+			osb->osb_count);
+	if (!IS_ERR(th)) {
+		rc = osd_oi_insert_batch(info, dev, osb->osb_idx,
+					 osb->osb_recs, osb->osb_count, th);
+		ldiskfs_journal_stop(th);
+	} else {
+		rc = PTR_ERR(th);
+	}
+	if (rc != 0)
+		CDEBUG(D_LFSCK, "%s: fail to insert %d OI mappings into OI "
+		       "file %d in batch: rc = %d\n", osd_name(dev),
+		       osb->osb_count, osb->osb_idx, rc);
+
+	for (i = 0; i < osb->osb_count; i++) {
+		struct osd_scrub_oi_item *item = &osb->osb_items[i];
+
+		rc = osb->osb_recs[i].ibr_rc;
+		if (rc != 0)
+			rc = osd_scrub_refresh_mapping(info, dev,
+						       &item->osi_fid,
+						       &item->osi_id,
+						       DTO_INDEX_INSERT,
+						       false, 0);
+		if (rc == 0) {
+			sf->sf_items_updated++;
+		} else if (rc < 0) {
+			sf->sf_items_failed++;
+			if (sf->sf_pos_first_inconsistent == 0 ||
+			    sf->sf_pos_first_inconsistent >
+			    item->osi_id.oii_ino)
+				sf->sf_pos_first_inconsistent =
+					item->osi_id.oii_ino;
+			if (result == 0)
+				result = rc;
+		}
+
+		/* There may be conflict unlink during the OI scrub,
+		 * if happend, then remove the new added OI mapping. */
+		if (unlikely(item->osi_inode->i_nlink == 0))
+			osd_scrub_refresh_mapping(info, dev, &item->osi_fid,
+						  &item->osi_id,
+						  DTO_INDEX_DELETE, false, 0);
+		iput(item->osi_inode);
+		item->osi_inode = NULL;
+	}
+	osb->osb_count = 0;
+
+	RETURN(sf->sf_param & SP_FAILOUT ? result : 0);
+}
+
+/**
+ * Queue the OI mapping (@fid @id) for the batched insert into the OI file
+ * \a idx, the reference on \a inode is transferred to the batch.
+ *
+ * Called with os_rwsem held for write.
+ */
+static int osd_scrub_oi_batch_add(struct osd_thread_info *info,
+				  struct osd_device *dev,
+				  const struct lu_fid *fid,
+				  const struct osd_inode_id *id,
+				  struct inode *inode, int idx)
+{
+	struct osd_scrub_oi_batch *osb = dev->od_scrub.os_oi_batch;
+	struct osd_scrub_oi_item  *item;
+	int			   rc;
+
+	if (osb->osb_count == OSD_SCRUB_OI_BATCH ||
+	    (osb->osb_count > 0 && osb->osb_idx != idx)) {
+		rc = osd_scrub_oi_batch_flush(info, dev);
+		if (rc != 0)
+			return rc;
+	}
+
+	item = &osb->osb_items[osb->osb_count++];
+	item->osi_fid = *fid;
+	item->osi_id = *id;
+	fid_cpu_to_be(&item->osi_key, fid);
+	osd_id_pack(&item->osi_rec, id);
+	item->osi_inode = inode;
+	osb->osb_idx = idx;
+	return 0;
+}
+
 /* OI_scrub file ops */
 
 static void osd_scrub_file_to_cpu(struct scrub_file *des,
@@ -517,7 +666,8 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 
 	rc = osd_oi_lookup(info, dev, fid, lid2,
 		(val == SCRUB_NEXT_OSTOBJ ||
-		 val == SCRUB_NEXT_OSTOBJ_OLD) ? OI_KNOWN_ON_OST : 0);
+		 val == SCRUB_NEXT_OSTOBJ_OLD) ? OI_KNOWN_ON_OST :
+						 OI_SKIP_CACHE);
 	if (rc != 0) {
 		if (rc == -ENOENT)
 			ops = DTO_INDEX_INSERT;
@@ -588,6 +738,16 @@ iget:
 		dev->od_igif_inoi = 1;
 	}
 
+	/* Rebuilding the OI file, insert the mapping in batch. */
+	if (ops == DTO_INDEX_INSERT && val == 0 && oii == NULL &&
+	    scrub->os_oi_batch != NULL && scrub->os_full_speed &&
+	    !scrub->os_partial_scan && !(sf->sf_param & SP_DRYRUN)) {
+		rc = osd_scrub_oi_batch_add(info, dev, fid, lid, inode, idx);
+		if (rc == 0)
+			inode = NULL;
+		GOTO(out, rc);
+	}
+
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops, false,
 			(val == SCRUB_NEXT_OSTOBJ ||
 			 val == SCRUB_NEXT_OSTOBJ_OLD) ? OI_KNOWN_ON_OST : 0);
@@ -692,6 +852,10 @@ static int osd_scrub_prep(struct osd_device *dev)
 	scrub->os_full_scrub = 0;
 	spin_unlock(&scrub->os_lock);
 	scrub->os_new_checked = 0;
+	scrub->os_ra_next = 0;
+	scrub->os_ra_groups = 0;
+	scrub->os_ra_hit = 0;
+	scrub->os_ra_miss = 0;
 	if (drop_dryrun && sf->sf_pos_first_inconsistent != 0)
 		sf->sf_pos_latest_start = sf->sf_pos_first_inconsistent;
 	else if (sf->sf_pos_last_checkpoint != 0)
@@ -716,7 +880,8 @@ static int osd_scrub_prep(struct osd_device *dev)
 	RETURN(rc);
 }
 
-static int osd_scrub_checkpoint(struct osd_scrub *scrub)
+static int osd_scrub_checkpoint(struct osd_thread_info *info,
+				struct osd_scrub *scrub)
 {
 	struct scrub_file *sf = &scrub->os_file;
 	int		   rc;
@@ -727,6 +892,8 @@ static int osd_scrub_checkpoint(struct osd_scrub *scrub)
 		return 0;
 
 	down_write(&scrub->os_rwsem);
+	/* The checkpoint position must not pass the pending OI mappings. */
+	osd_scrub_oi_batch_flush(info, osd_scrub2dev(scrub));
 	sf->sf_items_checked += scrub->os_new_checked;
 	scrub->os_new_checked = 0;
 	sf->sf_pos_last_checkpoint = scrub->os_pos_current;
@@ -795,6 +962,7 @@ struct osd_iit_param {
 	ldiskfs_group_t bg;
 	__u32 gbase;
 	__u32 offset;
+	__u32 *ra_next;
 };
 
 typedef int (*osd_iit_next_policy)(struct osd_thread_info *info,
@@ -822,6 +990,167 @@ static int osd_iit_next(struct osd_iit_param *param, __u32 *pos)
 	}
 }
 
+static __u64 osd_scrub_inode_bitmap(struct super_block *sb,
+				    struct ldiskfs_group_desc *desc)
+{
+	__u64 block = le32_to_cpu(desc->bg_inode_bitmap_lo);
+
+	if (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT)
+		block |= (__u64)le32_to_cpu(desc->bg_inode_bitmap_hi) << 32;
+
+	return block;
+}
+
+static __u64 osd_scrub_inode_table(struct super_block *sb,
+				   struct ldiskfs_group_desc *desc)
+{
+	__u64 block = le32_to_cpu(desc->bg_inode_table_lo);
+
+	if (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT)
+		block |= (__u64)le32_to_cpu(desc->bg_inode_table_hi) << 32;
+
+	return block;
+}
+
+/* bg_itable_unused and LDISKFS_BG_INODE_UNINIT are only maintained, and
+ * covered by the group descriptor checksum, with the uninit_bg or the
+ * metadata_csum feature, as ext4_has_group_desc_csum() checks. */
+static inline bool osd_scrub_has_gdt_csum(struct super_block *sb)
+{
+	if (LDISKFS_HAS_RO_COMPAT_FEATURE(sb,
+					  LDISKFS_FEATURE_RO_COMPAT_GDT_CSUM))
+		return true;
+
+#ifdef LDISKFS_FEATURE_RO_COMPAT_METADATA_CSUM
+	if (LDISKFS_HAS_RO_COMPAT_FEATURE(sb,
+				LDISKFS_FEATURE_RO_COMPAT_METADATA_CSUM))
+		return true;
+#endif
+
+	return false;
+}
+
+/* Whether the group's inode table has never been initialized. */
+static inline bool osd_scrub_group_uninit(struct super_block *sb,
+					  struct ldiskfs_group_desc *desc)
+{
+	return osd_scrub_has_gdt_csum(sb) &&
+	       desc->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT);
+}
+
+/* How many inodes at the head of the group's inode table may be in use,
+ * the others have never been initialized. */
+static inline __u32 osd_scrub_group_used(struct super_block *sb,
+					 struct ldiskfs_group_desc *desc)
+{
+	__u32 unused;
+
+	if (!osd_scrub_has_gdt_csum(sb))
+		return LDISKFS_INODES_PER_GROUP(sb);
+
+	unused = ldiskfs_itable_unused_count(sb, desc);
+	if (unused >= LDISKFS_INODES_PER_GROUP(sb))
+		return 0;
+
+	return LDISKFS_INODES_PER_GROUP(sb) - unused;
+}
+
+static inline bool osd_scrub_block_cached(struct super_block *sb, __u64 block)
+{
+	struct buffer_head *bh = sb_find_get_block(sb, block);
+	bool cached = bh != NULL && buffer_uptodate(bh);
+
+	brelse(bh);
+	return cached;
+}
+
+/**
+ * Read ahead the inode bitmaps and the in-use part of the inode tables
+ * for the block groups in the window after the current one.
+ *
+ * The reads are submitted asynchronously, the iteration will find them
+ * in the buffer cache when it reaches such groups. The groups without
+ * any initialized inode are skipped. With flex_bg, the inode tables of
+ * neighbouring groups are adjacent, so the block layer can merge them.
+ */
+static void osd_scrub_readahead(struct osd_device *dev,
+				struct osd_iit_param *param)
+{
+	struct osd_scrub	  *scrub   = &dev->od_scrub;
+	struct super_block	  *sb	   = param->sb;
+	struct ldiskfs_group_desc *desc;
+	__u32			   window  = dev->od_scrub_ra_groups;
+	__u32			   ngroups = LDISKFS_SB(sb)->s_groups_count;
+	__u32			   end;
+	__u32			   bg;
+	__u32			   used;
+	__u64			   blocks;
+	__u64			   start;
+	__u64			   i;
+	int			   count   = 0;
+
+	if (window == 0)
+		return;
+
+	end = param->bg + window + 1;
+	if (end > ngroups)
+		end = ngroups;
+
+	/* The iteration restarted from some other position. */
+	if (*param->ra_next < param->bg || *param->ra_next > end)
+		*param->ra_next = param->bg;
+
+	for (bg = *param->ra_next; bg < end; bg++) {
+		desc = ldiskfs_get_group_desc(sb, bg, NULL);
+		if (desc == NULL)
+			break;
+
+		if (osd_scrub_group_uninit(sb, desc))
+			continue;
+
+		used = osd_scrub_group_used(sb, desc);
+		if (used == 0)
+			continue;
+
+		sb_breadahead(sb, osd_scrub_inode_bitmap(sb, desc));
+
+		blocks = ((__u64)used * LDISKFS_INODE_SIZE(sb) +
+			  sb->s_blocksize - 1) >> sb->s_blocksize_bits;
+		start = osd_scrub_inode_table(sb, desc);
+		for (i = 0; i < blocks; i++)
+			sb_breadahead(sb, start + i);
+		count++;
+	}
+	*param->ra_next = bg;
+
+	if (count > 0) {
+		spin_lock(&scrub->os_lock);
+		scrub->os_ra_groups += count;
+		spin_unlock(&scrub->os_lock);
+	}
+}
+
+/* Whether the current group's inode bitmap and the head of its inode
+ * table have been cached when the iteration reaches it. */
+static void osd_scrub_ra_account(struct osd_device *dev,
+				 struct osd_iit_param *param,
+				 struct ldiskfs_group_desc *desc)
+{
+	struct osd_scrub   *scrub = &dev->od_scrub;
+	struct super_block *sb	  = param->sb;
+	bool		    hit;
+
+	hit = osd_scrub_block_cached(sb, osd_scrub_inode_bitmap(sb, desc)) &&
+	      osd_scrub_block_cached(sb, osd_scrub_inode_table(sb, desc));
+
+	spin_lock(&scrub->os_lock);
+	if (hit)
+		scrub->os_ra_hit++;
+	else
+		scrub->os_ra_miss++;
+	spin_unlock(&scrub->os_lock);
+}
+
 /**
  * \retval SCRUB_NEXT_OSTOBJ_OLD: FID-on-OST
  * \retval 0: FID-on-MDT
@@ -1103,7 +1432,7 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 	if (rc != 0)
 		return rc;
 
-	rc = osd_scrub_checkpoint(scrub);
+	rc = osd_scrub_checkpoint(info, scrub);
 	if (rc != 0) {
 		CDEBUG(D_LFSCK, "%.16s: fail to checkpoint, pos = %u: "
 		       "rc = %d\n", osd_scrub2name(scrub),
@@ -1344,6 +1673,7 @@ full:
 		exec = osd_scrub_exec;
 		pos = &scrub->os_pos_current;
 		count = &scrub->os_new_checked;
+		param.ra_next = &scrub->os_ra_next;
 	} else {
 		struct osd_otable_cache *ooc = &dev->od_otable_it->ooi_cache;
 
@@ -1351,6 +1681,7 @@ full:
 		exec = osd_preload_exec;
 		pos = &ooc->ooc_pos_preload;
 		count = &ooc->ooc_cached_items;
+		param.ra_next = &ooc->ooc_ra_next;
 	}
 	limit = le32_to_cpu(LDISKFS_SB(param.sb)->s_es->s_inodes_count);
 
@@ -1363,8 +1694,12 @@ full:
 		if (desc == NULL)
 			RETURN(-EIO);
 
+		param.offset = (*pos - 1) % LDISKFS_INODES_PER_GROUP(param.sb);
 		ldiskfs_lock_group(param.sb, param.bg);
-		if (desc->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT)) {
+		/* Skip the group without any initialized inode after the
+		 * position, the bitmap is not needed for that. */
+		if (osd_scrub_group_uninit(param.sb, desc) ||
+		    param.offset >= osd_scrub_group_used(param.sb, desc)) {
 			ldiskfs_unlock_group(param.sb, param.bg);
 			*pos = 1 + (param.bg + 1) *
 				LDISKFS_INODES_PER_GROUP(param.sb);
@@ -1372,7 +1707,8 @@ full:
 		}
 		ldiskfs_unlock_group(param.sb, param.bg);
 
-		param.offset = (*pos - 1) % LDISKFS_INODES_PER_GROUP(param.sb);
+		osd_scrub_readahead(dev, &param);
+		osd_scrub_ra_account(dev, &param, desc);
 		param.gbase = 1 + param.bg * LDISKFS_INODES_PER_GROUP(param.sb);
 		param.bitmap = ldiskfs_read_inode_bitmap(param.sb, param.bg);
 		if (param.bitmap == NULL) {
@@ -1467,6 +1803,9 @@ static int osd_scrub_main(void *args)
 		GOTO(out, rc);
 	}
 
+	/* Not fatal, the OI mappings will be inserted one by one. */
+	OBD_ALLOC_PTR(scrub->os_oi_batch);
+
 	if (!scrub->os_full_speed && !scrub->os_partial_scan) {
 		struct l_wait_info lwi = { 0 };
 		struct osd_otable_it *it = dev->od_otable_it;
@@ -1491,6 +1830,9 @@ static int osd_scrub_main(void *args)
 	GOTO(post, rc);
 
 post:
+	down_write(&scrub->os_rwsem);
+	osd_scrub_oi_batch_flush(osd_oti_get(&env), dev);
+	up_write(&scrub->os_rwsem);
 	osd_scrub_post(scrub, rc);
 	CDEBUG(D_LFSCK, "%.16s: OI scrub: stop, pos = %u: rc = %d\n",
 	       osd_scrub2name(scrub), scrub->os_pos_current, rc);
@@ -1504,6 +1846,15 @@ out:
 		list_del_init(&oii->oii_list);
 		OBD_FREE_PTR(oii);
 	}
+	if (scrub->os_oi_batch != NULL) {
+		struct osd_scrub_oi_batch *osb = scrub->os_oi_batch;
+
+		/* Simulated crash, drop the pending OI mappings. */
+		while (osb->osb_count > 0)
+			iput(osb->osb_items[--osb->osb_count].osi_inode);
+		OBD_FREE_PTR(scrub->os_oi_batch);
+		scrub->os_oi_batch = NULL;
+	}
 	lu_env_fini(&env);
 
 noenv:
@@ -1777,7 +2128,7 @@ osd_ios_scan_one(struct osd_thread_info *info, struct osd_device *dev,
 		tfid = lma->lma_self_fid;
 	}
 
-	rc = osd_oi_lookup(info, dev, &tfid, id2, 0);
+	rc = osd_oi_lookup(info, dev, &tfid, id2, OI_SKIP_CACHE);
 	if (rc != 0) {
 		if (rc != -ENOENT)
 			RETURN(rc);
@@ -2926,6 +3277,8 @@ int osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 	struct scrub_file *sf      = &scrub->os_file;
 	__u64		   checked;
 	__u64		   speed;
+	__u64		   ra_rate;
+	__u64		   ra_total;
 	int		   rc;
 
 	down_read(&scrub->os_rwsem);
@@ -3028,6 +3381,20 @@ int osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 			      sf->sf_run_time, speed, scrub->os_lf_scanned,
 			      scrub->os_lf_repaired, scrub->os_lf_failed);
 	}
+	if (rc < 0)
+		goto out;
+
+	ra_total = scrub->os_ra_hit + scrub->os_ra_miss;
+	ra_rate = scrub->os_ra_hit * 100;
+	if (ra_total != 0)
+		ra_rate = div64_u64(ra_rate, ra_total);
+	rc = seq_printf(m, "readahead_window: %u groups\n"
+		      "readahead_groups: "LPU64"\n"
+		      "readahead_hit: "LPU64"\n"
+		      "readahead_miss: "LPU64"\n"
+		      "readahead_hit_rate: "LPU64"%%\n",
+		      dev->od_scrub_ra_groups, scrub->os_ra_groups,
+		      scrub->os_ra_hit, scrub->os_ra_miss, ra_rate);
 
 out:
 	up_read(&scrub->os_rwsem);
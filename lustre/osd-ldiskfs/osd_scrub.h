@@ -35,6 +35,8 @@
 
 #include "osd_oi.h"
 
+struct osd_scrub_oi_batch;
+
 #define SCRUB_MAGIC_V1			0x4C5FD252
 #define SCRUB_CHECKPOINT_INTERVAL	60
 #define SCRUB_OI_BITMAP_SIZE		(OSD_OI_FID_NR_MAX >> 3)
@@ -237,6 +239,20 @@ struct osd_scrub {
 				os_full_scrub:1;
 	__u64			os_bad_oimap_count;
 	__u64			os_bad_oimap_time;
+
+	/* The next block group to be read ahead for the scrub. */
+	__u32			os_ra_next;
+	/* Readahead statistics for the current scanning, in RAM only.
+	 * How many block groups have been read ahead. */
+	__u64			os_ra_groups;
+	/* How many block groups were found cached (or not) when the
+	 * iteration reached them. */
+	__u64			os_ra_hit;
+	__u64			os_ra_miss;
+
+	/* OI mappings to be re-inserted into a rebuilt OI file, they are
+	 * inserted in FID order by batch. */
+	struct osd_scrub_oi_batch *os_oi_batch;
 };
 
 #endif /* _OSD_SCRUB_H */
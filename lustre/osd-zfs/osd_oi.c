@@ -470,6 +470,9 @@ int osd_fid_lookup(const struct lu_env *env, struct osd_device *dev,
 		RETURN(-ENOENT);
 
 	if (unlikely(fid_is_acct(fid))) {
+		/* the DMU does not account space per project */
+		if (fid_oid(fid) == ACCT_PROJECT_OID)
+			RETURN(-ENOENT);
 		if (fid_oid(fid) == ACCT_USER_OID)
 			*oid = dev->od_iusr_oid;
 		else
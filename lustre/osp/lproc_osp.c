@@ -186,6 +186,94 @@ static ssize_t osp_syn_changes_seq_write(struct file *file, const char *buffer,
 }
 LPROC_SEQ_FOPS(osp_syn_changes);
 
+/**
+ * Show number of changes applied by the target and cancelled since mount
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_syn_drained_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device	*dev = m->private;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	return seq_printf(m, LPU64"\n", osp->opd_syn_drained);
+}
+LPROC_SEQ_FOPS_RO(osp_syn_drained);
+
+/**
+ * Show rate (changes per second) the sync backlog is drained at
+ *
+ * The rate is sampled by the sync thread every OSP_SYNC_RATE_INTERVAL
+ * seconds; if the thread has not cancelled anything for longer, the rate
+ * is computed over the whole time elapsed since the last sample.
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_syn_drain_rate_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device	*dev = m->private;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+	time_t			 elapsed;
+	__u64			 rate;
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	rate = osp->opd_syn_drain_rate;
+	elapsed = cfs_time_current_sec() - osp->opd_syn_rate_stamp;
+	if (elapsed >= 2 * OSP_SYNC_RATE_INTERVAL) {
+		rate = osp->opd_syn_drained - osp->opd_syn_rate_drained;
+		do_div(rate, elapsed);
+	}
+
+	return seq_printf(m, LPU64"\n", rate);
+}
+LPROC_SEQ_FOPS_RO(osp_syn_drain_rate);
+
+/**
+ * Show how the remote-only transactions are batched into OUT RPCs
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_out_batch_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device	*dev = m->private;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+	__u64			 trans;
+	__u64			 rpcs;
+	int			 in_flight;
+	int			 batched;
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	spin_lock(&osp->opd_update_lock);
+	trans = osp->opd_update_trans_sent;
+	rpcs = osp->opd_update_rpcs_sent;
+	in_flight = osp->opd_update_rpcs;
+	batched = osp->opd_update_batch_trans;
+	spin_unlock(&osp->opd_update_lock);
+
+	return seq_printf(m, "trans_sent: "LPU64"\n"
+			  "rpcs_sent: "LPU64"\n"
+			  "rpcs_in_flight: %d\n"
+			  "trans_batched: %d\n",
+			  trans, rpcs, in_flight, batched);
+}
+LPROC_SEQ_FOPS_RO(osp_out_batch_stats);
+
 /**
  * Show maximum number of RPCs in flight allowed
  *
@@ -521,6 +609,36 @@ static int osp_prealloc_reserved_seq_show(struct seq_file *m, void *data)
 }
 LPROC_SEQ_FOPS_RO(osp_prealloc_reserved);
 
+/**
+ * Show precreation demand forecast and stall statistics
+ *
+ * create_rate is the smoothed rate objects are consumed at, forecast is
+ * the number of objects the pool is kept ahead of the demand, stalls and
+ * stall_time_us count creations which had to wait for a precreate RPC.
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_prealloc_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct osp_device *osp = lu2osp_dev(obd->obd_lu_dev);
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return 0;
+
+	seq_printf(m, "create_rate: %u\n", osp_precreate_rate(osp));
+	seq_printf(m, "forecast: %d\n", osp_precreate_forecast(osp));
+	seq_printf(m, "precreate_rpc_ms: %u\n", osp->opd_pre_rpc_ms);
+	seq_printf(m, "stalls: "LPU64"\n", osp->opd_pre_stalls);
+	seq_printf(m, "stall_time_us: "LPU64"\n", osp->opd_pre_stall_us);
+	return seq_printf(m, "seq_prefetched: "LPU64"\n",
+			  osp->opd_pre_seq_prefetched);
+}
+LPROC_SEQ_FOPS_RO(osp_prealloc_stats);
+
 /**
  * Show interval (in seconds) to update statfs data
  *
@@ -575,6 +693,27 @@ osp_maxage_seq_write(struct file *file, const char *buffer,
 }
 LPROC_SEQ_FOPS(osp_maxage);
 
+/**
+ * Show the recent bulk I/O service time (in usec) the OST reported via
+ * statfs, the LOD uses it to avoid the busy OSTs for new objects.
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_io_latency_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device	*dev = m->private;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return -EINVAL;
+
+	return seq_printf(m, "%u\n", osp->opd_statfs.os_io_latency);
+}
+LPROC_SEQ_FOPS_RO(osp_io_latency);
+
 /**
  * Show current precreation status: output 0 means success, otherwise negative
  * number is printed
@@ -749,6 +888,8 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 	  .fops =	&osp_prealloc_last_seq_fops	},
 	{ .name =	"prealloc_reserved",
 	  .fops =	&osp_prealloc_reserved_fops	},
+	{ .name =	"prealloc_stats",
+	  .fops =	&osp_prealloc_stats_fops	},
 	{ .name =	"timeouts",
 	  .fops =	&osp_timeouts_fops		},
 	{ .name =	"import",
@@ -757,6 +898,8 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 	  .fops =	&osp_state_fops			},
 	{ .name =	"maxage",
 	  .fops =	&osp_maxage_fops		},
+	{ .name =	"io_latency",
+	  .fops =	&osp_io_latency_fops		},
 	{ .name =	"prealloc_status",
 	  .fops =	&osp_pre_status_fops		},
 	{ .name =	"sync_changes",
@@ -765,6 +908,12 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 	  .fops =	&osp_syn_in_flight_fops		},
 	{ .name =	"sync_in_progress",
 	  .fops =	&osp_syn_in_prog_fops		},
+	{ .name =	"drained_changes",
+	  .fops =	&osp_syn_drained_fops		},
+	{ .name =	"drain_rate",
+	  .fops =	&osp_syn_drain_rate_fops	},
+	{ .name =	"out_batch_stats",
+	  .fops =	&osp_out_batch_stats_fops	},
 	{ .name =	"old_sync_processed",
 	  .fops =	&osp_old_sync_processed_fops	},
 
@@ -885,6 +885,8 @@ static int osp_init0(const struct lu_env *env, struct osp_device *osp,
 	INIT_LIST_HEAD(&osp->opd_async_updates);
 	init_rwsem(&osp->opd_async_updates_rwsem);
 	atomic_set(&osp->opd_async_updates_count, 0);
+	spin_lock_init(&osp->opd_update_lock);
+	init_waitqueue_head(&osp->opd_update_waitq);
 
 	obd = class_name2obd(lustre_cfg_string(cfg, 0));
 	if (obd == NULL) {
@@ -1197,6 +1199,11 @@ static struct lu_device *osp_device_fini(const struct lu_env *env,
 		osp->opd_async_requests = NULL;
 	}
 
+	if (osp->opd_update_batch != NULL) {
+		dt_update_request_destroy(osp->opd_update_batch);
+		osp->opd_update_batch = NULL;
+	}
+
 	if (osp->opd_storage_exp)
 		obd_disconnect(osp->opd_storage_exp);
 
@@ -91,6 +91,19 @@ struct osp_precreate {
 	int				 osp_pre_grow_slow;
 	/* cleaning up orphans or recreating missing objects */
 	int				 osp_pre_recovering;
+	/* objects handed out since the demand was sampled */
+	__u32				 osp_pre_demand;
+	/* smoothed creation rate, objects per second */
+	__u32				 osp_pre_create_rate;
+	cfs_time_t			 osp_pre_demand_stamp;
+	/* duration of the last precreate RPC, in ms */
+	__u32				 osp_pre_rpc_ms;
+	/* sequence allocated before the current one is used up */
+	__u64				 osp_pre_next_seq;
+	/* statistics: waits for precreated objects and their duration */
+	__u64				 osp_pre_stalls;
+	__u64				 osp_pre_stall_us;
+	__u64				 osp_pre_seq_prefetched;
 };
 
 struct osp_device {
@@ -177,6 +190,14 @@ struct osp_device {
 	/* stop processing new requests until barrier=0 */
 	atomic_t			 opd_syn_barrier;
 	wait_queue_head_t		 opd_syn_barrier_waitq;
+	/* destroy RPC being filled with contiguous objects, not sent yet */
+	struct ptlrpc_request		*opd_syn_destroy_req;
+	/* number of llog records cancelled once applied by the target */
+	__u64				 opd_syn_drained;
+	/* drain rate (records per second) and the sample it is based on */
+	__u64				 opd_syn_drain_rate;
+	__u64				 opd_syn_rate_drained;
+	time_t				 opd_syn_rate_stamp;
 
 	/*
 	 * statfs related fields: OSP maintains it on its own
@@ -201,8 +222,26 @@ struct osp_device {
 	struct list_head		 opd_async_updates;
 	struct rw_semaphore		 opd_async_updates_rwsem;
 	atomic_t			 opd_async_updates_count;
+
+	/* Remote-only transactions are sent asynchronously with at most
+	 * cl_max_rpcs_in_flight OUT RPCs in flight, the next ones are
+	 * merged into opd_update_batch until one of the RPCs is replied. */
+	spinlock_t			 opd_update_lock;
+	struct dt_update_request	*opd_update_batch;
+	/* transactions merged into opd_update_batch */
+	int				 opd_update_batch_trans;
+	/* bumped each time opd_update_batch is sent */
+	__u64				 opd_update_batch_seq;
+	int				 opd_update_rpcs;
+	wait_queue_head_t		 opd_update_waitq;
+	/* transactions and OUT RPCs sent, to show the batching ratio */
+	__u64				 opd_update_trans_sent;
+	__u64				 opd_update_rpcs_sent;
 };
 
+/* The batch is bound by the request buffers of the OUT service. */
+#define OSP_UPDATE_BATCH_SIZE		(2 * OUT_UPDATE_INIT_BUFFER_SIZE)
+
 #define opd_pre_lock			opd_pre->osp_pre_lock
 #define opd_pre_used_fid		opd_pre->osp_pre_used_fid
 #define opd_pre_last_created_fid	opd_pre->osp_pre_last_created_fid
@@ -214,6 +253,14 @@ struct osp_device {
 #define opd_pre_max_grow_count		opd_pre->osp_pre_max_grow_count
 #define opd_pre_grow_slow		opd_pre->osp_pre_grow_slow
 #define opd_pre_recovering		opd_pre->osp_pre_recovering
+#define opd_pre_demand			opd_pre->osp_pre_demand
+#define opd_pre_create_rate		opd_pre->osp_pre_create_rate
+#define opd_pre_demand_stamp		opd_pre->osp_pre_demand_stamp
+#define opd_pre_rpc_ms			opd_pre->osp_pre_rpc_ms
+#define opd_pre_next_seq		opd_pre->osp_pre_next_seq
+#define opd_pre_stalls			opd_pre->osp_pre_stalls
+#define opd_pre_stall_us		opd_pre->osp_pre_stall_us
+#define opd_pre_seq_prefetched		opd_pre->osp_pre_seq_prefetched
 
 extern struct kmem_cache *osp_object_kmem;
 
@@ -256,6 +303,12 @@ extern const struct dt_device_operations osp_dt_ops;
 extern struct dt_object_operations osp_md_obj_ops;
 extern struct dt_body_operations osp_md_body_ops;
 
+#define OSP_SYNC_CANCEL_BATCH	32
+/* max number of contiguous objects destroyed with a single RPC */
+#define OSP_SYNC_DESTROY_BATCH	32
+/* interval (in seconds) the drain rate is sampled over */
+#define OSP_SYNC_RATE_INTERVAL	5
+
 struct osp_thread_info {
 	struct lu_buf		 osi_lb;
 	struct lu_buf		 osi_lb2;
@@ -272,6 +325,9 @@ struct osp_thread_info {
 		struct llog_gen_rec		osi_gen;
 	};
 	struct llog_cookie	 osi_cookie;
+	/* committed records cancelled together, see
+	 * osp_sync_process_committed() */
+	struct llog_cookie	 osi_cookies[OSP_SYNC_CANCEL_BATCH];
 	struct llog_catid	 osi_cid;
 	struct lu_seq_range	 osi_seq;
 	struct ldlm_res_id	 osi_resid;
@@ -573,6 +629,8 @@ extern const struct dt_index_operations osp_md_index_ops;
 /* osp_precreate.c */
 int osp_init_precreate(struct osp_device *d);
 int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d);
+__u32 osp_precreate_rate(struct osp_device *d);
+int osp_precreate_forecast(struct osp_device *d);
 __u64 osp_precreate_get_id(struct osp_device *d);
 int osp_precreate_get_fid(const struct lu_env *env, struct osp_device *d,
 			  struct lu_fid *fid);
@@ -46,6 +46,14 @@
 
 #include "osp_internal.h"
 
+/* how often the creation rate is sampled */
+#define OSP_PRE_RATE_INTERVAL	(cfs_time_seconds(1) / 4)
+/* time the pool should last beyond a precreate RPC, in ms */
+#define OSP_PRE_LEAD_MS		1000
+/* allocate the next sequence when fewer ids are left in the current one
+ * than this many precreate windows */
+#define OSP_PRE_SEQ_PREFETCH	4
+
 /*
  * there are two specific states to take care about:
  *
@@ -255,6 +263,93 @@ static inline int osp_objs_precreated(const struct lu_env *env,
 			    &osp->opd_pre_used_fid);
 }
 
+/**
+ * Get the smoothed creation rate
+ *
+ * The rate is only folded in osp_precreate_demand_nolock() when objects are
+ * handed out, so decay it here by 1/4 for every OSP_PRE_RATE_INTERVAL past
+ * the current one which went without creations.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		objects per second
+ */
+__u32 osp_precreate_rate(struct osp_device *d)
+{
+	cfs_duration_t	idle = cfs_time_sub(cfs_time_current(),
+					    d->opd_pre_demand_stamp);
+	__u64		rate = d->opd_pre_create_rate;
+	unsigned long	n;
+
+	for (n = idle / OSP_PRE_RATE_INTERVAL; n > 1 && rate > 0; n--)
+		rate = rate * 3 / 4;
+
+	return rate;
+}
+
+/**
+ * Estimate how many objects will be consumed during a precreate
+ *
+ * The estimation is based on the smoothed creation rate and the duration
+ * of the last precreate RPC: the pool should hold enough objects to serve
+ * the creations while the next precreate is in progress, with a margin
+ * of OSP_PRE_LEAD_MS. Like opd_pre_grow_count, it does not exceed half of
+ * opd_pre_max_grow_count. Notice this function relies on an external
+ * locking.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		the number of objects to keep ahead of the demand
+ */
+int osp_precreate_forecast(struct osp_device *d)
+{
+	__u32 rate = osp_precreate_rate(d);
+	__u64 want;
+
+	if (rate == 0)
+		return 0;
+
+	want = (__u64)rate * (OSP_PRE_LEAD_MS + 2 * d->opd_pre_rpc_ms);
+	do_div(want, MSEC_PER_SEC);
+
+	return min_t(__u64, want, d->opd_pre_max_grow_count / 2);
+}
+
+/**
+ * Account an object handed out from the pool
+ *
+ * Counts creations and, every OSP_PRE_RATE_INTERVAL, folds them into the
+ * smoothed creation rate. A growing rate is taken at once so that a burst
+ * of creations is followed immediately, a falling one decays slowly so the
+ * pool is not shrunk between the bursts, see osp_precreate_rate(). Notice
+ * this function relies on an external locking.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_precreate_demand_nolock(struct osp_device *d)
+{
+	cfs_time_t	now = cfs_time_current();
+	unsigned int	ms;
+	__u32		rate;
+	__u32		prev;
+
+	d->opd_pre_demand++;
+	if (cfs_time_before(now, cfs_time_add(d->opd_pre_demand_stamp,
+					      OSP_PRE_RATE_INTERVAL)))
+		return;
+
+	ms = jiffies_to_msecs(cfs_time_sub(now, d->opd_pre_demand_stamp));
+	rate = d->opd_pre_demand * MSEC_PER_SEC / max(ms, 1U);
+	prev = osp_precreate_rate(d);
+	if (rate > prev)
+		d->opd_pre_create_rate = rate;
+	else
+		d->opd_pre_create_rate = (3 * (__u64)prev + rate) / 4;
+
+	d->opd_pre_demand = 0;
+	d->opd_pre_demand_stamp = now;
+}
+
 /**
  * Check pool of precreated objects is nearly empty
  *
@@ -273,10 +368,11 @@ static inline int osp_precreate_near_empty_nolock(const struct lu_env *env,
 						  struct osp_device *d)
 {
 	int window = osp_objs_precreated(env, d);
+	int low = max(d->opd_pre_grow_count / 2, osp_precreate_forecast(d));
 
 	/* don't consider new precreation till OST is healty and
 	 * has free space */
-	return ((window - d->opd_pre_reserved < d->opd_pre_grow_count / 2) &&
+	return ((window - d->opd_pre_reserved < low) &&
 		(d->opd_pre_status == 0));
 }
 
@@ -430,11 +526,18 @@ static int osp_precreate_rollover_new_seq(struct lu_env *env,
 	int		rc;
 	ENTRY;
 
-	rc = seq_client_get_seq(env, osp->opd_obd->u.cli.cl_seq, &fid->f_seq);
-	if (rc != 0) {
-		CERROR("%s: alloc fid error: rc = %d\n",
-		       osp->opd_obd->obd_name, rc);
-		RETURN(rc);
+	if (osp->opd_pre_next_seq != 0) {
+		/* allocated in advance by osp_precreate_prefetch_seq() */
+		fid->f_seq = osp->opd_pre_next_seq;
+		osp->opd_pre_next_seq = 0;
+	} else {
+		rc = seq_client_get_seq(env, osp->opd_obd->u.cli.cl_seq,
+					&fid->f_seq);
+		if (rc != 0) {
+			CERROR("%s: alloc fid error: rc = %d\n",
+			       osp->opd_obd->obd_name, rc);
+			RETURN(rc);
+		}
 	}
 
 	fid->f_oid = 1;
@@ -464,6 +567,55 @@ static int osp_precreate_rollover_new_seq(struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Allocate the next sequence before the current one is used up
+ *
+ * Allocation of a new sequence costs a synchronous RPC to the sequence
+ * controller; if it's done once the current sequence is exhausted, all the
+ * creations on this target stall behind it. So once fewer IDs than a few
+ * precreate windows are left in the current sequence, the next one is
+ * allocated in advance and osp_precreate_rollover_new_seq() just starts
+ * using it. An allocated but unused sequence is simply lost on restart.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] osp	OSP device
+ */
+static void osp_precreate_prefetch_seq(struct lu_env *env,
+				       struct osp_device *osp)
+{
+	struct lu_fid	*fid = &osp->opd_pre_last_created_fid;
+	__u64		 seq;
+	__u64		 left;
+	int		 rc;
+
+	if (osp->opd_pre_next_seq != 0 || !osp_is_fid_client(osp))
+		return;
+
+	spin_lock(&osp->opd_pre_lock);
+	if (fid_is_idif(fid)) {
+		spin_unlock(&osp->opd_pre_lock);
+		return;
+	}
+	left = LUSTRE_DATA_SEQ_MAX_WIDTH - fid_oid(fid);
+	spin_unlock(&osp->opd_pre_lock);
+
+	if (left > (__u64)OSP_PRE_SEQ_PREFETCH * osp->opd_pre_max_grow_count)
+		return;
+
+	rc = seq_client_get_seq(env, osp->opd_obd->u.cli.cl_seq, &seq);
+	if (rc != 0) {
+		/* not fatal, will be retried at rollover */
+		CDEBUG(D_HA, "%s: can't prefetch sequence: rc = %d\n",
+		       osp->opd_obd->obd_name, rc);
+		return;
+	}
+
+	CDEBUG(D_HA, "%s: prefetched sequence "LPX64", "LPU64" ids left\n",
+	       osp->opd_obd->obd_name, seq, left);
+	osp->opd_pre_next_seq = seq;
+	osp->opd_pre_seq_prefetched++;
+}
+
 /**
  * Find IDs available in current sequence
  *
@@ -543,6 +695,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
 	struct ost_body		*body;
+	cfs_time_t		 start;
 	int			 rc, grow, diff;
 	struct lu_fid		*fid = &oti->osi_fid;
 	ENTRY;
@@ -578,6 +731,8 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	if (d->opd_pre_grow_count > d->opd_pre_max_grow_count / 2)
 		d->opd_pre_grow_count = d->opd_pre_max_grow_count / 2;
 	grow = d->opd_pre_grow_count;
+	/* ask for at least what is expected to be consumed meanwhile */
+	grow = max(grow, osp_precreate_forecast(d));
 	spin_unlock(&d->opd_pre_lock);
 
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
@@ -607,6 +762,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 
 	ptlrpc_request_set_replen(req);
 
+	start = cfs_time_current();
 	rc = ptlrpc_queue_wait(req);
 	if (rc) {
 		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
@@ -614,6 +770,8 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 		GOTO(out_req, rc);
 	}
 	LASSERT(req->rq_transno == 0);
+	d->opd_pre_rpc_ms = jiffies_to_msecs(cfs_time_sub(cfs_time_current(),
+							  start));
 
 	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
 	if (body == NULL)
@@ -1192,6 +1350,8 @@ static int osp_precreate_thread(void *_arg)
 					       " rc = %d\n",
 					       d->opd_obd->obd_name, rc);
 			}
+
+			osp_precreate_prefetch_seq(&env, d);
 		}
 	}
 
@@ -1290,6 +1450,7 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d)
 {
 	struct l_wait_info	 lwi;
 	cfs_time_t		 expire = cfs_time_shift(obd_timeout);
+	cfs_time_t		 stall = 0;
 	int			 precreated, rc;
 
 	ENTRY;
@@ -1370,10 +1531,22 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d)
 			break;
 		}
 
+		if (stall == 0)
+			stall = cfs_time_current();
 		l_wait_event(d->opd_pre_user_waitq,
 			     osp_precreate_ready_condition(env, d), &lwi);
 	}
 
+	if (stall != 0) {
+		unsigned int us;
+
+		us = jiffies_to_usecs(cfs_time_sub(cfs_time_current(), stall));
+		spin_lock(&d->opd_pre_lock);
+		d->opd_pre_stalls++;
+		d->opd_pre_stall_us += us;
+		spin_unlock(&d->opd_pre_lock);
+	}
+
 	RETURN(rc);
 }
 
@@ -1414,6 +1587,7 @@ int osp_precreate_get_fid(const struct lu_env *env, struct osp_device *d,
 	d->opd_pre_used_fid.f_oid++;
 	memcpy(fid, &d->opd_pre_used_fid, sizeof(*fid));
 	d->opd_pre_reserved--;
+	osp_precreate_demand_nolock(d);
 	/*
 	 * last_used_id must be changed along with getting new id otherwise
 	 * we might miscalculate gap causing object loss or leak
@@ -1548,6 +1722,7 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_pre_grow_count = OST_MIN_PRECREATE;
 	d->opd_pre_min_grow_count = OST_MIN_PRECREATE;
 	d->opd_pre_max_grow_count = OST_MAX_PRECREATE;
+	d->opd_pre_demand_stamp = cfs_time_current();
 
 	spin_lock_init(&d->opd_pre_lock);
 	init_waitqueue_head(&d->opd_pre_waitq);
@@ -99,6 +99,8 @@ struct osp_job_req_args {
 	struct ptlrpc_replay_async_args	jra_raa;
 	struct list_head		jra_link;
 	__u32				jra_magic;
+	/** number of consecutive llog records the RPC applies */
+	__u32				jra_count;
 };
 
 static inline int osp_sync_running(struct osp_device *d)
@@ -466,12 +468,11 @@ static int osp_sync_interpret(const struct lu_env *env,
 	       rc, (unsigned) req->rq_transno);
 	LASSERT(rc || req->rq_transno);
 
-	if (rc == -ENOENT) {
+	if (rc == -ENOENT && req->rq_transno == 0) {
 		/*
 		 * we tried to destroy object or update attributes,
 		 * but object doesn't exist anymore - cancell llog record
 		 */
-		LASSERT(req->rq_transno == 0);
 		LASSERT(list_empty(&jra->jra_link));
 
 		ptlrpc_request_addref(req);
@@ -481,6 +482,14 @@ static int osp_sync_interpret(const struct lu_env *env,
 		spin_unlock(&d->opd_syn_lock);
 
 		wake_up(&d->opd_syn_waitq);
+	} else if (rc == -ENOENT) {
+		/*
+		 * multi-object destroy where some of the objects were
+		 * gone already, the rest has been destroyed: the records
+		 * are cancelled from the commit callback like for success
+		 */
+		CDEBUG(D_HA, "%s: partial destroy, transno "LPU64"\n",
+		       d->opd_obd->obd_name, req->rq_transno);
 	} else if (rc) {
 		struct obd_import *imp = req->rq_import;
 		/*
@@ -549,6 +558,77 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 	ptlrpcd_add_req(req, PDL_POLICY_ROUND, -1);
 }
 
+/**
+ * Send the destroy RPC being filled, if any.
+ *
+ * Destroys of contiguous objects are accumulated in a single OST_DESTROY
+ * RPC, see osp_sync_new_unlink64_job(). The RPC must be sent before the
+ * sync thread goes to sleep or handles a change of another kind.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_send_destroy(struct osp_device *d)
+{
+	struct ptlrpc_request *req = d->opd_syn_destroy_req;
+
+	if (req == NULL)
+		return;
+
+	d->opd_syn_destroy_req = NULL;
+	osp_sync_send_new_rpc(d, req);
+}
+
+/**
+ * Try to add the record to the destroy RPC being filled.
+ *
+ * The record can join the RPC if it stores the objects following the ones
+ * already in the RPC and it's the next record in the same plain llog, so
+ * that the RPC is still described by the first cookie and the number of
+ * records.
+ *
+ * \param[in] d		OSP device
+ * \param[in] llh	llog handle where the record is stored
+ * \param[in] rec	unlink record
+ *
+ * \retval 1		the record has been added to the RPC
+ * \retval 0		the record can't be added
+ */
+static int osp_sync_merge_destroy(struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct llog_unlink64_rec *rec)
+{
+	struct ptlrpc_request	*req = d->opd_syn_destroy_req;
+	struct osp_job_req_args	*jra;
+	struct ost_body		*body;
+	struct ost_id		 oi;
+
+	if (req == NULL)
+		return 0;
+
+	jra = ptlrpc_req_async_args(req);
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body != NULL);
+
+	if (memcmp(&body->oa.o_lcookie.lgc_lgl, &llh->lgh_id,
+		   sizeof(llh->lgh_id)) != 0 ||
+	    body->oa.o_lcookie.lgc_index + jra->jra_count !=
+	    rec->lur_hdr.lrh_index)
+		return 0;
+
+	if (body->oa.o_misc + rec->lur_count > OSP_SYNC_DESTROY_BATCH)
+		return 0;
+
+	if (fid_to_ostid(&rec->lur_fid, &oi) != 0 ||
+	    ostid_seq(&oi) != ostid_seq(&body->oa.o_oi) ||
+	    ostid_id(&oi) != ostid_id(&body->oa.o_oi) + body->oa.o_misc)
+		return 0;
+
+	body->oa.o_misc += rec->lur_count;
+	jra->jra_count++;
+
+	return 1;
+}
+
 
 /**
  * Allocate and prepare RPC for a new change.
@@ -576,6 +656,7 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 	struct ptlrpc_request	*req;
 	struct ost_body		*body;
 	struct obd_import	*imp;
+	struct osp_job_req_args	*jra;
 	int			 rc;
 
 	/* Prepare the request */
@@ -603,6 +684,9 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 	body->oa.o_lcookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
 	body->oa.o_lcookie.lgc_index = h->lrh_index;
 
+	jra = ptlrpc_req_async_args(req);
+	jra->jra_count = 1;
+
 	req->rq_interpret_reply = osp_sync_interpret;
 	req->rq_commit_cb = osp_sync_request_commit_cb;
 	req->rq_cb_data = d;
@@ -735,6 +819,7 @@ static int osp_prep_unlink_update_req(const struct lu_env *env,
 	struct llog_unlink64_rec	*rec = (struct llog_unlink64_rec *)h;
 	struct dt_update_request	*update = NULL;
 	struct ptlrpc_request		*req;
+	struct osp_job_req_args		*jra;
 	struct llog_cookie		lcookie;
 	const void			*buf;
 	__u16				size;
@@ -773,6 +858,9 @@ static int osp_prep_unlink_update_req(const struct lu_env *env,
 	if (rc != 0)
 		GOTO(out, rc);
 
+	jra = ptlrpc_req_async_args(req);
+	jra->jra_count = 1;
+
 	req->rq_interpret_reply = osp_sync_interpret;
 	req->rq_commit_cb = osp_sync_request_commit_cb;
 	req->rq_cb_data = osp;
@@ -795,7 +883,8 @@ out:
  * updates transferred via a network). For OST we still use the old
  * protocol (OBD?), originally for compatibility. Later we can start to
  * use OUT for OST as well, this will allow batching and better code
- * unification.
+ * unification. For OST, destroys of contiguous objects stored in the
+ * consecutive records are sent with a single multi-object OST_DESTROY.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] d		OSP device
@@ -822,23 +911,40 @@ static int osp_sync_new_unlink64_job(const struct lu_env *env,
 		rc = osp_prep_unlink_update_req(env, d, llh, h, &req);
 		if (rc != 0)
 			RETURN(rc);
-	} else {
-		req = osp_sync_new_job(d, llh, h, OST_DESTROY,
-				       &RQF_OST_DESTROY);
-		if (IS_ERR(req))
-			RETURN(PTR_ERR(req));
-
-		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-		if (body == NULL)
-			RETURN(-EFAULT);
-		rc = fid_to_ostid(&rec->lur_fid, &body->oa.o_oi);
-		if (rc < 0)
-			RETURN(rc);
-		body->oa.o_misc = rec->lur_count;
-		body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID |
-				   OBD_MD_FLOBJCOUNT;
+		osp_sync_send_new_rpc(d, req);
+		RETURN(1);
 	}
-	osp_sync_send_new_rpc(d, req);
+
+	if (osp_sync_merge_destroy(d, llh, rec)) {
+		/* no new RPC, the one being filled is accounted already */
+		spin_lock(&d->opd_syn_lock);
+		d->opd_syn_rpc_in_flight--;
+		d->opd_syn_rpc_in_progress--;
+		spin_unlock(&d->opd_syn_lock);
+		RETURN(1);
+	}
+	osp_sync_send_destroy(d);
+
+	req = osp_sync_new_job(d, llh, h, OST_DESTROY, &RQF_OST_DESTROY);
+	if (IS_ERR(req))
+		RETURN(PTR_ERR(req));
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	if (body == NULL) {
+		ptlrpc_req_finished(req);
+		RETURN(-EFAULT);
+	}
+	rc = fid_to_ostid(&rec->lur_fid, &body->oa.o_oi);
+	if (rc < 0) {
+		ptlrpc_req_finished(req);
+		RETURN(rc);
+	}
+	body->oa.o_misc = rec->lur_count;
+	body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID | OBD_MD_FLOBJCOUNT;
+
+	/* following records may destroy the next objects, keep the RPC
+	 * open till a record of another kind or the llog end is met */
+	d->opd_syn_destroy_req = req;
 	RETURN(1);
 }
 
@@ -873,6 +979,10 @@ static int osp_sync_process_record(const struct lu_env *env,
 	cookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
 	cookie.lgc_index = rec->lrh_index;
 
+	/* only contiguous destroys are sent with a single RPC */
+	if (rec->lrh_type != MDS_UNLINK64_REC)
+		osp_sync_send_destroy(d);
+
 	if (unlikely(rec->lrh_type == LLOG_GEN_REC)) {
 		struct llog_gen_rec *gen = (struct llog_gen_rec *)rec;
 
@@ -969,12 +1079,14 @@ static void osp_sync_process_committed(const struct lu_env *env,
 {
 	struct obd_device	*obd = d->opd_obd;
 	struct obd_import	*imp = obd->u.cli.cl_import;
+	struct llog_cookie	*cookies = osp_env_info(env)->osi_cookies;
 	struct ost_body		*body;
 	struct ptlrpc_request	*req;
 	struct llog_ctxt	*ctxt;
 	struct llog_handle	*llh;
 	struct list_head	 list;
-	int			 rc, done = 0;
+	time_t			 now;
+	int			 rc, done = 0, nr = 0, i;
 
 	ENTRY;
 
@@ -992,9 +1104,8 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		osp_statfs_need_now(d);
 
 	/*
-	 * now cancel them all
-	 * XXX: can we improve this using some batching?
-	 *      with batch RPC that'll happen automatically?
+	 * now cancel them all, in batches so that records from the same
+	 * plain llog cost a single llog header update
 	 * XXX: can we store ctxt in lod_device and save few cycles ?
 	 */
 	ctxt = llog_get_context(obd, LLOG_MDS_OST_ORIG_CTXT);
@@ -1042,21 +1153,50 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		}
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
-		if (req->rq_transno <= imp->imp_peer_committed_transno) {
-			rc = llog_cat_cancel_records(env, llh, 1, lcookie);
-			if (rc)
-				CERROR("%s: can't cancel record: %d\n",
-				       obd->obd_name, rc);
-		} else {
+		if (req->rq_transno > imp->imp_peer_committed_transno) {
 			DEBUG_REQ(D_HA, req, "not committed");
+			ptlrpc_req_finished(req);
+			done++;
+			continue;
 		}
 
+		/* a multi-object destroy applies consecutive records */
+		for (i = 0; i < jra->jra_count; i++) {
+			cookies[nr] = *lcookie;
+			cookies[nr].lgc_index += i;
+			if (++nr < OSP_SYNC_CANCEL_BATCH)
+				continue;
+			rc = llog_cat_cancel_records(env, llh, nr, cookies);
+			if (rc)
+				CERROR("%s: can't cancel %d records: %d\n",
+				       obd->obd_name, nr, rc);
+			nr = 0;
+		}
+		d->opd_syn_drained += jra->jra_count;
+
 		ptlrpc_req_finished(req);
 		done++;
 	}
 
+	if (nr > 0) {
+		rc = llog_cat_cancel_records(env, llh, nr, cookies);
+		if (rc)
+			CERROR("%s: can't cancel %d records: %d\n",
+			       obd->obd_name, nr, rc);
+	}
+
 	llog_ctxt_put(ctxt);
 
+	now = cfs_time_current_sec();
+	if (now >= d->opd_syn_rate_stamp + OSP_SYNC_RATE_INTERVAL) {
+		__u64 rate = d->opd_syn_drained - d->opd_syn_rate_drained;
+
+		do_div(rate, now - d->opd_syn_rate_stamp);
+		d->opd_syn_drain_rate = rate;
+		d->opd_syn_rate_drained = d->opd_syn_drained;
+		d->opd_syn_rate_stamp = now;
+	}
+
 	LASSERT(d->opd_syn_rpc_in_progress >= done);
 	spin_lock(&d->opd_syn_lock);
 	d->opd_syn_rpc_in_progress -= done;
@@ -1104,6 +1244,7 @@ static int osp_sync_process_queues(const struct lu_env *env,
 
 		if (!osp_sync_running(d)) {
 			CDEBUG(D_HA, "stop llog processing\n");
+			osp_sync_send_destroy(d);
 			return LLOG_PROC_BREAK;
 		}
 
@@ -1147,6 +1288,9 @@ static int osp_sync_process_queues(const struct lu_env *env,
 			rec = NULL;
 		}
 
+		/* nothing to add to the destroy RPC till we wake up */
+		osp_sync_send_destroy(d);
+
 		if (d->opd_syn_last_processed_id == d->opd_syn_last_used_id)
 			osp_sync_remove_from_tracker(d);
 
@@ -1451,6 +1595,7 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 	init_waitqueue_head(&d->opd_syn_barrier_waitq);
 	init_waitqueue_head(&d->opd_syn_thread.t_ctl_waitq);
 	INIT_LIST_HEAD(&d->opd_syn_committed_there);
+	d->opd_syn_rate_stamp = cfs_time_current_sec();
 
 	task = kthread_run(osp_sync_thread, d, "osp-syn-%u-%u",
 			   d->opd_index, d->opd_group);
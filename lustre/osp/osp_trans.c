@@ -53,6 +53,21 @@
  * will be called one by one to handle each own result.
  *
  *
+ * 3. Batch remote-only transactions
+ *
+ * The remote-only transactions, such as the LFSCK repairs, are sent
+ * asynchronously with one OUT RPC each as long as there are less than
+ * cl_max_rpcs_in_flight such RPCs in flight. Beyond that they are merged
+ * into osp_device::opd_update_batch, each with its own batchid so that the
+ * target still executes them as separate transactions, and the batch is
+ * sent as soon as one of the RPCs in flight is replied. So an idle target
+ * gets every transaction without delay while a busy one gets them packed.
+ *
+ * The remote updates of a distributed transaction, such as the striped
+ * directory creation, are sent to all the targets in parallel and waited
+ * for together by the LOD, see out_remote_send() and out_remote_wait().
+ *
+ *
  * Author: Di Wang <di.wang@intel.com>
  * Author: Fan, Yong <fan.yong@intel.com>
  */
@@ -65,7 +80,8 @@ struct osp_async_update_args {
 	struct dt_update_request *oaua_update;
 	atomic_t		 *oaua_count;
 	wait_queue_head_t	 *oaua_waitq;
-	bool			  oaua_flow_control;
+	/* remote-only transactions packed in the RPC */
+	int			  oaua_trans;
 };
 
 struct osp_async_request {
@@ -126,6 +142,9 @@ static void osp_async_request_fini(const struct lu_env *env,
 	OBD_FREE_PTR(oar);
 }
 
+static void osp_update_rpc_done(const struct lu_env *env,
+				struct osp_device *osp);
+
 /**
  * Interpret the packaged OUT RPC results.
  *
@@ -153,10 +172,6 @@ static int osp_async_update_interpret(const struct lu_env *env,
 	int				 index  = 0;
 	int				 rc1	= 0;
 
-	if (oaua->oaua_flow_control)
-		obd_put_request_slot(
-				&dt2osp_dev(dt_update->dur_dt)->opd_obd->u.cli);
-
 	/* Unpack the results from the reply message. */
 	if (req->rq_repmsg != NULL) {
 		reply = req_capsule_server_sized_get(&req->rq_pill,
@@ -197,7 +212,11 @@ static int osp_async_update_interpret(const struct lu_env *env,
 		index++;
 	}
 
-	if (oaua->oaua_count != NULL && atomic_dec_and_test(oaua->oaua_count))
+	if (oaua->oaua_trans > 0)
+		osp_update_rpc_done(env, dt2osp_dev(dt_update->dur_dt));
+
+	if (oaua->oaua_count != NULL &&
+	    atomic_sub_and_test(oaua->oaua_trans, oaua->oaua_count))
 		wake_up_all(oaua->oaua_waitq);
 
 	dt_update_request_destroy(dt_update);
@@ -245,7 +264,7 @@ int osp_unplug_async_request(const struct lu_env *env,
 		args->oaua_update = update;
 		args->oaua_count = NULL;
 		args->oaua_waitq = NULL;
-		args->oaua_flow_control = false;
+		args->oaua_trans = 0;
 		req->rq_interpret_reply = osp_async_update_interpret;
 		ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
 	}
@@ -253,6 +272,250 @@ int osp_unplug_async_request(const struct lu_env *env,
 	return rc;
 }
 
+/**
+ * Send remote-only transactions with one OUT RPC.
+ *
+ * The caller has taken the RPC slot in osp_device::opd_update_rpcs and has
+ * accounted the transactions in osp_device::opd_async_updates_count, both
+ * are released when the RPC is replied, or here if it cannot be sent.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] osp	pointer to the OSP device
+ * \param[in] update	pointer to the updates to be sent
+ * \param[in] trans	number of transactions packed in \a update
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int osp_update_rpc_send(const struct lu_env *env,
+			       struct osp_device *osp,
+			       struct dt_update_request *update, int trans)
+{
+	struct osp_async_update_args	*args;
+	struct ptlrpc_request		*req;
+	int				 rc;
+
+	rc = out_prep_update_req(env, osp->opd_obd->u.cli.cl_import,
+				 update->dur_buf.ub_req, &req);
+	if (rc != 0) {
+		/* The transactions have been committed locally already,
+		 * their remote updates are lost. */
+		CERROR("%s: cannot send %d remote transactions, their "
+		       "updates are dropped: rc = %d\n",
+		       osp->opd_obd->obd_name, trans, rc);
+		dt_update_request_destroy(update);
+		osp_update_rpc_done(env, osp);
+		if (atomic_sub_and_test(trans, &osp->opd_async_updates_count))
+			wake_up_all(&osp->opd_syn_barrier_waitq);
+
+		return rc;
+	}
+
+	args = ptlrpc_req_async_args(req);
+	args->oaua_update = update;
+	args->oaua_count = &osp->opd_async_updates_count;
+	args->oaua_waitq = &osp->opd_syn_barrier_waitq;
+	args->oaua_trans = trans;
+	req->rq_interpret_reply = osp_async_update_interpret;
+
+	spin_lock(&osp->opd_update_lock);
+	osp->opd_update_trans_sent += trans;
+	osp->opd_update_rpcs_sent++;
+	spin_unlock(&osp->opd_update_lock);
+
+	ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
+
+	return 0;
+}
+
+/**
+ * Release the RPC slot of the replied (or unsent) remote-only transactions.
+ *
+ * If some transactions have been batched meanwhile, the slot is handed over
+ * to the batch, that is sent right now.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] osp	pointer to the OSP device
+ */
+static void osp_update_rpc_done(const struct lu_env *env,
+				struct osp_device *osp)
+{
+	struct dt_update_request	*batch;
+	int				 trans;
+
+	spin_lock(&osp->opd_update_lock);
+	batch = osp->opd_update_batch;
+	trans = osp->opd_update_batch_trans;
+	if (batch != NULL) {
+		osp->opd_update_batch = NULL;
+		osp->opd_update_batch_trans = 0;
+		osp->opd_update_batch_seq++;
+	} else {
+		osp->opd_update_rpcs--;
+	}
+	spin_unlock(&osp->opd_update_lock);
+
+	wake_up_all(&osp->opd_update_waitq);
+	if (batch != NULL)
+		osp_update_rpc_send(env, osp, batch, trans);
+}
+
+/**
+ * Allocate an empty batch of remote-only transactions.
+ *
+ * Its buffer is allocated at the full batch size in advance, so that the
+ * transactions can be merged into it under osp_device::opd_update_lock.
+ *
+ * \param[in] osp	pointer to the OSP device
+ *
+ * \retval		pointer to the batch
+ * \retval		negative error number on failure
+ */
+static struct dt_update_request *
+osp_update_batch_alloc(struct osp_device *osp)
+{
+	struct dt_update_request	*batch;
+	int				 rc;
+
+	batch = dt_update_request_create(&osp->opd_dt_dev);
+	if (IS_ERR(batch))
+		return batch;
+
+	rc = update_buffer_resize(&batch->dur_buf, OSP_UPDATE_BATCH_SIZE);
+	if (rc != 0) {
+		dt_update_request_destroy(batch);
+		return ERR_PTR(rc);
+	}
+
+	batch->dur_buf.ub_req->ourq_flags |= UPDATE_REQ_FL_BATCH;
+
+	return batch;
+}
+
+/**
+ * Send a remote-only transaction asynchronously.
+ *
+ * If an RPC slot is free and no transaction is waiting in the batch, the
+ * transaction is sent with its own RPC. Otherwise it is merged into the
+ * batch that is sent in the next free slot. If the batch is full, or the
+ * transaction does not fit in an empty batch, wait for the batch to be
+ * sent or for a free slot respectively.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] osp	pointer to the OSP device
+ * \param[in] update	pointer to the updates of the transaction, which
+ *			is released here
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int osp_update_batch_add(const struct lu_env *env,
+				struct osp_device *osp,
+				struct dt_update_request *update)
+{
+	struct client_obd		*cli = &osp->opd_obd->u.cli;
+	struct dt_update_request	*batch;
+	struct dt_update_request	*new = NULL;
+	struct l_wait_info		 lwi = { 0 };
+	bool				 solo;
+	bool				 send = false;
+	__u64				 seq;
+	int				 trans;
+	int				 rc = 0;
+
+	LASSERT(list_empty(&update->dur_cb_items));
+
+	solo = object_update_request_size(update->dur_buf.ub_req) >
+	       OSP_UPDATE_BATCH_SIZE / 2;
+
+	down_read(&osp->opd_async_updates_rwsem);
+	atomic_inc(&osp->opd_async_updates_count);
+	up_read(&osp->opd_async_updates_rwsem);
+
+	spin_lock(&osp->opd_update_lock);
+	while (1) {
+		batch = osp->opd_update_batch;
+		if (osp->opd_update_rpcs < cli->cl_max_rpcs_in_flight) {
+			osp->opd_update_rpcs++;
+			if (batch == NULL) {
+				send = true;
+				break;
+			}
+
+			/* max_rpcs_in_flight has been raised, send the batch
+			 * in the new slot to keep the transactions ordered */
+			trans = osp->opd_update_batch_trans;
+			osp->opd_update_batch = NULL;
+			osp->opd_update_batch_trans = 0;
+			osp->opd_update_batch_seq++;
+			spin_unlock(&osp->opd_update_lock);
+
+			osp_update_rpc_send(env, osp, batch, trans);
+			spin_lock(&osp->opd_update_lock);
+			continue;
+		}
+
+		if (!solo) {
+			if (batch == NULL && new == NULL) {
+				spin_unlock(&osp->opd_update_lock);
+				new = osp_update_batch_alloc(osp);
+				if (IS_ERR(new)) {
+					rc = PTR_ERR(new);
+					new = NULL;
+					GOTO(out, rc);
+				}
+
+				spin_lock(&osp->opd_update_lock);
+				continue;
+			}
+
+			if (batch == NULL) {
+				batch = new;
+				new = NULL;
+				osp->opd_update_batch = batch;
+			}
+
+			rc = out_update_merge(&batch->dur_buf,
+					      update->dur_buf.ub_req,
+					      &batch->dur_batchid);
+			if (rc == 0) {
+				osp->opd_update_batch_trans++;
+				break;
+			}
+		}
+
+		/* wait till the batch is sent or a slot is freed */
+		seq = osp->opd_update_batch_seq;
+		spin_unlock(&osp->opd_update_lock);
+
+		l_wait_event(osp->opd_update_waitq,
+			     osp->opd_update_batch_seq != seq ||
+			     osp->opd_update_rpcs < cli->cl_max_rpcs_in_flight,
+			     &lwi);
+		spin_lock(&osp->opd_update_lock);
+	}
+	spin_unlock(&osp->opd_update_lock);
+
+	if (send) {
+		if (new != NULL)
+			dt_update_request_destroy(new);
+
+		return osp_update_rpc_send(env, osp, update, 1);
+	}
+
+	GOTO(out, rc);
+
+out:
+	if (new != NULL)
+		dt_update_request_destroy(new);
+	dt_update_request_destroy(update);
+	if (rc != 0 &&
+	    atomic_dec_and_test(&osp->opd_async_updates_count))
+		wake_up_all(&osp->opd_syn_barrier_waitq);
+
+	return rc;
+}
+
 /**
  * Find or create (if NOT exist or purged) the shared asynchronous idempotent
  * request queue - osp_device::opd_async_requests.
@@ -421,9 +684,12 @@ out:
 /**
  * Trigger the request for remote updates.
  *
- * If the transaction is not a remote one or it is required to be sync mode
- * (th->th_sync is set), then it will be sent synchronously; otherwise, the
- * RPC will be sent asynchronously.
+ * If the remote transaction is required to be sync mode (th->th_sync is
+ * set), then it will be sent synchronously; otherwise, the RPC will be sent
+ * asynchronously, possibly batched with other remote transactions, see
+ * osp_update_batch_add(). The updates of a transaction that is not a remote
+ * one are sent in parallel with the updates to the other targets, and the
+ * caller waits for all of them with out_remote_wait().
  *
  * Please refer to osp_trans_create() for transaction type.
  *
@@ -431,14 +697,13 @@ out:
  * \param[in] osp		pointer to the OSP device
  * \param[in] dt_update		pointer to the dt_update_request
  * \param[in] th		pointer to the transaction handler
- * \param[in] flow_control	whether need to control the flow
  *
  * \retval			0 for success
  * \retval			negative error number on failure
  */
 static int osp_trans_trigger(const struct lu_env *env, struct osp_device *osp,
 			     struct dt_update_request *dt_update,
-			     struct thandle *th, bool flow_control)
+			     struct thandle *th)
 {
 	struct thandle_update	*tu = th->th_update;
 	int			 rc = 0;
@@ -446,9 +711,6 @@ static int osp_trans_trigger(const struct lu_env *env, struct osp_device *osp,
 	LASSERT(tu != NULL);
 
 	if (is_only_remote_trans(th)) {
-		struct osp_async_update_args	*args;
-		struct ptlrpc_request		*req;
-
 		list_del_init(&dt_update->dur_list);
 		if (th->th_sync) {
 			rc = out_remote_sync(env, osp->opd_obd->u.cli.cl_import,
@@ -458,30 +720,11 @@ static int osp_trans_trigger(const struct lu_env *env, struct osp_device *osp,
 			return rc;
 		}
 
-		rc = out_prep_update_req(env, osp->opd_obd->u.cli.cl_import,
-					 dt_update->dur_buf.ub_req, &req);
-		if (rc == 0) {
-			down_read(&osp->opd_async_updates_rwsem);
-
-			args = ptlrpc_req_async_args(req);
-			args->oaua_update = dt_update;
-			args->oaua_count = &osp->opd_async_updates_count;
-			args->oaua_waitq = &osp->opd_syn_barrier_waitq;
-			args->oaua_flow_control = flow_control;
-			req->rq_interpret_reply =
-				osp_async_update_interpret;
-
-			atomic_inc(args->oaua_count);
-			up_read(&osp->opd_async_updates_rwsem);
-
-			ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
-		} else {
-			dt_update_request_destroy(dt_update);
-		}
+		rc = osp_update_batch_add(env, osp, dt_update);
 	} else {
 		th->th_sync = 1;
-		rc = out_remote_sync(env, osp->opd_obd->u.cli.cl_import,
-				     dt_update, NULL);
+		rc = out_remote_send(env, osp->opd_obd->u.cli.cl_import,
+				     dt_update, tu);
 	}
 
 	return rc;
@@ -530,8 +773,7 @@ int osp_trans_start(const struct lu_env *env, struct dt_device *dt,
 		return rc;
 
 	if (!is_only_remote_trans(th) && !tu->tu_sent_after_local_trans)
-		rc = osp_trans_trigger(env, dt2osp_dev(dt), dt_update, th,
-				       false);
+		rc = osp_trans_trigger(env, dt2osp_dev(dt), dt_update, th);
 
 	return rc;
 }
@@ -585,25 +827,13 @@ int osp_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	if (is_only_remote_trans(th)) {
 		if (th->th_result == 0) {
 			struct osp_device *osp = dt2osp_dev(th->th_dev);
-			struct client_obd *cli = &osp->opd_obd->u.cli;
 
-			rc = obd_get_request_slot(cli);
 			if (!osp->opd_imp_active || !osp->opd_imp_connected) {
-				if (rc == 0)
-					obd_put_request_slot(cli);
-
-				rc = -ENOTCONN;
-			}
-
-			if (rc != 0) {
 				dt_update_request_destroy(dt_update);
-				GOTO(put, rc);
+				GOTO(put, rc = -ENOTCONN);
 			}
 
-			rc = osp_trans_trigger(env, dt2osp_dev(dt),
-					       dt_update, th, true);
-			if (rc != 0)
-				obd_put_request_slot(cli);
+			rc = osp_trans_trigger(env, osp, dt_update, th);
 		} else {
 			rc = th->th_result;
 			dt_update_request_destroy(dt_update);
@@ -611,7 +841,7 @@ int osp_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	} else {
 		if (tu->tu_sent_after_local_trans)
 			rc = osp_trans_trigger(env, dt2osp_dev(dt),
-					       dt_update, th, false);
+					       dt_update, th);
 		rc = dt_update->dur_rc;
 		dt_update_request_destroy(dt_update);
 	}
@@ -1735,7 +1735,7 @@ void lustre_swab_obd_statfs (struct obd_statfs *os)
         __swab64s (&os->os_maxbytes);
         __swab32s (&os->os_state);
 	CLASSERT(offsetof(typeof(*os), os_fprecreated) != 0);
-        CLASSERT(offsetof(typeof(*os), os_spare2) != 0);
+	__swab32s(&os->os_io_latency);
         CLASSERT(offsetof(typeof(*os), os_spare3) != 0);
         CLASSERT(offsetof(typeof(*os), os_spare4) != 0);
         CLASSERT(offsetof(typeof(*os), os_spare5) != 0);
@@ -2532,7 +2532,7 @@ void lustre_swab_object_update_request(struct object_update_request *our)
 	size_t i;
 	__swab32s(&our->ourq_magic);
 	__swab16s(&our->ourq_count);
-	__swab16s(&our->ourq_padding);
+	__swab16s(&our->ourq_flags);
 	for (i = 0; i < our->ourq_count; i++) {
 		struct object_update *ou;
 
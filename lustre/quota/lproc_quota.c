@@ -188,8 +188,10 @@ static int lprocfs_quota_seq_show(struct seq_file *p, void *v)
 		if (fid_is_acct(fid)) {
 			if (fid_oid(fid) == ACCT_USER_OID)
 				seq_printf(p, "usr_accounting:\n");
-			else
+			else if (fid_oid(fid) == ACCT_GROUP_OID)
 				seq_printf(p, "grp_accounting:\n");
+			else
+				seq_printf(p, "prj_accounting:\n");
 		} else if (fid_seq(fid) == FID_SEQ_QUOTA_GLB) {
 			int	poolid, rtype, qtype;
 
@@ -373,9 +373,10 @@ struct dt_object *lquota_disk_slv_find(const struct lu_env *env,
  *                  slave index.
  * \param uuid    - is the uuid of slave which is (re)connecting to the master
  *                  target
- * \param local   - indicate whether to use local reserved FID (LQUOTA_USR_OID
- *                  & LQUOTA_GRP_OID) for the slave index creation or to
- *                  allocate a new fid from sequence FID_SEQ_QUOTA
+ * \param local   - indicate whether to use local reserved FID (LQUOTA_USR_OID,
+ *                  LQUOTA_GRP_OID & LQUOTA_PRJ_OID) for the slave index
+ *                  creation or to allocate a new fid from sequence
+ *                  FID_SEQ_QUOTA
  *
  * \retval     - pointer to the dt_object of the slave index on success,
  *               appropriate error on failure
@@ -414,8 +415,7 @@ struct dt_object *lquota_disk_slv_find_create(const struct lu_env *env,
 			RETURN(ERR_PTR(rc));
 
 		/* use predefined fid in the reserved oid list */
-		qti->qti_fid.f_oid = (type == USRQUOTA) ? LQUOTA_USR_OID
-							: LQUOTA_GRP_OID;
+		qti->qti_fid.f_oid = lquota_slv_oid(type);
 
 		slv_idx = local_index_find_or_create_with_fid(env, dev,
 							      &qti->qti_fid,
@@ -31,7 +31,8 @@
 #ifndef _LQUOTA_INTERNAL_H
 #define _LQUOTA_INTERNAL_H
 
-#define QTYPE_NAME(qtype) ((qtype) == USRQUOTA ? "usr" : "grp")
+#define QTYPE_NAME(qtype) ((qtype) == USRQUOTA ? "usr" :	\
+			   (qtype) == GRPQUOTA ? "grp" : "prj")
 #define RES_NAME(res) ((res) == LQUOTA_RES_MD ? "md" : "dt")
 
 #define QIF_IFLAGS (QIF_INODES | QIF_ITIME | QIF_ILIMITS)
@@ -46,6 +47,7 @@
 enum lquota_local_oid {
 	LQUOTA_USR_OID		= 1UL, /* slave index copy for user quota */
 	LQUOTA_GRP_OID		= 2UL, /* slave index copy for group quota */
+	LQUOTA_PRJ_OID		= 3UL, /* slave index copy for project quota */
 	/* all OIDs after this are allocated dynamically by the QMT */
 	LQUOTA_GENERATED_OID	= 4096UL,
 };
@@ -132,6 +134,15 @@ struct lquota_slv_entry {
 
 	/* when latest edquot set */
 	__u64			lse_edquot_time;
+
+	/* space consumed since lse_rate_time, in inodes or kbytes */
+	__u64			lse_consumed;
+
+	/* smoothed consumption rate, in inodes or kbytes per second */
+	__u64			lse_rate;
+
+	/* when the consumption rate was last sampled, in seconds */
+	__u64			lse_rate_time;
 };
 
 /* In-memory entry for each enforced quota id
@@ -212,6 +223,9 @@ struct lquota_site {
 #define lqe_acq_rc		u.se.lse_acq_rc
 #define lqe_acq_time		u.se.lse_acq_time
 #define lqe_edquot_time		u.se.lse_edquot_time
+#define lqe_consumed		u.se.lse_consumed
+#define lqe_rate		u.se.lse_rate
+#define lqe_rate_time		u.se.lse_rate_time
 
 #define LQUOTA_BUMP_VER 0x1
 #define LQUOTA_SET_VER  0x2
@@ -279,8 +293,9 @@ static inline void lqe_read_unlock(struct lquota_entry *lqe)
 #define LQUOTA_LEAST_QUNIT(type) \
 	(type == LQUOTA_RES_MD ? (1 << 10) : toqb(OFD_MAX_BRW_SIZE))
 
-#define LQUOTA_OVER_FL(type) \
-	(type == USRQUOTA ? QUOTA_FL_OVER_USRQUOTA : QUOTA_FL_OVER_GRPQUOTA)
+#define LQUOTA_OVER_FL(type)					\
+	(type == USRQUOTA ? QUOTA_FL_OVER_USRQUOTA :		\
+	 type == GRPQUOTA ? QUOTA_FL_OVER_GRPQUOTA : QUOTA_FL_OVER_PRJQUOTA)
 
 /* Common data shared by quota-level handlers. This is allocated per-thread to
  * reduce stack consumption */
@@ -367,6 +382,7 @@ void lquota_lqe_debug0(struct lquota_entry *lqe,
 /* lquota_lib.c */
 struct dt_object *acct_obj_lookup(const struct lu_env *, struct dt_device *,
 				  int);
+__u32 lquota_slv_oid(int);
 void lquota_generate_fid(struct lu_fid *, int, int, int);
 int lquota_extract_fid(const struct lu_fid *, int *, int *, int *);
 const struct dt_index_features *glb_idx_feature(struct lu_fid *);
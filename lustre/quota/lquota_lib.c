@@ -54,13 +54,44 @@ LU_KEY_INIT_FINI(lquota, struct lquota_thread_info);
 LU_CONTEXT_KEY_DEFINE(lquota, LCT_MD_THREAD | LCT_DT_THREAD | LCT_LOCAL);
 LU_KEY_INIT_GENERIC(lquota);
 
+/* reserved FID of the accounting object, indexed by quota type */
+static const __u32 acct_oid[LL_MAXQUOTAS] = {
+	[USRQUOTA]	= ACCT_USER_OID,
+	[GRPQUOTA]	= ACCT_GROUP_OID,
+	[PRJQUOTA]	= ACCT_PROJECT_OID,
+};
+
+/* reserved OID of the local slave index copy, indexed by quota type */
+static const __u32 slv_oid[LL_MAXQUOTAS] = {
+	[USRQUOTA]	= LQUOTA_USR_OID,
+	[GRPQUOTA]	= LQUOTA_GRP_OID,
+	[PRJQUOTA]	= LQUOTA_PRJ_OID,
+};
+
+/* quota type as stored in the global index FID, indexed by quota type */
+static const __u8 lquota_type[LL_MAXQUOTAS] = {
+	[USRQUOTA]	= LQUOTA_TYPE_USR,
+	[GRPQUOTA]	= LQUOTA_TYPE_GRP,
+	[PRJQUOTA]	= LQUOTA_TYPE_PRJ,
+};
+
 /**
- * Look-up accounting object to collect space usage information for user
- * or group.
+ * Return the reserved OID of the local slave index copy for quota type
+ * \a type.
+ */
+__u32 lquota_slv_oid(int type)
+{
+	LASSERT(type >= 0 && type < LL_MAXQUOTAS);
+	return slv_oid[type];
+}
+
+/**
+ * Look-up accounting object to collect space usage information for user,
+ * group or project.
  *
  * \param env  - is the environment passed by the caller
  * \param dev  - is the dt_device storing the accounting object
- * \param type - is the quota type, either USRQUOTA or GRPQUOTA
+ * \param type - is the quota type, USRQUOTA, GRPQUOTA or PRJQUOTA
  */
 struct dt_object *acct_obj_lookup(const struct lu_env *env,
 				  struct dt_device *dev, int type)
@@ -69,8 +100,10 @@ struct dt_object *acct_obj_lookup(const struct lu_env *env,
 	struct dt_object		*obj = NULL;
 	ENTRY;
 
-	lu_local_obj_fid(&qti->qti_fid,
-			 type == USRQUOTA ? ACCT_USER_OID : ACCT_GROUP_OID);
+	if (type < 0 || type >= LL_MAXQUOTAS)
+		RETURN(ERR_PTR(-EINVAL));
+
+	lu_local_obj_fid(&qti->qti_fid, acct_oid[type]);
 
 	/* lookup the accounting object */
 	obj = dt_locate(env, dev, &qti->qti_fid);
@@ -100,11 +133,12 @@ struct dt_object *acct_obj_lookup(const struct lu_env *env,
 }
 
 /**
- * Initialize slave index object to collect local quota limit for user or group.
+ * Initialize slave index object to collect local quota limit for user, group
+ * or project.
  *
  * \param env - is the environment passed by the caller
  * \param dev - is the dt_device storing the slave index object
- * \param type - is the quota type, either USRQUOTA or GRPQUOTA
+ * \param type - is the quota type, USRQUOTA, GRPQUOTA or PRJQUOTA
  */
 static struct dt_object *quota_obj_lookup(const struct lu_env *env,
 					  struct dt_device *dev, int type)
@@ -114,7 +148,7 @@ static struct dt_object *quota_obj_lookup(const struct lu_env *env,
 	ENTRY;
 
 	qti->qti_fid.f_seq = FID_SEQ_QUOTA;
-	qti->qti_fid.f_oid = type == USRQUOTA ? LQUOTA_USR_OID : LQUOTA_GRP_OID;
+	qti->qti_fid.f_oid = lquota_slv_oid(type);
 	qti->qti_fid.f_ver = 0;
 
 	/* lookup the quota object */
@@ -173,7 +207,7 @@ int lquotactl_slv(const struct lu_env *env, struct dt_device *dev,
 		RETURN(-EOPNOTSUPP);
 	}
 
-	if (oqctl->qc_type != USRQUOTA && oqctl->qc_type != GRPQUOTA)
+	if (oqctl->qc_type < 0 || oqctl->qc_type >= LL_MAXQUOTAS)
 		/* no support for directory quota yet */
 		RETURN(-EOPNOTSUPP);
 
@@ -242,7 +276,8 @@ void lquota_generate_fid(struct lu_fid *fid, int pool_id, int pool_type,
 {
 	__u8	 qtype;
 
-	qtype = (quota_type == USRQUOTA) ? LQUOTA_TYPE_USR : LQUOTA_TYPE_GRP;
+	LASSERT(quota_type >= 0 && quota_type < LL_MAXQUOTAS);
+	qtype = lquota_type[quota_type];
 
 	fid->f_seq = FID_SEQ_QUOTA_GLB;
 	fid->f_oid = (qtype << 24) | (pool_type << 16) | (__u16)pool_id;
@@ -283,7 +318,17 @@ int lquota_extract_fid(const struct lu_fid *fid, int *pool_id, int *pool_type,
 		if (tmp >= LQUOTA_TYPE_MAX)
 			RETURN(-ENOTSUPP);
 
-		*quota_type = (tmp == LQUOTA_TYPE_USR) ? USRQUOTA : GRPQUOTA;
+		switch (tmp) {
+		case LQUOTA_TYPE_USR:
+			*quota_type = USRQUOTA;
+			break;
+		case LQUOTA_TYPE_GRP:
+			*quota_type = GRPQUOTA;
+			break;
+		default:
+			*quota_type = PRJQUOTA;
+			break;
+		}
 	}
 
 	RETURN(0);
@@ -316,7 +361,10 @@ const struct dt_index_features *glb_idx_feature(struct lu_fid *fid)
 	if (rc)
 		return ERR_PTR(rc);
 
-	if (quota_type == USRQUOTA) {
+	if (quota_type == PRJQUOTA) {
+		/* no administrative quota file to convert for project */
+		return &dt_quota_glb_features;
+	} else if (quota_type == USRQUOTA) {
 		if (res_type == LQUOTA_RES_MD)
 			return &dt_quota_iusr_features;
 		else
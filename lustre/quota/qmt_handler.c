@@ -190,6 +190,31 @@ out_nolock:
 	return rc;
 }
 
+/*
+ * Check whether limits of the given quota type can be enforced.
+ * Project limits would never be enforced as long as the backend OSD does not
+ * account space per project, so they are rejected until it does.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param qmt  - is the master device
+ * \param type - is the quota type
+ */
+static bool qmt_type_supported(const struct lu_env *env,
+			       struct qmt_device *qmt, int type)
+{
+	struct dt_object	*obj;
+
+	if (type != PRJQUOTA)
+		return true;
+
+	obj = acct_obj_lookup(env, qmt->qmt_child, type);
+	if (IS_ERR(obj))
+		return false;
+
+	lu_object_put(env, &obj->do_lu);
+	return true;
+}
+
 /*
  * Handle quotactl request.
  *
@@ -209,7 +234,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 
 	LASSERT(qmt != NULL);
 
-	if (oqctl->qc_type >= MAXQUOTAS)
+	if (oqctl->qc_type >= LL_MAXQUOTAS)
 		/* invalid quota type */
 		RETURN(-EINVAL);
 
@@ -231,6 +256,9 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		break;
 
 	case Q_SETINFO:  /* modify grace times */
+		if (!qmt_type_supported(env, qmt, oqctl->qc_type))
+			RETURN(-EOPNOTSUPP);
+
 		/* setinfo should be using dqi->dqi_valid, but lfs incorrectly
 		 * sets the valid flags in dqb->dqb_valid instead, try to live
 		 * with that ... */
@@ -291,6 +319,10 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		if (oqctl->qc_id == 0)
 			/* can't enforce a quota limit for root user & group */
 			RETURN(-EPERM);
+
+		if (!qmt_type_supported(env, qmt, oqctl->qc_type))
+			RETURN(-EOPNOTSUPP);
+
 		/* extract quota ID from quotactl request */
 		id->qid_uid = oqctl->qc_id;
 
@@ -158,7 +158,7 @@ static int qpi_state_seq_show(struct seq_file *m, void *data)
 		   atomic_read(&pool->qpi_ref),
 		   pool->qpi_least_qunit);
 
-	for (type = 0; type < MAXQUOTAS; type++)
+	for (type = 0; type < LL_MAXQUOTAS; type++)
 		seq_printf(m, "    %s:\n"
 			   "        #slv: %d\n"
 			   "        #lqe: %d\n",
@@ -266,7 +266,7 @@ static void qmt_pool_free(const struct lu_env *env, struct qmt_pool_info *pool)
 
 	/* release per-quota type site used to manage quota entries as well as
 	 * references to global index files */
-	for (qtype = 0; qtype < MAXQUOTAS; qtype++) {
+	for (qtype = 0; qtype < LL_MAXQUOTAS; qtype++) {
 		/* release lqe storing grace time */
 		if (pool->qpi_grace_lqe[qtype] != NULL)
 			lqe_putref(pool->qpi_grace_lqe[qtype]);
@@ -480,7 +480,7 @@ int qmt_pool_prepare(const struct lu_env *env, struct qmt_device *qmt,
 			RETURN(PTR_ERR(obj));
 		pool->qpi_root = obj;
 
-		for (qtype = 0; qtype < MAXQUOTAS; qtype++) {
+		for (qtype = 0; qtype < LL_MAXQUOTAS; qtype++) {
 			/* Generating FID of global index in charge of storing
 			 * settings for this quota type */
 			lquota_generate_fid(&qti->qti_fid, pool_id, pool_type,
@@ -653,7 +653,7 @@ out:
  *              pool configuration
  * \param pool_id   - is the 16-bit identifier of the pool
  * \param pool_type - is the pool type, either LQUOTA_RES_MD or LQUOTA_RES_DT.
- * \param qtype     - is the quota type, either user or group.
+ * \param qtype     - is the quota type, either user, group or project.
  * \param qid       - is the quota ID to look-up
  *
  * \retval - valid pointer to lquota entry on success, appropriate error on
@@ -140,13 +140,14 @@ static void qsd_lqe_debug(struct lquota_entry *lqe, void *arg,
 	libcfs_debug_vmsg2(msgdata, fmt, args,
 			   "qsd:%s qtype:%s id:"LPU64" enforced:%d granted:"
 			   LPU64" pending:"LPU64" waiting:"LPU64" req:%d usage:"
-			   LPU64" qunit:"LPU64" qtune:"LPU64" edquot:%d\n",
+			   LPU64" qunit:"LPU64" qtune:"LPU64" edquot:%d rate:"
+			   LPU64"\n",
 			   qqi->qqi_qsd->qsd_svname, QTYPE_NAME(qqi->qqi_qtype),
 			   lqe->lqe_id.qid_uid, lqe->lqe_enforced,
 			   lqe->lqe_granted, lqe->lqe_pending_write,
 			   lqe->lqe_waiting_write, lqe->lqe_pending_req,
 			   lqe->lqe_usage, lqe->lqe_qunit, lqe->lqe_qtune,
-			   lqe->lqe_edquot);
+			   lqe->lqe_edquot, lqe->lqe_rate);
 }
 
 /*
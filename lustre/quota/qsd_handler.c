@@ -142,6 +142,57 @@ static int qsd_ready(struct lquota_entry *lqe, struct lustre_handle *lockh)
 	RETURN(0);
 }
 
+/**
+ * Account quota space consumed by an operation and, once per second, fold
+ * it into the smoothed consumption rate of the ID. A higher rate is taken
+ * at once so that a burst of writes is followed immediately, a lower rate
+ * decays slowly. Must be called with lqe write lock held.
+ *
+ * \param lqe   - is the qid entry the space was consumed from
+ * \param space - is the amount of quota space consumed
+ */
+static void qsd_lqe_consume(struct lquota_entry *lqe, __u64 space)
+{
+	__u64	now = cfs_time_current_sec();
+	__u64	rate;
+
+	lqe->lqe_consumed += space;
+	if (now < lqe->lqe_rate_time + 1)
+		return;
+
+	rate = lqe->lqe_consumed;
+	if (lqe->lqe_rate_time != 0)
+		do_div(rate, now - lqe->lqe_rate_time);
+	if (rate > lqe->lqe_rate)
+		lqe->lqe_rate = rate;
+	else
+		lqe->lqe_rate = (3 * lqe->lqe_rate + rate) >> 2;
+
+	lqe->lqe_consumed = 0;
+	lqe->lqe_rate_time = now;
+}
+
+/**
+ * How much spare quota space a slave should own for a given ID before
+ * pre-acquiring more. This is qtune, or what the ID is expected to consume
+ * within the next qsd_preacq_horizon seconds if more, so that the master
+ * is asked for space before writers run out of it. Never more than qunit,
+ * which is what the master grants back to a pre-acquire at most.
+ *
+ * \param lqe - is the lquota entry to compute the margin for
+ */
+static __u64 qsd_preacq_margin(struct lquota_entry *lqe)
+{
+	int	horizon = lqe2qqi(lqe)->qqi_qsd->qsd_preacq_horizon;
+	__u64	margin;
+
+	if (horizon == 0 || lqe->lqe_rate == 0)
+		return lqe->lqe_qtune;
+
+	margin = min(lqe->lqe_rate * horizon, lqe->lqe_qunit);
+	return max(margin, lqe->lqe_qtune);
+}
+
 /**
  * Check whether any quota space adjustment (pre-acquire/release/report) is
  * needed for a given quota ID. If a non-null \a qbody is passed, then the
@@ -265,7 +316,7 @@ static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 
 	/* 3. Time to pre-acquire? */
 	if (!lqe->lqe_edquot && !lqe->lqe_nopreacq && usage > 0 &&
-	    lqe->lqe_qunit != 0 && granted < usage + lqe->lqe_qtune) {
+	    lqe->lqe_qunit != 0 && granted < usage + qsd_preacq_margin(lqe)) {
 		/* To pre-acquire quota space, we report how much spare quota
 		 * space the slave currently owns, then the master will grant us
 		 * back how much we can pretend given the current state of
@@ -457,6 +508,7 @@ static int qsd_acquire_local(struct lquota_entry *lqe, __u64 space)
 		/* Yay! we got enough space */
 		lqe->lqe_pending_write += space;
 		lqe->lqe_waiting_write -= space;
+		qsd_lqe_consume(lqe, space);
 		rc = 0;
 	/* lqe_edquot flag is used to avoid flooding dqacq requests when
 	 * the user is over quota, however, the lqe_edquot could be stale
@@ -1114,7 +1166,7 @@ EXPORT_SYMBOL(qsd_op_end);
  *              of the operation.
  * \param qid - is the lquota ID of the user/group for which to trigger
  *              quota space adjustment
- * \param qtype - is the quota type (USRQUOTA or GRPQUOTA)
+ * \param qtype - is the quota type (USRQUOTA, GRPQUOTA or PRJQUOTA)
  */
 void qsd_op_adjust(const struct lu_env *env, struct qsd_instance *qsd,
 		   union lquota_id *qid, int qtype)
@@ -70,7 +70,7 @@ struct qsd_instance {
 	 *
 	 * This will have to be revisited if new quota types are added in the
 	 * future. For the time being, we can just use an array. */
-	struct qsd_qtype_info	*qsd_type_array[MAXQUOTAS];
+	struct qsd_qtype_info	*qsd_type_array[LL_MAXQUOTAS];
 
 	/* per-filesystem quota information */
 	struct qsd_fsinfo	*qsd_fsinfo;
@@ -107,6 +107,10 @@ struct qsd_instance {
 	 * enforced here (via procfs) */
 	int			 qsd_timeout;
 
+	/* how many seconds of consumption (at the current per-ID rate)
+	 * to pre-acquire ahead of writers, 0 to only keep qtune */
+	int			 qsd_preacq_horizon;
+
 	unsigned long		 qsd_is_md:1,    /* managing quota for mdt */
 				 qsd_started:1,  /* instance is now started */
 				 qsd_prepared:1, /* qsd_prepare() successfully
@@ -126,7 +130,7 @@ struct qsd_qtype_info {
 	/* reference count incremented by each user of this structure */
 	atomic_t		 qqi_ref;
 
-	/* quota type, either USRQUOTA or GRPQUOTA
+	/* quota type, either USRQUOTA, GRPQUOTA or PRJQUOTA
 	 * immutable after creation. */
 	int			 qqi_qtype;
 
@@ -277,11 +281,17 @@ static inline int qsd_type_enabled(struct qsd_instance *qsd, int type)
 	int	enabled, pool;
 
 	LASSERT(qsd != NULL);
-	LASSERT(type < MAXQUOTAS);
+	LASSERT(type < LL_MAXQUOTAS);
 
 	if (qsd->qsd_fsinfo == NULL)
 		return 0;
 
+	/* unlike user & group, project usage is only tracked by some OSD
+	 * backends, so enforcement is silently skipped without accounting */
+	if (type == PRJQUOTA && (qsd->qsd_type_array[type] == NULL ||
+				 qsd->qsd_type_array[type]->qqi_acct_obj == NULL))
+		return 0;
+
 	pool = qsd->qsd_is_md ? LQUOTA_RES_MD : LQUOTA_RES_DT;
 	enabled = qsd->qsd_fsinfo->qfs_enabled[pool - LQUOTA_FIRST_RES];
 
@@ -336,6 +346,9 @@ static inline int qsd_wait_timeout(struct qsd_instance *qsd)
 	return min_t(int, at_max / 2, obd_timeout / 2);
 }
 
+/* default pre-acquire horizon, in seconds */
+#define QSD_PREACQ_HORIZON	2
+
 /* qsd_entry.c */
 extern struct lquota_entry_operations qsd_lqe_ops;
 int qsd_refresh_usage(const struct lu_env *, struct lquota_entry *);
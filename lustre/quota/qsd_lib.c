@@ -86,6 +86,8 @@ static int qsd_state_seq_show(struct seq_file *m, void *data)
 		strcat(enabled, "u");
 	if (qsd_type_enabled(qsd, GRPQUOTA))
 		strcat(enabled, "g");
+	if (qsd_type_enabled(qsd, PRJQUOTA))
+		strcat(enabled, "p");
 	if (strlen(enabled) == 0)
 		strcat(enabled, "none");
 
@@ -104,18 +106,24 @@ static int qsd_state_seq_show(struct seq_file *m, void *data)
 			strcat(enabled, "u");
 		if (qsd->qsd_type_array[GRPQUOTA]->qqi_acct_obj != NULL)
 			strcat(enabled, "g");
+		if (qsd->qsd_type_array[PRJQUOTA]->qqi_acct_obj != NULL)
+			strcat(enabled, "p");
 		if (strlen(enabled) == 0)
 			strcat(enabled, "none");
 		rc += seq_printf(m, "space acct:     %s\n"
 				"user uptodate:  glb[%d],slv[%d],reint[%d]\n"
-				"group uptodate: glb[%d],slv[%d],reint[%d]\n",
+				"group uptodate: glb[%d],slv[%d],reint[%d]\n"
+				"project uptodate: glb[%d],slv[%d],reint[%d]\n",
 				enabled,
 				qsd->qsd_type_array[USRQUOTA]->qqi_glb_uptodate,
 				qsd->qsd_type_array[USRQUOTA]->qqi_slv_uptodate,
 				qsd->qsd_type_array[USRQUOTA]->qqi_reint,
 				qsd->qsd_type_array[GRPQUOTA]->qqi_glb_uptodate,
 				qsd->qsd_type_array[GRPQUOTA]->qqi_slv_uptodate,
-				qsd->qsd_type_array[GRPQUOTA]->qqi_reint);
+				qsd->qsd_type_array[GRPQUOTA]->qqi_reint,
+				qsd->qsd_type_array[PRJQUOTA]->qqi_glb_uptodate,
+				qsd->qsd_type_array[PRJQUOTA]->qqi_slv_uptodate,
+				qsd->qsd_type_array[PRJQUOTA]->qqi_reint);
 	}
 	return rc;
 }
@@ -133,6 +141,8 @@ static int qsd_enabled_seq_show(struct seq_file *m, void *data)
 		strcat(enabled, "u");
 	if (qsd_type_enabled(qsd, GRPQUOTA))
 		strcat(enabled, "g");
+	if (qsd_type_enabled(qsd, PRJQUOTA))
+		strcat(enabled, "p");
 	if (strlen(enabled) == 0)
 		strcat(enabled, "none");
 
@@ -160,7 +170,7 @@ lprocfs_force_reint_seq_write(struct file *file, const char *buffer,
 		rc = -EAGAIN;
 	} else {
 		/* mark all indexes as stale */
-		for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++) {
+		for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++) {
 			qsd->qsd_type_array[qtype]->qqi_glb_uptodate = false;
 			qsd->qsd_type_array[qtype]->qqi_slv_uptodate = false;
 		}
@@ -171,7 +181,7 @@ lprocfs_force_reint_seq_write(struct file *file, const char *buffer,
 		return rc;
 
 	/* kick off reintegration */
-	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++) {
+	for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++) {
 		rc = qsd_start_reint_thread(qsd->qsd_type_array[qtype]);
 		if (rc)
 			break;
@@ -207,6 +217,33 @@ qsd_timeout_seq_write(struct file *file, const char *buffer,
 }
 LPROC_SEQ_FOPS(qsd_timeout);
 
+static int qsd_preacq_horizon_seq_show(struct seq_file *m, void *data)
+{
+	struct qsd_instance *qsd = m->private;
+	LASSERT(qsd != NULL);
+
+	return seq_printf(m, "%d\n", qsd->qsd_preacq_horizon);
+}
+
+static ssize_t
+qsd_preacq_horizon_seq_write(struct file *file, const char *buffer,
+			     size_t count, loff_t *off)
+{
+	struct qsd_instance *qsd = ((struct seq_file *)file->private_data)->private;
+	int		     horizon, rc;
+	LASSERT(qsd != NULL);
+
+	rc = lprocfs_write_helper(buffer, count, &horizon);
+	if (rc)
+		return rc;
+	if (horizon < 0)
+		return -EINVAL;
+
+	qsd->qsd_preacq_horizon = horizon;
+	return count;
+}
+LPROC_SEQ_FOPS(qsd_preacq_horizon);
+
 static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	{ .name	=	"info",
 	  .fops	=	&qsd_state_fops		},
@@ -216,6 +253,8 @@ static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	  .fops	=	&qsd_force_reint_fops	},
 	{ .name	=	"timeout",
 	  .fops	=	&qsd_timeout_fops	},
+	{ .name	=	"preacq_horizon",
+	  .fops	=	&qsd_preacq_horizon_fops	},
 	{ NULL }
 };
 
@@ -250,7 +289,7 @@ static int qsd_conn_callback(void *data)
 	 * reintegration procedure (i.e. global lock enqueue and slave
 	 * index transfer) since the space usage reconciliation (i.e.
 	 * step 3) will have to wait for qsd_start() to be called */
-	for (type = USRQUOTA; type < MAXQUOTAS; type++) {
+	for (type = USRQUOTA; type < LL_MAXQUOTAS; type++) {
 		struct qsd_qtype_info *qqi = qsd->qsd_type_array[type];
 		wake_up(&qqi->qqi_reint_thread.t_ctl_waitq);
 	}
@@ -394,7 +433,9 @@ static int qsd_qtype_init(const struct lu_env *env, struct qsd_instance *qsd,
 		       qsd->qsd_svname, QTYPE_NAME(qtype),
 		       PTR_ERR(qqi->qqi_acct_obj));
 		qqi->qqi_acct_obj = NULL;
-		qsd->qsd_acct_failed = true;
+		/* project accounting is optional, see qsd_type_enabled() */
+		if (qtype != PRJQUOTA)
+			qsd->qsd_acct_failed = true;
 	}
 
 	/* open global index copy */
@@ -435,7 +476,9 @@ static int qsd_qtype_init(const struct lu_env *env, struct qsd_instance *qsd,
 
 	/* register proc entry for accounting & global index copy objects */
 	rc = lprocfs_seq_create(qsd->qsd_proc,
-				qtype == USRQUOTA ? "acct_user" : "acct_group",
+				qtype == USRQUOTA ? "acct_user" :
+				qtype == GRPQUOTA ? "acct_group" :
+						    "acct_project",
 				0444, &lprocfs_quota_seq_fops,
 				qqi->qqi_acct_obj);
 	if (rc) {
@@ -445,7 +488,9 @@ static int qsd_qtype_init(const struct lu_env *env, struct qsd_instance *qsd,
 	}
 
 	rc = lprocfs_seq_create(qsd->qsd_proc,
-				qtype == USRQUOTA ? "limit_user" : "limit_group",
+				qtype == USRQUOTA ? "limit_user" :
+				qtype == GRPQUOTA ? "limit_group" :
+						    "limit_project",
 				0444, &lprocfs_quota_seq_fops,
 				qqi->qqi_glb_obj);
 	if (rc) {
@@ -492,7 +537,7 @@ void qsd_fini(const struct lu_env *env, struct qsd_instance *qsd)
 	qsd_stop_upd_thread(qsd);
 
 	/* shutdown the reintegration threads */
-	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++) {
+	for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++) {
 		if (qsd->qsd_type_array[qtype] == NULL)
 			continue;
 		qsd_stop_reint_thread(qsd->qsd_type_array[qtype]);
@@ -503,7 +548,7 @@ void qsd_fini(const struct lu_env *env, struct qsd_instance *qsd)
 	}
 
 	/* free per-quota type data */
-	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++)
+	for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++)
 		qsd_qtype_fini(env, qsd, qtype);
 
 	/* deregister connection to the quota master */
@@ -581,6 +626,7 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 	INIT_LIST_HEAD(&qsd->qsd_adjust_list);
 	qsd->qsd_prepared = false;
 	qsd->qsd_started = false;
+	qsd->qsd_preacq_horizon = QSD_PREACQ_HORIZON;
 
 	/* copy service name */
 	if (strlcpy(qsd->qsd_svname, svname, sizeof(qsd->qsd_svname))
@@ -690,7 +736,7 @@ int qsd_prepare(const struct lu_env *env, struct qsd_instance *qsd)
 	}
 
 	/* initialize per-quota type data */
-	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++) {
+	for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++) {
 		rc = qsd_qtype_init(env, qsd, qtype);
 		if (rc)
 			RETURN(rc);
@@ -702,7 +748,7 @@ int qsd_prepare(const struct lu_env *env, struct qsd_instance *qsd)
 	write_unlock(&qsd->qsd_lock);
 
 	/* start reintegration thread for each type, if required */
-	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++) {
+	for (qtype = USRQUOTA; qtype < LL_MAXQUOTAS; qtype++) {
 		struct qsd_qtype_info	*qqi = qsd->qsd_type_array[qtype];
 
 		if (qsd_type_enabled(qsd, qtype) && qsd->qsd_acct_failed) {
@@ -790,7 +836,7 @@ int qsd_start(const struct lu_env *env, struct qsd_instance *qsd)
 
 	/* Trigger the 3rd step of reintegration: If usage > granted, acquire
 	 * up to usage; If usage < granted, release down to usage.  */
-	for (type = USRQUOTA; type < MAXQUOTAS; type++) {
+	for (type = USRQUOTA; type < LL_MAXQUOTAS; type++) {
 		struct qsd_qtype_info	*qqi = qsd->qsd_type_array[type];
 		wake_up(&qqi->qqi_reint_thread.t_ctl_waitq);
 	}
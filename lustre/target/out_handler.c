@@ -1444,6 +1444,28 @@ static int out_trans_stop(const struct lu_env *env,
 	return rc;
 }
 
+/**
+ * Record the object modified by OUT for the incremental LFSCK.
+ *
+ * The cross-MDT updates bypass the MDD on this target, so the MDD cannot
+ * record the objects modified by them in the dirty set.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] arg	the executed update
+ */
+static void out_tx_mark_dirty(const struct lu_env *env, struct tx_arg *arg)
+{
+	struct lfsck_request *lr = &tgt_th_info(env)->tti_lr;
+
+	if (arg->object == NULL)
+		return;
+
+	lfsck_pack_rfa(lr, lu_object_fid(&arg->object->do_lu),
+		       LE_DIRTY_MARK, 0);
+	tgt_lfsck_in_notify(env, tgt_ses_info(env)->tsi_tgt->lut_bottom,
+			    lr, NULL);
+}
+
 static int out_tx_end(const struct lu_env *env, struct thandle_exec_args *ta,
 		      int declare_ret)
 {
@@ -1459,6 +1481,8 @@ static int out_tx_end(const struct lu_env *env, struct thandle_exec_args *ta,
 	if (declare_ret != 0 || ta->ta_argno == 0)
 		GOTO(stop, rc = declare_ret);
 
+	OBD_FAIL_TIMEOUT_MS(OBD_FAIL_OUT_UPDATE_DELAY, cfs_fail_val);
+
 	LASSERT(ta->ta_handle->th_dev != NULL);
 	rc = out_trans_start(env, ta);
 	if (unlikely(rc != 0))
@@ -1486,6 +1510,7 @@ static int out_tx_end(const struct lu_env *env, struct thandle_exec_args *ta,
 		}
 		CDEBUG(D_INFO, "%s: executed %u/%u: rc = %d\n",
 		       dt_obd_name(ta->ta_handle->th_dev), i, ta->ta_argno, rc);
+		out_tx_mark_dirty(env, ta->ta_args[i]);
 	}
 
 	/* Only fail for real update */
@@ -1525,9 +1550,13 @@ int out_handle(struct tgt_session_info *tsi)
 	int				 bufsize;
 	int				 count;
 	int				 current_batchid = -1;
+	__u64				 failed_batchid = 0;
+	bool				 failed = false;
+	bool				 batch;
 	int				 i;
 	int				 rc = 0;
 	int				 rc1 = 0;
+	int				 rc2 = 0;
 
 	ENTRY;
 
@@ -1576,6 +1605,7 @@ int out_handle(struct tgt_session_info *tsi)
 	object_update_reply_init(reply, count);
 	tti->tti_u.update.tti_update_reply = reply;
 	tti->tti_mult_trans = !req_is_replay(tgt_ses_req(tsi));
+	batch = ureq->ourq_flags & UPDATE_REQ_FL_BATCH;
 
 	/* Walk through updates in the request to execute them synchronously */
 	for (i = 0; i < count; i++) {
@@ -1619,6 +1649,11 @@ int out_handle(struct tgt_session_info *tsi)
 			GOTO(next, rc = -ENOTSUPP);
 		}
 
+		/* The rest of a failed transaction in the batch is skipped,
+		 * the sender sees no result for these updates. */
+		if (failed && update->ou_batchid == failed_batchid)
+			GOTO(next, rc = 0);
+
 		/* Check resend case only for modifying RPC */
 		if (h->th_flags & MUTABOR) {
 			struct ptlrpc_request *req = tgt_ses_req(tsi);
@@ -1642,6 +1677,13 @@ int out_handle(struct tgt_session_info *tsi)
 		     !(h->th_flags & MUTABOR)) && ta->ta_handle != NULL) {
 			rc = out_tx_end(env, ta, rc);
 			current_batchid = -1;
+			if (rc != 0 && batch) {
+				/* the previous transaction failed as a whole,
+				 * go on with this one */
+				if (rc2 == 0)
+					rc2 = rc;
+				rc = 0;
+			}
 			if (rc != 0)
 				GOTO(next, rc);
 
@@ -1658,6 +1700,18 @@ int out_handle(struct tgt_session_info *tsi)
 		rc = h->th_act(tsi);
 next:
 		lu_object_put(env, &dt_obj->do_lu);
+		if (rc < 0 && batch) {
+			/* abort the failed transaction only */
+			if (current_batchid != -1) {
+				out_tx_end(env, ta, rc);
+				current_batchid = -1;
+			}
+			failed = true;
+			failed_batchid = update->ou_batchid;
+			if (rc2 == 0)
+				rc2 = rc;
+			rc = 0;
+		}
 		if (rc < 0)
 			GOTO(out, rc);
 	}
@@ -1667,6 +1721,8 @@ out:
 		if (rc == 0)
 			rc = rc1;
 	}
+	if (rc == 0)
+		rc = rc2;
 
 	RETURN(rc);
 }
@@ -275,6 +275,75 @@ int out_remote_sync(const struct lu_env *env, struct obd_import *imp,
 }
 EXPORT_SYMBOL(out_remote_sync);
 
+/**
+ * Send update RPC as a part of a distributed transaction.
+ *
+ * The RPC is added to the request set of the transaction, so that the
+ * updates to all the remote targets are sent in parallel by
+ * out_remote_wait(). If the set cannot be allocated, the RPC is sent
+ * synchronously.
+ *
+ * \param[in] env	execution environment
+ * \param[in] imp	import on which ptlrpc request will be sent
+ * \param[in] dt_update	hold all of updates which will be packed into the req
+ * \param[in] tu	remote updates of the transaction
+ *
+ * \retval		0 if the RPC is prepared or succeeds.
+ * \retval		negative errno if the RPC fails.
+ */
+int out_remote_send(const struct lu_env *env, struct obd_import *imp,
+		    struct dt_update_request *dt_update,
+		    struct thandle_update *tu)
+{
+	struct ptlrpc_request	*req = NULL;
+	int			 rc;
+	ENTRY;
+
+	if (tu->tu_rqset == NULL) {
+		tu->tu_rqset = ptlrpc_prep_set();
+		if (tu->tu_rqset == NULL)
+			RETURN(out_remote_sync(env, imp, dt_update, NULL));
+	}
+
+	rc = out_prep_update_req(env, imp, dt_update->dur_buf.ub_req, &req);
+	if (rc != 0) {
+		dt_update->dur_rc = rc;
+		RETURN(rc);
+	}
+
+	/* for distributed debugging */
+	lustre_msg_set_status(req->rq_reqmsg, current_pid());
+	ptlrpc_set_add_req(tu->tu_rqset, req);
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(out_remote_send);
+
+/**
+ * Wait for the update RPCs sent by out_remote_send().
+ *
+ * \param[in] env	execution environment
+ * \param[in] tu	remote updates of the transaction
+ *
+ * \retval		0 if all the RPCs succeed.
+ * \retval		negative errno if any RPC fails.
+ */
+int out_remote_wait(const struct lu_env *env, struct thandle_update *tu)
+{
+	int rc;
+	ENTRY;
+
+	if (tu == NULL || tu->tu_rqset == NULL)
+		RETURN(0);
+
+	rc = ptlrpc_set_wait(tu->tu_rqset);
+	ptlrpc_set_destroy(tu->tu_rqset);
+	tu->tu_rqset = NULL;
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(out_remote_wait);
+
 /**
  * resize update buffer
  *
@@ -286,11 +355,11 @@ EXPORT_SYMBOL(out_remote_sync);
  * \retval		0 if extending succeeds.
  * \retval		negative errno if extending fails.
  */
-static int update_buffer_resize(struct update_buffer *ubuf, size_t new_size)
+int update_buffer_resize(struct update_buffer *ubuf, size_t new_size)
 {
 	struct object_update_request *ureq;
 
-	if (new_size > ubuf->ub_req_size)
+	if (new_size <= ubuf->ub_req_size)
 		return 0;
 
 	OBD_ALLOC_LARGE(ureq, new_size);
@@ -306,6 +375,58 @@ static int update_buffer_resize(struct update_buffer *ubuf, size_t new_size)
 
 	return 0;
 }
+EXPORT_SYMBOL(update_buffer_resize);
+
+/**
+ * Append all the updates of another request to the update buffer.
+ *
+ * The updates of \a ureq are copied to the end of \a ubuf, which is not
+ * enlarged so that it can be done under a spinlock. They get new batchids
+ * starting from \a batchid, which is moved past the last one used, so the
+ * merged transactions stay separate transactions for the OUT handler.
+ *
+ * \param[in] ubuf	update buffer to append the updates to
+ * \param[in] ureq	update request holding the updates to be appended
+ * \param[in,out] batchid	first batchid to be used
+ *
+ * \retval		0 if the updates are appended
+ * \retval		-E2BIG if \a ubuf is too small, nothing is appended
+ */
+int out_update_merge(struct update_buffer *ubuf,
+		     const struct object_update_request *ureq, __u64 *batchid)
+{
+	struct object_update_request	*dst = ubuf->ub_req;
+	struct object_update		*update;
+	size_t				 dst_size;
+	size_t				 src_size;
+	__u64				 prev = 0;
+	__u64				 orig;
+	unsigned int			 i;
+
+	dst_size = object_update_request_size(dst);
+	src_size = object_update_request_size(ureq) -
+		   offsetof(struct object_update_request, ourq_updates[0]);
+	if (dst_size + src_size > ubuf->ub_req_size ||
+	    dst->ourq_count + ureq->ourq_count > USHRT_MAX)
+		return -E2BIG;
+
+	update = (struct object_update *)((char *)dst + dst_size);
+	memcpy(update, &ureq->ourq_updates[0], src_size);
+	for (i = 0; i < ureq->ourq_count; i++) {
+		orig = update->ou_batchid;
+		if (i > 0 && orig != prev)
+			(*batchid)++;
+		prev = orig;
+		update->ou_batchid = *batchid;
+		update = (struct object_update *)((char *)update +
+						  object_update_size(update));
+	}
+	(*batchid)++;
+	dst->ourq_count += ureq->ourq_count;
+
+	return 0;
+}
+EXPORT_SYMBOL(out_update_merge);
 
 /**
  * Pack the header of object_update_request
@@ -105,6 +105,21 @@ test_2() {
 }
 run_test 2 "Metadata survey with stripe_count = 1"
 
+test_3() {
+    local mdt=$(facet_svc $SINGLEMDS)
+    local cl_user
+
+    cl_user=$(do_facet $SINGLEMDS $LCTL --device $mdt changelog_register -n)
+    [ -n "$cl_user" ] || error "changelog_register failed"
+
+    # compare with test_1 for the cost of changelog records
+    mds_survey_run "mdd" "0"
+    do_facet $SINGLEMDS $LCTL get_param -n mdd.$mdt.changelog_users
+    do_facet $SINGLEMDS $LCTL --device $mdt changelog_deregister $cl_user ||
+        error "changelog_deregister $cl_user failed"
+}
+run_test 3 "Metadata survey with changelogs enabled"
+
 # remount the clients
 restore_mount $MOUNT
 
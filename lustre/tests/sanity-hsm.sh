@@ -1539,6 +1539,39 @@ test_16() {
 }
 run_test 16 "Test CT bandwith control option"
 
+test_17() {
+	# test needs a running copytool
+	copytool_setup
+
+	mkdir -p $DIR/$tdir
+	local f=$DIR/$tdir/$tfile
+	local afile=$HSM_ARCHIVE/$tdir/$tfile
+
+	# sparse archived file large enough to be restored by several
+	# streams, with data only at its beginning and at its end
+	do_facet $SINGLEAGT mkdir -p $(dirname $afile)
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$afile bs=1M count=1 ||
+		file_creation_failure dd $afile $?
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$afile bs=1M count=1 \
+		seek=255 conv=notrunc ||
+		file_creation_failure dd $afile $?
+
+	import_file $tdir/$tfile $f
+	local fid=$(path2fid $f)
+	$LFS hsm_restore $f
+	wait_request_state $fid RESTORE SUCCEED
+
+	local LSZ=$(stat -c "%s" $f)
+	local ASZ=$(do_facet $SINGLEAGT stat -c "%s" $afile)
+	[[ $LSZ -eq $ASZ ]] || error "Incorrect size $LSZ != $ASZ"
+
+	do_facet $SINGLEAGT cmp $afile $f ||
+		error "Restored file differs"
+
+	copytool_cleanup
+}
+run_test 17 "Restore a large sparse file with several copy streams"
+
 test_20() {
 	mkdir -p $DIR/$tdir
 
@@ -3981,6 +4014,36 @@ test_251() {
 }
 run_test 251 "Coordinator request timeout"
 
+test_252() {
+	# test needs a running copytool
+	copytool_setup
+
+	mkdir -p $DIR/$tdir
+	local f=$DIR/$tdir/$tfile
+	local fid=$(copy_file /etc/passwd $f)
+
+	get_hsm_param action_stats | grep -q "not loaded" &&
+		error "coordinator actions are not in memory"
+
+	$LFS hsm_archive --archive $HSM_ARCHIVE_NUMBER $f
+	wait_request_state $fid ARCHIVE SUCCEED
+
+	local stats=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		$HSM_PARAM.action_stats | grep "^ARCHIVE:")
+	echo "$stats"
+	local dispatched=$(echo "$stats" |
+		sed -e 's/.*dispatched=\([0-9]*\).*/\1/')
+	local completed=$(echo "$stats" |
+		sed -e 's/.*completed=\([0-9]*\).*/\1/')
+	[[ $dispatched -ge 1 ]] ||
+		error "archive not counted as dispatched: $stats"
+	[[ $completed -ge 1 ]] ||
+		error "archive not counted as completed: $stats"
+
+	copytool_cleanup
+}
+run_test 252 "Coordinator action statistics"
+
 test_300() {
 	# the only way to test ondisk conf is to restart MDS ...
 	echo "Stop coordinator and remove coordinator state at mount"
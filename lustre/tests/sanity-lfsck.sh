@@ -4212,6 +4212,96 @@ test_31h() {
 }
 run_test 31h "Repair the corrupted shard's name entry"
 
+lfsck_oit_run() {
+	local workers=$1
+
+	do_facet $SINGLEMDS "echo $workers > \
+		/sys/module/lfsck/parameters/lfsck_oit_workers"
+	$START_NAMESPACE -r || error "($workers) Fail to start LFSCK!"
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_NAMESPACE
+		error "($workers) unexpected status"
+	}
+}
+
+test_32() {
+	lfsck_prep 10 100
+
+	local saved=$(do_facet $SINGLEMDS \
+		cat /sys/module/lfsck/parameters/lfsck_oit_workers)
+
+	lfsck_oit_run 0
+	local checked0=$($SHOW_NAMESPACE |
+			 awk '/^checked_phase1/ { print $2 }')
+	local dirs0=$($SHOW_NAMESPACE | awk '/^directories/ { print $2 }')
+
+	lfsck_oit_run 4
+	local checked4=$($SHOW_NAMESPACE |
+			 awk '/^checked_phase1/ { print $2 }')
+	local dirs4=$($SHOW_NAMESPACE | awk '/^directories/ { print $2 }')
+	local failed=$($SHOW_NAMESPACE | awk '/^failed_phase1/ { print $2 }')
+
+	do_facet $SINGLEMDS "echo $saved > \
+		/sys/module/lfsck/parameters/lfsck_oit_workers"
+
+	[ $checked0 -eq $checked4 ] ||
+		error "(1) checked $checked4 objects, expect $checked0"
+	[ $dirs0 -eq $dirs4 ] ||
+		error "(2) checked $dirs4 directories, expect $dirs0"
+	[ $failed -eq 0 ] || error "(3) $failed objects failed"
+}
+run_test 32 "LFSCK scans the same objects with OIT workers"
+
+lfsck_incr_run() {
+	local msg=$1
+
+	shift
+	$START_NAMESPACE "$@" || error "($msg) Fail to start LFSCK!"
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_NAMESPACE
+		error "($msg) unexpected status"
+	}
+}
+
+test_33() {
+	lfsck_prep 10 100
+
+	echo "The first incremental LFSCK scans the whole device"
+	lfsck_incr_run 1 -r -i
+	$SHOW_NAMESPACE | grep "^param:" | grep -q incremental ||
+		error "(2) incremental mode is not recorded"
+	local full=$($SHOW_NAMESPACE |
+		     awk '/^checked_phase1/ { print $2 }')
+
+	echo "Modify some objects, then only check them"
+	touch $DIR/$tdir/d0/f{0,1,2} || error "(3) Fail to touch files"
+	chmod 0600 $DIR/$tdir/d1/f0 || error "(4) Fail to chmod"
+	mv $DIR/$tdir/d2/f0 $DIR/$tdir/d3/f_new || error "(5) Fail to rename"
+	sync
+
+	lfsck_incr_run 6 -i
+	local incr=$($SHOW_NAMESPACE |
+		     awk '/^checked_phase1/ { print $2 }')
+	local failed=$($SHOW_NAMESPACE | awk '/^failed_phase1/ { print $2 }')
+
+	[ $incr -lt $((full / 2)) ] ||
+		error "(7) checked $incr objects, full scan checked $full"
+	[ $failed -eq 0 ] || error "(8) $failed objects failed"
+
+	echo "The dirty set is reset after the incremental mode is off"
+	lfsck_incr_run 9 -ioff
+	$SHOW_NAMESPACE | grep "^param:" | grep -q incremental &&
+		error "(10) incremental mode is not cleared"
+	incr=$($SHOW_NAMESPACE | awk '/^checked_phase1/ { print $2 }')
+	[ $incr -ge $((full / 2)) ] ||
+		error "(11) checked $incr objects, expect the full scan"
+}
+run_test 33 "Incremental LFSCK only checks the modified objects"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -117,7 +117,7 @@ check_runas_id_ret $TSTUSR2 $TSTUSR2 $RUNAS2 ||
 
 resetquota() {
 	[ "$#" != 2 ] && error "resetquota: wrong number of arguments: $#"
-	[ "$1" != "-u" -a "$1" != "-g" ] &&
+	[ "$1" != "-u" -a "$1" != "-g" -a "$1" != "-p" ] &&
 		error "resetquota: wrong specifier $1 passed"
 
 	$LFS setquota "$1" "$2" -b 0 -B 0 -i 0 -I 0 $MOUNT ||
@@ -166,8 +166,8 @@ getquota() {
 	local uuid
 
 	[ "$#" != 4 ] && error "getquota: wrong number of arguments: $#"
-	[ "$1" != "-u" -a "$1" != "-g" ] &&
-		error "getquota: wrong u/g specifier $1 passed"
+	[ "$1" != "-u" -a "$1" != "-g" -a "$1" != "-p" ] &&
+		error "getquota: wrong u/g/p specifier $1 passed"
 
 	uuid="$3"
 
@@ -2379,6 +2379,68 @@ test_37() {
 }
 run_test 37 "Quota accounted properly for file created by 'lfs setstripe'"
 
+test_38() {
+	local LIMIT=10  # 10M
+	local TESTFILE="$DIR/$tdir/$tfile"
+	local param="osd-*.*OST*.quota_slave.preacq_horizon"
+	local horizon=$(do_facet ost1 $LCTL get_param -n $param | head -n1)
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	set_ost_qtype "u" || error "enable ost quota failed"
+	# pre-acquire well ahead of the writer
+	do_nodes $(comma_list $(osts_nodes)) $LCTL set_param $param=30
+
+	$LFS setquota -u $TSTUSR -b 0 -B ${LIMIT}M -i 0 -I 0 $DIR ||
+		error "set user quota failed"
+	$LFS setstripe $TESTFILE -c 1 -i 0
+	chown $TSTUSR.$TSTUSR $TESTFILE
+
+	log "Write..."
+	$RUNAS $DD of=$TESTFILE count=$((LIMIT/2)) ||
+		quota_error u $TSTUSR "user write failure, but expect success"
+	log "Write out of block quota ..."
+	$RUNAS $DD of=$TESTFILE count=$((LIMIT/2)) seek=$((LIMIT/2)) || true
+	cancel_lru_locks osc
+	$RUNAS $DD of=$TESTFILE count=1 seek=$LIMIT &&
+		quota_error u $TSTUSR "user write success, but expect EDQUOT"
+
+	do_nodes $(comma_list $(osts_nodes)) $LCTL set_param $param=$horizon
+	rm -f $TESTFILE
+	wait_delete_completed
+	resetquota -u $TSTUSR
+	cleanup_quota_test
+}
+run_test 38 "Rate based pre-acquire honors block hardlimit"
+
+test_39() {
+	local PRJID=1000
+	local LIMIT=10240  # 10M
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	$LFS quota -p $PRJID $DIR || error "lfs quota -p failed"
+	$LFS quota -t -p $DIR || error "lfs quota -t -p failed"
+	$RUNAS $LFS quota -p $PRJID $DIR &&
+		error "project quota readable by $TSTUSR"
+
+	# the project quota type has its own global index on the master
+	do_facet $SINGLEMDS $LCTL get_param -n "qmt.*.dt-0x0.glb-prj" ||
+		error "no project global index"
+
+	# no OSD accounts space per project yet, limits must be rejected
+	$LFS setquota -p $PRJID -b 0 -B ${LIMIT} -i 0 -I 0 $DIR &&
+		error "set project quota should fail"
+	local hard=$(getquota -p $PRJID global bhardlimit)
+	[ "$hard" = "0" ] ||
+		error "project block hardlimit $hard, expected 0"
+
+	cleanup_quota_test
+}
+run_test 39 "Project quota limits are rejected without project accounting"
+
 quota_fini()
 {
         do_nodes $(comma_list $(nodes_list)) "lctl set_param debug=-quota"
@@ -1141,6 +1141,55 @@ test_15() {
 }
 run_test 15 "Dryrun mode OI scrub"
 
+scrub_readahead_groups() {
+	do_nodes $(comma_list $(mdts_nodes)) $LCTL set_param -n \
+		osd-ldiskfs.*.scrub_readahead_groups=$1
+}
+
+scrub_get_field() {
+	local error_id=$1
+	local field=$2
+	local n
+
+	for n in $(seq $MDSCOUNT); do
+		scrub_status $n | awk "/^$field:/ { print \$2 }" ||
+			error "($error_id) Fail to get $field on mds$n"
+	done
+}
+
+test_16() {
+	scrub_prep 100
+	echo "starting MDTs with OI scrub disabled"
+	scrub_start_mds 1 "$MOUNT_OPTS_NOSCRUB"
+
+	local saved=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		osd-ldiskfs.${MDT_DEV}.scrub_readahead_groups)
+
+	scrub_readahead_groups 0
+	scrub_start 2 -r
+	scrub_check_status 3 completed
+	local checked0=$(scrub_get_field 4 checked)
+	local groups=$(scrub_get_field 5 readahead_groups)
+	for n in $groups; do
+		[ $n -eq 0 ] ||
+			error "(6) Expected no readahead, but got $n groups"
+	done
+
+	scrub_readahead_groups 16
+	scrub_start 7 -r
+	scrub_check_status 8 completed
+	local checked16=$(scrub_get_field 9 checked)
+	groups=$(scrub_get_field 10 readahead_groups)
+	scrub_readahead_groups $saved
+
+	for n in $groups; do
+		[ $n -gt 0 ] || error "(11) Expected readahead, but got none"
+	done
+	[ "$checked0" == "$checked16" ] ||
+		error "(12) Expected '$checked0' checked, but got '$checked16'"
+}
+run_test 16 "OI scrub reads inode tables ahead"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -7418,6 +7418,57 @@ test_116b() { # LU-2093
 }
 run_test 116b "QoS shouldn't LBUG if not enough OSTs found on the 2nd pass"
 
+test_116c() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ $OSTCOUNT -lt 2 ] && skip_env "need at least 2 OSTs" && return
+
+	local lod=lo*.$FSNAME-MDT0000-mdtlov
+	local osp=osp.$FSNAME-OST0000-osc-MDT0000
+	local old_prio=$(do_facet $SINGLEMDS lctl get_param -n \
+			 $lod.qos_prio_perf 2>/dev/null | head -1)
+	[ -z "$old_prio" ] && skip "no qos_prio_perf" && return
+	local old_lod_age=$(do_facet $SINGLEMDS lctl get_param -n \
+			    $lod.qos_maxage | head -1 | awk '{ print $1 }')
+	local old_osp_age=$(do_facet $SINGLEMDS lctl get_param -n \
+			    $osp.maxage)
+
+	do_facet $SINGLEMDS lctl set_param $lod.qos_prio_perf=100 \
+		$lod.qos_maxage=1 $osp.maxage=1
+
+	test_mkdir -p $DIR/$tdir
+	# slow down the bulk writes on OST0000
+	#define OBD_FAIL_OST_BRW_PAUSE_BULK      0x214
+	do_facet ost1 $LCTL set_param fail_val=1 fail_loc=0x80000214
+	$SETSTRIPE -i 0 -c 1 $DIR/$tdir/slow ||
+		error "setstripe $DIR/$tdir/slow failed"
+	dd if=/dev/zero of=$DIR/$tdir/slow bs=1M count=1 oflag=direct ||
+		error "write $DIR/$tdir/slow failed"
+	do_facet ost1 $LCTL set_param fail_val=0 fail_loc=0
+
+	wait_update_facet $SINGLEMDS \
+		"$LCTL get_param -n $osp.io_latency | \
+		 awk '{ print (\$1 > 500000) }'" 1 30 ||
+		error "I/O latency of OST0000 is not reported"
+
+	local count=$((OSTCOUNT * 50))
+	createmany -o $DIR/$tdir/f- $count || error "create files failed"
+	local on_ost0=0
+	local i
+	for ((i = 0; i < count; i++)); do
+		[ $($GETSTRIPE -i $DIR/$tdir/f-$i) -eq 0 ] &&
+			on_ost0=$((on_ost0 + 1))
+	done
+	echo "$on_ost0 of $count objects allocated on OST0000"
+
+	do_facet $SINGLEMDS lctl set_param $lod.qos_prio_perf=$old_prio \
+		$lod.qos_maxage=$old_lod_age $osp.maxage=$old_osp_age
+	rm -rf $DIR/$tdir
+
+	[ $on_ost0 -lt $((count / OSTCOUNT)) ] ||
+		error "slow OST0000 got $on_ost0 of $count objects"
+}
+run_test 116c "QoS should avoid the OSTs with high I/O latency"
+
 test_117() # bug 10891
 {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
@@ -10436,6 +10487,70 @@ test_160c() {
 }
 run_test 160c "verify that changelog log catch the truncate event"
 
+test_160d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 \
+		changelog_register -n)
+	local nrec
+
+	rm -rf $DIR/$tdir
+	mkdir -p $DIR/$tdir/sub || error "mkdir $tdir/sub failed"
+	touch $DIR/$tdir/f1 $DIR/$tdir/sub/f2 || error "touch failed"
+	rm -f $DIR/$tdir/f1 || error "rm f1 failed"
+
+	$LFS changelog --type CREAT,UNLNK $MDT0
+	nrec=$($LFS changelog --type CREAT,UNLNK $MDT0 |
+	       grep -vc "CREAT\|UNLNK")
+	[ $nrec -eq 0 ] || error "$nrec records of other types reported"
+
+	local pfid=$($LFS path2fid $DIR/$tdir/sub)
+	$LFS changelog --parent $pfid $MDT0
+	nrec=$($LFS changelog --parent $pfid $MDT0 | grep -c "f2")
+	[ $nrec -eq 1 ] || error "$nrec f2 records under $pfid, expect 1"
+	nrec=$($LFS changelog --parent $pfid $MDT0 | grep -c "f1")
+	[ $nrec -eq 0 ] || error "$nrec f1 records under $pfid, expect 0"
+
+	$LFS changelog_clear $MDT0 $USER 0
+	echo "deregistering $USER"
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+}
+run_test 160d "changelog records filtered by type and parent"
+
+test_160e() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 \
+		changelog_register -n)
+	local fid
+	local all
+	local collapsed
+	local i
+
+	rm -rf $DIR/$tdir
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	touch $DIR/$tdir/f || error "touch failed"
+	for i in 1 2 3 4 5; do
+		chmod 64$i $DIR/$tdir/f || error "chmod failed"
+	done
+	fid=$($LFS path2fid $DIR/$tdir/f | tr -d '[]')
+
+	all=$($LFS changelog $MDT0 | grep SATTR | grep -c "t=\[$fid\]")
+	collapsed=$($LFS changelog --collapse $MDT0 | grep SATTR |
+		    grep -c "t=\[$fid\]")
+	echo "SATTR records for $fid: $all, collapsed: $collapsed"
+	[ $collapsed -eq 1 ] || error "$collapsed SATTR records, expect 1"
+	$LFS changelog --collapse $MDT0 | grep -q "CREAT.*t=\[$fid\]" ||
+		error "CREAT record was collapsed"
+
+	$LFS changelog_clear $MDT0 $USER 0
+	echo "deregistering $USER"
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+}
+run_test 160e "changelog collapses superseded records"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	test_mkdir -p -c1 $DIR/$tdir
@@ -12941,6 +13056,36 @@ test_243()
 }
 run_test 243 "various group lock tests"
 
+test_244()
+{
+	local param="seq.cli-*MDT0000-mdc-*.width"
+	local count=1000
+	local old_width=$($LCTL get_param -n $param | head -1)
+
+	[ -z "$old_width" ] && skip "no client sequence width" && return
+
+	# switch the sequence (and prefetch the next one) every 100 files
+	$LCTL set_param $param=100
+	test_mkdir -c1 $DIR/$tdir
+	createmany -o $DIR/$tdir/f- $count
+	local rc=$?
+	$LCTL set_param $param=$old_width
+	[ $rc -eq 0 ] || error "createmany failed"
+
+	local fids=$(for ((i = 0; i < count; i++)); do
+			$LFS path2fid $DIR/$tdir/f-$i
+		     done | sort)
+	local nfids=$(echo "$fids" | uniq | wc -l)
+	local nseqs=$(echo "$fids" | awk -F ':' '{ print $1 }' | uniq | wc -l)
+	echo "$nfids FIDs in $nseqs sequences"
+
+	[ $nfids -eq $count ] || error "$((count - nfids)) duplicate FIDs"
+	[ $nseqs -ge $((count / 100)) ] ||
+		error "only $nseqs sequences used for $count files"
+	rm -rf $DIR/$tdir
+}
+run_test 244 "FID allocation across sequence switches"
+
 test_250() {
 	[ "$(facet_fstype ost$(($($GETSTRIPE -i $DIR/$tfile) + 1)))" = "zfs" ] \
 	 && skip "no 16TB file size limit on ZFS" && return
@@ -12955,6 +13100,196 @@ test_250() {
 }
 run_test 250 "Write above 16T limit"
 
+test_251() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local ostname=$(ostname_from_index 0)
+	local stats="osd-*.$ostname.extent_stats"
+	local objs
+
+	test_mkdir -p $DIR/$tdir
+	$SETSTRIPE -i 0 -c 1 $DIR/$tdir || error "setstripe $tdir failed"
+	do_facet ost1 $LCTL set_param -n $stats=clear
+
+	# one in 16 written objects leaving the cache is sampled
+	createmany -o $DIR/$tdir/f 64 || error "create files failed"
+	for i in $(seq 0 63); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=64k count=4 \
+			2>/dev/null || error "dd to f$i failed"
+	done
+	sync
+	cancel_lru_locks osc
+	# the lu_object shrinker evicts the unreferenced objects
+	do_facet ost1 "echo 2 > /proc/sys/vm/drop_caches"
+
+	do_facet ost1 $LCTL get_param -n $stats
+	objs=$(do_facet ost1 $LCTL get_param -n $stats |
+	       awk '/^extents per object/ { on = 1; next }
+		    /^object size/ { on = 0 }
+		    on && /^[0-9]+[KM]?:/ { sum += $2 } END { print sum + 0 }')
+	[ $objs -gt 0 ] || error "no evicted object sampled in $stats"
+	rm -rf $DIR/$tdir
+}
+run_test 251 "fragmentation of OST objects is sampled on cache eviction"
+
+test_252() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "only for ldiskfs MDT" && return
+
+	local mdtname=$(facet_svc $SINGLEMDS)
+	local status
+	local hits
+
+	status=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		 osd-ldiskfs.$mdtname.oi_cache | awk '/status:/ { print $2 }')
+	[ "$status" == "enabled" ] || { skip "OI cache disabled"; return; }
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f 100 || error "create files failed"
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null || error "ls $tdir failed"
+
+	hits=$(do_facet $SINGLEMDS $LCTL get_param -n \
+	       osd-ldiskfs.$mdtname.oi_cache | awk '/hits:/ { print $2 }')
+	echo "OI cache hits: $hits"
+	[ -n "$hits" ] || error "no OI cache statistics"
+	rm -rf $DIR/$tdir
+}
+run_test 252 "OI lookup cache statistics"
+
+test_253() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local mdtname=$(facet_svc $SINGLEMDS)
+	local hist="mdt.$mdtname.site_lookup_hist"
+	local lookups
+
+	do_facet $SINGLEMDS $LCTL set_param -n $hist=1
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f 100 || error "create files failed"
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null || error "ls $tdir failed"
+
+	do_facet $SINGLEMDS $LCTL get_param $hist
+	lookups=$(do_facet $SINGLEMDS $LCTL get_param -n $hist |
+		  awk '/^[0-9]+:/ { sum += $2 + $6 } END { print sum + 0 }')
+	do_facet $SINGLEMDS $LCTL set_param -n $hist=0
+	[ $lookups -gt 0 ] || error "no lookups in $hist"
+	rm -rf $DIR/$tdir
+}
+run_test 253 "lu_object lookup latency histogram"
+
+test_254() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "only for ldiskfs MDT" && return
+	which setfacl > /dev/null 2>&1 || { skip "no setfacl"; return; }
+
+	local mdtname=$(facet_svc $SINGLEMDS)
+	local stats="osd-ldiskfs.$mdtname.stats"
+	local hits
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f 100 || error "create files failed"
+	do_facet $SINGLEMDS $LCTL set_param -n $stats=clear
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null || error "ls $tdir failed"
+
+	hits=$(do_facet $SINGLEMDS $LCTL get_param -n $stats |
+	       awk '/xattr_absent_hit/ { print $2 }')
+	echo "absent xattr lookups answered from cache: $hits"
+	[ ${hits:-0} -gt 0 ] || error "no xattr_absent_hit in $stats"
+
+	# the cache must not hide an xattr added after it was loaded
+	setfacl -m u:$RUNAS_ID:rw $DIR/$tdir/f0 || error "setfacl failed"
+	cancel_lru_locks mdc
+	getfacl $DIR/$tdir/f0 | grep -q "user:.*:rw-" ||
+		error "ACL not visible after setfacl"
+	setfacl -b $DIR/$tdir/f0 || error "setfacl -b failed"
+	cancel_lru_locks mdc
+	getfacl $DIR/$tdir/f0 | grep -q "user:.*:rw-" &&
+		error "ACL still visible after removal"
+	rm -rf $DIR/$tdir
+}
+run_test 254 "MDT absent xattr lookups are cached"
+
+test_255() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local count=256
+	local ostname=$(ostname_from_index 0)
+	local osp="osc.$ostname-osc-MDT0000.drained_changes"
+	local drained
+	local destroys
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe $tdir failed"
+	createmany -o $DIR/$tdir/f $count || error "create files failed"
+	sync
+	wait_delete_completed
+
+	drained=$(do_facet $SINGLEMDS $LCTL get_param -n $osp)
+	do_facet ost1 $LCTL set_param -n obdfilter.$ostname.stats=clear
+	unlinkmany $DIR/$tdir/f $count || error "unlink files failed"
+	wait_delete_completed
+
+	drained=$(($(do_facet $SINGLEMDS $LCTL get_param -n $osp) - drained))
+	destroys=$(do_facet ost1 $LCTL get_param -n obdfilter.$ostname.stats |
+		   awk '/^destroy/ { print $2 }')
+	echo "$drained changes drained with ${destroys:-0} destroy RPCs"
+	[ $drained -ge $count ] ||
+		error "only $drained of $count changes drained"
+	[ ${destroys:-0} -lt $count ] ||
+		error "contiguous objects destroyed with $destroys RPCs"
+	do_facet $SINGLEMDS $LCTL get_param osc.$ostname-osc-MDT0000.drain_rate
+	rm -rf $DIR/$tdir
+}
+run_test 255 "OSP destroys contiguous objects with one RPC"
+
+prealloc_stat_256() {
+	do_facet $SINGLEMDS $LCTL get_param -n $1 |
+		awk '/^'$2':/ { print $2 }'
+}
+
+test_256() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local stats="osc.$mdtosc.prealloc_stats"
+	local max=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		    osc.$mdtosc.max_create_count)
+	local forecast
+	local rate
+	local idle
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe $tdir failed"
+	createmany -o $DIR/$tdir/f 2000 || error "create files failed"
+
+	do_facet $SINGLEMDS $LCTL get_param $stats
+	rate=$(prealloc_stat_256 $stats create_rate)
+	forecast=$(prealloc_stat_256 $stats forecast)
+	[ ${rate:-0} -gt 0 ] || error "no creation rate in $stats"
+	[ ${forecast:-0} -gt 0 ] || error "no forecast with rate $rate"
+	[ $forecast -le $((max / 2)) ] ||
+		error "forecast $forecast above max_create_count/2 $((max / 2))"
+
+	# 12 sampling intervals without creations
+	sleep 3
+	idle=$(prealloc_stat_256 $stats create_rate)
+	echo "create_rate: $rate after the creations, $idle once idle"
+	[ ${idle:-0} -lt $rate ] ||
+		error "creation rate $rate did not decay once idle: $idle"
+
+	unlinkmany $DIR/$tdir/f 2000 || error "unlink files failed"
+	rm -rf $DIR/$tdir
+}
+run_test 256 "OSP tracks object creation rate"
+
 cleanup_test_300() {
 	trap 0
 	umask $SAVE_UMASK
@@ -13344,6 +13679,173 @@ test_300i() {
 }
 run_test 300i "client handle unknown hash type striped directory"
 
+fld_cache_stat() {
+	$LCTL get_param -n fld.*clilmv*.cache_stats |
+		awk '/^'$1' / { sum += $2 } END { print sum + 0 }'
+}
+
+test_300j() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local count=100
+
+	mkdir $DIR/$tdir
+	$LFS setdirstripe -i 0 -c$MDSCOUNT -t all_char $DIR/$tdir/striped_dir ||
+		error "set striped dir error"
+	createmany -o $DIR/$tdir/striped_dir/f- $count ||
+		error "create files under striped dir failed"
+
+	# drop the cached layout and FLD entries
+	cancel_lru_locks mdc
+	$LCTL set_param fld.*clilmv*.cache_flush=1
+	$LCTL set_param fld.*clilmv*.cache_stats=clear
+
+	for ((i = 0; i < count; i++)); do
+		stat $DIR/$tdir/striped_dir/f-$i > /dev/null ||
+			error "stat f-$i failed"
+	done
+
+	local lookup=$(fld_cache_stat lookup)
+	local miss=$(fld_cache_stat miss)
+	local rpc=$(fld_cache_stat rpc)
+	echo "FLD cache: $lookup lookups, $miss misses, $rpc RPCs"
+
+	[ $lookup -gt 0 ] || error "no FLD cache lookup"
+	# every sequence is looked up from the FLD server only once
+	[ $rpc -le $((MDSCOUNT * 2)) ] ||
+		error "too many FLD RPCs: $rpc for $lookup lookups"
+}
+run_test 300j "FLD cache is refilled after flush"
+
+test_300k() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local count=5000
+	local plain
+	local striped
+
+	mkdir -p $DIR/$tdir
+	$LFS setdirstripe -i 0 -c$MDSCOUNT -t all_char $DIR/$tdir/striped_dir ||
+		error "set striped dir error"
+	mkdir $DIR/$tdir/plain_dir || error "mkdir plain dir failed"
+	createmany -o $DIR/$tdir/striped_dir/f- $count ||
+		error "create files under striped dir failed"
+	createmany -o $DIR/$tdir/plain_dir/f- $count ||
+		error "create files under plain dir failed"
+
+	cancel_lru_locks mdc
+	# each entry is listed once, . and .. only from the master stripe
+	local total=$(ls -af $DIR/$tdir/striped_dir | wc -l)
+	local uniq=$(ls -af $DIR/$tdir/striped_dir | sort -u | wc -l)
+	[ $total -eq $((count + 2)) ] ||
+		error "$total entries listed, expect $((count + 2))"
+	[ $uniq -eq $total ] || error "$((total - uniq)) duplicate entries"
+
+	cancel_lru_locks mdc
+	plain=$( { time -p ls -f $DIR/$tdir/plain_dir > /dev/null; } 2>&1 |
+		 awk '/^real/ { print $2 }')
+	cancel_lru_locks mdc
+	striped=$( { time -p ls -f $DIR/$tdir/striped_dir > /dev/null; } 2>&1 |
+		   awk '/^real/ { print $2 }')
+	echo "list $count entries: plain dir ${plain}s, striped dir ${striped}s"
+
+	rm -rf $DIR/$tdir
+}
+run_test 300k "readdir of striped directory merges all stripes once"
+
+test_300l() {
+	local param="mdd.*MDT0000*"
+	local rate=$(do_facet $SINGLEMDS lctl get_param -n $param.dir_split_rate)
+	local size=$(do_facet $SINGLEMDS lctl get_param -n $param.dir_split_size)
+	local fid
+
+	mkdir -p $DIR/$tdir
+	fid=$($LFS path2fid $DIR/$tdir | tr -d '[]')
+
+	do_facet $SINGLEMDS lctl set_param $param.dir_split_candidates=clear
+	do_facet $SINGLEMDS lctl set_param -n $param.dir_split_rate=10
+	do_facet $SINGLEMDS lctl set_param -n $param.dir_split_size=0
+
+	createmany -o $DIR/$tdir/f- 300 || error "create files failed"
+	sleep 6
+	touch $DIR/$tdir/$tfile || error "touch $tfile failed"
+
+	do_facet $SINGLEMDS lctl get_param -n $param.dir_split_candidates
+	do_facet $SINGLEMDS lctl get_param -n $param.dir_split_candidates |
+		grep -q "$fid" || error "$DIR/$tdir is not reported"
+
+	do_facet $SINGLEMDS lctl set_param $param.dir_split_candidates=clear
+	do_facet $SINGLEMDS lctl set_param -n $param.dir_split_rate=$rate
+	do_facet $SINGLEMDS lctl set_param -n $param.dir_split_size=$size
+	rm -rf $DIR/$tdir
+}
+run_test 300l "report directories with high create rate for restriping"
+
+out_batch_stat() {
+	do_facet mds1 $LCTL get_param -n \
+		osp.$FSNAME-MDT0001-osp-MDT0000.out_batch_stats |
+		awk '/^'$1':/ { print $2 }'
+}
+
+test_300m() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local osp=$FSNAME-MDT0001-osp-MDT0000
+	local count=100
+	local max_rpcs
+	local trans
+	local rpcs
+	local fid
+	local i
+
+	$LFS mkdir -i 0 $DIR/$tdir || error "mkdir $tdir failed"
+	# The remote sub-dirs get crashed linkEA, the namespace LFSCK on
+	# MDT0 repairs them with remote-only transactions.
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet mds1 $LCTL set_param fail_loc=0x1603
+	for i in $(seq $count); do
+		$LFS mkdir -i 1 $DIR/$tdir/d-$i || { i=0; break; }
+	done
+	do_facet mds1 $LCTL set_param fail_loc=0
+	[ $i -eq $count ] || error "mkdir remote sub-dirs failed"
+
+	trans=$(out_batch_stat trans_sent)
+	rpcs=$(out_batch_stat rpcs_sent)
+	[ -n "$trans" -a -n "$rpcs" ] || error "no out_batch_stats"
+
+	# Slow down the remote transactions, so that the repairs queue up
+	# behind the single RPC slot.
+	max_rpcs=$(do_facet mds1 $LCTL get_param -n \
+		   osp.$osp.max_rpcs_in_flight)
+	do_facet mds1 $LCTL set_param osp.$osp.max_rpcs_in_flight=1
+	#define OBD_FAIL_OUT_UPDATE_DELAY	0x1702
+	do_facet mds2 $LCTL set_param fail_val=200 fail_loc=0x1702
+
+	do_facet mds1 $LCTL lfsck_start -M $FSNAME-MDT0000 -t namespace -A -r ||
+		error "start namespace LFSCK failed"
+	wait_update_facet mds1 "$LCTL get_param -n \
+		mdd.$FSNAME-MDT0000.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 120
+	i=$?
+
+	do_facet mds2 $LCTL set_param fail_loc=0 fail_val=0
+	do_facet mds1 $LCTL set_param osp.$osp.max_rpcs_in_flight=$max_rpcs
+	[ $i -eq 0 ] || error "namespace LFSCK did not complete"
+
+	trans=$(($(out_batch_stat trans_sent) - trans))
+	rpcs=$(($(out_batch_stat rpcs_sent) - rpcs))
+	echo "$trans remote transactions sent with $rpcs RPCs"
+	[ $trans -gt 0 ] || error "no remote-only transaction sent"
+	[ $rpcs -lt $trans ] ||
+		error "$rpcs RPCs sent for $trans transactions, no batch"
+
+	fid=$($LFS path2fid $DIR/$tdir/d-1)
+	[ "$($LFS fid2path $DIR $fid)" == "$DIR/$tdir/d-1" ] ||
+		error "linkEA of d-1 not repaired"
+	rm -rf $DIR/$tdir
+}
+run_test 300m "batch the remote-only transactions into OUT RPCs"
+
 test_400a() { # LU-1606, was conf-sanity test_74
 	local extra_flags=''
 	local out=$TMP/$tfile
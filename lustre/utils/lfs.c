@@ -243,15 +243,16 @@ command_t cmdlist[] = {
          " quotas off. Deprecated as of 2.4.0.\n"
          "usage: quotaoff [ -ug ] <filesystem>"},
         {"setquota", lfs_setquota, 0, "Set filesystem quotas.\n"
-         "usage: setquota <-u|-g> <uname>|<uid>|<gname>|<gid>\n"
+         "usage: setquota <-u|-g|-p> <uname>|<uid>|<gname>|<gid>|<projid>\n"
          "                -b <block-softlimit> -B <block-hardlimit>\n"
          "                -i <inode-softlimit> -I <inode-hardlimit> <filesystem>\n"
-         "       setquota <-u|--user|-g|--group> <uname>|<uid>|<gname>|<gid>\n"
+         "       setquota <-u|--user|-g|--group|-p|--projid>\n"
+         "                <uname>|<uid>|<gname>|<gid>|<projid>\n"
          "                [--block-softlimit <block-softlimit>]\n"
          "                [--block-hardlimit <block-hardlimit>]\n"
          "                [--inode-softlimit <inode-softlimit>]\n"
          "                [--inode-hardlimit <inode-hardlimit>] <filesystem>\n"
-         "       setquota [-t] <-u|--user|-g|--group>\n"
+         "       setquota [-t] <-u|--user|-g|--group|-p|--projid>\n"
          "                [--block-grace <block-grace>]\n"
          "                [--inode-grace <inode-grace>] <filesystem>\n"
          "       -b can be used instead of --block-softlimit/--block-grace\n"
@@ -268,8 +269,9 @@ command_t cmdlist[] = {
         {"quota", lfs_quota, 0, "Display disk usage and limits.\n"
 	 "usage: quota [-q] [-v] [-h] [-o <obd_uuid>|-i <mdt_idx>|-I "
 		       "<ost_idx>]\n"
-         "             [<-u|-g> <uname>|<uid>|<gname>|<gid>] <filesystem>\n"
-         "       quota [-o <obd_uuid>|-i <mdt_idx>|-I <ost_idx>] -t <-u|-g> <filesystem>"},
+         "             [<-u|-g|-p> <uname>|<uid>|<gname>|<gid>|<projid>] "
+		       "<filesystem>\n"
+         "       quota [-o <obd_uuid>|-i <mdt_idx>|-I <ost_idx>] -t <-u|-g|-p> <filesystem>"},
 #endif
         {"flushctx", lfs_flushctx, 0, "Flush security context for current user.\n"
          "usage: flushctx [-k] [mountpoint...]"},
@@ -293,7 +295,9 @@ command_t cmdlist[] = {
          "usage: ls [OPTION]... [FILE]..."},
         {"changelog", lfs_changelog, 0,
          "Show the metadata changes on an MDT."
-         "\nusage: changelog <mdtname> [startrec [endrec]]"},
+         "\nusage: changelog [--follow] [--collapse] [--type <type>[,...]] "
+	 "[--parent <fid>]\n"
+	 "                 [--jobid <jobid>] <mdtname> [startrec [endrec]]"},
         {"changelog_clear", lfs_changelog_clear, 0,
          "Indicate that old changelog records up to <endrec> are no longer of "
          "interest to consumer <id>, allowing the system to free up space.\n"
@@ -2489,6 +2493,19 @@ do {									\
 	nr = limit;							\
 } while (0)
 
+/* map a -u/-g/-p command line option to its quota type */
+static inline int opt2qtype(int opt)
+{
+	switch (opt) {
+	case 'u':
+		return USRQUOTA;
+	case 'g':
+		return GRPQUOTA;
+	default:
+		return PRJQUOTA;
+	}
+}
+
 static inline int has_times_option(int argc, char **argv)
 {
         int i;
@@ -2511,6 +2528,7 @@ int lfs_setquota_times(int argc, char **argv)
                 {"block-grace",     required_argument, 0, 'b'},
                 {"group",           no_argument,       0, 'g'},
                 {"inode-grace",     required_argument, 0, 'i'},
+                {"projid",          no_argument,       0, 'p'},
                 {"times",           no_argument,       0, 't'},
                 {"user",            no_argument,       0, 'u'},
                 {0, 0, 0, 0}
@@ -2518,18 +2536,19 @@ int lfs_setquota_times(int argc, char **argv)
 
         memset(&qctl, 0, sizeof(qctl));
         qctl.qc_cmd  = LUSTRE_Q_SETINFO;
-        qctl.qc_type = UGQUOTA;
+        qctl.qc_type = ALLQUOTA;
 
-        while ((c = getopt_long(argc, argv, "b:gi:tu", long_opts, NULL)) != -1) {
+        while ((c = getopt_long(argc, argv, "b:gi:ptu", long_opts, NULL)) != -1) {
                 switch (c) {
                 case 'u':
                 case 'g':
-                        if (qctl.qc_type != UGQUOTA) {
-                                fprintf(stderr, "error: -u and -g can't be used "
-                                                "more than once\n");
+                case 'p':
+                        if (qctl.qc_type != ALLQUOTA) {
+                                fprintf(stderr, "error: -u, -g and -p can't be "
+                                                "used more than once\n");
                                 return CMD_HELP;
                         }
-                        qctl.qc_type = (c == 'u') ? USRQUOTA : GRPQUOTA;
+                        qctl.qc_type = opt2qtype(c);
                         break;
                 case 'b':
                         if ((dqi->dqi_bgrace = str2sec(optarg)) == ULONG_MAX) {
@@ -2554,8 +2573,8 @@ int lfs_setquota_times(int argc, char **argv)
                 }
         }
 
-        if (qctl.qc_type == UGQUOTA) {
-                fprintf(stderr, "error: neither -u nor -g specified\n");
+        if (qctl.qc_type == ALLQUOTA) {
+                fprintf(stderr, "error: neither -u, -g nor -p specified\n");
                 return CMD_HELP;
         }
 
@@ -2594,6 +2613,7 @@ int lfs_setquota(int argc, char **argv)
                 {"group",           required_argument, 0, 'g'},
                 {"inode-softlimit", required_argument, 0, 'i'},
                 {"inode-hardlimit", required_argument, 0, 'I'},
+                {"projid",          required_argument, 0, 'p'},
                 {"user",            required_argument, 0, 'u'},
                 {0, 0, 0, 0}
         };
@@ -2605,22 +2625,28 @@ int lfs_setquota(int argc, char **argv)
 
         memset(&qctl, 0, sizeof(qctl));
         qctl.qc_cmd  = LUSTRE_Q_SETQUOTA;
-        qctl.qc_type = UGQUOTA; /* UGQUOTA makes no sense for setquota,
-                                 * so it can be used as a marker that qc_type
-                                 * isn't reinitialized from command line */
+        qctl.qc_type = ALLQUOTA; /* ALLQUOTA makes no sense for setquota,
+                                  * so it can be used as a marker that qc_type
+                                  * isn't reinitialized from command line */
 
-        while ((c = getopt_long(argc, argv, "b:B:g:i:I:u:", long_opts, NULL)) != -1) {
+        while ((c = getopt_long(argc, argv, "b:B:g:i:I:p:u:", long_opts,
+				NULL)) != -1) {
                 switch (c) {
                 case 'u':
                 case 'g':
-                        if (qctl.qc_type != UGQUOTA) {
-                                fprintf(stderr, "error: -u and -g can't be used"
-                                                " more than once\n");
+                case 'p':
+                        if (qctl.qc_type != ALLQUOTA) {
+                                fprintf(stderr, "error: -u, -g and -p can't be "
+                                                "used more than once\n");
                                 return CMD_HELP;
                         }
-                        qctl.qc_type = (c == 'u') ? USRQUOTA : GRPQUOTA;
-                        rc = name2id(&qctl.qc_id, optarg,
-                                     (qctl.qc_type == USRQUOTA) ? USER : GROUP);
+                        qctl.qc_type = opt2qtype(c);
+                        /* project IDs have no name database */
+                        rc = -ENOENT;
+                        if (qctl.qc_type != PRJQUOTA)
+                                rc = name2id(&qctl.qc_id, optarg,
+                                             (qctl.qc_type == USRQUOTA) ?
+                                             USER : GROUP);
                         if (rc) {
                                 qctl.qc_id = strtoul(optarg, &endptr, 10);
                                 if (*endptr != '\0') {
@@ -2677,8 +2703,8 @@ int lfs_setquota(int argc, char **argv)
                 }
         }
 
-        if (qctl.qc_type == UGQUOTA) {
-                fprintf(stderr, "error: neither -u nor -g was specified\n");
+        if (qctl.qc_type == ALLQUOTA) {
+                fprintf(stderr, "error: neither -u, -g nor -p was specified\n");
                 return CMD_HELP;
         }
 
@@ -2751,6 +2777,8 @@ static inline char *type2name(int check_type)
                 return "user";
         else if (check_type == GRPQUOTA)
                 return "group";
+        else if (check_type == PRJQUOTA)
+                return "project";
         else
                 return "unknown";
 }
@@ -2985,7 +3013,7 @@ static int lfs_quota(int argc, char **argv)
 	int c;
 	char *mnt, *name = NULL;
 	struct if_quotactl qctl = { .qc_cmd = LUSTRE_Q_GETQUOTA,
-				    .qc_type = UGQUOTA };
+				    .qc_type = ALLQUOTA };
 	char *obd_type = (char *)qctl.obd_type;
 	char *obd_uuid = (char *)qctl.obd_uuid.uuid;
 	int rc, rc1 = 0, rc2 = 0, rc3 = 0,
@@ -2995,21 +3023,17 @@ static int lfs_quota(int argc, char **argv)
 	__u64 total_ialloc = 0, total_balloc = 0;
 	bool human_readable = false;
 
-	while ((c = getopt(argc, argv, "gi:I:o:qtuvh")) != -1) {
+	while ((c = getopt(argc, argv, "gi:I:o:pqtuvh")) != -1) {
                 switch (c) {
                 case 'u':
-                        if (qctl.qc_type != UGQUOTA) {
-                                fprintf(stderr, "error: use either -u or -g\n");
-                                return CMD_HELP;
-                        }
-                        qctl.qc_type = USRQUOTA;
-                        break;
                 case 'g':
-                        if (qctl.qc_type != UGQUOTA) {
-                                fprintf(stderr, "error: use either -u or -g\n");
+                case 'p':
+                        if (qctl.qc_type != ALLQUOTA) {
+                                fprintf(stderr, "error: use either -u, -g or "
+                                                "-p\n");
                                 return CMD_HELP;
                         }
-                        qctl.qc_type = GRPQUOTA;
+                        qctl.qc_type = opt2qtype(c);
                         break;
                 case 't':
                         qctl.qc_cmd = LUSTRE_Q_GETINFO;
@@ -3043,7 +3067,7 @@ static int lfs_quota(int argc, char **argv)
         }
 
         /* current uid/gid info for "lfs quota /path/to/lustre/mount" */
-        if (qctl.qc_cmd == LUSTRE_Q_GETQUOTA && qctl.qc_type == UGQUOTA &&
+        if (qctl.qc_cmd == LUSTRE_Q_GETQUOTA && qctl.qc_type == ALLQUOTA &&
             optind == argc - 1) {
 ug_output:
                 memset(&qctl, 0, sizeof(qctl)); /* spoiled by print_*_quota */
@@ -3064,14 +3088,17 @@ ug_output:
         /* lfs quota -u username /path/to/lustre/mount */
         } else if (qctl.qc_cmd == LUSTRE_Q_GETQUOTA) {
                 /* options should be followed by u/g-name and mntpoint */
-                if (optind + 2 != argc || qctl.qc_type == UGQUOTA) {
+                if (optind + 2 != argc || qctl.qc_type == ALLQUOTA) {
                         fprintf(stderr, "error: missing quota argument(s)\n");
                         return CMD_HELP;
                 }
 
                 name = argv[optind++];
-                rc = name2id(&qctl.qc_id, name,
-                             (qctl.qc_type == USRQUOTA) ? USER : GROUP);
+                /* project IDs have no name database */
+                rc = -ENOENT;
+                if (qctl.qc_type != PRJQUOTA)
+                        rc = name2id(&qctl.qc_id, name,
+                                     (qctl.qc_type == USRQUOTA) ? USER : GROUP);
                 if (rc) {
                         qctl.qc_id = strtoul(name, &endptr, 10);
                         if (*endptr != '\0') {
@@ -3080,7 +3107,7 @@ ug_output:
                                 return CMD_HELP;
                         }
                 }
-        } else if (optind + 1 != argc || qctl.qc_type == UGQUOTA) {
+        } else if (optind + 1 != argc || qctl.qc_type == ALLQUOTA) {
                 fprintf(stderr, "error: missing quota info argument(s)\n");
                 return CMD_HELP;
         }
@@ -3092,7 +3119,7 @@ ug_output:
                 switch (rc1) {
                 case -ESRCH:
                         fprintf(stderr, "%s quotas are not enabled.\n",
-                                qctl.qc_type == USRQUOTA ? "user" : "group");
+                                type2name(qctl.qc_type));
                         goto out;
                 case -EPERM:
                         fprintf(stderr, "Permission denied.\n");
@@ -3248,25 +3275,77 @@ static int lfs_ls(int argc, char **argv)
         return(llapi_ls(argc, argv));
 }
 
+/* Parse a comma separated list of record type names, e.g. "CREAT,UNLNK" */
+static int changelog_parse_types(char *list, __u32 *mask)
+{
+	char *name;
+	int type;
+
+	for (name = strtok(list, ","); name != NULL;
+	     name = strtok(NULL, ",")) {
+		for (type = 0; type < CL_LAST; type++)
+			if (strcasecmp(name, changelog_type2str(type)) == 0)
+				break;
+		if (type == CL_LAST) {
+			fprintf(stderr, "error: unknown changelog record "
+				"type '%s'\n", name);
+			return -EINVAL;
+		}
+		*mask |= 1U << type;
+	}
+
+	return 0;
+}
+
 static int lfs_changelog(int argc, char **argv)
 {
         void *changelog_priv;
 	struct changelog_rec *rec;
+	struct changelog_filter filter = { 0 };
+	bool use_filter = false;
         long long startrec = 0, endrec = 0;
         char *mdd;
         struct option long_opts[] = {
+		{"collapse", no_argument, 0, 'c'},
                 {"follow", no_argument, 0, 'f'},
+		{"jobid", required_argument, 0, 'j'},
+		{"parent", required_argument, 0, 'p'},
+		{"type", required_argument, 0, 't'},
                 {0, 0, 0, 0}
         };
-        char short_opts[] = "f";
-        int rc, follow = 0;
+	char short_opts[] = "cfj:p:t:";
+	int rc, follow = 0, collapse = 0;
 
         while ((rc = getopt_long(argc, argv, short_opts,
                                 long_opts, NULL)) != -1) {
                 switch (rc) {
+		case 'c':
+			collapse++;
+			break;
                 case 'f':
                         follow++;
                         break;
+		case 'j':
+			strncpy(filter.cf_jobid, optarg,
+				sizeof(filter.cf_jobid) - 1);
+			use_filter = true;
+			break;
+		case 'p':
+			if (*optarg == '[')
+				optarg++;
+			if (sscanf(optarg, SFID, RFID(&filter.cf_pfid)) != 3) {
+				fprintf(stderr, "error: %s: bad FID '%s'\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			use_filter = true;
+			break;
+		case 't':
+			if (changelog_parse_types(optarg,
+						  &filter.cf_type_mask) != 0)
+				return CMD_HELP;
+			use_filter = true;
+			break;
                 case '?':
                         return CMD_HELP;
                 default:
@@ -3284,11 +3363,14 @@ static int lfs_changelog(int argc, char **argv)
         if (argc > optind)
                 endrec = strtoll(argv[optind++], NULL, 10);
 
-	rc = llapi_changelog_start(&changelog_priv,
-				   CHANGELOG_FLAG_BLOCK |
-				   CHANGELOG_FLAG_JOBID |
-				   (follow ? CHANGELOG_FLAG_FOLLOW : 0),
-				   mdd, startrec);
+	rc = llapi_changelog_start_filter(&changelog_priv,
+					  CHANGELOG_FLAG_BLOCK |
+					  CHANGELOG_FLAG_JOBID |
+					  (follow ? CHANGELOG_FLAG_FOLLOW : 0) |
+					  (collapse ? CHANGELOG_FLAG_COLLAPSE :
+						      0),
+					  mdd, startrec,
+					  use_filter ? &filter : NULL);
 	if (rc < 0) {
 		fprintf(stderr, "Can't start changelog: %s\n",
 			strerror(errno = -rc));
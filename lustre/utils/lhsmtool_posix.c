@@ -42,8 +42,11 @@
 #include <stdlib.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <time.h>
+#include <unistd.h>
 #include <utime.h>
 #include <sys/time.h>
 #include <sys/xattr.h>
@@ -61,6 +64,11 @@
 
 #define ONE_MB 0x100000
 
+/* Default number of streams used to copy a large file */
+#define COPY_STREAMS_DEFAULT 4
+/* Files are only split in streams of at least this size */
+#define COPY_STREAM_MIN (64 * ONE_MB)
+
 #ifndef NSEC_PER_SEC
 # define NSEC_PER_SEC 1000000000UL
 #endif
@@ -90,6 +98,7 @@ struct options {
 	int			 o_report_int;
 	unsigned long long	 o_bandwidth;
 	size_t			 o_chunk_size;
+	int			 o_copy_streams;
 	enum ct_action		 o_action;
 	char			*o_event_fifo;
 	char			*o_mnt;
@@ -107,6 +116,7 @@ struct options opt = {
 	.o_copy_xattrs = 1,
 	.o_report_int = REPORT_INTERVAL_DEFAULT,
 	.o_chunk_size = ONE_MB,
+	.o_copy_streams = COPY_STREAMS_DEFAULT,
 };
 
 /* hsm_copytool_private will hold an open FD on the lustre mount point
@@ -194,13 +204,16 @@ static void usage(const char *name, int rc)
 	"   --dry-run                 Don't run, just show what would be done\n"
 	"   -c, --chunk-size <sz>     I/O size used during data copy\n"
 	"                             (unit can be used, default is MB)\n"
+	"   -t, --copy-streams <n>    Max parallel streams used to copy a\n"
+	"                             large file (default is %d)\n"
 	"   -f, --event-fifo <path>   Write events stream to fifo\n"
 	"   -p, --hsm-root <path>     Target HSM mount point\n"
 	"   -q, --quiet               Produce less verbose output\n"
 	"   -u, --update-interval <s> Interval between progress reports sent\n"
 	"                             to Coordinator\n"
 	"   -v, --verbose             Produce more verbose output\n",
-	cmd_name, cmd_name, cmd_name, cmd_name, cmd_name);
+	cmd_name, cmd_name, cmd_name, cmd_name, cmd_name,
+	COPY_STREAMS_DEFAULT);
 
 	exit(rc);
 }
@@ -214,6 +227,8 @@ static int ct_parseopts(int argc, char * const *argv)
 		{"bandwidth",	   required_argument, NULL,		   'b'},
 		{"chunk-size",	   required_argument, NULL,		   'c'},
 		{"chunk_size",	   required_argument, NULL,		   'c'},
+		{"copy-streams",   required_argument, NULL,		   't'},
+		{"copy_streams",   required_argument, NULL,		   't'},
 		{"daemon",	   no_argument,	      &opt.o_daemonize,	    1},
 		{"event-fifo",	   required_argument, NULL,		   'f'},
 		{"event_fifo",	   required_argument, NULL,		   'f'},
@@ -242,7 +257,7 @@ static int ct_parseopts(int argc, char * const *argv)
 	unsigned long long	 unit;
 
 	optind = 0;
-	while ((c = getopt_long(argc, argv, "A:b:c:f:hiMp:qru:v",
+	while ((c = getopt_long(argc, argv, "A:b:c:f:hiMp:qrt:u:v",
 				long_opts, NULL)) != -1) {
 		switch (c) {
 		case 'A':
@@ -290,6 +305,15 @@ static int ct_parseopts(int argc, char * const *argv)
 		case 'r':
 			opt.o_action = CA_REBIND;
 			break;
+		case 't':
+			opt.o_copy_streams = atoi(optarg);
+			if (opt.o_copy_streams < 1) {
+				rc = -EINVAL;
+				CT_ERROR(rc, "bad value for -%c '%s'", c,
+					 optarg);
+				return rc;
+			}
+			break;
 		case 'u':
 			opt.o_report_int = atoi(optarg);
 			if (opt.o_report_int < 0) {
@@ -512,6 +536,199 @@ static int ct_restore_stripe(const char *src, const char *dst, int dst_fd,
 	return rc;
 }
 
+/* State shared by the streams copying one file */
+struct ct_copy_ctx {
+	struct hsm_copyaction_private	*cc_hcp;
+	const char			*cc_src;
+	const char			*cc_dst;
+	int				 cc_src_fd;
+	int				 cc_dst_fd;
+	__u64				 cc_length;	 /* bytes to copy */
+	__u64				 cc_write_total; /* bytes written */
+	time_t				 cc_start_time;
+	time_t				 cc_last_bw_print;
+	int				 cc_rc;		 /* first error */
+	pthread_mutex_t			 cc_lock;
+};
+
+/* One stream copies a contiguous segment of the file */
+struct ct_copy_stream {
+	struct ct_copy_ctx	*cs_ctx;
+	__u64			 cs_offset;
+	__u64			 cs_length;
+	pthread_t		 cs_thread;
+};
+
+static int ct_copy_failed(struct ct_copy_ctx *cc, int rc)
+{
+	pthread_mutex_lock(&cc->cc_lock);
+	if (rc < 0 && cc->cc_rc == 0)
+		cc->cc_rc = rc;
+	rc = cc->cc_rc;
+	pthread_mutex_unlock(&cc->cc_lock);
+
+	return rc;
+}
+
+/* account written bytes and sleep if needed, to honor bandwidth limits
+ * which apply to the sum of all streams */
+static void ct_copy_account(struct ct_copy_ctx *cc, size_t size)
+{
+	unsigned long long	write_theory;
+	unsigned long long	excess;
+	struct timespec		delay;
+	time_t			now;
+	int			rc;
+
+	pthread_mutex_lock(&cc->cc_lock);
+	cc->cc_write_total += size;
+	if (opt.o_bandwidth == 0) {
+		pthread_mutex_unlock(&cc->cc_lock);
+		return;
+	}
+
+	now = time(NULL);
+	write_theory = (now - cc->cc_start_time) * opt.o_bandwidth;
+	if (write_theory >= cc->cc_write_total) {
+		pthread_mutex_unlock(&cc->cc_lock);
+		return;
+	}
+
+	excess = cc->cc_write_total - write_theory;
+
+	delay.tv_sec = excess / opt.o_bandwidth;
+	delay.tv_nsec = (excess % opt.o_bandwidth) * NSEC_PER_SEC /
+			opt.o_bandwidth;
+
+	if (now >= cc->cc_last_bw_print + opt.o_report_int) {
+		CT_TRACE("bandwith control: %lluB/s excess=%llu sleep for "
+			 "%lld.%09lds", opt.o_bandwidth, excess,
+			 (long long)delay.tv_sec, delay.tv_nsec);
+		cc->cc_last_bw_print = now;
+	}
+	pthread_mutex_unlock(&cc->cc_lock);
+
+	do {
+		rc = nanosleep(&delay, &delay);
+	} while (rc < 0 && errno == EINTR);
+	if (rc < 0)
+		CT_ERROR(errno, "delay for bandwidth control failed to sleep: "
+			 "residual=%lld.%09lds", (long long)delay.tv_sec,
+			 delay.tv_nsec);
+}
+
+/* report the part of a segment already copied */
+static int ct_copy_progress(struct ct_copy_ctx *cc,
+			    const struct hsm_extent *he)
+{
+	int	rc;
+
+	pthread_mutex_lock(&cc->cc_lock);
+	CT_TRACE("%%"LPU64" ", 100 * cc->cc_write_total / cc->cc_length);
+	rc = llapi_hsm_action_progress(cc->cc_hcp, he, cc->cc_length, 0);
+	pthread_mutex_unlock(&cc->cc_lock);
+	if (rc < 0)
+		/* Action has been canceled or something wrong
+		 * is happening. Stop copying data. */
+		CT_ERROR(rc, "progress ioctl for copy '%s'->'%s' failed",
+			 cc->cc_src, cc->cc_dst);
+
+	return rc;
+}
+
+static void *ct_copy_stream(void *data)
+{
+	struct ct_copy_stream	*cs = data;
+	struct ct_copy_ctx	*cc = cs->cs_ctx;
+	struct hsm_extent	 he;
+	__u64			 offset = cs->cs_offset;
+	__u64			 end = cs->cs_offset + cs->cs_length;
+	time_t			 last_report_time = cc->cc_start_time;
+	time_t			 now;
+	char			*buf;
+	int			 rc;
+
+	/* page aligned, so the buffer can be used for direct I/O by
+	 * the file systems which bypass their cache for large I/O */
+	rc = posix_memalign((void **)&buf, sysconf(_SC_PAGESIZE),
+			    opt.o_chunk_size);
+	if (rc != 0) {
+		rc = -rc;
+		CT_ERROR(rc, "cannot allocate copy buffer");
+		ct_copy_failed(cc, rc);
+		return NULL;
+	}
+
+	he.offset = cs->cs_offset;
+	while (offset < end && ct_copy_failed(cc, 0) == 0) {
+		ssize_t	rsize;
+		ssize_t	wsize;
+		size_t	chunk = (end - offset > opt.o_chunk_size) ?
+				opt.o_chunk_size : end - offset;
+#ifdef SEEK_DATA
+		off_t	data;
+
+		/* holes are not copied, the destination is extended to the
+		 * full size at the end */
+		data = lseek(cc->cc_src_fd, offset, SEEK_DATA);
+		if (data < 0 && errno == ENXIO)
+			/* only a hole up to the end of the file */
+			break;
+		if (data > (off_t)offset) {
+			offset = (data > end) ? end : data;
+			continue;
+		}
+#endif
+		rsize = pread(cc->cc_src_fd, buf, chunk, offset);
+		if (rsize == 0)
+			/* EOF */
+			break;
+
+		if (rsize < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot read from '%s'", cc->cc_src);
+			break;
+		}
+
+		wsize = pwrite(cc->cc_dst_fd, buf, rsize, offset);
+		if (wsize < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot write to '%s'", cc->cc_dst);
+			break;
+		}
+
+		offset += wsize;
+		ct_copy_account(cc, wsize);
+
+		now = time(NULL);
+		if (now >= last_report_time + opt.o_report_int) {
+			last_report_time = now;
+			he.length = offset - cs->cs_offset;
+			rc = ct_copy_progress(cc, &he);
+			if (rc < 0)
+				break;
+		}
+	}
+
+	ct_copy_failed(cc, rc);
+	free(buf);
+
+	return NULL;
+}
+
+/* a file is only split when each stream gets at least COPY_STREAM_MIN */
+static int ct_copy_streams(__u64 length)
+{
+	__u64	streams = length / COPY_STREAM_MIN;
+
+	if (streams < 1)
+		return 1;
+	if (streams > opt.o_copy_streams)
+		return opt.o_copy_streams;
+
+	return streams;
+}
+
 static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 			const char *dst, int src_fd, int dst_fd,
 			const struct hsm_action_item *hai, long hal_flags)
@@ -520,16 +737,14 @@ static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 	__u64			 offset = hai->hai_extent.offset;
 	struct stat		 src_st;
 	struct stat		 dst_st;
-	char			*buf = NULL;
-	__u64			 write_total = 0;
+	struct ct_copy_ctx	 cc;
+	struct ct_copy_stream	*cs = NULL;
 	__u64			 length;
-	time_t			 last_report_time;
+	__u64			 segment;
+	int			 streams;
+	int			 i;
 	int			 rc = 0;
 	double			 start_ct_now = ct_now();
-	/* Bandwidth Control */
-	time_t			start_time;
-	time_t			now;
-	time_t			last_bw_print;
 
 	if (fstat(src_fd, &src_st) < 0) {
 		rc = -errno;
@@ -567,7 +782,15 @@ static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 	/* Don't read beyond a given extent */
 	length = min(hai->hai_extent.length, src_st.st_size);
 
-	start_time = last_bw_print = last_report_time = time(NULL);
+	memset(&cc, 0, sizeof(cc));
+	cc.cc_hcp = hcp;
+	cc.cc_src = src;
+	cc.cc_dst = dst;
+	cc.cc_src_fd = src_fd;
+	cc.cc_dst_fd = dst_fd;
+	cc.cc_length = length;
+	cc.cc_start_time = cc.cc_last_bw_print = time(NULL);
+	pthread_mutex_init(&cc.cc_lock, NULL);
 
 	he.offset = offset;
 	he.length = 0;
@@ -582,98 +805,63 @@ static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 
 	errno = 0;
 
-	buf = malloc(opt.o_chunk_size);
-	if (buf == NULL) {
+	/* each stream copies a segment made of whole chunks, reported to
+	 * the coordinator as its own extent */
+	streams = ct_copy_streams(length);
+	segment = (length + streams - 1) / streams;
+	segment = (segment + opt.o_chunk_size - 1) / opt.o_chunk_size *
+		  opt.o_chunk_size;
+	if (segment == 0)
+		segment = opt.o_chunk_size;
+	streams = (length + segment - 1) / segment;
+	if (streams == 0)
+		streams = 1;
+
+	cs = calloc(streams, sizeof(*cs));
+	if (cs == NULL) {
 		rc = -ENOMEM;
 		goto out;
 	}
 
-	CT_TRACE("start copy of "LPU64" bytes from '%s' to '%s'",
-		 length, src, dst);
+	posix_fadvise(src_fd, offset, length, POSIX_FADV_SEQUENTIAL);
 
-	while (write_total < length) {
-		ssize_t	rsize;
-		ssize_t	wsize;
-		int	chunk = (length - write_total > opt.o_chunk_size) ?
-				 opt.o_chunk_size : length - write_total;
-
-		rsize = pread(src_fd, buf, chunk, offset);
-		if (rsize == 0)
-			/* EOF */
-			break;
+	CT_TRACE("start copy of "LPU64" bytes from '%s' to '%s' with %d "
+		 "streams", length, src, dst, streams);
 
-		if (rsize < 0) {
-			rc = -errno;
-			CT_ERROR(rc, "cannot read from '%s'", src);
-			break;
-		}
+	for (i = 0; i < streams; i++) {
+		cs[i].cs_ctx = &cc;
+		cs[i].cs_offset = offset + i * segment;
+		cs[i].cs_length = (i == streams - 1) ?
+				  length - i * segment : segment;
+	}
 
-		wsize = pwrite(dst_fd, buf, rsize, offset);
-		if (wsize < 0) {
-			rc = -errno;
-			CT_ERROR(rc, "cannot write to '%s'", dst);
+	/* the first segment is copied by the calling thread */
+	for (i = 1; i < streams; i++) {
+		rc = pthread_create(&cs[i].cs_thread, NULL, ct_copy_stream,
+				    &cs[i]);
+		if (rc != 0) {
+			rc = -rc;
+			CT_ERROR(rc, "cannot start copy stream %d of '%s'", i,
+				 src);
+			ct_copy_failed(&cc, rc);
 			break;
 		}
+	}
+	streams = i;
 
-		write_total += wsize;
-		offset += wsize;
-
-		now = time(NULL);
-		/* sleep if needed, to honor bandwidth limits */
-		if (opt.o_bandwidth != 0) {
-			unsigned long long write_theory;
-
-			write_theory = (now - start_time) * opt.o_bandwidth;
-
-			if (write_theory < write_total) {
-				unsigned long long	excess;
-				struct timespec		delay;
-
-				excess = write_total - write_theory;
-
-				delay.tv_sec = excess / opt.o_bandwidth;
-				delay.tv_nsec = (excess % opt.o_bandwidth) *
-					NSEC_PER_SEC / opt.o_bandwidth;
-
-				if (now >= last_bw_print + opt.o_report_int) {
-					CT_TRACE("bandwith control: %lluB/s "
-						 "excess=%llu sleep for "
-						 "%lld.%09lds",
-						 opt.o_bandwidth, excess,
-						 (long long)delay.tv_sec,
-						 delay.tv_nsec);
-					last_bw_print = now;
-				}
+	ct_copy_stream(&cs[0]);
+	for (i = 1; i < streams; i++)
+		pthread_join(cs[i].cs_thread, NULL);
 
-				do {
-					rc = nanosleep(&delay, &delay);
-				} while (rc < 0 && errno == EINTR);
-				if (rc < 0) {
-					CT_ERROR(errno, "delay for bandwidth "
-						 "control failed to sleep: "
-						 "residual=%lld.%09lds",
-						 (long long)delay.tv_sec,
-						 delay.tv_nsec);
-					rc = 0;
-				}
-			}
-		}
+	rc = cc.cc_rc;
 
-		now = time(NULL);
-		if (now >= last_report_time + opt.o_report_int) {
-			last_report_time = now;
-			CT_TRACE("%%"LPU64" ", 100 * write_total / length);
-			he.length = write_total;
-			rc = llapi_hsm_action_progress(hcp, &he, length, 0);
-			if (rc < 0) {
-				/* Action has been canceled or something wrong
-				 * is happening. Stop copying data. */
-				CT_ERROR(rc, "progress ioctl for copy"
-					 " '%s'->'%s' failed", src, dst);
-				goto out;
-			}
-		}
-		rc = 0;
+	/* trailing holes were not written */
+	if (rc == 0 && fstat(dst_fd, &dst_st) == 0 &&
+	    dst_st.st_size < offset + length &&
+	    ftruncate(dst_fd, offset + length) < 0) {
+		rc = -errno;
+		CT_ERROR(rc, "cannot extend '%s' to size "LPU64, dst,
+			 offset + length);
 	}
 
 out:
@@ -697,8 +885,9 @@ out:
 		}
 	}
 
-	if (buf != NULL)
-		free(buf);
+	if (cs != NULL)
+		free(cs);
+	pthread_mutex_destroy(&cc.cc_lock);
 
 	CT_TRACE("copied "LPU64" bytes in %f seconds",
 		 length, ct_now() - start_ct_now);
@@ -4236,6 +4236,7 @@ struct changelog_private {
 	int				magic;
 	enum changelog_send_flag	flags;
 	lustre_kernelcomm		kuc;
+	struct changelog_filter		filter;
 };
 
 /** Start reading from a changelog
@@ -4247,6 +4248,21 @@ struct changelog_private {
  */
 int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 			  const char *device, long long startrec)
+{
+	return llapi_changelog_start_filter(priv, flags, device, startrec,
+					    NULL);
+}
+
+/** Start reading the changelog records matching a filter
+ * Records of other types, directories or jobs are dropped by the client
+ * kernel before they reach the reader, so consumers interested in a few
+ * events do not have to receive and parse the whole changelog.
+ * @param filter Records to report, or NULL for all of them
+ * (other parameters as for llapi_changelog_start)
+ */
+int llapi_changelog_start_filter(void **priv, enum changelog_send_flag flags,
+				 const char *device, long long startrec,
+				 const struct changelog_filter *filter)
 {
 	struct changelog_private	*cp;
 	static bool			 warned;
@@ -4258,6 +4274,12 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 		return -ENOMEM;
 
 	cp->magic = CHANGELOG_PRIV_MAGIC;
+	if (filter != NULL) {
+		cp->filter = *filter;
+		flags |= CHANGELOG_FLAG_FILTER;
+	} else {
+		flags &= ~CHANGELOG_FLAG_FILTER;
+	}
 	cp->flags = flags;
 
 	/* Set up the receiver */
@@ -4276,8 +4298,22 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 	}
 
 	/* Tell the kernel to start sending */
-	rc = changelog_ioctl(device, OBD_IOC_CHANGELOG_SEND, cp->kuc.lk_wfd,
-			     startrec, flags);
+	if (flags & CHANGELOG_FLAG_FILTER) {
+		struct ioc_changelog_filter	icf;
+		int				*idx;
+
+		memset(&icf, 0, sizeof(icf));
+		icf.icf_changelog.icc_id = cp->kuc.lk_wfd;
+		icf.icf_changelog.icc_recno = startrec;
+		icf.icf_changelog.icc_flags = flags;
+		icf.icf_filter = cp->filter;
+		idx = (int *)(&icf.icf_changelog.icc_mdtindex);
+		rc = root_ioctl(device, OBD_IOC_CHANGELOG_SEND, &icf, idx,
+				WANT_ERROR);
+	} else {
+		rc = changelog_ioctl(device, OBD_IOC_CHANGELOG_SEND,
+				     cp->kuc.lk_wfd, startrec, flags);
+	}
 	/* Only the kernel reference keeps the write side open */
 	close(cp->kuc.lk_wfd);
 	cp->kuc.lk_wfd = LK_NOFD;
@@ -4373,6 +4409,12 @@ repeat:
 	/* Our message is a changelog_rec.  Use pointer math to skip
 	 * kuch_hdr and point directly to the message payload. */
 	*rech = (struct changelog_rec *)(kuch + 1);
+
+	/* Kernels not aware of CHANGELOG_FLAG_FILTER send every record */
+	if ((cp->flags & CHANGELOG_FLAG_FILTER) &&
+	    !changelog_filter_match(&cp->filter, *rech))
+		goto repeat;
+
 	changelog_remap_rec(*rech, rec_fmt);
 
         return 0;
@@ -730,7 +730,7 @@ check_obd_statfs(void)
 	CHECK_MEMBER(obd_statfs, os_namelen);
 	CHECK_MEMBER(obd_statfs, os_state);
 	CHECK_MEMBER(obd_statfs, os_fprecreated);
-	CHECK_MEMBER(obd_statfs, os_spare2);
+	CHECK_MEMBER(obd_statfs, os_io_latency);
 	CHECK_MEMBER(obd_statfs, os_spare3);
 	CHECK_MEMBER(obd_statfs, os_spare4);
 	CHECK_MEMBER(obd_statfs, os_spare5);
@@ -2091,7 +2091,7 @@ static void check_object_update_request(void)
 	CHECK_STRUCT(object_update_request);
 	CHECK_MEMBER(object_update_request, ourq_magic);
 	CHECK_MEMBER(object_update_request, ourq_count);
-	CHECK_MEMBER(object_update_request, ourq_padding);
+	CHECK_MEMBER(object_update_request, ourq_flags);
 	CHECK_MEMBER(object_update_request, ourq_updates);
 }
 
@@ -2154,6 +2154,8 @@ static void check_lfsck_request(void)
 	CHECK_VALUE(LE_SKIP_NLINK);
 	CHECK_VALUE(LE_SET_LMV_MASTER);
 	CHECK_VALUE(LE_SET_LMV_SLAVE);
+	CHECK_VALUE(LE_DIRTY_TRACK_ON);
+	CHECK_VALUE(LE_DIRTY_TRACK_OFF);
 
 	CHECK_VALUE_X(LEF_TO_OST);
 	CHECK_VALUE_X(LEF_FROM_OST);
@@ -2422,6 +2424,7 @@ main(int argc, char **argv)
 
 	CHECK_CVALUE(LQUOTA_TYPE_USR);
 	CHECK_CVALUE(LQUOTA_TYPE_GRP);
+	CHECK_CVALUE(LQUOTA_TYPE_PRJ);
 
 	CHECK_CVALUE(LQUOTA_RES_MD);
 	CHECK_CVALUE(LQUOTA_RES_DT);
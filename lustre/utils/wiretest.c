@@ -366,6 +366,7 @@ void lustre_assert_wire_constants(void)
 	CLASSERT(LUSTRE_RES_ID_HSH_OFF == 3);
 	CLASSERT(LQUOTA_TYPE_USR == 0);
 	CLASSERT(LQUOTA_TYPE_GRP == 1);
+	CLASSERT(LQUOTA_TYPE_PRJ == 2);
 	CLASSERT(LQUOTA_RES_MD == 1);
 	CLASSERT(LQUOTA_RES_DT == 2);
 	LASSERTF(OBD_PING == 400, "found %lld\n",
@@ -1619,10 +1620,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_statfs, os_fprecreated));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_fprecreated) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_fprecreated));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare2) == 112, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare2));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare2) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare2));
+	LASSERTF((int)offsetof(struct obd_statfs, os_io_latency) == 112, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_io_latency));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_io_latency) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_io_latency));
 	LASSERTF((int)offsetof(struct obd_statfs, os_spare3) == 116, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_statfs, os_spare3));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare3) == 4, "found %lld\n",
@@ -4587,10 +4588,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct object_update_request, ourq_count));
 	LASSERTF((int)sizeof(((struct object_update_request *)0)->ourq_count) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct object_update_request *)0)->ourq_count));
-	LASSERTF((int)offsetof(struct object_update_request, ourq_padding) == 6, "found %lld\n",
-		 (long long)(int)offsetof(struct object_update_request, ourq_padding));
-	LASSERTF((int)sizeof(((struct object_update_request *)0)->ourq_padding) == 2, "found %lld\n",
-		 (long long)(int)sizeof(((struct object_update_request *)0)->ourq_padding));
+	LASSERTF((int)offsetof(struct object_update_request, ourq_flags) == 6, "found %lld\n",
+		 (long long)(int)offsetof(struct object_update_request, ourq_flags));
+	LASSERTF((int)sizeof(((struct object_update_request *)0)->ourq_flags) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct object_update_request *)0)->ourq_flags));
 	LASSERTF((int)offsetof(struct object_update_request, ourq_updates) == 8, "found %lld\n",
 		 (long long)(int)offsetof(struct object_update_request, ourq_updates));
 	LASSERTF((int)sizeof(((struct object_update_request *)0)->ourq_updates) == 0, "found %lld\n",
@@ -4735,6 +4736,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)LE_SET_LMV_MASTER);
 	LASSERTF(LE_SET_LMV_SLAVE == 16, "found %lld\n",
 		 (long long)LE_SET_LMV_SLAVE);
+	LASSERTF(LE_DIRTY_TRACK_ON == 17, "found %lld\n",
+		 (long long)LE_DIRTY_TRACK_ON);
+	LASSERTF(LE_DIRTY_TRACK_OFF == 18, "found %lld\n",
+		 (long long)LE_DIRTY_TRACK_OFF);
 	LASSERTF(LEF_TO_OST == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)LEF_TO_OST);
 	LASSERTF(LEF_FROM_OST == 0x00000002UL, "found 0x%.8xUL\n",